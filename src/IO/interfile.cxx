@@ -907,6 +907,23 @@ write_basic_interfile(const string& filename,
   return success;
 }
 
+//! use positional reads if \a open_mode is read-only (see ProjDataFromStream::use_positional_reads_for_reading)
+static void
+use_positional_reads_if_read_only(ProjDataFromStream& proj_data, const string& data_file_name, const ios::openmode open_mode)
+{
+  if (open_mode & ios::out)
+    return;
+  try
+    {
+      proj_data.use_positional_reads_for_reading(data_file_name);
+    }
+  catch (...)
+    {
+      warning("interfile parsing: opening %s for positional reads failed. Reading via the stream instead.",
+              data_file_name.c_str());
+    }
+}
+
 static ProjDataFromStream*
 read_interfile_PDFS_SPECT(istream& input, const string& directory_for_data, const ios::openmode open_mode)
 {
@@ -939,15 +956,17 @@ read_interfile_PDFS_SPECT(istream& input, const string& directory_for_data, cons
       return 0;
     }
 
-  return new ProjDataFromStream(hdr.get_exam_info_sptr(),
-                                hdr.data_info_sptr,
-                                data_in,
-                                hdr.data_offset_each_dataset[0],
-                                segment_sequence,
-                                hdr.storage_order,
-                                hdr.type_of_numbers,
-                                hdr.file_byte_order,
-                                static_cast<float>(hdr.image_scaling_factors[0][0]));
+  auto pdfs_ptr = new ProjDataFromStream(hdr.get_exam_info_sptr(),
+                                         hdr.data_info_sptr,
+                                         data_in,
+                                         hdr.data_offset_each_dataset[0],
+                                         segment_sequence,
+                                         hdr.storage_order,
+                                         hdr.type_of_numbers,
+                                         hdr.file_byte_order,
+                                         static_cast<float>(hdr.image_scaling_factors[0][0]));
+  use_positional_reads_if_read_only(*pdfs_ptr, full_data_file_name, open_mode);
+  return pdfs_ptr;
 }
 
 ProjDataFromStream*
@@ -988,6 +1007,7 @@ read_interfile_PDFS_Siemens(istream& input, const string& directory_for_data, co
 
   if (hdr.timing_poss_sequence.size() > 1)
     pdfs_ptr->set_timing_poss_sequence_in_stream(hdr.timing_poss_sequence);
+  use_positional_reads_if_read_only(*pdfs_ptr, full_data_file_name, open_mode);
   return pdfs_ptr;
 }
 
@@ -1061,6 +1081,7 @@ read_interfile_PDFS(istream& input, const string& directory_for_data, const ios:
 
   if (hdr.timing_poss_sequence.size() > 1)
     pdfs_ptr->set_timing_poss_sequence_in_stream(hdr.timing_poss_sequence);
+  use_positional_reads_if_read_only(*pdfs_ptr, full_data_file_name, open_mode);
   return pdfs_ptr;
 }
 
@@ -1243,6 +1264,13 @@ write_basic_interfile_PDFS_header(const string& header_file_name, const string&
           order_of_z = 2;
           break;
         }
+        case ProjDataFromStream::Timing_Segment_AxialPos_View_TangPos: {
+          order_of_timing_poss = 5;
+          order_of_segment = 4;
+          order_of_view = 2;
+          order_of_z = 3;
+          break;
+        }
         default: {
           error("write_interfile_PSOV_header: unsupported storage order, "
                 "defaulting to Segment_View_AxialPos_TangPos.\n Please correct by hand !");
@@ -0,0 +1,152 @@
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup buildblock
+  \brief Implementation of class stir::FileWithPositionalReads
+*/
+
+#include "stir/FileWithPositionalReads.h"
+#include "stir/error.h"
+
+#if defined(__OS_WIN__)
+#  include <windows.h>
+#else
+#  include <sys/types.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <cerrno>
+#endif
+
+START_NAMESPACE_STIR
+
+FileWithPositionalReads::FileWithPositionalReads()
+    : opened(false)
+#if defined(__OS_WIN__)
+      ,
+      file_handle(0)
+#else
+      ,
+      file_descriptor(-1)
+#endif
+{}
+
+FileWithPositionalReads::FileWithPositionalReads(const std::string& filename)
+    : FileWithPositionalReads()
+{
+  this->open(filename);
+}
+
+FileWithPositionalReads::~FileWithPositionalReads()
+{
+  this->close();
+}
+
+#if defined(__OS_WIN__)
+
+void
+FileWithPositionalReads::open(const std::string& filename_v)
+{
+  this->close();
+  this->filename = filename_v;
+  HANDLE fh = CreateFileA(filename.c_str(),
+                          GENERIC_READ,
+                          FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                          NULL,
+                          OPEN_EXISTING,
+                          FILE_ATTRIBUTE_NORMAL,
+                          NULL);
+  if (fh == INVALID_HANDLE_VALUE)
+    error("FileWithPositionalReads: cannot open \"" + filename + "\"");
+  this->file_handle = fh;
+  this->opened = true;
+}
+
+void
+FileWithPositionalReads::close()
+{
+  if (!this->opened)
+    return;
+  if (this->file_handle)
+    CloseHandle(static_cast<HANDLE>(this->file_handle));
+  this->file_handle = 0;
+  this->opened = false;
+}
+
+std::size_t
+FileWithPositionalReads::read(char* buffer, const std::size_t num_bytes, const std::uint64_t offset) const
+{
+  std::size_t num_read = 0;
+  while (num_read < num_bytes)
+    {
+      const std::uint64_t current_offset = offset + num_read;
+      OVERLAPPED overlapped = {};
+      overlapped.Offset = static_cast<DWORD>(current_offset & 0xFFFFFFFFu);
+      overlapped.OffsetHigh = static_cast<DWORD>(current_offset >> 32);
+      const std::size_t remaining = num_bytes - num_read;
+      const DWORD num_to_read = remaining > 0x40000000u ? 0x40000000u : static_cast<DWORD>(remaining);
+      DWORD num_read_this_time = 0;
+      if (!ReadFile(static_cast<HANDLE>(this->file_handle), buffer + num_read, num_to_read, &num_read_this_time, &overlapped)
+          || num_read_this_time == 0)
+        break;
+      num_read += num_read_this_time;
+    }
+  return num_read;
+}
+
+#else // Unix
+
+void
+FileWithPositionalReads::open(const std::string& filename_v)
+{
+  this->close();
+  this->filename = filename_v;
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    error("FileWithPositionalReads: cannot open \"" + filename + "\"");
+  this->file_descriptor = fd;
+  this->opened = true;
+}
+
+void
+FileWithPositionalReads::close()
+{
+  if (!this->opened)
+    return;
+  if (this->file_descriptor >= 0)
+    ::close(this->file_descriptor);
+  this->file_descriptor = -1;
+  this->opened = false;
+}
+
+std::size_t
+FileWithPositionalReads::read(char* buffer, const std::size_t num_bytes, const std::uint64_t offset) const
+{
+  std::size_t num_read = 0;
+  // pread can return fewer bytes than asked for, so loop until done (or end of file)
+  while (num_read < num_bytes)
+    {
+      const ssize_t num_read_this_time
+          = ::pread(this->file_descriptor, buffer + num_read, num_bytes - num_read, static_cast<off_t>(offset + num_read));
+      if (num_read_this_time < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          break;
+        }
+      if (num_read_this_time == 0)
+        break;
+      num_read += static_cast<std::size_t>(num_read_this_time);
+    }
+  return num_read;
+}
+
+#endif
+
+END_NAMESPACE_STIR
@@ -1282,6 +1282,11 @@ apply_block_norm(FanProjData& fan_data, const BlockData3D& block_data, const boo
   const int num_tangential_crystals_per_block = num_tangential_detectors / num_tangential_blocks;
   assert(num_tangential_blocks * num_tangential_crystals_per_block == num_tangential_detectors);
 
+  // note: as rb >= ra, all elements for a given ra are stored in the ra-th row of fan_data,
+  // such that we can loop over rings in parallel
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
     for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
       // loop rb from ra to avoid double counting
@@ -1394,6 +1399,9 @@ apply_geo_norm(FanProjData& fan_data, const GeoData3D& geo_data, const bool appl
               }
           }
 
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
     for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
       //    for (int rb = fan_data.get_min_ra(); rb <= fan_data.get_max_ra(); ++rb)
@@ -1414,6 +1422,9 @@ void
 apply_efficiencies(FanProjData& fan_data, const DetectorEfficiencies& efficiencies, const bool apply)
 {
   const int num_detectors_per_ring = fan_data.get_num_detectors_per_ring();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
     for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
       // loop rb from ra to avoid double counting
@@ -1432,6 +1443,9 @@ apply_efficiencies(FanProjData& fan_data, const DetectorEfficiencies& efficienci
 void
 make_fan_sum_data(Array<2, float>& data_fan_sums, const FanProjData& fan_data)
 {
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
     for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
       data_fan_sums[ra][a] = fan_data.sum(ra, a);
@@ -1520,6 +1534,9 @@ make_fan_sum_data(Array<2, float>& data_fan_sums,
   assert(data_fan_sums.get_min_index() == 0);
   const int num_detectors_per_ring = data_fan_sums[0].get_length();
 
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = data_fan_sums.get_min_index(); ra <= data_fan_sums.get_max_index(); ++ra)
     for (int a = data_fan_sums[ra].get_min_index(); a <= data_fan_sums[ra].get_max_index(); ++a)
       {
@@ -1547,6 +1564,9 @@ make_geo_data(GeoData3D& geo_data, const FanProjData& fan_data)
   FanProjData work = fan_data;
   work.fill(0);
 
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
     for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
       // 1// for (int rb = fan_data.get_min_ra(); rb <= fan_data.get_max_ra(); ++rb)
@@ -1568,6 +1588,10 @@ make_geo_data(GeoData3D& geo_data, const FanProjData& fan_data)
 
   geo_data.fill(0);
 
+  // every (ra,a) only accumulates into its own row of geo_data
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic) collapse(2)
+#endif
   for (int ra = 0; ra < num_axial_crystals_per_block; ++ra)
     //  for (int a = 0; a <= num_transaxial_detectors/2; ++a)
     for (int a = 0; a < num_transaxial_crystals_per_block / 2; ++a)
@@ -1607,47 +1631,88 @@ make_block_data(BlockData3D& block_data, const FanProjData& fan_data)
   const int num_axial_blocks = block_data.get_num_rings();
   const int num_transaxial_blocks = block_data.get_num_detectors_per_ring();
   const int num_axial_crystals_per_block = num_axial_detectors / num_axial_blocks;
-  assert(num_axial_blocks * num_axial_crystals_per_block == num_axial_detectors);
+  if (num_axial_blocks * num_axial_crystals_per_block != num_axial_detectors)
+    error("make_block_data: number of rings (%d) has to be a multiple of the number of axial blocks (%d)",
+          num_axial_detectors,
+          num_axial_blocks);
   const int num_transaxial_crystals_per_block = num_transaxial_detectors / num_transaxial_blocks;
   assert(num_transaxial_blocks * num_transaxial_crystals_per_block == num_transaxial_detectors);
 
+  assert(fan_data.get_min_ra() >= 0);
   block_data.fill(0);
-  for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
-    for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
-      // loop rb from ra to avoid double counting
-      for (int rb = max(ra, fan_data.get_min_rb(ra)); rb <= fan_data.get_max_rb(ra); ++rb)
-        for (int b = fan_data.get_min_b(a); b <= fan_data.get_max_b(a); ++b)
-          {
-            block_data(ra / num_axial_crystals_per_block,
-                       a / num_transaxial_crystals_per_block,
-                       rb / num_axial_crystals_per_block,
-                       b / num_transaxial_crystals_per_block)
-                += fan_data(ra, a, rb, b);
-          }
+  // all rings in an axial block accumulate into the same row of block_data,
+  // so we loop over axial blocks in parallel (using the same block index ra / num_axial_crystals_per_block as before)
+  const int min_axial_block_num = fan_data.get_min_ra() / num_axial_crystals_per_block;
+  const int max_axial_block_num = fan_data.get_max_ra() / num_axial_crystals_per_block;
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int axial_block_num = min_axial_block_num; axial_block_num <= max_axial_block_num; ++axial_block_num)
+    for (int ra = max(fan_data.get_min_ra(), axial_block_num * num_axial_crystals_per_block);
+         ra <= min(fan_data.get_max_ra(), (axial_block_num + 1) * num_axial_crystals_per_block - 1);
+         ++ra)
+      for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
+        // loop rb from ra to avoid double counting
+        for (int rb = max(ra, fan_data.get_min_rb(ra)); rb <= fan_data.get_max_rb(ra); ++rb)
+          for (int b = fan_data.get_min_b(a); b <= fan_data.get_max_b(a); ++b)
+            {
+              block_data(axial_block_num,
+                         a / num_transaxial_crystals_per_block,
+                         rb / num_axial_crystals_per_block,
+                         b / num_transaxial_crystals_per_block)
+                  += fan_data(ra, a, rb, b);
+            }
 }
 
-void
-iterate_efficiencies(DetectorEfficiencies& efficiencies, const Array<2, float>& data_fan_sums, const FanProjData& model)
+static float
+efficiency_denominator(const DetectorEfficiencies& efficiencies, const FanProjData& model, const int ra, const int a)
 {
   const int num_detectors_per_ring = model.get_num_detectors_per_ring();
+  float denominator = 0;
+  for (int rb = model.get_min_rb(ra); rb <= model.get_max_rb(ra); ++rb)
+    for (int b = model.get_min_b(a); b <= model.get_max_b(a); ++b)
+      denominator += efficiencies[rb][b % num_detectors_per_ring] * model(ra, a, rb, b);
+  return denominator;
+}
+
+void
+iterate_efficiencies(DetectorEfficiencies& efficiencies,
+                     const Array<2, float>& data_fan_sums,
+                     const FanProjData& model,
+                     const bool simultaneous_update)
+{
   assert(model.get_min_ra() == data_fan_sums.get_min_index());
   assert(model.get_max_ra() == data_fan_sums.get_max_index());
   assert(model.get_min_a() == data_fan_sums[data_fan_sums.get_min_index()].get_min_index());
   assert(model.get_max_a() == data_fan_sums[data_fan_sums.get_min_index()].get_max_index());
-  for (int ra = model.get_min_ra(); ra <= model.get_max_ra(); ++ra)
-    for (int a = model.get_min_a(); a <= model.get_max_a(); ++a)
-      {
-        if (data_fan_sums[ra][a] == 0)
-          efficiencies[ra][a] = 0;
-        else
+  if (simultaneous_update)
+    {
+      // all denominators use the efficiencies from the previous sub-iteration, so all rings are independent
+      const DetectorEfficiencies previous_efficiencies(efficiencies);
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+      for (int ra = model.get_min_ra(); ra <= model.get_max_ra(); ++ra)
+        for (int a = model.get_min_a(); a <= model.get_max_a(); ++a)
           {
-            float denominator = 0;
-            for (int rb = model.get_min_rb(ra); rb <= model.get_max_rb(ra); ++rb)
-              for (int b = model.get_min_b(a); b <= model.get_max_b(a); ++b)
-                denominator += efficiencies[rb][b % num_detectors_per_ring] * model(ra, a, rb, b);
-            efficiencies[ra][a] = data_fan_sums[ra][a] / denominator;
+            if (data_fan_sums[ra][a] == 0)
+              efficiencies[ra][a] = 0;
+            else
+              efficiencies[ra][a] = data_fan_sums[ra][a] / efficiency_denominator(previous_efficiencies, model, ra, a);
           }
-      }
+    }
+  else
+    {
+      // sequential update, using the new efficiencies as soon as they are computed
+      for (int ra = model.get_min_ra(); ra <= model.get_max_ra(); ++ra)
+        for (int a = model.get_min_a(); a <= model.get_max_a(); ++a)
+          {
+            if (data_fan_sums[ra][a] == 0)
+              efficiencies[ra][a] = 0;
+            else
+              efficiencies[ra][a] = data_fan_sums[ra][a] / efficiency_denominator(efficiencies, model, ra, a);
+          }
+    }
 }
 
 // version without model
@@ -1708,6 +1773,9 @@ iterate_geo_norm(GeoData3D& norm_geo_data, const GeoData3D& measured_geo_data, c
 
   const float threshold = measured_geo_data.find_max() / 10000.F;
 
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic) collapse(2)
+#endif
   for (int ra = 0; ra < num_axial_crystals_per_block; ++ra)
     for (int a = 0; a < num_transaxial_crystals_per_block / 2; ++a)
       // loop rb from ra to avoid double counting
@@ -1729,6 +1797,9 @@ iterate_block_norm(BlockData3D& norm_block_data, const BlockData3D& measured_blo
   make_block_data(norm_block_data, model);
   // norm_block_data = measured_block_data / norm_block_data;
   const float threshold = measured_block_data.find_max() / 10000.F;
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = norm_block_data.get_min_ra(); ra <= norm_block_data.get_max_ra(); ++ra)
     for (int a = norm_block_data.get_min_a(); a <= norm_block_data.get_max_a(); ++a)
       // loop rb from ra to avoid double counting
@@ -1746,6 +1817,9 @@ double
 KL(const FanProjData& d1, const FanProjData& d2, const double threshold)
 {
   double sum = 0;
+#ifdef STIR_OPENMP
+#  pragma omp parallel for reduction(+ : sum) schedule(dynamic)
+#endif
   for (int ra = d1.get_min_ra(); ra <= d1.get_max_ra(); ++ra)
     {
       double asum = 0;
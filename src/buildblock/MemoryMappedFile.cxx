@@ -0,0 +1,208 @@
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup buildblock
+  \brief Implementation of class stir::MemoryMappedFile
+*/
+
+#include "stir/MemoryMappedFile.h"
+#include "stir/error.h"
+#include <algorithm>
+
+#if defined(__OS_WIN__)
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+START_NAMESPACE_STIR
+
+MemoryMappedFile::MemoryMappedFile()
+    : opened(false),
+      mode(Mode::read_only),
+      data_ptr(0),
+      num_bytes(0)
+#if defined(__OS_WIN__)
+      ,
+      file_handle(0),
+      mapping_handle(0)
+#else
+      ,
+      file_descriptor(-1)
+#endif
+{}
+
+MemoryMappedFile::MemoryMappedFile(const std::string& filename, const Mode mode)
+    : MemoryMappedFile()
+{
+  this->open(filename, mode);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+  this->close();
+}
+
+char*
+MemoryMappedFile::get_data_ptr()
+{
+  if (this->mode != Mode::read_write)
+    error("MemoryMappedFile: file \"" + this->filename + "\" was opened read-only, but write access was requested");
+  return this->data_ptr;
+}
+
+#if defined(__OS_WIN__)
+
+void
+MemoryMappedFile::open(const std::string& filename_v, const Mode mode_v)
+{
+  this->close();
+  this->filename = filename_v;
+  this->mode = mode_v;
+  const bool rw = this->mode == Mode::read_write;
+  HANDLE fh = CreateFileA(filename.c_str(),
+                          rw ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                          FILE_SHARE_READ | FILE_SHARE_WRITE,
+                          NULL,
+                          OPEN_EXISTING,
+                          FILE_ATTRIBUTE_NORMAL,
+                          NULL);
+  if (fh == INVALID_HANDLE_VALUE)
+    error("MemoryMappedFile: cannot open \"" + filename + "\"");
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(fh, &file_size))
+    {
+      CloseHandle(fh);
+      error("MemoryMappedFile: cannot find size of \"" + filename + "\"");
+    }
+  this->file_handle = fh;
+  this->num_bytes = static_cast<std::size_t>(file_size.QuadPart);
+  this->opened = true;
+  if (this->num_bytes == 0)
+    return;
+
+  HANDLE mh = CreateFileMappingA(fh, NULL, rw ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+  if (mh == NULL)
+    {
+      this->close();
+      error("MemoryMappedFile: cannot create mapping for \"" + filename + "\"");
+    }
+  this->mapping_handle = mh;
+  void* ptr = MapViewOfFile(mh, rw ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+  if (ptr == NULL)
+    {
+      this->close();
+      error("MemoryMappedFile: cannot map \"" + filename + "\"");
+    }
+  this->data_ptr = static_cast<char*>(ptr);
+}
+
+void
+MemoryMappedFile::close()
+{
+  if (!this->opened)
+    return;
+  if (this->data_ptr)
+    UnmapViewOfFile(this->data_ptr);
+  if (this->mapping_handle)
+    CloseHandle(static_cast<HANDLE>(this->mapping_handle));
+  if (this->file_handle)
+    CloseHandle(static_cast<HANDLE>(this->file_handle));
+  this->data_ptr = 0;
+  this->mapping_handle = 0;
+  this->file_handle = 0;
+  this->num_bytes = 0;
+  this->opened = false;
+}
+
+void
+MemoryMappedFile::flush()
+{
+  if (this->data_ptr && this->mode == Mode::read_write)
+    FlushViewOfFile(this->data_ptr, 0);
+}
+
+void
+MemoryMappedFile::will_need(const std::size_t, const std::size_t) const
+{}
+
+#else // Unix
+
+void
+MemoryMappedFile::open(const std::string& filename_v, const Mode mode_v)
+{
+  this->close();
+  this->filename = filename_v;
+  this->mode = mode_v;
+  const bool rw = this->mode == Mode::read_write;
+  const int fd = ::open(filename.c_str(), rw ? O_RDWR : O_RDONLY);
+  if (fd < 0)
+    error("MemoryMappedFile: cannot open \"" + filename + "\"");
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0)
+    {
+      ::close(fd);
+      error("MemoryMappedFile: cannot find size of \"" + filename + "\"");
+    }
+  this->file_descriptor = fd;
+  this->num_bytes = static_cast<std::size_t>(file_stat.st_size);
+  this->opened = true;
+  if (this->num_bytes == 0)
+    return;
+
+  void* ptr = mmap(0, this->num_bytes, rw ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+  if (ptr == MAP_FAILED)
+    {
+      this->close();
+      error("MemoryMappedFile: cannot map \"" + filename + "\"");
+    }
+  this->data_ptr = static_cast<char*>(ptr);
+}
+
+void
+MemoryMappedFile::close()
+{
+  if (!this->opened)
+    return;
+  if (this->data_ptr)
+    munmap(this->data_ptr, this->num_bytes);
+  if (this->file_descriptor >= 0)
+    ::close(this->file_descriptor);
+  this->data_ptr = 0;
+  this->file_descriptor = -1;
+  this->num_bytes = 0;
+  this->opened = false;
+}
+
+void
+MemoryMappedFile::flush()
+{
+  if (this->data_ptr && this->mode == Mode::read_write)
+    msync(this->data_ptr, this->num_bytes, MS_SYNC);
+}
+
+void
+MemoryMappedFile::will_need(const std::size_t offset, const std::size_t num_bytes_v) const
+{
+  if (!this->data_ptr || offset >= this->num_bytes)
+    return;
+  // madvise needs a page-aligned address
+  const std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const std::size_t aligned_offset = offset - offset % page_size;
+  const std::size_t length = std::min(this->num_bytes - aligned_offset, num_bytes_v + (offset - aligned_offset));
+  madvise(this->data_ptr + aligned_offset, length, MADV_WILLNEED);
+}
+
+#endif
+
+END_NAMESPACE_STIR
@@ -49,9 +49,12 @@
 #include "stir/ViewgramIndices.h"
 #include "stir/is_null_ptr.h"
 #include "stir/numerics/norm.h"
+#include "stir/apply_to_proj_data.h"
 #include <cstring>
 #include <fstream>
 #include <algorithm>
+#include <functional>
+#include <limits>
 #include "stir/error.h"
 
 using std::istream;
@@ -360,16 +363,7 @@ ProjData::set_segment(const SegmentByView<float>& segment)
 void
 ProjData::fill(const float value)
 {
-  for (int timing_pos_num = this->get_min_tof_pos_num(); timing_pos_num <= this->get_max_tof_pos_num(); ++timing_pos_num)
-    {
-      for (int segment_num = this->get_min_segment_num(); segment_num <= this->get_max_segment_num(); ++segment_num)
-        {
-          SegmentByView<float> segment(this->get_empty_segment_by_view(segment_num, false, timing_pos_num));
-          segment.fill(value);
-          if (this->set_segment(segment) == Succeeded::no)
-            error("Error setting segment of projection data");
-        }
-    }
+  transform_proj_data(*this, [value](SegmentBySinogram<float>& segment) { segment.fill(value); });
 }
 
 void
@@ -381,14 +375,8 @@ ProjData::fill(const ProjData& proj_data)
   if ((*this->get_proj_data_info_sptr()) != (*source_proj_data_info_sptr))
     error("Filling projection data from incompatible  source");
 
-  for (int segment_num = this->get_min_segment_num(); segment_num <= this->get_max_segment_num(); ++segment_num)
-    {
-      for (int timing_pos_num = this->get_min_tof_pos_num(); timing_pos_num <= this->get_max_tof_pos_num(); ++timing_pos_num)
-        {
-          if (this->set_segment(proj_data.get_segment_by_view(segment_num, timing_pos_num)) == Succeeded::no)
-            error("Error setting segment of projection data");
-        }
-    }
+  auto copy = [](SegmentBySinogram<float>& segment, const SegmentBySinogram<float>& source) { segment = source; };
+  transform_proj_data(*this, copy, proj_data);
 }
 
 ProjData::ProjData()
@@ -423,19 +411,10 @@ ProjData::xapyb(const ProjData& x, const float a, const ProjData& y, const float
   if (*get_proj_data_info_sptr() != *x.get_proj_data_info_sptr() || *get_proj_data_info_sptr() != *y.get_proj_data_info_sptr())
     error("ProjData::xapyb: ProjDataInfo don't match");
 
-  const int s_min = get_min_segment_num();
-  const int s_max = get_max_segment_num();
-
-  for (int timing_pos_num = this->get_min_tof_pos_num(); timing_pos_num <= this->get_max_tof_pos_num(); ++timing_pos_num)
-    for (int s = s_min; s <= s_max; ++s)
-      {
-        auto seg = get_empty_segment_by_sinogram(s, false, timing_pos_num);
-        const auto sx = x.get_segment_by_sinogram(s, timing_pos_num);
-        const auto sy = y.get_segment_by_sinogram(s, timing_pos_num);
-        seg.xapyb(sx, a, sy, b);
-        if (set_segment(seg) == Succeeded::no)
-          error("ProjData::xapyb: set_segment failed. Write-only file?");
-      }
+  auto func = [a, b](SegmentBySinogram<float>& seg, const SegmentBySinogram<float>& sx, const SegmentBySinogram<float>& sy) {
+    seg.xapyb(sx, a, sy, b);
+  };
+  transform_proj_data(*this, func, x, y);
 }
 
 void
@@ -445,22 +424,12 @@ ProjData::xapyb(const ProjData& x, const ProjData& a, const ProjData& y, const P
       || *get_proj_data_info_sptr() != *a.get_proj_data_info_sptr() || *get_proj_data_info_sptr() != *b.get_proj_data_info_sptr())
     error("ProjData::xapyb: ProjDataInfo don't match");
 
-  const int s_min = get_min_segment_num();
-  const int s_max = get_max_segment_num();
-
-  for (int timing_pos_num = this->get_min_tof_pos_num(); timing_pos_num <= this->get_max_tof_pos_num(); ++timing_pos_num)
-    for (int s = s_min; s <= s_max; ++s)
-      {
-        auto seg = get_empty_segment_by_sinogram(s, false, timing_pos_num);
-        const auto sx = x.get_segment_by_sinogram(s, timing_pos_num);
-        const auto sy = y.get_segment_by_sinogram(s, timing_pos_num);
-        const auto sa = a.get_segment_by_sinogram(s, timing_pos_num);
-        const auto sb = b.get_segment_by_sinogram(s, timing_pos_num);
-
-        seg.xapyb(sx, sa, sy, sb);
-        if (set_segment(seg) == Succeeded::no)
-          error("ProjData::xapyb: set_segment failed. Write-only file?");
-      }
+  auto func = [](SegmentBySinogram<float>& seg,
+                 const SegmentBySinogram<float>& sx,
+                 const SegmentBySinogram<float>& sa,
+                 const SegmentBySinogram<float>& sy,
+                 const SegmentBySinogram<float>& sb) { seg.xapyb(sx, sa, sy, sb); };
+  transform_proj_data(*this, func, x, a, y, b);
 }
 
 void
@@ -478,74 +447,31 @@ ProjData::sapyb(const ProjData& a, const ProjData& y, const ProjData& b)
 float
 ProjData::sum() const
 {
-  double t = 0.;
-  for (int timing_pos_num = this->get_min_tof_pos_num(); timing_pos_num <= this->get_max_tof_pos_num(); ++timing_pos_num)
-    for (int s = this->get_min_segment_num(); s <= this->get_max_segment_num(); ++s)
-      {
-        const SegmentIndices ind(s, timing_pos_num);
-        t += this->get_segment_by_sinogram(ind).sum();
-      }
-  return static_cast<float>(t);
+  auto segment_sum = [](const SegmentBySinogram<float>& seg) { return static_cast<double>(seg.sum()); };
+  return static_cast<float>(reduce_proj_data(*this, 0., segment_sum, std::plus<double>()));
 }
 
 float
 ProjData::find_max() const
 {
-  float t = 0;
-  bool init = true;
-  for (int timing_pos_num = this->get_min_tof_pos_num(); timing_pos_num <= this->get_max_tof_pos_num(); ++timing_pos_num)
-    for (int s = this->get_min_segment_num(); s <= this->get_max_segment_num(); ++s)
-      {
-        const SegmentIndices ind(s, timing_pos_num);
-        const auto t_seg = this->get_segment_by_sinogram(ind).find_max();
-        if (init)
-          {
-            init = false;
-            t = t_seg;
-          }
-        else
-          {
-            t = std::max(t, t_seg);
-          }
-      }
-  return t;
+  auto segment_max = [](const SegmentBySinogram<float>& seg) { return seg.find_max(); };
+  auto combine = [](float t, float t_seg) { return std::max(t, t_seg); };
+  return reduce_proj_data(*this, -std::numeric_limits<float>::max(), segment_max, combine);
 }
 
 float
 ProjData::find_min() const
 {
-  float t = 0;
-  bool init = true;
-  for (int timing_pos_num = this->get_min_tof_pos_num(); timing_pos_num <= this->get_max_tof_pos_num(); ++timing_pos_num)
-    for (int s = this->get_min_segment_num(); s <= this->get_max_segment_num(); ++s)
-      {
-        const SegmentIndices ind(s, timing_pos_num);
-        const auto t_seg = this->get_segment_by_sinogram(ind).find_min();
-        if (init)
-          {
-            init = false;
-            t = t_seg;
-          }
-        else
-          {
-            t = std::min(t, t_seg);
-          }
-      }
-  return t;
+  auto segment_min = [](const SegmentBySinogram<float>& seg) { return seg.find_min(); };
+  auto combine = [](float t, float t_seg) { return std::min(t, t_seg); };
+  return reduce_proj_data(*this, std::numeric_limits<float>::max(), segment_min, combine);
 }
 
 double
 ProjData::norm_squared() const
 {
-  double t = 0.;
-  for (int timing_pos_num = this->get_min_tof_pos_num(); timing_pos_num <= this->get_max_tof_pos_num(); ++timing_pos_num)
-    for (int s = this->get_min_segment_num(); s <= this->get_max_segment_num(); ++s)
-      {
-        const SegmentIndices ind(s, timing_pos_num);
-        const auto seg = this->get_segment_by_sinogram(ind);
-        t += stir::norm_squared(seg.begin_all(), seg.end_all());
-      }
-  return t;
+  auto segment_norm_squared = [](const SegmentBySinogram<float>& seg) { return stir::norm_squared(seg.begin_all(), seg.end_all()); };
+  return reduce_proj_data(*this, 0., segment_norm_squared, std::plus<double>());
 }
 
 double
@@ -554,86 +480,64 @@ ProjData::norm() const
   return std::sqrt(this->norm_squared());
 }
 
-// static helper functions to iterate over segment and apply a function
-
-// func(s1, s2) is supposed to modify s1
-template <typename Func>
-static ProjData&
-apply_func(ProjData& self, const ProjData& arg, Func func)
-{
-  for (int timing_pos_num = self.get_min_tof_pos_num(); timing_pos_num <= self.get_max_tof_pos_num(); ++timing_pos_num)
-    for (int s = self.get_min_segment_num(); s <= self.get_max_segment_num(); ++s)
-      {
-        const SegmentIndices ind(s, timing_pos_num);
-        auto seg = self.get_segment_by_sinogram(ind);
-        func(seg, arg.get_segment_by_sinogram(ind));
-        self.set_segment(seg);
-      }
-  return self;
-}
-
-// func(s1) is supposed to modify s1
-template <typename Func>
-static ProjData&
-apply_func(ProjData& self, Func func)
-{
-  for (int timing_pos_num = self.get_min_tof_pos_num(); timing_pos_num <= self.get_max_tof_pos_num(); ++timing_pos_num)
-    for (int s = self.get_min_segment_num(); s <= self.get_max_segment_num(); ++s)
-      {
-        const SegmentIndices ind(s, timing_pos_num);
-        auto seg = self.get_segment_by_sinogram(ind);
-        func(seg);
-        self.set_segment(seg);
-      }
-  return self;
-}
-
 ProjData&
 ProjData::operator+=(const ProjData& arg)
 {
-  return apply_func(*this, arg, [](SegmentBySinogram<float>& s, const SegmentBySinogram<float>& s_arg) { s += s_arg; });
+  in_place_apply_to_proj_data(
+      *this, [](SegmentBySinogram<float>& s, const SegmentBySinogram<float>& s_arg) { s += s_arg; }, arg);
+  return *this;
 }
 
 ProjData&
 ProjData::operator-=(const ProjData& arg)
 {
-  return apply_func(*this, arg, [](SegmentBySinogram<float>& s, const SegmentBySinogram<float>& s_arg) { s -= s_arg; });
+  in_place_apply_to_proj_data(
+      *this, [](SegmentBySinogram<float>& s, const SegmentBySinogram<float>& s_arg) { s -= s_arg; }, arg);
+  return *this;
 }
 
 ProjData&
 ProjData::operator*=(const ProjData& arg)
 {
-  return apply_func(*this, arg, [](SegmentBySinogram<float>& s, const SegmentBySinogram<float>& s_arg) { s *= s_arg; });
+  in_place_apply_to_proj_data(
+      *this, [](SegmentBySinogram<float>& s, const SegmentBySinogram<float>& s_arg) { s *= s_arg; }, arg);
+  return *this;
 }
 
 ProjData&
 ProjData::operator/=(const ProjData& arg)
 {
-  return apply_func(*this, arg, [](SegmentBySinogram<float>& s, const SegmentBySinogram<float>& s_arg) { s /= s_arg; });
+  in_place_apply_to_proj_data(
+      *this, [](SegmentBySinogram<float>& s, const SegmentBySinogram<float>& s_arg) { s /= s_arg; }, arg);
+  return *this;
 }
 
 ProjData&
 ProjData::operator+=(float arg)
 {
-  return apply_func(*this, [arg](SegmentBySinogram<float>& s) { s += arg; });
+  in_place_apply_to_proj_data(*this, [arg](SegmentBySinogram<float>& s) { s += arg; });
+  return *this;
 }
 
 ProjData&
 ProjData::operator-=(float arg)
 {
-  return apply_func(*this, [arg](SegmentBySinogram<float>& s) { s -= arg; });
+  in_place_apply_to_proj_data(*this, [arg](SegmentBySinogram<float>& s) { s -= arg; });
+  return *this;
 }
 
 ProjData&
 ProjData::operator*=(float arg)
 {
-  return apply_func(*this, [arg](SegmentBySinogram<float>& s) { s *= arg; });
+  in_place_apply_to_proj_data(*this, [arg](SegmentBySinogram<float>& s) { s *= arg; });
+  return *this;
 }
 
 ProjData&
 ProjData::operator/=(float arg)
 {
-  return apply_func(*this, [arg](SegmentBySinogram<float>& s) { s /= arg; });
+  in_place_apply_to_proj_data(*this, [arg](SegmentBySinogram<float>& s) { s /= arg; });
+  return *this;
 }
 
 std::vector<int>
@@ -37,7 +37,10 @@
 #include "stir/IO/write_data.h"
 #include "stir/IO/read_data.h"
 #include "stir/is_null_ptr.h"
+#include "stir/MemoryMappedFile.h"
+#include "stir/FileWithPositionalReads.h"
 #include <numeric>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include "stir/warning.h"
@@ -173,8 +176,168 @@ checked_seekp(const std::string& fname, std::ostream& s, const std::streamoff of
   if (!s)
     error("ProjDataFromStream::" + fname + " error after seekp to offset " + std::to_string(offset));
 }
+
+//! A read-only std::streambuf for data in memory, supporting seekg
+class ReadOnlyMemoryStreamBuf : public std::streambuf
+{
+public:
+  ReadOnlyMemoryStreamBuf(const char* data_ptr, const std::size_t num_bytes)
+  {
+    char* const begin = const_cast<char*>(data_ptr);
+    this->setg(begin, begin, begin + num_bytes);
+  }
+
+protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+  {
+    if (!(which & std::ios_base::in))
+      return pos_type(off_type(-1));
+    char* const base = dir == std::ios_base::beg ? this->eback() : dir == std::ios_base::cur ? this->gptr() : this->egptr();
+    if (off < this->eback() - base || off > this->egptr() - base)
+      return pos_type(off_type(-1));
+    this->setg(this->eback(), base + off, this->egptr());
+    return pos_type(this->gptr() - this->eback());
+  }
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+  {
+    return this->seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+};
+
+//! A read-only std::streambuf using positional reads from a file, supporting seekg
+/*! There is no buffering, i.e. every read from the stream results in a read from the file. */
+class PositionalReadStreamBuf : public std::streambuf
+{
+public:
+  explicit PositionalReadStreamBuf(const FileWithPositionalReads& file)
+      : file(file),
+        position(0)
+  {}
+
+protected:
+  // only used for reading single characters
+  int_type underflow() override
+  {
+    if (this->file.read(&this->current_char, 1, this->position) != 1)
+      return traits_type::eof();
+    this->setg(&this->current_char, &this->current_char, &this->current_char + 1);
+    ++this->position;
+    return traits_type::to_int_type(this->current_char);
+  }
+  std::streamsize xsgetn(char* s, std::streamsize n) override
+  {
+    std::streamsize num_read = 0;
+    // first use a character left by underflow() (if any)
+    if (n > 0 && this->gptr() < this->egptr())
+      {
+        *s = *this->gptr();
+        this->gbump(1);
+        num_read = 1;
+      }
+    const std::size_t num_read_from_file
+        = this->file.read(s + num_read, static_cast<std::size_t>(n - num_read), this->position);
+    this->position += num_read_from_file;
+    return num_read + static_cast<std::streamsize>(num_read_from_file);
+  }
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+  {
+    if (!(which & std::ios_base::in) || dir == std::ios_base::end)
+      return pos_type(off_type(-1));
+    const std::uint64_t current = this->position - static_cast<std::uint64_t>(this->egptr() - this->gptr());
+    const off_type new_position = (dir == std::ios_base::beg ? 0 : static_cast<off_type>(current)) + off;
+    if (new_position < 0)
+      return pos_type(off_type(-1));
+    this->position = static_cast<std::uint64_t>(new_position);
+    this->setg(0, 0, 0);
+    return pos_type(new_position);
+  }
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+  {
+    return this->seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+
+private:
+  const FileWithPositionalReads& file;
+  //! position in the file corresponding to egptr()
+  std::uint64_t position;
+  char current_char;
+};
 } // namespace detail
 
+void
+ProjDataFromStream::use_memory_mapping_for_reading(const std::string& filename)
+{
+  this->data_mmap_sptr.reset(new MemoryMappedFile(filename, MemoryMappedFile::Mode::read_only));
+}
+
+bool
+ProjDataFromStream::uses_memory_mapping_for_reading() const
+{
+  return !is_null_ptr(this->data_mmap_sptr);
+}
+
+void
+ProjDataFromStream::use_positional_reads_for_reading(const std::string& filename)
+{
+  this->data_file_sptr.reset(new FileWithPositionalReads(filename));
+}
+
+bool
+ProjDataFromStream::uses_positional_reads_for_reading() const
+{
+  return !is_null_ptr(this->data_file_sptr);
+}
+
+Succeeded
+ProjDataFromStream::read_from_stream(const std::function<void(std::istream&)>& read_function) const
+{
+  Succeeded succeeded = Succeeded::yes;
+  if (!is_null_ptr(this->data_mmap_sptr))
+    {
+      // every call uses its own stream, so no need for a critical section
+      detail::ReadOnlyMemoryStreamBuf buffer(this->data_mmap_sptr->get_const_data_ptr(), this->data_mmap_sptr->size());
+      std::istream s(&buffer);
+      try
+        {
+          read_function(s);
+        }
+      catch (...)
+        {
+          succeeded = Succeeded::no;
+        }
+      return succeeded;
+    }
+  if (!is_null_ptr(this->data_file_sptr))
+    {
+      // every call uses its own stream, and reads specify the offset, so no need for a critical section
+      detail::PositionalReadStreamBuf buffer(*this->data_file_sptr);
+      std::istream s(&buffer);
+      try
+        {
+          read_function(s);
+        }
+      catch (...)
+        {
+          succeeded = Succeeded::no;
+        }
+      return succeeded;
+    }
+
+#ifdef STIR_OPENMP
+#  pragma omp critical(PROJDATAFROMSTREAMIO)
+#endif
+  try
+    {
+      read_function(*sino_stream);
+    }
+  catch (...)
+    {
+      succeeded = Succeeded::no;
+    }
+  // end of critical section
+  return succeeded;
+}
+
 Viewgram<float>
 ProjDataFromStream::get_viewgram(const int view_num,
                                  const int segment_num,
@@ -195,44 +358,46 @@ ProjDataFromStream::get_viewgram(const int view_num,
   Succeeded succeeded = Succeeded::yes;
   Bin bin(segment_num, view_num, this->get_min_axial_pos_num(segment_num), this->get_min_tangential_pos_num(), timing_pos);
 
-#ifdef STIR_OPENMP
-#  pragma omp critical(PROJDATAFROMSTREAMIO)
-#endif
-  try
-    {
-      if (get_storage_order() == Segment_AxialPos_View_TangPos || get_storage_order() == Timing_Segment_AxialPos_View_TangPos)
-        {
-          for (bin.axial_pos_num() = get_min_axial_pos_num(segment_num);
-               bin.axial_pos_num() <= get_max_axial_pos_num(segment_num);
-               bin.axial_pos_num()++)
-            {
-              detail::checked_seekg("get_viewgram", *sino_stream, get_offset(bin));
-              if ((succeeded
-                   = read_data(*sino_stream, viewgram[bin.axial_pos_num()], on_disk_data_type, scale, on_disk_byte_order))
-                  == Succeeded::no)
-                break;
-              if (scale != 1)
-                break;
-            }
-        }
-      else if (get_storage_order() == Segment_View_AxialPos_TangPos
-               || get_storage_order() == Timing_Segment_View_AxialPos_TangPos)
-        {
-          // read in one go (skipping the extra seek)
-          detail::checked_seekg("get_viewgram", *sino_stream, get_offset(bin));
-          succeeded = read_data(*sino_stream, viewgram, on_disk_data_type, scale, on_disk_byte_order);
-        }
-      else
-        {
-          warning("ProjDataFromStream::get_viewgram: unsupported storage order");
-          succeeded = Succeeded::no;
-        }
-    }
-  catch (...)
-    {
-      succeeded = Succeeded::no;
-    }
-  // end of critical section
+  const auto read_function = [&](std::istream& s) {
+    if (get_storage_order() == Segment_AxialPos_View_TangPos || get_storage_order() == Timing_Segment_AxialPos_View_TangPos)
+      {
+        if (!is_null_ptr(data_mmap_sptr))
+          {
+            // the rows are spread over the file, ask the operating system to read the whole range in one go
+            Bin last_bin = bin;
+            last_bin.axial_pos_num() = get_max_axial_pos_num(segment_num);
+            const std::streamoff first_offset = get_offset(bin);
+            const std::size_t num_bytes = static_cast<std::size_t>(get_offset(last_bin) - first_offset)
+                                          + get_num_tangential_poss() * on_disk_data_type.size_in_bytes();
+            data_mmap_sptr->will_need(static_cast<std::size_t>(first_offset), num_bytes);
+          }
+        for (bin.axial_pos_num() = get_min_axial_pos_num(segment_num);
+             bin.axial_pos_num() <= get_max_axial_pos_num(segment_num);
+             bin.axial_pos_num()++)
+          {
+            detail::checked_seekg("get_viewgram", s, get_offset(bin));
+            if ((succeeded = read_data(s, viewgram[bin.axial_pos_num()], on_disk_data_type, scale, on_disk_byte_order))
+                == Succeeded::no)
+              break;
+            if (scale != 1)
+              break;
+          }
+      }
+    else if (get_storage_order() == Segment_View_AxialPos_TangPos
+             || get_storage_order() == Timing_Segment_View_AxialPos_TangPos)
+      {
+        // read in one go (skipping the extra seek)
+        detail::checked_seekg("get_viewgram", s, get_offset(bin));
+        succeeded = read_data(s, viewgram, on_disk_data_type, scale, on_disk_byte_order);
+      }
+    else
+      {
+        warning("ProjDataFromStream::get_viewgram: unsupported storage order");
+        succeeded = Succeeded::no;
+      }
+  };
+  if (read_from_stream(read_function) == Succeeded::no)
+    succeeded = Succeeded::no;
   if (scale != 1)
     error("ProjDataFromStream: error reading data: scale factor returned by read_data should be 1");
   if (succeeded == Succeeded::no)
@@ -266,12 +431,15 @@ ProjDataFromStream::get_bin_value(const Bin& this_bin) const
       error("ProjDataFromStream::get_bin_value: error in stream state before reading\n");
     }
 
-  detail::checked_seekg("get_bin_value", *sino_stream, get_offset(this_bin));
-
   Array<1, float> value(1);
   float scale = float(1);
+  Succeeded succeeded = Succeeded::yes;
 
-  if (read_data(*sino_stream, value, on_disk_data_type, scale, on_disk_byte_order) == Succeeded::no)
+  const auto read_function = [&](std::istream& s) {
+    detail::checked_seekg("get_bin_value", s, get_offset(this_bin));
+    succeeded = read_data(s, value, on_disk_data_type, scale, on_disk_byte_order);
+  };
+  if (read_from_stream(read_function) == Succeeded::no || succeeded == Succeeded::no)
     error("ProjDataFromStream: error reading data\n");
   if (scale != 1.f)
     error("ProjDataFromStream: error reading data: scale factor returned by read_data should be 1\n");
@@ -517,40 +685,33 @@ ProjDataFromStream::get_sinogram(const int ax_pos_num,
   Succeeded succeeded = Succeeded::yes;
   Bin bin(segment_num, this->get_min_view_num(), ax_pos_num, this->get_min_tangential_pos_num(), timing_pos);
 
-#ifdef STIR_OPENMP
-#  pragma omp critical(PROJDATAFROMSTREAMIO)
-#endif
-  try
-    {
-      if (get_storage_order() == Segment_AxialPos_View_TangPos || get_storage_order() == Timing_Segment_AxialPos_View_TangPos)
-        {
-          detail::checked_seekg("get_sinogram", *sino_stream, get_offset(bin));
-          succeeded = read_data(*sino_stream, sinogram, on_disk_data_type, scale, on_disk_byte_order);
-        }
-      else if (get_storage_order() == Segment_View_AxialPos_TangPos
-               || get_storage_order() == Timing_Segment_View_AxialPos_TangPos)
-        {
-          for (bin.view_num() = get_min_view_num(); bin.view_num() <= get_max_view_num(); bin.view_num()++)
-            {
-              detail::checked_seekg("get_sinogram", *sino_stream, get_offset(bin));
-              if ((succeeded = read_data(*sino_stream, sinogram[bin.view_num()], on_disk_data_type, scale, on_disk_byte_order))
-                  == Succeeded::no)
-                break;
-              if (scale != 1)
-                break;
-            }
-        }
-      else
-        {
-          warning("ProjDataFromStream::get_sinogram: unsupported storage order");
-          succeeded = Succeeded::no;
-        }
-    }
-  catch (...)
-    {
-      succeeded = Succeeded::no;
-    }
-  // end of critical section
+  const auto read_function = [&](std::istream& s) {
+    if (get_storage_order() == Segment_AxialPos_View_TangPos || get_storage_order() == Timing_Segment_AxialPos_View_TangPos)
+      {
+        detail::checked_seekg("get_sinogram", s, get_offset(bin));
+        succeeded = read_data(s, sinogram, on_disk_data_type, scale, on_disk_byte_order);
+      }
+    else if (get_storage_order() == Segment_View_AxialPos_TangPos
+             || get_storage_order() == Timing_Segment_View_AxialPos_TangPos)
+      {
+        for (bin.view_num() = get_min_view_num(); bin.view_num() <= get_max_view_num(); bin.view_num()++)
+          {
+            detail::checked_seekg("get_sinogram", s, get_offset(bin));
+            if ((succeeded = read_data(s, sinogram[bin.view_num()], on_disk_data_type, scale, on_disk_byte_order))
+                == Succeeded::no)
+              break;
+            if (scale != 1)
+              break;
+          }
+      }
+    else
+      {
+        warning("ProjDataFromStream::get_sinogram: unsupported storage order");
+        succeeded = Succeeded::no;
+      }
+  };
+  if (read_from_stream(read_function) == Succeeded::no)
+    succeeded = Succeeded::no;
   if (scale != 1)
     error("ProjDataFromStream: error reading data: scale factor returned by read_data should be 1");
   if (succeeded == Succeeded::no)
@@ -679,19 +840,12 @@ ProjDataFromStream::get_segment_by_sinogram(const int segment_num, const int tim
                     this->get_min_axial_pos_num(segment_num),
                     this->get_min_tangential_pos_num(),
                     timing_num);
-#ifdef STIR_OPENMP
-#  pragma omp critical(PROJDATAFROMSTREAMIO)
-#endif
-      try
-        {
-          detail::checked_seekg("get_segment_by_sinogram", *sino_stream, get_offset(bin));
-          succeeded = read_data(*sino_stream, segment, on_disk_data_type, scale, on_disk_byte_order);
-        }
-      catch (...)
-        {
-          succeeded = Succeeded::no;
-        }
-      // end of critical section
+      const auto read_function = [&](std::istream& s) {
+        detail::checked_seekg("get_segment_by_sinogram", s, get_offset(bin));
+        succeeded = read_data(s, segment, on_disk_data_type, scale, on_disk_byte_order);
+      };
+      if (read_from_stream(read_function) == Succeeded::no)
+        succeeded = Succeeded::no;
       if (succeeded == Succeeded::no)
         error("ProjDataFromStream: error reading data\n");
       if (scale != 1)
@@ -729,19 +883,12 @@ ProjDataFromStream::get_segment_by_view(const int segment_num, const int timing_
                     this->get_min_axial_pos_num(segment_num),
                     this->get_min_tangential_pos_num(),
                     timing_pos);
-#ifdef STIR_OPENMP
-#  pragma omp critical(PROJDATAFROMSTREAMIO)
-#endif
-      try
-        {
-          detail::checked_seekg("get_segment_by_view", *sino_stream, get_offset(bin));
-          succeeded = read_data(*sino_stream, segment, on_disk_data_type, scale, on_disk_byte_order);
-        }
-      catch (...)
-        {
-          succeeded = Succeeded::no;
-        }
-      // end of critical section
+      const auto read_function = [&](std::istream& s) {
+        detail::checked_seekg("get_segment_by_view", s, get_offset(bin));
+        succeeded = read_data(s, segment, on_disk_data_type, scale, on_disk_byte_order);
+      };
+      if (read_from_stream(read_function) == Succeeded::no)
+        succeeded = Succeeded::no;
       if (succeeded == Succeeded::no)
         error("ProjDataFromStream: error reading data");
       if (scale != 1)
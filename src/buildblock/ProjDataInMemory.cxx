@@ -30,6 +30,7 @@
 #include "stir/SegmentByView.h"
 #include "stir/Bin.h"
 #include "stir/is_null_ptr.h"
+#include "stir/error.h"
 #include "stir/numerics/norm.h"
 #include <iostream>
 #include <cstring>
@@ -50,7 +51,24 @@ ProjDataInMemory::ProjDataInMemory(shared_ptr<const ExamInfo> const& exam_info_s
       segment_sequence(ProjData::standard_segment_sequence(*proj_data_info_ptr))
 {
   this->create_buffer(initialise_with_0);
+  this->set_up_offsets();
+}
+
+ProjDataInMemory::ProjDataInMemory(shared_ptr<const ExamInfo> const& exam_info_sptr,
+                                   shared_ptr<const ProjDataInfo> const& proj_data_info_ptr,
+                                   shared_ptr<float[]> data_sptr)
+    : ProjData(exam_info_sptr, proj_data_info_ptr),
+      buffer(IndexRange<1>(static_cast<int>(this->size_all())), data_sptr),
+      segment_sequence(ProjData::standard_segment_sequence(*proj_data_info_ptr))
+{
+  if (is_null_ptr(data_sptr))
+    error("ProjDataInMemory: constructor called with a null pointer for the data");
+  this->set_up_offsets();
+}
 
+void
+ProjDataInMemory::set_up_offsets()
+{
   int sum = 0;
   for (int segment_num = proj_data_info_sptr->get_min_segment_num(); segment_num <= proj_data_info_sptr->get_max_segment_num();
        ++segment_num)
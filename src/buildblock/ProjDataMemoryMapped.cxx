@@ -0,0 +1,186 @@
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup projdata
+  \brief Implementation of class stir::ProjDataMemoryMapped
+*/
+
+#include "stir/ProjDataMemoryMapped.h"
+#include "stir/ProjDataFromStream.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/IO/InterfileHeader.h"
+#include "stir/IO/interfile.h"
+#include "stir/ByteOrder.h"
+#include "stir/NumericType.h"
+#include "stir/Succeeded.h"
+#include "stir/utilities.h"
+#include "stir/error.h"
+#include "stir/info.h"
+#include <boost/format.hpp>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+START_NAMESPACE_STIR
+
+namespace detail
+{
+//! construct the name of the binary file as in ProjDataInterfile
+static std::string
+data_filename_for_ProjDataMemoryMapped(const std::string& filename)
+{
+  std::string data_name = filename;
+  const std::string::size_type pos = find_pos_of_extension(filename);
+  if (pos != std::string::npos && filename.substr(pos) == ".hs")
+    replace_extension(data_name, ".s");
+  else
+    add_extension(data_name, ".s");
+  return data_name;
+}
+
+//! write the header, create the binary file of the correct size (filled with 0) and map it
+static shared_ptr<MemoryMappedFile>
+create_file_for_ProjDataMemoryMapped(shared_ptr<const ExamInfo> const& exam_info_sptr,
+                                     shared_ptr<const ProjDataInfo> const& proj_data_info_sptr,
+                                     const std::string& filename)
+{
+  const std::string data_name = data_filename_for_ProjDataMemoryMapped(filename);
+  std::string header_name = data_name;
+  replace_extension(header_name, ".hs");
+
+  // use a ProjDataFromStream object (without stream) to describe the layout for the header
+  // (the storage order is changed to the TOF one for TOF data)
+  const ProjDataFromStream layout(exam_info_sptr,
+                                  proj_data_info_sptr,
+                                  shared_ptr<std::iostream>(),
+                                  0,
+                                  ProjData::standard_segment_sequence(*proj_data_info_sptr),
+                                  ProjDataFromStream::Segment_AxialPos_View_TangPos,
+                                  NumericType::FLOAT,
+                                  ByteOrder::native,
+                                  1.F);
+  if (write_basic_interfile_PDFS_header(header_name, data_name, layout) != Succeeded::yes)
+    error("ProjDataMemoryMapped: error writing header " + header_name);
+
+  const std::streamoff num_bytes = static_cast<std::streamoff>(layout.size_all() * sizeof(float));
+  {
+    // create a file of the correct size. This will be filled with zeroes.
+    std::ofstream data_out(data_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!data_out)
+      error("ProjDataMemoryMapped: error creating " + data_name);
+    if (num_bytes > 0)
+      {
+        data_out.seekp(num_bytes - 1);
+        data_out.put(0);
+      }
+    if (!data_out)
+      error("ProjDataMemoryMapped: error writing to " + data_name);
+  }
+  return std::make_shared<MemoryMappedFile>(data_name, MemoryMappedFile::Mode::read_write);
+}
+
+//! return a pointer to the data that keeps the mapping alive
+static shared_ptr<float[]>
+get_data_sptr_for_ProjDataMemoryMapped(shared_ptr<MemoryMappedFile> const& mmap_sptr, const std::size_t offset_in_bytes)
+{
+  // for read-only mappings, the const_cast is safe as ProjDataMemoryMapped::read_from_file only gives const access
+  char* const ptr = mmap_sptr->get_mode() == MemoryMappedFile::Mode::read_write
+                        ? mmap_sptr->get_data_ptr()
+                        : const_cast<char*>(mmap_sptr->get_const_data_ptr());
+  // the "deleter" does nothing, except keeping the mapping alive as long as the pointer is used
+  auto keep_mapping = [mmap_sptr](float*) {};
+  return shared_ptr<float[]>(reinterpret_cast<float*>(ptr + offset_in_bytes), keep_mapping);
+}
+} // namespace detail
+
+ProjDataMemoryMapped::ProjDataMemoryMapped(shared_ptr<const ExamInfo> const& exam_info_sptr,
+                                           shared_ptr<const ProjDataInfo> const& proj_data_info_sptr,
+                                           shared_ptr<MemoryMappedFile> const& mmap_sptr_v,
+                                           const std::size_t offset_in_bytes,
+                                           const std::string& data_filename_v)
+    : ProjDataInMemory(
+        exam_info_sptr, proj_data_info_sptr, detail::get_data_sptr_for_ProjDataMemoryMapped(mmap_sptr_v, offset_in_bytes)),
+      mmap_sptr(mmap_sptr_v),
+      data_filename(data_filename_v)
+{}
+
+ProjDataMemoryMapped::ProjDataMemoryMapped(shared_ptr<const ExamInfo> const& exam_info_sptr,
+                                           shared_ptr<const ProjDataInfo> const& proj_data_info_sptr,
+                                           const std::string& filename)
+    : ProjDataMemoryMapped(exam_info_sptr,
+                           proj_data_info_sptr,
+                           detail::create_file_for_ProjDataMemoryMapped(exam_info_sptr, proj_data_info_sptr, filename),
+                           0,
+                           detail::data_filename_for_ProjDataMemoryMapped(filename))
+{}
+
+shared_ptr<ProjDataMemoryMapped>
+ProjDataMemoryMapped::map_existing_file(const std::string& filename, const MemoryMappedFile::Mode mode)
+{
+  InterfilePDFSHeader hdr;
+  if (!hdr.parse(filename))
+    error("ProjDataMemoryMapped: Interfile parsing of PET projection data in " + filename + " failed");
+
+  const std::string directory_name = get_directory_name(filename);
+  char full_data_file_name[max_filename_length];
+  strcpy(full_data_file_name, hdr.data_file_name.c_str());
+  prepend_directory_name(full_data_file_name, directory_name.c_str());
+
+  // check if the data are stored as ProjDataInMemory would
+  shared_ptr<const ProjDataInfo> proj_data_info_sptr(hdr.data_info_sptr->create_shared_clone());
+  const bool is_TOF = proj_data_info_sptr->get_num_tof_poss() > 1;
+  if (hdr.storage_order
+      != (is_TOF ? ProjDataFromStream::Timing_Segment_AxialPos_View_TangPos : ProjDataFromStream::Segment_AxialPos_View_TangPos))
+    error("ProjDataMemoryMapped: " + filename + " needs to be stored by sinogram");
+  if (hdr.type_of_numbers != NumericType::FLOAT || !hdr.file_byte_order.is_native_order())
+    error("ProjDataMemoryMapped: " + filename + " needs to contain floats in native byte order");
+  for (auto scale_factor : hdr.image_scaling_factors[0])
+    if (scale_factor != 1)
+      error("ProjDataMemoryMapped: " + filename + " cannot have a scale factor");
+  if (hdr.segment_sequence != ProjData::standard_segment_sequence(*proj_data_info_sptr))
+    error("ProjDataMemoryMapped: " + filename + " needs to have segments in the standard order (0, -1, +1, ...)");
+  for (std::size_t i = 1; i < hdr.timing_poss_sequence.size(); ++i)
+    if (hdr.timing_poss_sequence[i] != hdr.timing_poss_sequence[i - 1] + 1)
+      error("ProjDataMemoryMapped: " + filename + " needs to have TOF bins in increasing order");
+
+  const std::size_t offset_in_bytes = hdr.data_offset_each_dataset[0];
+  if (offset_in_bytes % sizeof(float) != 0)
+    error("ProjDataMemoryMapped: " + filename + " has a data offset that is not a multiple of 4 bytes");
+
+  auto mmap_sptr = std::make_shared<MemoryMappedFile>(full_data_file_name, mode);
+  const std::size_t num_bytes_needed = offset_in_bytes + proj_data_info_sptr->size_all() * sizeof(float);
+  if (mmap_sptr->size() < num_bytes_needed)
+    error(boost::format("ProjDataMemoryMapped: %1% is too small (%2% bytes, while %3% are needed)") % full_data_file_name
+          % mmap_sptr->size() % num_bytes_needed);
+
+  info(boost::format("ProjDataMemoryMapped: mapped %1% (%2% MB)") % full_data_file_name % (num_bytes_needed / 1048576), 3);
+  return shared_ptr<ProjDataMemoryMapped>(
+      new ProjDataMemoryMapped(hdr.get_exam_info_sptr(), proj_data_info_sptr, mmap_sptr, offset_in_bytes, full_data_file_name));
+}
+
+shared_ptr<const ProjDataMemoryMapped>
+ProjDataMemoryMapped::read_from_file(const std::string& filename)
+{
+  return map_existing_file(filename, MemoryMappedFile::Mode::read_only);
+}
+
+shared_ptr<ProjDataMemoryMapped>
+ProjDataMemoryMapped::open_for_update(const std::string& filename)
+{
+  return map_existing_file(filename, MemoryMappedFile::Mode::read_write);
+}
+
+void
+ProjDataMemoryMapped::flush()
+{
+  this->mmap_sptr->flush();
+}
+
+END_NAMESPACE_STIR
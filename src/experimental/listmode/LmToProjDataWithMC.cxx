@@ -57,6 +57,12 @@ LmToProjDataWithMC::post_processing()
   return LmToProjData::post_processing();
 }
 
+bool
+LmToProjDataWithMC::supports_parallel_histogramming() const
+{
+  return false;
+}
+
 Succeeded
 LmToProjDataWithMC::set_up()
 {
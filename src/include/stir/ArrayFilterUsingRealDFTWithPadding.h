@@ -74,7 +74,7 @@ public:
       twice as long as the input and output arrays.
 
       As this function uses fourier_for_real_data(), see there for restrictions
-      on the possible kernel length, but at time of writing, it has to be a power of 2.
+      on the possible kernel length. At time of writing, the last dimension has to be even.
   */
   Succeeded set_kernel(const Array<num_dimensions, elemT>& real_filter_kernel);
 
@@ -88,7 +88,7 @@ public:
       twice as long as the input and output arrays.
 
       See fourier() for restrictions on the possible
-      kernel length, but at time of writing, it has to be a power of 2.
+      kernel length. At time of writing, any length can be used.
   */
   Succeeded set_kernel_in_frequency_space(const Array<num_dimensions, std::complex<elemT>>& kernel_in_frequency_space);
 
@@ -0,0 +1,81 @@
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+#ifndef __stir_FileWithPositionalReads_H__
+#define __stir_FileWithPositionalReads_H__
+
+/*!
+  \file
+  \ingroup buildblock
+  \brief Declaration of class stir::FileWithPositionalReads
+*/
+
+#include "stir/common.h"
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup buildblock
+  \brief A simple wrapper around the operating system's facilities to read from a file at a given offset
+
+  Every read specifies its own offset, i.e. there is no "current position" that is shared between
+  reads. Different threads can therefore read from the same object concurrently, without locking.
+
+  Uses \c pread on Unix-type systems, and \c ReadFile with an \c OVERLAPPED offset on Windows.
+
+  Objects of this class cannot be copied. Use a \c shared_ptr if you need to share the file.
+
+  In contrast to MemoryMappedFile, reading beyond the end of the file (e.g. when it was truncated
+  after opening) just returns fewer bytes.
+*/
+class FileWithPositionalReads
+{
+public:
+  //! Default constructor, creates an object that is not connected to a file
+  FileWithPositionalReads();
+
+  //! Constructor that calls open()
+  explicit FileWithPositionalReads(const std::string& filename);
+
+  //! Destructor calls close()
+  ~FileWithPositionalReads();
+
+  FileWithPositionalReads(const FileWithPositionalReads&) = delete;
+  FileWithPositionalReads& operator=(const FileWithPositionalReads&) = delete;
+
+  //! Open the file for reading
+  /*! Calls error() if the file cannot be opened. */
+  void open(const std::string& filename);
+
+  //! Close the file (if any)
+  void close();
+
+  bool is_open() const { return this->opened; }
+
+  //! Read (at most) \a num_bytes at \a offset into \a buffer
+  /*! \return the number of bytes read, which is less than \a num_bytes only at the end of the file
+      or when an error occurred.
+  */
+  std::size_t read(char* buffer, const std::size_t num_bytes, const std::uint64_t offset) const;
+
+private:
+  bool opened;
+  std::string filename;
+#if defined(__OS_WIN__)
+  void* file_handle;
+#else
+  int file_descriptor;
+#endif
+};
+
+END_NAMESPACE_STIR
+
+#endif
@@ -95,6 +95,8 @@ public:
   inline SavedPosition save_get_position();
   //! Set current position
   inline Succeeded set_get_position(const SavedPosition&);
+  //! Save current position in the vector, in place of a previously saved one
+  inline Succeeded overwrite_saved_get_position(const SavedPosition&);
   //! Get the vector with the saved positions
   inline std::vector<unsigned long int> get_saved_get_positions() const;
   //! Set a vector with saved positions
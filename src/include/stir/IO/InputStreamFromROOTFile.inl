@@ -42,6 +42,16 @@ InputStreamFromROOTFile::save_get_position()
   return saved_get_positions.size() - 1;
 }
 
+Succeeded
+InputStreamFromROOTFile::overwrite_saved_get_position(const InputStreamFromROOTFile::SavedPosition& pos)
+{
+  assert(current_position <= nentries);
+  if (pos >= saved_get_positions.size())
+    return Succeeded::no;
+  saved_get_positions[pos] = current_position;
+  return Succeeded::yes;
+}
+
 Succeeded
 InputStreamFromROOTFile::set_get_position(const InputStreamFromROOTFile::SavedPosition& pos)
 {
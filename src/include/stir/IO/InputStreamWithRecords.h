@@ -22,6 +22,7 @@
 
 #include "stir/shared_ptr.h"
 #include "stir/Succeeded.h"
+#include "stir/MemoryMappedFile.h"
 
 #include <iostream>
 #include <string>
@@ -36,9 +37,18 @@ START_NAMESPACE_STIR
     the function to find out what the size of the record is. In that case, all IO
     handling is completely generic and is implemented in this class.
 
-    Current implementation needs a \c max_size_of_record to allocate enough memory
-    (on the stack) before reading. This is efficient in many cases, but impractical
-    in others.
+    Data are read from the stream in large blocks into an internal buffer, from which
+    records are then initialised. This avoids the overhead of reading every record
+    separately from the stream. Alternatively, when constructed with a filename, the file
+    can be memory-mapped (see MemoryMappedFile), such that records are initialised directly
+    from the mapped memory.
+
+    Current implementation needs a \c max_size_of_record to make sure that the buffer
+    is large enough.
+
+    Reading is thread-safe (protected by an OpenMP critical section). When multiple threads
+    need to read records, it is more efficient to use get_next_records() to read many
+    records at once.
 
     \par Requirements
     \c RecordT needs to have the following member functions
@@ -76,12 +86,23 @@ public:
                                 const std::size_t size_of_record_signature,
                                 const std::size_t max_size_of_record,
                                 const OptionsT& options,
-                                const std::streampos start_of_data = 0);
+                                const std::streampos start_of_data = 0,
+                                const bool use_memory_mapping = false);
 
   virtual ~InputStreamWithRecords() {}
 
   inline virtual Succeeded get_next_record(RecordT& record) const;
 
+  //! Read a number of records at once
+  /*! Fills the records pointed to by <code>records[0]</code> ... <code>records[num_records-1]</code>
+      (in order) and returns how many were read. This is less than \a num_records only if there
+      are no more records available.
+
+      This function is more efficient than calling get_next_record() repeatedly, as the
+      locking is done only once.
+  */
+  inline std::size_t get_next_records(RecordT* const* const records, const std::size_t num_records) const;
+
   //! go back to starting position
   inline Succeeded reset();
 
@@ -94,6 +115,9 @@ public:
   //! set current "get" position to previously saved value
   inline Succeeded set_get_position(const SavedPosition&);
 
+  //! save current "get" position in the internal array, in place of a previously saved value
+  inline Succeeded overwrite_saved_get_position(const SavedPosition&);
+
   //! Function that enables the user to store the saved get_positions
   /*! Together with set_saved_get_positions(), this allows
       reinstating the saved get_positions when
@@ -108,8 +132,18 @@ public:
   */
   inline void set_saved_get_positions(const std::vector<std::streampos>&);
 
+  //! Get the underlying stream
+  /*! \warning As data is buffered, the position of the stream does not correspond to the
+      position of the next record. Reading from the stream will therefore lead to
+      unexpected results.
+  */
   inline std::istream& get_stream() { return *this->stream_ptr; }
 
+  //! Set the size of the buffer used when reading from the stream (defaults to 1 MB)
+  /*! Will be increased if necessary to be able to hold a record of maximum size. Calling this function
+      discards currently buffered data, so should only be called before reading, or after reset() etc. */
+  inline void set_buffer_size(const std::size_t buffer_size);
+
 private:
   shared_ptr<std::istream> stream_ptr;
   const std::string filename;
@@ -121,6 +155,26 @@ private:
   const std::size_t max_size_of_record;
 
   const OptionsT options;
+
+  //! memory-mapped file (only used when memory-mapping is enabled)
+  shared_ptr<MemoryMappedFile> mmap_sptr;
+  //! buffer for data read from the stream (only used without memory-mapping)
+  mutable std::vector<char> buffer;
+  //! pointer to the currently available data (either in \c buffer or in the mapped file)
+  mutable const char* window_ptr;
+  //! number of bytes available at \c window_ptr
+  mutable std::size_t window_size;
+  //! position of the next record relative to \c window_ptr
+  mutable std::size_t pos_in_window;
+  //! position in the file/stream corresponding to \c window_ptr
+  mutable std::streamoff window_start_position;
+
+  //! makes sure that at least \a num_bytes are available in the window (if possible)
+  inline bool make_available(const std::size_t num_bytes) const;
+  //! read next record without locking
+  inline Succeeded read_record(RecordT& record) const;
+  //! discard buffered data and set the position of the next record
+  inline void set_window_start(const std::streamoff position) const;
 };
 
 END_NAMESPACE_STIR
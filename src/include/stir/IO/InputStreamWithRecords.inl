@@ -19,12 +19,20 @@
 #include "stir/Succeeded.h"
 #include "stir/is_null_ptr.h"
 #include "stir/shared_ptr.h"
-#include "boost/shared_array.hpp"
 #include "stir/warning.h"
 #include "stir/error.h"
 #include <fstream>
+#include <algorithm>
+#include <cstring>
 
 START_NAMESPACE_STIR
+
+namespace detail
+{
+//! default size of the buffer used by InputStreamWithRecords
+const std::size_t default_input_stream_with_records_buffer_size = 1024 * 1024;
+} // namespace detail
+
 template <class RecordT, class OptionsT>
 InputStreamWithRecords<RecordT, OptionsT>::InputStreamWithRecords(const shared_ptr<std::istream>& stream_ptr,
                                                                   const std::size_t size_of_record_signature,
@@ -33,14 +41,20 @@ InputStreamWithRecords<RecordT, OptionsT>::InputStreamWithRecords(const shared_p
     : stream_ptr(stream_ptr),
       size_of_record_signature(size_of_record_signature),
       max_size_of_record(max_size_of_record),
-      options(options)
+      options(options),
+      window_ptr(0),
+      window_size(0),
+      pos_in_window(0),
+      window_start_position(0)
 {
   assert(size_of_record_signature <= max_size_of_record);
+  this->set_buffer_size(detail::default_input_stream_with_records_buffer_size);
   if (is_null_ptr(stream_ptr))
     return;
   starting_stream_position = stream_ptr->tellg();
   if (!stream_ptr->good())
     error("InputStreamWithRecords: error in tellg()\n");
+  this->window_start_position = std::streamoff(starting_stream_position);
 }
 
 template <class RecordT, class OptionsT>
@@ -48,21 +62,116 @@ InputStreamWithRecords<RecordT, OptionsT>::InputStreamWithRecords(const std::str
                                                                   const std::size_t size_of_record_signature,
                                                                   const std::size_t max_size_of_record,
                                                                   const OptionsT& options,
-                                                                  const std::streampos start_of_data)
+                                                                  const std::streampos start_of_data,
+                                                                  const bool use_memory_mapping)
     : filename(filename),
       starting_stream_position(start_of_data),
       size_of_record_signature(size_of_record_signature),
       max_size_of_record(max_size_of_record),
-      options(options)
+      options(options),
+      window_ptr(0),
+      window_size(0),
+      pos_in_window(0),
+      window_start_position(0)
 {
   assert(size_of_record_signature <= max_size_of_record);
   std::fstream* s_ptr = new std::fstream;
   open_read_binary(*s_ptr, filename.c_str());
   stream_ptr.reset(s_ptr);
+  if (use_memory_mapping)
+    {
+      this->mmap_sptr.reset(new MemoryMappedFile(filename));
+      if (std::streamoff(start_of_data) > static_cast<std::streamoff>(this->mmap_sptr->size()))
+        error("InputStreamWithRecords: start of data is beyond the end of file %s\n", filename.c_str());
+    }
+  else
+    this->set_buffer_size(detail::default_input_stream_with_records_buffer_size);
   if (reset() == Succeeded::no)
     error("InputStreamWithRecords: error in reset() for filename %s\n", filename.c_str());
 }
 
+template <class RecordT, class OptionsT>
+void
+InputStreamWithRecords<RecordT, OptionsT>::set_buffer_size(const std::size_t buffer_size)
+{
+  if (!is_null_ptr(this->mmap_sptr))
+    return;
+  const std::streamoff current_position = this->window_start_position + static_cast<std::streamoff>(this->pos_in_window);
+  this->buffer.resize(std::max(buffer_size, this->max_size_of_record));
+  this->buffer.shrink_to_fit();
+  if (!is_null_ptr(this->stream_ptr) && this->window_size > 0)
+    {
+      // go back to where we were
+      this->stream_ptr->clear();
+      this->stream_ptr->seekg(current_position, std::ios::beg);
+    }
+  this->set_window_start(current_position);
+}
+
+template <class RecordT, class OptionsT>
+void
+InputStreamWithRecords<RecordT, OptionsT>::set_window_start(const std::streamoff position) const
+{
+  if (!is_null_ptr(this->mmap_sptr))
+    {
+      this->window_ptr = this->mmap_sptr->get_const_data_ptr();
+      this->window_size = this->mmap_sptr->size();
+      this->window_start_position = 0;
+      this->pos_in_window = std::min(static_cast<std::size_t>(position), this->window_size);
+    }
+  else
+    {
+      this->window_ptr = this->buffer.data();
+      this->window_size = 0;
+      this->window_start_position = position;
+      this->pos_in_window = 0;
+    }
+}
+
+template <class RecordT, class OptionsT>
+bool
+InputStreamWithRecords<RecordT, OptionsT>::make_available(const std::size_t num_bytes) const
+{
+  if (this->window_size - this->pos_in_window >= num_bytes)
+    return true;
+  if (!is_null_ptr(this->mmap_sptr) || is_null_ptr(this->stream_ptr))
+    return false;
+
+  // move remaining data to the start of the buffer and fill up
+  const std::size_t num_remaining = this->window_size - this->pos_in_window;
+  if (num_remaining > 0)
+    std::memmove(this->buffer.data(), this->buffer.data() + this->pos_in_window, num_remaining);
+  this->window_start_position += static_cast<std::streamoff>(this->pos_in_window);
+  this->pos_in_window = 0;
+  this->window_ptr = this->buffer.data();
+  this->stream_ptr->read(this->buffer.data() + num_remaining, static_cast<std::streamsize>(this->buffer.size() - num_remaining));
+  if (this->stream_ptr->bad())
+    {
+      warning("Error after reading from list mode stream in get_next_record");
+      this->window_size = num_remaining;
+      return false;
+    }
+  this->window_size = num_remaining + static_cast<std::size_t>(this->stream_ptr->gcount());
+  return this->window_size >= num_bytes;
+}
+
+template <class RecordT, class OptionsT>
+Succeeded
+InputStreamWithRecords<RecordT, OptionsT>::read_record(RecordT& record) const
+{
+  assert(this->size_of_record_signature <= this->max_size_of_record);
+  if (!this->make_available(this->size_of_record_signature))
+    return Succeeded::no;
+  const std::size_t size_of_record
+      = record.size_of_record_at_ptr(this->window_ptr + this->pos_in_window, this->size_of_record_signature, options);
+  assert(size_of_record <= this->max_size_of_record);
+  if (!this->make_available(size_of_record))
+    return Succeeded::no;
+  const char* const data_ptr = this->window_ptr + this->pos_in_window;
+  this->pos_in_window += size_of_record;
+  return record.init_from_data_ptr(data_ptr, size_of_record, options);
+}
+
 template <class RecordT, class OptionsT>
 Succeeded
 InputStreamWithRecords<RecordT, OptionsT>::get_next_record(RecordT& record) const
@@ -76,35 +185,32 @@ InputStreamWithRecords<RecordT, OptionsT>::get_next_record(RecordT& record) cons
 #  pragma omp critical(LISTMODEIO)
 #endif
   {
-    // rely on file caching by the C++ library or the OS
-    assert(this->size_of_record_signature <= this->max_size_of_record);
-    boost::shared_array<char> data_sptr(new char[this->max_size_of_record]);
-
-    stream_ptr->read(data_sptr.get(), this->size_of_record_signature);
-    if (stream_ptr->gcount() < static_cast<std::streamsize>(this->size_of_record_signature))
-      {
-        ret = Succeeded::no;
-      }
-    const std::size_t size_of_record = record.size_of_record_at_ptr(data_sptr.get(), this->size_of_record_signature, options);
-    assert(size_of_record <= this->max_size_of_record);
-    if (size_of_record > this->size_of_record_signature)
-      stream_ptr->read(data_sptr.get() + this->size_of_record_signature, size_of_record - this->size_of_record_signature);
-    if (stream_ptr->eof())
-      {
-        ret = Succeeded::no;
-      }
-    else if (stream_ptr->bad())
-      {
-        warning("Error after reading from list mode stream in get_next_record");
-        ret = Succeeded::no;
-      }
-    if (ret == Succeeded::yes)
-      ret = record.init_from_data_ptr(data_sptr.get(), size_of_record, options);
+    ret = this->read_record(record);
   }
 
   return ret;
 }
 
+template <class RecordT, class OptionsT>
+std::size_t
+InputStreamWithRecords<RecordT, OptionsT>::get_next_records(RecordT* const* const records, const std::size_t num_records) const
+{
+  if (is_null_ptr(stream_ptr))
+    return 0;
+
+  std::size_t num_read = 0;
+
+#ifdef STIR_OPENMP
+#  pragma omp critical(LISTMODEIO)
+#endif
+  {
+    while (num_read < num_records && this->read_record(*records[num_read]) == Succeeded::yes)
+      ++num_read;
+  }
+
+  return num_read;
+}
+
 template <class RecordT, class OptionsT>
 Succeeded
 InputStreamWithRecords<RecordT, OptionsT>::reset()
@@ -112,6 +218,10 @@ InputStreamWithRecords<RecordT, OptionsT>::reset()
   if (is_null_ptr(stream_ptr))
     return Succeeded::no;
 
+  this->set_window_start(std::streamoff(starting_stream_position));
+  if (!is_null_ptr(this->mmap_sptr))
+    return Succeeded::yes;
+
   // Strangely enough, once you read past EOF, even seekg(0) doesn't reset the eof flag
   if (stream_ptr->eof())
     stream_ptr->clear();
@@ -127,25 +237,24 @@ typename InputStreamWithRecords<RecordT, OptionsT>::SavedPosition
 InputStreamWithRecords<RecordT, OptionsT>::save_get_position()
 {
   assert(!is_null_ptr(stream_ptr));
-  // TODO should somehow check if tellg() worked and return an error if it didn't
-  std::streampos pos;
-  if (!stream_ptr->eof())
-    {
-      pos = stream_ptr->tellg();
-      if (!stream_ptr->good())
-        error("InputStreamWithRecords<RecordT, OptionsT>::save_get_position\n"
-              "Error after getting position in file");
-    }
-  else
-    {
-      // use -1 to signify eof
-      // (this is probably the behaviour of tellg anyway, but this way we're sure).
-      pos = std::streampos(-1);
-    }
+  // note: cannot use tellg() as data is buffered
+  const std::streampos pos(this->window_start_position + static_cast<std::streamoff>(this->pos_in_window));
   saved_get_positions.push_back(pos);
   return saved_get_positions.size() - 1;
 }
 
+template <class RecordT, class OptionsT>
+Succeeded
+InputStreamWithRecords<RecordT, OptionsT>::overwrite_saved_get_position(
+    const typename InputStreamWithRecords<RecordT, OptionsT>::SavedPosition& pos)
+{
+  assert(!is_null_ptr(stream_ptr));
+  if (pos >= saved_get_positions.size())
+    return Succeeded::no;
+  saved_get_positions[pos] = std::streampos(this->window_start_position + static_cast<std::streamoff>(this->pos_in_window));
+  return Succeeded::yes;
+}
+
 template <class RecordT, class OptionsT>
 Succeeded
 InputStreamWithRecords<RecordT, OptionsT>::set_get_position(
@@ -155,6 +264,16 @@ InputStreamWithRecords<RecordT, OptionsT>::set_get_position(
     return Succeeded::no;
 
   assert(pos < saved_get_positions.size());
+  if (!is_null_ptr(this->mmap_sptr))
+    {
+      // use -1 to signify eof (as used by previous versions)
+      if (saved_get_positions[pos] == std::streampos(-1))
+        this->set_window_start(static_cast<std::streamoff>(this->mmap_sptr->size()));
+      else
+        this->set_window_start(std::streamoff(saved_get_positions[pos]));
+      return Succeeded::yes;
+    }
+
   stream_ptr->clear();
   if (saved_get_positions[pos] == std::streampos(-1))
     stream_ptr->seekg(0, std::ios::end); // go to eof
@@ -163,8 +282,9 @@ InputStreamWithRecords<RecordT, OptionsT>::set_get_position(
 
   if (!stream_ptr->good())
     return Succeeded::no;
-  else
-    return Succeeded::yes;
+
+  this->set_window_start(std::streamoff(stream_ptr->tellg()));
+  return Succeeded::yes;
 }
 
 template <class RecordT, class OptionsT>
@@ -105,6 +105,9 @@ public:
   //! set current "get" position to previously saved value
   inline Succeeded set_get_position(const SavedPosition&);
 
+  //! save current "get" position in the internal array, in place of a previously saved value
+  inline Succeeded overwrite_saved_get_position(const SavedPosition&);
+
   //! Function that enables the user to store the saved get_positions
   /*! Together with set_saved_get_positions(), this allows
       reinstating the saved get_positions when
@@ -164,6 +164,18 @@ InputStreamWithRecordsFromHDF5<RecordT>::save_get_position()
   return saved_get_positions.size() - 1;
 }
 
+template <class RecordT>
+Succeeded
+InputStreamWithRecordsFromHDF5<RecordT>::overwrite_saved_get_position(
+    const typename InputStreamWithRecordsFromHDF5<RecordT>::SavedPosition& pos)
+{
+  assert(!is_null_ptr(input_sptr));
+  if (pos >= saved_get_positions.size())
+    return Succeeded::no;
+  saved_get_positions[pos] = current_offset;
+  return Succeeded::yes;
+}
+
 template <class RecordT>
 Succeeded
 InputStreamWithRecordsFromHDF5<RecordT>::set_get_position(
@@ -228,7 +228,16 @@ void make_geo_data(GeoData3D& geo_data, const FanProjData& fan_data);
 
 void make_block_data(BlockData3D& block_data, const FanProjData& fan_data);
 
-void iterate_efficiencies(DetectorEfficiencies& efficiencies, const Array<2, float>& data_fan_sums, const FanProjData& model);
+//! Update the detector efficiencies
+/*! By default, efficiencies are updated in place, i.e. the update for a detector uses the efficiencies
+    that were already updated in this sub-iteration. With \a simultaneous_update, all detectors are updated
+    from the efficiencies of the previous sub-iteration instead. This gives (slightly) different results,
+    but can be run in parallel over all rings.
+*/
+void iterate_efficiencies(DetectorEfficiencies& efficiencies,
+                          const Array<2, float>& data_fan_sums,
+                          const FanProjData& model,
+                          const bool simultaneous_update = false);
 
 // version without model
 void iterate_efficiencies(DetectorEfficiencies& efficiencies,
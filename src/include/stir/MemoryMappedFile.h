@@ -0,0 +1,104 @@
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+#ifndef __stir_MemoryMappedFile_H__
+#define __stir_MemoryMappedFile_H__
+
+/*!
+  \file
+  \ingroup buildblock
+  \brief Declaration of class stir::MemoryMappedFile
+*/
+
+#include "stir/common.h"
+#include <string>
+#include <cstddef>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup buildblock
+  \brief A simple wrapper around the operating system's facilities to map a file into memory
+
+  Pages of the file are only read from disk when accessed, and are shared between
+  all processes that map the same file. This is therefore useful for large files that are read
+  by multiple processes (or need to be available "instantly").
+
+  Uses \c mmap on Unix-type systems, and \c CreateFileMapping on Windows.
+
+  Objects of this class cannot be copied. Use a \c shared_ptr if you need to share the mapping.
+
+  \warning Writing via a read-only mapping results in a crash.
+*/
+class MemoryMappedFile
+{
+public:
+  enum class Mode
+  {
+    read_only,
+    read_write
+  };
+
+  //! Default constructor, creates an object that is not mapped to a file
+  MemoryMappedFile();
+
+  //! Constructor that calls open()
+  explicit MemoryMappedFile(const std::string& filename, const Mode mode = Mode::read_only);
+
+  //! Destructor calls close()
+  ~MemoryMappedFile();
+
+  MemoryMappedFile(const MemoryMappedFile&) = delete;
+  MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+  //! Map the whole file in memory
+  /*! The file has to exist already, i.e. it will not be created or resized.
+      Calls error() if the file cannot be opened or mapped. Mapping an empty file is allowed,
+      but then get_data_ptr() returns 0.
+  */
+  void open(const std::string& filename, const Mode mode = Mode::read_only);
+
+  //! Unmap the file (if any)
+  void close();
+
+  bool is_open() const { return this->opened; }
+
+  //! Number of bytes in the file
+  std::size_t size() const { return this->num_bytes; }
+
+  Mode get_mode() const { return this->mode; }
+
+  //! Get a pointer to the start of the data
+  const char* get_const_data_ptr() const { return this->data_ptr; }
+  //! Get a pointer to the start of the data
+  /*! Calls error() if the file was opened read-only */
+  char* get_data_ptr();
+
+  //! Write modified pages to disk (does nothing for read-only mappings)
+  void flush();
+
+  //! Hint to the operating system that the range will be needed soon (might do nothing)
+  void will_need(const std::size_t offset, const std::size_t num_bytes) const;
+
+private:
+  bool opened;
+  Mode mode;
+  char* data_ptr;
+  std::size_t num_bytes;
+  std::string filename;
+#if defined(__OS_WIN__)
+  void* file_handle;
+  void* mapping_handle;
+#else
+  int file_descriptor;
+#endif
+};
+
+END_NAMESPACE_STIR
+
+#endif
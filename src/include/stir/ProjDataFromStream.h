@@ -35,10 +35,15 @@
 #include "stir/shared_ptr.h"
 #include "stir/Bin.h"
 #include <iostream>
+#include <functional>
+#include <string>
 #include <vector>
 
 START_NAMESPACE_STIR
 
+class MemoryMappedFile;
+class FileWithPositionalReads;
+
 /*!
   \ingroup projdata
   \brief A class which reads/writes projection data from/to a (binary) stream.
@@ -48,6 +53,17 @@ START_NAMESPACE_STIR
   stream isn't closed yet. This is important in an interactive context, as the object
   owning the stream might not be deleted yet before we try to read the file again.
 
+  After construction, all reads and writes go via the stream, and are therefore serialised when using
+  multiple threads. If the stream corresponds to a file that is only read, use_positional_reads_for_reading()
+  can be used to read with the file offset passed in every read (e.g. \c pread), such that different threads
+  can read concurrently without locking. This is done by read_from_file() for Interfile data opened
+  read-only. Alternatively, use_memory_mapping_for_reading() maps the file in memory, such that
+  reading is done from the mapped memory. This is never done automatically.
+
+  \warning When using memory mapping, the file must not be truncated or rewritten while this object exists.
+  Otherwise, subsequent reads can crash the program (e.g. with SIGBUS) instead of failing with an error.
+  On Windows, a mapped file cannot be truncated or deleted.
+
   \warning Data have to be contiguous.
   \warning The parameter make_num_tangential_poss_odd (used in various
   get_ functions) is temporary and will be removed soon.
@@ -157,6 +173,28 @@ public:
   //! Set the value of the bin
   virtual void set_bin_value(const Bin& bin);
 
+  //! Map the file in memory and use it for all subsequent read operations
+  /*! \a filename has to be the file corresponding to the stream. Writing is still done via the stream,
+      so this should only be used for data that are not modified by this object.
+
+      Calls error() if the file cannot be mapped.
+  */
+  void use_memory_mapping_for_reading(const std::string& filename);
+
+  //! Returns \c true if use_memory_mapping_for_reading() was called
+  bool uses_memory_mapping_for_reading() const;
+
+  //! Open the file for positional reads and use it for all subsequent read operations (unless memory mapping is used)
+  /*! \a filename has to be the file corresponding to the stream. Writing is still done via the stream,
+      so this should only be used for data that are not modified by this object.
+
+      Calls error() if the file cannot be opened.
+  */
+  void use_positional_reads_for_reading(const std::string& filename);
+
+  //! Returns \c true if use_positional_reads_for_reading() was called
+  bool uses_positional_reads_for_reading() const;
+
 protected:
   //! the stream with the data
   shared_ptr<std::iostream> sino_stream;
@@ -165,6 +203,14 @@ protected:
   /*! Throws if out-of-range or other error */
   std::streamoff get_offset(const Bin&) const;
 
+  //! Call \a read_function with the stream to read from
+  /*! If the data are memory mapped or positional reads are used, \a read_function is called with a stream
+      on the mapped memory or the file that is only used in this call. Otherwise, it is called with the stream,
+      inside a critical section when using OpenMP.
+      Returns Succeeded::no if \a read_function threw an exception.
+  */
+  Succeeded read_from_stream(const std::function<void(std::istream&)>& read_function) const;
+
 private:
   void activate_TOF();
   //! offset of the whole 3d sinogram in the stream
@@ -189,6 +235,11 @@ private:
   // memory as float, with the scale factor multiplied out
   float scale_factor;
 
+  //! memory-mapped file used for reading (if not null)
+  shared_ptr<const MemoryMappedFile> data_mmap_sptr;
+  //! file used for positional reads (if not null)
+  shared_ptr<const FileWithPositionalReads> data_file_sptr;
+
 private:
 #if __cplusplus > 199711L
   ProjDataFromStream& operator=(ProjDataFromStream&&) = delete;
@@ -273,11 +273,28 @@ public:
   }
   //@}
 
+protected:
+  //! constructor using existing (contiguous) memory for the data
+  /*!
+    No data are copied. \a data_sptr has to point to a block of at least \c size_all() elements,
+    stored in the order used by this class, i.e. timing position, segment (in the order given by
+    ProjData::standard_segment_sequence()), axial position, view and tangential position
+    (running fastest). This corresponds to the ProjDataFromStream::Segment_AxialPos_View_TangPos
+    (or Timing_Segment_AxialPos_View_TangPos for TOF data) storage order.
+
+    The memory is kept alive (via the \c shared_ptr) at least as long as this object.
+  */
+  ProjDataInMemory(shared_ptr<const ExamInfo> const& exam_info_sptr,
+                   shared_ptr<const ProjDataInfo> const& proj_data_info_ptr,
+                   shared_ptr<float[]> data_sptr);
+
 private:
   Array<1, float> buffer;
 
   //! allocates buffer for storing the data. Has to be called by constructors
   void create_buffer(const bool initialise_with_0 = false);
+  //! sets offset_3d_data and timing_poss_sequence. Has to be called by constructors
+  void set_up_offsets();
   //! offset of the whole 3d sinogram in the stream
   std::streamoff offset;
   //! offset of a complete non-tof sinogram
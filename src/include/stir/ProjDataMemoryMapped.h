@@ -0,0 +1,101 @@
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup projdata
+  \brief Declaration of class stir::ProjDataMemoryMapped
+*/
+
+#ifndef __stir_ProjDataMemoryMapped_H__
+#define __stir_ProjDataMemoryMapped_H__
+
+#include "stir/ProjDataInMemory.h"
+#include "stir/MemoryMappedFile.h"
+#include "stir/shared_ptr.h"
+#include <string>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup projdata
+  \brief A class for projection data in an Interfile file that is memory-mapped.
+
+  The binary data is mapped into memory (see MemoryMappedFile), and then used directly as the
+  buffer of the ProjDataInMemory base class. All functionality of ProjDataInMemory (i.e. iterators
+  such as begin_all(), get_data_ptr(), fill(), sum(), operator+= etc.) therefore works without
+  copying the data. Pages are only read from disk when accessed, and, as the file is mapped in
+  shared mode, modifications are visible to all processes that map the same file, and
+  are written to disk by the operating system (or when calling flush()).
+
+  This is therefore useful for (large) data that are used by multiple processes, or when the
+  data do not fit in memory.
+
+  The binary data has to be stored in the same way as ProjDataInMemory does, i.e. as
+  \c float in native byte order without scale factor, in
+  ProjDataFromStream::Segment_AxialPos_View_TangPos (or Timing_Segment_AxialPos_View_TangPos)
+  storage order, with segments in the order given by ProjData::standard_segment_sequence().
+  Files created by this class satisfy these conditions of course.
+
+  \warning Objects of this class cannot be copied (but the copy-constructor of the base class
+  can be used to make an in-memory copy).
+  \warning As the memory is shared with other processes (and the file), it is up to the user to
+  make sure that no other process modifies the data while it is being used.
+*/
+class ProjDataMemoryMapped : public ProjDataInMemory
+{
+public:
+  //! Creates a new file (and corresponding Interfile header) and maps it read-write
+  /*!
+    File names are determined as for ProjDataInterfile, i.e. if \a filename has no extension or
+    has extension .hs, the extensions .s and .hs will be used for binary file and header file.
+    Otherwise, \a filename is used for the binary data, and its extension will be replaced with .hs for the header.
+
+    All data will be initialised to 0.
+
+    \warning Any existing files with the same names will be overwritten without warning.
+  */
+  ProjDataMemoryMapped(shared_ptr<const ExamInfo> const& exam_info_sptr,
+                       shared_ptr<const ProjDataInfo> const& proj_data_info_sptr,
+                       const std::string& filename);
+
+  //! Maps an existing file read-only
+  /*! \a filename has to be the name of the (PET) Interfile header. Calls error() if the
+      data cannot be mapped, or if the file is not in the format described above.
+  */
+  static shared_ptr<const ProjDataMemoryMapped> read_from_file(const std::string& filename);
+
+  //! Maps an existing file read-write
+  /*! \see read_from_file() */
+  static shared_ptr<ProjDataMemoryMapped> open_for_update(const std::string& filename);
+
+  ProjDataMemoryMapped(const ProjDataMemoryMapped&) = delete;
+  ProjDataMemoryMapped& operator=(const ProjDataMemoryMapped&) = delete;
+
+  //! Writes modified pages to disk (does nothing for read-only mappings)
+  void flush();
+
+  //! Name of the binary data file
+  const std::string& get_data_filename() const { return this->data_filename; }
+
+private:
+  shared_ptr<MemoryMappedFile> mmap_sptr;
+  std::string data_filename;
+
+  ProjDataMemoryMapped(shared_ptr<const ExamInfo> const& exam_info_sptr,
+                       shared_ptr<const ProjDataInfo> const& proj_data_info_sptr,
+                       shared_ptr<MemoryMappedFile> const& mmap_sptr,
+                       const std::size_t offset_in_bytes,
+                       const std::string& data_filename);
+
+  static shared_ptr<ProjDataMemoryMapped> map_existing_file(const std::string& filename, const MemoryMappedFile::Mode mode);
+};
+
+END_NAMESPACE_STIR
+
+#endif
@@ -0,0 +1,306 @@
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup projdata
+  \brief Functions to apply (elementwise) operations or reductions to (any) projection data, segment by segment.
+
+  The functions in this file loop over all segments (and TOF bins) of the projection data,
+  read the corresponding segments of all projection data involved, and call a function
+  on them. When using OpenMP, and if all projection data can be read/written from multiple
+  threads (currently this is the case for ProjDataInMemory and ProjDataFromStream), segments are
+  processed in parallel. This means that reading the next segment overlaps with computations on the
+  previous ones, and that computations are done by multiple threads.
+
+  Every thread holds one segment (for one TOF bin) of every projection data involved. Memory needed is therefore
+  (number of projection data) * (number of threads) * (size of the largest segment). To keep this bounded
+  for large (e.g. long axial FOV or TOF) data, the number of threads is reduced such that this does not exceed
+  detail::max_memory_for_segments_in_MB, but at least one thread is used. The memory used is therefore at most
+  the maximum of detail::max_memory_for_segments_in_MB and what the serial loop would use. (Any data that \c func
+  reads itself are not taken into account.)
+
+  Note that the unit of processing is a whole segment, as \c func gets SegmentBySinogram objects
+  for the full axial range.
+
+  The \c func arguments are called with SegmentBySinogram<float> objects. Use elementwise_function() to
+  convert a function of floats to such a function. This allows combining multiple
+  operations in a single pass over the data, e.g.
+  \code
+  // a = b*c + d
+  transform_proj_data(a, elementwise_function([](float& out, float b, float c, float d) { out = b * c + d; }), b, c, d);
+  \endcode
+
+  \warning \c func will be called by multiple threads at the same time, so it should not modify any shared state.
+  If \c func (or reading/writing a segment) throws, the remaining segments are still processed, after which the
+  first exception is rethrown.
+*/
+
+#ifndef __stir_apply_to_proj_data_H__
+#define __stir_apply_to_proj_data_H__
+
+#include "stir/ProjData.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataFromStream.h"
+#include "stir/SegmentBySinogram.h"
+#include "stir/SegmentIndices.h"
+#include "stir/Succeeded.h"
+#include "stir/error.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cassert>
+#include <exception>
+#include <algorithm>
+#ifdef STIR_OPENMP
+#  include <omp.h>
+#endif
+
+START_NAMESPACE_STIR
+
+//! returns if segments of this object can be read/written by multiple threads simultaneously
+/*! \ingroup projdata
+  This is currently only the case for ProjDataInMemory and ProjDataFromStream (and derived classes).
+*/
+inline bool
+proj_data_io_is_thread_safe(const ProjData& proj_data)
+{
+  return dynamic_cast<const ProjDataInMemory*>(&proj_data) != nullptr
+         || dynamic_cast<const ProjDataFromStream*>(&proj_data) != nullptr;
+}
+
+namespace detail
+{
+
+//! all segment indices of \a proj_data, in the order in which they will be processed
+inline std::vector<SegmentIndices>
+get_segment_indices_for_apply(const ProjData& proj_data)
+{
+  std::vector<SegmentIndices> all_indices;
+  all_indices.reserve(proj_data.get_num_tof_poss() * proj_data.get_num_segments());
+  for (int timing_pos_num = proj_data.get_min_tof_pos_num(); timing_pos_num <= proj_data.get_max_tof_pos_num(); ++timing_pos_num)
+    for (int segment_num = proj_data.get_min_segment_num(); segment_num <= proj_data.get_max_segment_num(); ++segment_num)
+      all_indices.push_back(SegmentIndices(segment_num, timing_pos_num));
+  return all_indices;
+}
+
+//! upper limit for the memory used by the segments that are processed simultaneously by multiple threads
+constexpr double max_memory_for_segments_in_MB = 1024.;
+
+//! number of threads to use, such that all threads together need at most max_memory_for_segments_in_MB
+/*! Every thread holds \a num_segments_per_thread segments (at most the size of the largest segment).
+    Without OpenMP, this returns 1.
+*/
+inline int
+get_num_threads_for_apply(const ProjDataInfo& proj_data_info, const std::size_t num_segments_per_thread)
+{
+#ifdef STIR_OPENMP
+  const int max_num_threads = omp_get_max_threads();
+#else
+  const int max_num_threads = 1;
+#endif
+  std::size_t max_num_axial_poss = 0;
+  for (int segment_num = proj_data_info.get_min_segment_num(); segment_num <= proj_data_info.get_max_segment_num(); ++segment_num)
+    max_num_axial_poss = std::max(max_num_axial_poss, static_cast<std::size_t>(proj_data_info.get_num_axial_poss(segment_num)));
+  const double segment_size_in_MB = static_cast<double>(max_num_axial_poss) * proj_data_info.get_num_views()
+                                    * proj_data_info.get_num_tangential_poss() * sizeof(float) / (1024. * 1024.);
+  const double memory_per_thread_in_MB = segment_size_in_MB * num_segments_per_thread;
+  if (memory_per_thread_in_MB * max_num_threads <= max_memory_for_segments_in_MB)
+    return max_num_threads;
+  return std::max(1, static_cast<int>(max_memory_for_segments_in_MB / memory_per_thread_in_MB));
+}
+
+//! calls error() if \a input does not have all segments (and TOF bins) of \a output, or is otherwise incompatible
+inline void
+check_proj_data_for_apply(const ProjData& output, const ProjData& input, const char* const caller)
+{
+  if (input.get_min_segment_num() > output.get_min_segment_num() || input.get_max_segment_num() < output.get_max_segment_num())
+    error(std::string(caller) + ": input projection data has fewer segments than the output");
+  shared_ptr<ProjDataInfo> input_proj_data_info_sptr = input.get_proj_data_info_sptr()->create_shared_clone();
+  input_proj_data_info_sptr->reduce_segment_range(output.get_min_segment_num(), output.get_max_segment_num());
+  if (*input_proj_data_info_sptr != *output.get_proj_data_info_sptr())
+    error(std::string(caller) + ": projection data are incompatible");
+}
+
+template <class Func, class... InputProjData>
+inline void
+apply_to_proj_data_segments(
+    ProjData& output, const bool read_output, const char* const caller, const Func& func, const InputProjData&... inputs)
+{
+  (check_proj_data_for_apply(output, inputs, caller), ...);
+  const auto all_indices = get_segment_indices_for_apply(output);
+  bool set_segment_failed = false;
+  // exceptions cannot cross the OpenMP parallel region, so we store the first one and rethrow it after the loop
+  std::exception_ptr exception_ptr;
+#ifdef STIR_OPENMP
+  const bool parallel = (proj_data_io_is_thread_safe(output) && ... && proj_data_io_is_thread_safe(inputs));
+  const int num_threads = get_num_threads_for_apply(*output.get_proj_data_info_sptr(), sizeof...(inputs) + 1);
+#  pragma omp parallel for schedule(dynamic) if (parallel) num_threads(num_threads)
+#endif
+  for (int i = 0; i < static_cast<int>(all_indices.size()); ++i)
+    {
+      try
+        {
+          // note: not using SegmentIndices as argument, as derived classes might hide those overloads
+          const int segment_num = all_indices[i].segment_num();
+          const int timing_pos_num = all_indices[i].timing_pos_num();
+          auto segment = read_output ? output.get_segment_by_sinogram(segment_num, timing_pos_num)
+                                     : output.get_empty_segment_by_sinogram(segment_num, false, timing_pos_num);
+          func(segment, inputs.get_segment_by_sinogram(segment_num, timing_pos_num)...);
+          if (output.set_segment(segment) != Succeeded::yes)
+            {
+#ifdef STIR_OPENMP
+#  pragma omp atomic write
+#endif
+              set_segment_failed = true;
+            }
+        }
+      catch (...)
+        {
+#ifdef STIR_OPENMP
+#  pragma omp critical(STIR_APPLY_TO_PROJ_DATA_EXCEPTION)
+#endif
+          if (!exception_ptr)
+            exception_ptr = std::current_exception();
+        }
+    }
+  if (exception_ptr)
+    std::rethrow_exception(exception_ptr);
+  if (set_segment_failed)
+    error(std::string(caller) + ": set_segment failed. Write-only file?");
+}
+
+template <class Func, class... ConstPtrs>
+inline void
+apply_elementwise_to_ptrs(const Func& func, float* const output_ptr, const std::size_t num_elements, const ConstPtrs... input_ptrs)
+{
+  for (std::size_t i = 0; i < num_elements; ++i)
+    func(output_ptr[i], input_ptrs[i]...);
+}
+
+template <class Func, class OutputIter, class... InputIters>
+inline void
+apply_elementwise_to_iters(const Func& func, OutputIter output_iter, const OutputIter output_end, InputIters... input_iters)
+{
+  for (; output_iter != output_end; ++output_iter)
+    {
+      func(*output_iter, *input_iters...);
+      ((void)++input_iters, ...);
+    }
+}
+
+template <class Func, class... InputSegments>
+inline void
+apply_elementwise(const Func& func, SegmentBySinogram<float>& output, const InputSegments&... inputs)
+{
+  assert(((inputs.size_all() == output.size_all()) && ...));
+  if ((output.is_contiguous() && ... && inputs.is_contiguous()))
+    {
+      // simple loop over pointers, such that the compiler can vectorise
+      apply_elementwise_to_ptrs(func, output.get_full_data_ptr(), output.size_all(), inputs.get_const_full_data_ptr()...);
+      output.release_full_data_ptr();
+      (inputs.release_const_full_data_ptr(), ...);
+    }
+  else
+    {
+      apply_elementwise_to_iters(func, output.begin_all(), output.end_all(), inputs.begin_all_const()...);
+    }
+}
+} // namespace detail
+
+//! Converts a function on floats to a function on segments
+/*!
+  \ingroup projdata
+  \a func will be called as <code>func(float& output, float input1, ...)</code> for all bins.
+  The result can be used as argument for in_place_apply_to_proj_data() or transform_proj_data().
+*/
+template <class Func>
+inline auto
+elementwise_function(Func func)
+{
+  return [func](SegmentBySinogram<float>& output, const auto&... inputs) {
+    detail::apply_elementwise(func, output, inputs...);
+  };
+}
+
+//! Modify projection data segment by segment, using (optional) other projection data as input
+/*!
+  \ingroup projdata
+  For every segment (and TOF bin), \c func is called as
+  <code>func(SegmentBySinogram<float>& data_segment, const SegmentBySinogram<float>& input1_segment, ...)</code>,
+  after which the modified segment is written back into \a data.
+
+  The \a inputs need to have at least the segments of \a data (and otherwise be compatible).
+  See the file documentation for info on parallelisation.
+*/
+template <class Func, class... InputProjData>
+inline void
+in_place_apply_to_proj_data(ProjData& data, Func func, const InputProjData&... inputs)
+{
+  detail::apply_to_proj_data_segments(data, /* read_output = */ true, "in_place_apply_to_proj_data", func, inputs...);
+}
+
+//! Set projection data segment by segment from other projection data
+/*!
+  \ingroup projdata
+  As in_place_apply_to_proj_data(), but the segments of \a output are not read, i.e. \c func
+  is called with a segment filled with 0.
+*/
+template <class Func, class... InputProjData>
+inline void
+transform_proj_data(ProjData& output, Func func, const InputProjData&... inputs)
+{
+  detail::apply_to_proj_data_segments(output, /* read_output = */ false, "transform_proj_data", func, inputs...);
+}
+
+//! Compute a reduction over all segments of projection data
+/*!
+  \ingroup projdata
+  \c func(const SegmentBySinogram<float>&) has to return a value of type \c T for every segment (and TOF bin). Results are then
+  combined by calling <code>init = combine(init, value)</code>, in a fixed order (i.e. independent of the number of threads).
+  See the file documentation for info on parallelisation.
+*/
+template <class T, class Func, class Combine>
+inline T
+reduce_proj_data(const ProjData& data, T init, Func func, Combine combine)
+{
+  const auto all_indices = detail::get_segment_indices_for_apply(data);
+  std::vector<T> values(all_indices.size(), init);
+  // exceptions cannot cross the OpenMP parallel region, so we store the first one and rethrow it after the loop
+  std::exception_ptr exception_ptr;
+#ifdef STIR_OPENMP
+  const bool parallel = proj_data_io_is_thread_safe(data);
+  const int num_threads = detail::get_num_threads_for_apply(*data.get_proj_data_info_sptr(), 1);
+#  pragma omp parallel for schedule(dynamic) if (parallel) num_threads(num_threads)
+#endif
+  for (int i = 0; i < static_cast<int>(all_indices.size()); ++i)
+    {
+      try
+        {
+          values[i] = func(data.get_segment_by_sinogram(all_indices[i]));
+        }
+      catch (...)
+        {
+#ifdef STIR_OPENMP
+#  pragma omp critical(STIR_REDUCE_PROJ_DATA_EXCEPTION)
+#endif
+          if (!exception_ptr)
+            exception_ptr = std::current_exception();
+        }
+    }
+  if (exception_ptr)
+    std::rethrow_exception(exception_ptr);
+  for (const T& value : values)
+    init = combine(init, value);
+  return init;
+}
+
+END_NAMESPACE_STIR
+
+#endif
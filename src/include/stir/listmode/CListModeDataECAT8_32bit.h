@@ -51,12 +51,16 @@ public:
 
   Succeeded get_next_record(CListRecord& record) const override;
 
+  std::size_t get_next_records(const std::vector<shared_ptr<ListRecord>>& records) const override;
+
   Succeeded reset() override;
 
   SavedPosition save_get_position() override;
 
   Succeeded set_get_position(const SavedPosition&) override;
 
+  Succeeded overwrite_saved_get_position(const SavedPosition&) override;
+
   //! returns \c true, as ECAT listmode data stores delayed events (and prompts)
   /*! \todo this might depend on the acquisition parameters */
   bool has_delayeds() const override { return true; }
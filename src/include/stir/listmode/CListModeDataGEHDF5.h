@@ -56,6 +56,8 @@ public:
 
   Succeeded set_get_position(const SavedPosition&) override;
 
+  Succeeded overwrite_saved_get_position(const SavedPosition&) override;
+
   //! returns \c false, as GEHDF5 listmode data does not store delayed events (and prompts)
   /*! \todo this depends on the acquisition parameters */
   bool has_delayeds() const override { return false; }
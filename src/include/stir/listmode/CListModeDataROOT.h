@@ -124,6 +124,8 @@ public:
 
   Succeeded set_get_position(const SavedPosition&) override;
 
+  Succeeded overwrite_saved_get_position(const SavedPosition&) override;
+
   bool has_delayeds() const override { return true; }
 
   inline unsigned long int get_total_number_of_events() const override;
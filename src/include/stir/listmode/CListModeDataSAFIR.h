@@ -74,6 +74,7 @@ public:
   std::string get_name() const override;
   shared_ptr<CListRecord> get_empty_record_sptr() const override;
   Succeeded get_next_record(CListRecord& record_of_general_type) const override;
+  std::size_t get_next_records(const std::vector<shared_ptr<ListRecord>>& records) const override;
   Succeeded reset() override;
 
   /*!
@@ -83,6 +84,10 @@ public:
   */
   SavedPosition save_get_position() override { return static_cast<SavedPosition>(current_lm_data_ptr->save_get_position()); }
   Succeeded set_get_position(const SavedPosition& pos) override { return current_lm_data_ptr->set_get_position(pos); }
+  Succeeded overwrite_saved_get_position(const SavedPosition& pos) override
+  {
+    return current_lm_data_ptr->overwrite_saved_get_position(pos);
+  }
 
   /*!
   Returns just false in the moment.
@@ -23,6 +23,7 @@
 
 #include <string>
 #include <ctime>
+#include <vector>
 #include "stir/ProjDataInfo.h"
 #include "stir/ExamData.h"
 #include "stir/RegisteredParsingObject.h"
@@ -183,6 +184,18 @@ public:
     return get_next(event);
   }
 
+  //! Gets a number of records in the listmode sequence
+  /*! Fills the records in \a records (in order) and returns the number of records that were read.
+      This is smaller than <code>records.size()</code> only if there are no more records available.
+      All records have to be of the appropriate type, i.e. obtained via get_empty_record_sptr().
+
+      The default implementation calls get_next_record() repeatedly. Derived classes can provide
+      a more efficient implementation (e.g. reading from a buffer with a single lock). It is therefore
+      recommended to use this function when reading many records, in particular when
+      the records are subsequently processed by multiple threads.
+  */
+  virtual std::size_t get_next_records(const std::vector<shared_ptr<ListRecord>>& records) const;
+
   //! Call this function if you want to re-start reading at the beginning.
   virtual Succeeded reset() = 0;
 
@@ -210,6 +223,16 @@ public:
 
   virtual Succeeded set_get_position(const SavedPosition&) = 0;
 
+  //! Save the current reading position in place of a previously saved one
+  /*!
+      This allows code that needs to go back many times (e.g. once per batch of records) to
+      avoid an ever growing number of saved positions.
+
+      The default implementation returns Succeeded::no, such that the caller has to use
+      save_get_position() instead.
+  */
+  virtual Succeeded overwrite_saved_get_position(const SavedPosition&);
+
   //! Get reference to scanner
   /*! Returns a reference to a scanner object that is appropriate for the
       list mode data that is being read.
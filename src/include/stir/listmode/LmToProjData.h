@@ -38,6 +38,8 @@ START_NAMESPACE_STIR
 
 class ListEvent;
 class ListTime;
+template <typename elemT>
+class SegmentByView;
 
 /*!
   \ingroup listmode
@@ -107,6 +109,14 @@ class ListTime;
     num_segments_in_memory := -1
     ; same for TOF bins
     num_TOF_bins_in_memory := 1
+
+    ; histogram the events using multiple threads (only useful when compiled with OpenMP)
+    parallel histogramming := 0 ; default
+    ; number of list mode records that are read and histogrammed at once
+    num records per batch for parallel histogramming := 100000 ; default
+    ; give each thread its own copy of the segments in memory (faster), or
+    ; let all threads update the same segments using atomic operations (less memory)
+    use thread-local buffers for parallel histogramming := 1 ; default
   End :=
   \endverbatim
 
@@ -141,6 +151,28 @@ class ListTime;
   </li>
   </ul>
 
+  \par Parallel histogramming
+
+  When <tt>parallel histogramming</tt> is enabled, the list mode data are read in batches
+  of records. Timing records in a batch are handled first (in the order of the file),
+  after which get_bin_from_event() and the normalisation are computed for all events of
+  the batch in parallel. Each thread then adds its events to its own copy of the
+  segments in memory (which are summed when the segments are written), or to the shared
+  segments using atomic operations. Time frames, \c num_events_to_store and pre/post-normalisation
+  are handled as in the serial case, and the list mode file is repositioned such that
+  the next frame starts at the same record. Events are added in a different order, so results
+  can differ in the last bits due to floating point rounding (unless all values are integers).
+  As BinNormalisation::get_bin_efficiency() is not necessarily thread-safe, it is called in a
+  critical section (unless the normalisation is trivial), which limits the speed-up when using
+  a normalisation.
+
+  \warning get_bin_from_event() will be called from multiple threads, and after
+  process_new_time_event() has been called for all timing records in the batch.
+  Derived classes for which this is not appropriate (e.g. because the bin depends on the
+  current time or on the order of the events) have to override supports_parallel_histogramming()
+  to return \c false, in which case set_up() will call error() when parallel histogramming is enabled.
+  This mode is not used when <tt>List event coordinates</tt> is set.
+
   \par Notes for developers
 
   The class provides several
@@ -208,8 +240,18 @@ public:
   long int get_num_events_to_store() const;
   void set_time_frame_definitions(const TimeFrameDefinitions&);
   const TimeFrameDefinitions& get_time_frame_definitions() const;
+  void set_parallel_histogramming(bool);
+  bool get_parallel_histogramming() const;
+  void set_num_records_per_batch(int);
+  int get_num_records_per_batch() const;
+  void set_use_thread_local_buffers(bool);
+  bool get_use_thread_local_buffers() const;
   //@}
 
+  //! Returns \c true if get_bin_from_event() can be called from multiple threads
+  /*! Returns \c true in this class. See the class documentation on parallel histogramming. */
+  virtual bool supports_parallel_histogramming() const;
+
   //! Perform various checks
   /*! Note: this is currently called by post_processing(). This will change in version 5.0 */
   Succeeded set_up() override;
@@ -283,6 +325,13 @@ protected:
   /*! corresponds to key "list event coordinates" */
   bool interactive;
 
+  //! Use multiple threads to histogram the events (see class documentation)
+  bool parallel_histogramming;
+  //! Number of records read at once when using parallel histogramming
+  int num_records_per_batch;
+  //! If \c false, parallel histogramming uses atomic updates of the segments in memory
+  bool use_thread_local_buffers;
+
   shared_ptr<ProjDataInfo> template_proj_data_info_ptr;
   //! This will be used for pre-normalisation
   shared_ptr<BinNormalisation> normalisation_ptr;
@@ -318,6 +367,22 @@ protected:
 
   //! an internal bool variable to check if the object has been set-up or not
   bool _already_setup;
+
+private:
+  //! histogram events from the current position until the end of the frame (or enough events are stored)
+  /*! Used by process_data() for parallel histogramming. Arguments correspond to the local
+      variables of the serial loop in process_data().
+  */
+  void histogram_events_in_parallel(VectorWithOffset<VectorWithOffset<SegmentByView<float>*>>& segments,
+                                    const int start_timing_pos_index,
+                                    const int end_timing_pos_index,
+                                    const int start_segment_index,
+                                    const int end_segment_index,
+                                    const double end_time,
+                                    unsigned long int& more_events,
+                                    long& num_stored_events,
+                                    long& num_prompts_in_frame,
+                                    long& num_delayeds_in_frame);
 };
 
 END_NAMESPACE_STIR
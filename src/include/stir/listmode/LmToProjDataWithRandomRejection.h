@@ -81,6 +81,9 @@ public:
 
   Succeeded set_up() override;
 
+  //! Returns \c false, as get_bin_from_event() depends on the order of the events
+  bool supports_parallel_histogramming() const override;
+
 protected:
   //! will be called when a new time frame starts
   /*! Initialises a vector with the number of times each event has to be replicated */
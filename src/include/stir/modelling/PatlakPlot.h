@@ -84,6 +84,9 @@ public:
   ModelMatrix<2> get_model_matrix(const PlasmaData& plasma_data,
                                   const TimeFrameDefinitions& time_frame_definitions,
                                   const unsigned int starting_frame);
+  //! Gets the model matrix as used by the functions below for images with the same characteristics as \a dyn_image
+  /*! The model matrix is scaled according to the voxel size if \c _in_correct_scale is \c false. */
+  ModelMatrix<2> get_model_matrix_for_dynamic_image(const DynamicDiscretisedDensity& dyn_image) const;
   //! Returns the frame that the PatlakPlot linearization is assumed to be valid.
   unsigned int get_starting_frame() const;
   //! Returns the number of the last frame available.
@@ -140,6 +143,8 @@ public:
 
 private:
   void create_model_matrix(); //!< Creates model matrix from private members
+  //! Scales the model matrix according to the voxel size of \a dyn_image (if not \c _in_correct_scale yet)
+  void scale_model_matrix_for_dynamic_image(const DynamicDiscretisedDensity& dyn_image) const;
   void initialise_keymap() override;
   bool post_processing() override;
   mutable ModelMatrix<2> _model_matrix;
@@ -0,0 +1,115 @@
+//
+//
+/*!
+  \file
+  \ingroup DFT
+  \brief Declaration of class stir::FourierTransformPlan
+
+*/
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+#ifndef __stir_numerics_FourierTransformPlan_h__
+#define __stir_numerics_FourierTransformPlan_h__
+
+#include "stir/shared_ptr.h"
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+START_NAMESPACE_STIR
+
+/*! \ingroup DFT
+  \brief A precomputed ("planned") one-dimensional discrete fourier transform of a given length.
+
+  This class is used by the functions in fourier.h for arrays of <code>std::complex\<float\></code>,
+  but can be used directly for transforms of contiguous data as well.
+
+  The convention is the same as for fourier_1d(), i.e. for a vector of length \a n
+  \f[
+    r_s = \sum_{s=0}^{n-1} c_r e^{\mathrm{sign} 2\pi i r s/n}
+  \f]
+
+  Any length is supported. The length is factorised in radices 4, 2, 3, 5 etc and
+  a mixed-radix Cooley-Tukey algorithm is used. If the length has a prime factor larger
+  than 61, Bluestein's algorithm is used instead (which uses a transform of a power of 2 length).
+  All twiddle factors are computed (in double precision) when the plan is constructed.
+
+  Plans are normally obtained via get_plan(), which keeps a (thread-safe) cache of plans
+  such that they are only computed once for every length and \c sign.
+  A plan is read-only after construction, and the same plan can therefore be used by
+  multiple threads at the same time.
+*/
+class FourierTransformPlan
+{
+public:
+  typedef std::complex<float> complex_type;
+
+  //! Get a plan for the given length and sign from the cache (or construct it if not yet present)
+  static shared_ptr<const FourierTransformPlan> get_plan(const int length, const int sign);
+
+  //! Remove all plans from the cache
+  /*! Plans that are still in use elsewhere will only be deleted when they are no longer used. */
+  static void clear_cache();
+
+  //! Construct the plan
+  /*! Normally you would use get_plan() instead. */
+  FourierTransformPlan(const int length, const int sign);
+
+  int get_length() const { return length; }
+  int get_sign() const { return sign; }
+
+  //! In-place transform of \c length contiguous elements
+  void transform(complex_type* data) const;
+
+  //! In-place transform of many vectors
+  /*! Transforms the vectors starting at <tt>data + i*distance</tt> for <tt>0\<=i\<num_transforms</tt>.
+      When compiled with OpenMP, the transforms are distributed over the threads.
+  */
+  void transform_many(complex_type* data, const int num_transforms, const std::ptrdiff_t distance) const;
+
+  //! Returns <tt>exp(sign*i*pi*k/length)</tt> for <tt>0\<=k\<=length/2</tt>
+  /*! This is used for computing DFTs of real data of length <tt>2*length</tt>. */
+  complex_type get_half_twiddle(const int k) const { return half_twiddles[k]; }
+
+private:
+  int length;
+  int sign;
+  //! pairs of (radix, remaining length) for every stage
+  std::vector<int> factors;
+  //! <tt>exp(sign*2*pi*i*k/length)</tt>
+  std::vector<complex_type> twiddles;
+  std::vector<complex_type> half_twiddles;
+
+  //! \name variables used for Bluestein's algorithm
+  //@{
+  bool use_bluestein;
+  //! <tt>exp(sign*pi*i*k^2/length)</tt>
+  std::vector<complex_type> chirp;
+  //! DFT of the convolution kernel, divided by its length
+  std::vector<complex_type> chirp_kernel_in_frequency_space;
+  shared_ptr<const FourierTransformPlan> convolution_forward_plan_sptr;
+  shared_ptr<const FourierTransformPlan> convolution_inverse_plan_sptr;
+  //@}
+
+  //! out-of-place transform of \a in (with stride \a in_stride) to \a out
+  void transform(complex_type* out, const complex_type* in, const std::ptrdiff_t in_stride) const;
+  void work(complex_type* out,
+            const complex_type* in,
+            const std::size_t fstride,
+            const std::ptrdiff_t in_stride,
+            const int* factors_ptr) const;
+  void butterfly_2(complex_type* out, const std::size_t fstride, const int m) const;
+  void butterfly_4(complex_type* out, const std::size_t fstride, const int m) const;
+  void butterfly_generic(complex_type* out, const std::size_t fstride, const int m, const int p) const;
+  void transform_using_bluestein(complex_type* data) const;
+};
+
+END_NAMESPACE_STIR
+
+#endif
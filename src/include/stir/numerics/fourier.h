@@ -34,6 +34,8 @@ START_NAMESPACE_STIR
 
   \see fourier_1d for conventions and restrictions
 
+  When compiled with OpenMP, the transforms of the different rows are computed in parallel.
+
   \warning Currently, the array has to have \c get_min_index()==0 at each dimension.
 */
 template <typename T>
@@ -74,7 +76,9 @@ inverse_fourier(T& c, const int sign = 1)
   \param[in] sign This can be used to implement a different convention for the DFT
 
   \warning Currently, the array has to be indexed from 0.
-  \warning Currently, the length of the array has to be a power of 2.
+  \warning For arrays of <code>std::complex\<float\></code>, any length can be used, as the
+  transform is computed using a FourierTransformPlan (which is cached for every length).
+  For other types, the length of the array has to be a power of 2.
 
   The convention used is as follows.
   For a vector of length \a n, the result is
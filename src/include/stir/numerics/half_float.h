@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup numerics
+  \brief Conversions between \c float and IEEE 754 half-precision (16-bit) floating point numbers
+
+  Half-precision numbers have about 3 significant decimal digits, and a range of about
+  \f$6\ 10^{-8}\f$ (subnormal) to 65504. They are used to reduce memory of large tables.
+*/
+
+#ifndef __stir_numerics_half_float_H__
+#define __stir_numerics_half_float_H__
+
+#include "stir/common.h"
+#include <cstdint>
+#include <cstring>
+
+START_NAMESPACE_STIR
+
+//! Convert a float to IEEE 754 half-precision (round to nearest even)
+inline std::uint16_t
+float_to_half(const float f)
+{
+  std::uint32_t x;
+  std::memcpy(&x, &f, sizeof(x));
+  const std::uint16_t sign = static_cast<std::uint16_t>((x >> 16) & 0x8000);
+  const std::uint32_t abs_x = x & 0x7fffffff;
+  if (abs_x >= 0x7f800000) // inf or NaN
+    return sign | 0x7c00 | (abs_x > 0x7f800000 ? 0x200 : 0);
+  if (abs_x >= 0x477ff000) // too large, round to inf
+    return sign | 0x7c00;
+  if (abs_x < 0x38800000) // subnormal half (or zero)
+    {
+      if (abs_x < 0x33000000) // underflows to zero
+        return sign;
+      const std::uint32_t mantissa = (abs_x & 0x007fffff) | 0x00800000;
+      const int shift = 126 - static_cast<int>(abs_x >> 23);
+      std::uint32_t h = mantissa >> shift;
+      const std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+      const std::uint32_t halfway = 1u << (shift - 1);
+      if (remainder > halfway || (remainder == halfway && (h & 1)))
+        ++h;
+      return sign | static_cast<std::uint16_t>(h);
+    }
+  // normal number: rebias exponent and round mantissa
+  std::uint32_t h = ((abs_x - 0x38000000) >> 13);
+  const std::uint32_t remainder = abs_x & 0x1fff;
+  if (remainder > 0x1000 || (remainder == 0x1000 && (h & 1)))
+    ++h;
+  return sign | static_cast<std::uint16_t>(h);
+}
+
+//! Convert an IEEE 754 half-precision number to float
+inline float
+half_to_float(const std::uint16_t h)
+{
+  const std::uint32_t sign = static_cast<std::uint32_t>(h & 0x8000) << 16;
+  std::uint32_t exponent = (h >> 10) & 0x1f;
+  std::uint32_t mantissa = h & 0x3ff;
+  std::uint32_t x;
+  if (exponent == 0x1f)
+    x = sign | 0x7f800000 | (mantissa << 13);
+  else if (exponent != 0)
+    x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  else if (mantissa == 0)
+    x = sign;
+  else
+    {
+      // subnormal half: normalise
+      exponent = 113;
+      while ((mantissa & 0x400) == 0)
+        {
+          mantissa <<= 1;
+          --exponent;
+        }
+      x = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+  float f;
+  std::memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+END_NAMESPACE_STIR
+
+#endif
@@ -30,6 +30,11 @@
 #include "stir/shared_ptr.h"
 #include "stir/Bin.h"
 #include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include <vector>
+#ifdef STIR_OPENMP
+#  include <mutex>
+#  include <condition_variable>
+#endif
 
 START_NAMESPACE_STIR
 
@@ -106,6 +111,24 @@ public:
                     const int min_tangential_pos_num,
                     const int max_tangential_pos_num);
 #endif
+  //! back project several projection data into corresponding volumes
+  /*! This is equivalent to calling back_project(DiscretisedDensity<3, float>&, const ProjData&, int, int)
+      for every pair <code>(*density_ptrs[n], *proj_data_ptrs[n])</code> (i.e. the images are overwritten).
+      However, derived classes that support it (see can_project_multiple_images_simultaneously()) will handle
+      all projection data for every set of related viewgrams, e.g. computing every row of the projection matrix only once.
+
+      All projection data need to have the same ProjDataInfo. This function does not modify the target used by
+      start_accumulating_in_new_target().
+
+      \warning When using OpenMP, every thread accumulates in its own set of images, so this needs
+      memory for (number of threads) * (number of images) images. If this is larger than the memory budget
+      (see set_thread_local_images_memory_budget_in_MB()), the images are back projected one by one.
+  */
+  void back_project(const std::vector<DiscretisedDensity<3, float>*>& density_ptrs,
+                    const std::vector<const ProjData*>& proj_data_ptrs,
+                    int subset_num = 0,
+                    int num_subsets = 1);
+
   /*! \brief projects the viewgrams into the volume
     it adds to the data backprojected since start_accumulating_in_new_target() was last called. */
   virtual void back_project(const ProjData&, int subset_num = 0, int num_subsets = 1);
@@ -140,6 +163,18 @@ public:
   /// Set data processor to use after back projection
   void set_post_data_processor(shared_ptr<DataProcessor<DiscretisedDensity<3, float>>> post_data_processor_sptr);
 
+  //! Set the maximum amount of memory (in MB) used for the images in which the OpenMP threads accumulate
+  /*! By default (or when setting the budget to 0), every thread accumulates in its own image. If the budget is
+      smaller than what this would need, fewer images are allocated (but at least one). The images then form a pool
+      shared by all threads: for every RelatedViewgrams, a thread takes an image that is not used by another thread
+      (waiting if necessary) and returns it to the pool afterwards. This bounds the memory, at the cost of threads
+      possibly having to wait.
+
+      This has to be called before set_up(). It has no effect when not using OpenMP.
+  */
+  void set_thread_local_images_memory_budget_in_MB(const float budget);
+  float get_thread_local_images_memory_budget_in_MB() const;
+
   virtual BackProjectorByBin* clone() const = 0;
 
 protected:
@@ -173,6 +208,24 @@ protected:
                                    const int max_axial_pos_num,
                                    const int min_tangential_pos_num,
                                    const int max_tangential_pos_num);
+  //! Returns if the derived class implements the back projection of multiple images
+  /*! If this returns \c true, the derived class has to implement the version of actual_back_project() that
+      takes a vector of RelatedViewgrams. Default implementation returns \c false.
+  */
+  virtual bool can_project_multiple_images_simultaneously() const;
+
+  //! back project several related viewgrams into corresponding images (accumulates)
+  /*! All related viewgrams correspond to the same view/segment/TOF numbers.
+
+      Default implementation calls error().
+  */
+  virtual void actual_back_project(const std::vector<DiscretisedDensity<3, float>*>& density_ptrs,
+                                   const std::vector<const RelatedViewgrams<float>*>& viewgrams_ptrs,
+                                   const int min_axial_pos_num,
+                                   const int max_axial_pos_num,
+                                   const int min_tangential_pos_num,
+                                   const int max_tangential_pos_num);
+
   //! check if the argument is the same as what was used for set_up()
   /*! calls error() if anything is wrong.
 
@@ -194,9 +247,13 @@ protected:
   //! Clone of the density sptr set with set_up()
   shared_ptr<DiscretisedDensity<3, float>> _density_sptr;
   shared_ptr<DataProcessor<DiscretisedDensity<3, float>>> _post_data_processor_sptr;
+  //! see set_thread_local_images_memory_budget_in_MB()
+  float _thread_local_images_memory_budget_in_MB;
 
   void set_defaults() override;
   void initialise_keymap() override;
+  //! Checks the memory budget for thread-local images
+  bool post_processing() override;
 
 protected:
   //! ProjDataInfo set by set_up()
@@ -204,9 +261,36 @@ protected:
 
 private:
 #ifdef STIR_OPENMP
-  //! A vector of back projected images that will be used with openMP. There will be as many images as openMP threads
+  //! A vector of back projected images that will be used with openMP.
+  /*! There will be as many images as openMP threads, unless limited by the memory budget. */
   std::vector<shared_ptr<DiscretisedDensity<3, float>>> _local_output_image_sptrs;
+  //! Only used when there are fewer images than threads: which images are currently used by a thread
+  std::vector<char> _local_output_image_in_use;
+  //! Only used when there are fewer images than threads: index of the image used by every thread
+  std::vector<int> _local_output_image_index_for_thread;
+  //! Protects _local_output_image_in_use and lets threads wait for a free image
+  /*! Copying a back projector gives a new mutex and condition variable. */
+  struct LocalOutputImagesSync
+  {
+    LocalOutputImagesSync() = default;
+    LocalOutputImagesSync(const LocalOutputImagesSync&) {}
+    LocalOutputImagesSync& operator=(const LocalOutputImagesSync&) { return *this; }
+
+    std::mutex mutex;
+    std::condition_variable image_released;
+  };
+  LocalOutputImagesSync _local_output_images_sync;
+
+  //! Returns the index in _local_output_image_sptrs of the image the current thread should accumulate in
+  /*! If there are fewer images than threads, this waits (without busy-waiting) until an image is free and marks it as used. */
+  int acquire_local_output_image();
+  //! Marks the image as free again (if there are fewer images than threads)
+  void release_local_output_image();
+  //! Calls acquire_local_output_image() on construction and release_local_output_image() on destruction
+  /*! This makes sure that the image is released, even if the back projection throws an exception. */
+  class LocalOutputImageGuard;
 #endif
+
 };
 
 END_NAMESPACE_STIR
@@ -69,6 +69,17 @@ public:
                            const int min_tangential_pos_num,
                            const int max_tangential_pos_num) override;
 
+  //! Returns \c true, as every row of the matrix can be used for multiple images
+  bool can_project_multiple_images_simultaneously() const override;
+
+  //! back project into several images, computing (and transforming) every row of the matrix only once
+  void actual_back_project(const std::vector<DiscretisedDensity<3, float>*>& image_ptrs,
+                           const std::vector<const RelatedViewgrams<float>*>& viewgrams_ptrs,
+                           const int min_axial_pos_num,
+                           const int max_axial_pos_num,
+                           const int min_tangential_pos_num,
+                           const int max_tangential_pos_num) override;
+
   shared_ptr<ProjMatrixByBin>& get_proj_matrix_sptr() { return proj_matrix_ptr; }
 
   BackProjectorByBinUsingProjMatrixByBin* clone() const override;
@@ -25,11 +25,15 @@
 #include "stir/Bin.h"
 #include "stir/shared_ptr.h"
 #include "stir/deprecated.h"
+#include <vector>
+#include <cstddef>
 
 START_NAMESPACE_STIR
 
 template <typename elemT>
 class RelatedViewgrams;
+template <typename elemT>
+class Viewgram;
 class Succeeded;
 class ProjDataInfo;
 class ProjData;
@@ -47,6 +51,26 @@ class ExamInfo;
   are object dependent).
 
   The present class can be used for both of these factors.
+
+  \par Caching of the efficiencies
+
+  The default implementations of apply(RelatedViewgrams<float>&) and undo(RelatedViewgrams<float>&)
+  call get_bin_efficiency() for every bin, which can be slow for some derived classes (e.g. when
+  combining crystal efficiencies, geometric and dead-time factors). They can therefore optionally store
+  the factors of every viewgram the first time that viewgram is normalised, and reuse them afterwards.
+  As viewgrams are normally processed by multiple threads, the cache is effectively filled in parallel.
+  The cache is cleared by set_up(). Derived classes that override apply() and undo() do not use it.
+
+  \par Parsing
+  These keywords can be used for all derived classes (although they have no effect for some, see above).
+  \verbatim
+  ; default is 0 (i.e. no caching)
+  cache bin efficiencies := 1
+  ; maximum memory to use for the cache, 0 means no limit (default)
+  memory budget for cached bin efficiencies (MB) := 1000
+  ; halve memory by storing as 16-bit floating point numbers (relative precision about 5e-4), default is 0
+  store cached bin efficiencies as fp16 := 0
+  \endverbatim
 */
 class BinNormalisation : public RegisteredObject<BinNormalisation>
 {
@@ -54,7 +78,7 @@ public:
   BinNormalisation();
 
   ~BinNormalisation() override;
-  /*! sets \c _already_setup to \c false */
+  /*! sets \c _already_setup to \c false, and switches off caching */
   void set_defaults() override;
   virtual float get_calibration_factor() const { return -1; }
 
@@ -137,6 +161,17 @@ public:
 
   shared_ptr<const ExamInfo> get_exam_info_sptr() const;
 
+  //! \name functions to set/get parameters for caching the efficiencies
+  /*! \see class documentation. Changing these clears the cache. */
+  //@{
+  void set_cache_bin_efficiencies(const bool);
+  bool get_cache_bin_efficiencies() const;
+  void set_cached_bin_efficiencies_memory_budget_in_MB(const double);
+  double get_cached_bin_efficiencies_memory_budget_in_MB() const;
+  void set_store_cached_bin_efficiencies_as_fp16(const bool);
+  bool get_store_cached_bin_efficiencies_as_fp16() const;
+  //@}
+
 protected:
   //! check if the argument is the same as what was used for set_up()
   /*! calls error() if anything is wrong.
@@ -146,11 +181,32 @@ protected:
   virtual void check(const ProjDataInfo& proj_data_info) const;
 
   virtual void check(const ExamInfo& exam_info) const;
+
+  //! adds the keywords for caching
+  /*! If overriding this function in a derived class, you need to call this one. */
+  void initialise_keymap() override;
+
   bool _already_set_up;
   shared_ptr<const ProjDataInfo> proj_data_info_sptr;
 
 private:
   shared_ptr<const ExamInfo> exam_info_sptr;
+
+  bool _cache_bin_efficiencies;
+  double _cached_bin_efficiencies_memory_budget_in_MB;
+  bool _store_cached_bin_efficiencies_as_fp16;
+
+  class CachedViewgramEfficiencies;
+  //! cached efficiencies, indexed by TOF bin, segment and view (see get_cache_index())
+  mutable std::vector<shared_ptr<const CachedViewgramEfficiencies>> _cached_efficiencies;
+  mutable std::size_t _cached_efficiencies_num_bytes;
+  mutable bool _cached_efficiencies_memory_budget_reached;
+
+  void clear_cached_efficiencies();
+  //! returns -1 if the viewgram cannot be cached
+  int get_cache_index(const Viewgram<float>&) const;
+  //! returns the efficiencies for this viewgram (computing them if necessary), or a null pointer if they are not cached
+  shared_ptr<const CachedViewgramEfficiencies> get_cached_efficiencies(const Viewgram<float>&) const;
 };
 
 END_NAMESPACE_STIR
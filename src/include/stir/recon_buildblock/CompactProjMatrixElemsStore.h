@@ -0,0 +1,113 @@
+//
+//
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup projection
+
+  \brief Declaration of class stir::CompactProjMatrixElemsStore
+*/
+#ifndef __stir_recon_buildblock_CompactProjMatrixElemsStore_H__
+#define __stir_recon_buildblock_CompactProjMatrixElemsStore_H__
+
+#include "stir/common.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+START_NAMESPACE_STIR
+
+class ProjMatrixElemsForOneBin;
+
+/*!
+  \ingroup projection
+  \brief A memory-efficient storage for a collection of ProjMatrixElemsForOneBin objects
+
+  This class is used by ProjMatrixByBin to cache rows of the projection matrix when
+  memory is a concern. Rows are identified by a key (e.g. encoding the bin coordinates)
+  and stored in an "arena", i.e. a small number of large memory blocks, avoiding the overhead
+  of a separate allocation per row.
+
+  Each row is encoded as
+  - the number of elements (as a variable-length integer)
+  - for each element, the difference of its voxel coordinates with the previous element
+    (as zig-zag encoded variable-length integers) and its value.
+
+  As neighbouring elements in a row are normally neighbouring voxels, the coordinates
+  take usually only 3 bytes per element (as opposed to 6). The value can be stored as a float
+  (lossless), a 16-bit floating point number (fp16), or a 16-bit integer quantised between the
+  minimum and maximum value of the row. Together, this reduces the memory needed by about a factor 2 (float)
+  or 3 (16-bit values) compared to a <code>std::unordered_map</code> of ProjMatrixElemsForOneBin objects.
+
+  Decoding is sequential through the row, so is as cache-friendly as reading the original row.
+
+  \warning This class is not thread-safe. Callers need to do their own locking if
+  multiple threads can insert elements.
+*/
+class CompactProjMatrixElemsStore
+{
+public:
+  //! Type used for keys
+  typedef std::uint64_t key_type;
+
+  //! Enum for the type of storage for the values
+  enum class ValueEncoding
+  {
+    float32,
+    float16,
+    quantised16
+  };
+
+  //! Convert a ValueEncoding to a string ("float", "fp16" or "quantised")
+  static std::string value_encoding_to_string(const ValueEncoding);
+
+  explicit CompactProjMatrixElemsStore(const ValueEncoding value_encoding = ValueEncoding::float32);
+
+  ValueEncoding get_value_encoding() const { return value_encoding; }
+
+  //! store a row
+  /*! If an element with the same \a key is already present, nothing is done (as for std::unordered_map::insert).
+      The bin of \a lor is not stored.
+  */
+  void insert(const key_type key, const ProjMatrixElemsForOneBin& lor);
+
+  //! get a row
+  /*! If the \a key is found, the elements of \a lor are replaced by the stored ones (its bin is not modified)
+      and \c true is returned. Otherwise, \a lor is not modified, and \c false is returned.
+  */
+  bool find(const key_type key, ProjMatrixElemsForOneBin& lor) const;
+
+  //! remove all rows and deallocate memory
+  void clear();
+
+  //! number of rows currently stored
+  std::size_t size() const { return offsets.size(); }
+
+  //! approximate memory (in bytes) used by the stored rows (excluding the index)
+  std::size_t get_num_bytes_used() const;
+
+private:
+  ValueEncoding value_encoding;
+  //! memory blocks. Rows do not span multiple blocks
+  std::vector<std::vector<unsigned char>> blocks;
+  //! number of bytes used in the last block
+  std::size_t num_bytes_used_in_last_block;
+  //! position of every row, encoded as block-number (upper 32 bits) and offset in the block (lower 32 bits)
+  std::unordered_map<key_type, std::uint64_t> offsets;
+
+  //! return a pointer to a memory location with at least \a num_bytes available
+  unsigned char* get_space(const std::size_t num_bytes);
+};
+
+END_NAMESPACE_STIR
+
+#endif
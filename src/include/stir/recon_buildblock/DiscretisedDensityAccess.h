@@ -0,0 +1,154 @@
+//
+//
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup projection
+  \brief Declaration (and inline implementation) of class stir::DiscretisedDensityAccess
+*/
+
+#ifndef __stir_recon_buildblock_DiscretisedDensityAccess_H__
+#define __stir_recon_buildblock_DiscretisedDensityAccess_H__
+
+#include "stir/DiscretisedDensity.h"
+#include "stir/BasicCoordinate.h"
+#include "stir/error.h"
+#include <vector>
+#include <cstddef>
+#include <cassert>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup projection
+  \brief Gives fast access to the voxels of a DiscretisedDensity, used by ProjMatrixElemsForOneBin
+
+  Accessing a voxel as <code>density[z][y][x]</code> needs 3 indirections (and for every one of them,
+  the offset of the index range is taken into account). If the image has a regular range,
+  this class stores a table of pointers to all rows of the image, such that a voxel can be accessed as
+  <code>get_const_row_ptr(get_row_index(z, y))[x]</code>. The row index can be reused for several images
+  with the same index range (see has_same_range()).
+
+  Setting up the table needs a loop over all rows of the image, so an
+  object of this class should be constructed once for many projection operations, not for every bin.
+
+  When has_row_pointers() is \c false, users of this class should use get_density() instead.
+
+  The object acts like a pointer to the image: a \c const object still gives modifiable access to the image
+  (if it was constructed from a non-const image).
+
+  \warning The object stores pointers to the image and its data. It can therefore not be used anymore
+  after the image is destroyed or resized.
+*/
+class DiscretisedDensityAccess
+{
+public:
+  //! Default constructor, not associated with any image
+  DiscretisedDensityAccess() = default;
+
+  //! Constructor for read-only access
+  explicit DiscretisedDensityAccess(const DiscretisedDensity<3, float>& density) { set_up(density, nullptr); }
+
+  //! Constructor for read-write access
+  explicit DiscretisedDensityAccess(DiscretisedDensity<3, float>& density) { set_up(density, &density); }
+
+  //! Returns \c true if voxels can be accessed via the row pointers
+  bool has_row_pointers() const { return !_const_row_ptrs.empty(); }
+
+  //! Returns \c true if both objects have row pointers for the same index range
+  bool has_same_range(const DiscretisedDensityAccess& other) const
+  {
+    return has_row_pointers() && other.has_row_pointers() && _min_z == other._min_z && _max_z == other._max_z
+           && _min_y == other._min_y && _max_y == other._max_y && _min_x == other._min_x && _max_x == other._max_x;
+  }
+
+  //! Returns the image (calls error() if not associated with any image)
+  const DiscretisedDensity<3, float>& get_density() const
+  {
+    if (!_const_density_ptr)
+      error("DiscretisedDensityAccess: no image set");
+    return *_const_density_ptr;
+  }
+
+  //! Returns the image for modification (calls error() if not constructed from a non-const image)
+  DiscretisedDensity<3, float>& get_modifiable_density() const
+  {
+    if (!_density_ptr)
+      error("DiscretisedDensityAccess: object constructed for read-only access");
+    return *_density_ptr;
+  }
+
+  int get_min_z() const { return _min_z; }
+  int get_max_z() const { return _max_z; }
+
+  //! Index of row <code>[z][y]</code> in the table of row pointers
+  /*! Only valid if has_row_pointers() is \c true. The indices need to be in the range of the image. */
+  std::size_t get_row_index(const int z, const int y) const
+  {
+    assert(has_row_pointers());
+    assert(z >= _min_z && z <= _max_z);
+    assert(y >= _min_y && y <= _max_y);
+    return static_cast<std::size_t>((z - _min_z) * (_max_y - _min_y + 1) + (y - _min_y));
+  }
+
+  //! Pointer to a row, to be indexed with \c x (i.e. taking the minimum index into account)
+  const float* get_const_row_ptr(const std::size_t row_index) const
+  {
+    assert(row_index < _const_row_ptrs.size());
+    return _const_row_ptrs[row_index];
+  }
+
+  //! Pointer to a row for modification
+  /*! Only valid if constructed from a non-const image. Use get_modifiable_density() to check this. */
+  float* get_row_ptr(const std::size_t row_index) const
+  {
+    assert(row_index < _row_ptrs.size());
+    return _row_ptrs[row_index];
+  }
+
+private:
+  const DiscretisedDensity<3, float>* _const_density_ptr = nullptr;
+  DiscretisedDensity<3, float>* _density_ptr = nullptr;
+  std::vector<const float*> _const_row_ptrs;
+  std::vector<float*> _row_ptrs;
+  int _min_z = 0, _max_z = -1, _min_y = 0, _max_y = -1, _min_x = 0, _max_x = -1;
+
+  void set_up(const DiscretisedDensity<3, float>& density, DiscretisedDensity<3, float>* const density_ptr)
+  {
+    _const_density_ptr = &density;
+    _density_ptr = density_ptr;
+    _min_z = density.get_min_index();
+    _max_z = density.get_max_index();
+    BasicCoordinate<3, int> min_indices, max_indices;
+    if (density.size_all() == 0 || !density.get_regular_range(min_indices, max_indices))
+      return;
+
+    _min_y = min_indices[2];
+    _max_y = max_indices[2];
+    _min_x = min_indices[3];
+    _max_x = max_indices[3];
+    const std::size_t num_rows = static_cast<std::size_t>((_max_z - _min_z + 1) * (_max_y - _min_y + 1));
+    _const_row_ptrs.reserve(num_rows);
+    if (density_ptr)
+      _row_ptrs.reserve(num_rows);
+    // note: the pointers are shifted such that they can be indexed with x, as in VectorWithOffset
+    for (int z = _min_z; z <= _max_z; ++z)
+      for (int y = _min_y; y <= _max_y; ++y)
+        {
+          _const_row_ptrs.push_back(&density[z][y][_min_x] - _min_x);
+          if (density_ptr)
+            _row_ptrs.push_back(&(*density_ptr)[z][y][_min_x] - _min_x);
+        }
+  }
+};
+
+END_NAMESPACE_STIR
+
+#endif
@@ -33,6 +33,7 @@
 #include "stir/shared_ptr.h"
 #include "stir/Bin.h"
 #include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include <vector>
 
 START_NAMESPACE_STIR
 
@@ -119,6 +120,22 @@ public:
                        const int min_tangential_pos_num,
                        const int max_tangential_pos_num);
 
+  //! project several volumes into corresponding projection data
+  /*! This is equivalent to calling
+      forward_project(ProjData&, const DiscretisedDensity<3, float>&, int, int, bool) for every pair
+      <code>(*proj_data_ptrs[n], *density_ptrs[n])</code>. However, derived classes that support it (see
+      can_project_multiple_images_simultaneously()) will handle all images for every set of related viewgrams,
+      e.g. computing every row of the projection matrix only once.
+
+      All projection data need to have the same ProjDataInfo. After this call, the last image will be set as input
+      (as if set_input() was called).
+  */
+  void forward_project(const std::vector<ProjData*>& proj_data_ptrs,
+                       const std::vector<const DiscretisedDensity<3, float>*>& density_ptrs,
+                       int subset_num = 0,
+                       int num_subsets = 1,
+                       bool zero = true);
+
 #if 0 // disabled as currently not used. needs to be written in the new style anyway
     //! function mainly used in ListMode reconstruction.
     /*! Calls actual_forward_project */
@@ -148,6 +165,25 @@ protected:
                                       const int min_tangential_pos_num,
                                       const int max_tangential_pos_num);
 
+  //! Returns if the derived class implements the forward projection of multiple images
+  /*! If this returns \c true, the derived class has to implement the version of actual_forward_project() that
+      takes a vector of RelatedViewgrams. Default implementation returns \c false.
+  */
+  virtual bool can_project_multiple_images_simultaneously() const;
+
+  //! forward project several images into corresponding related viewgrams
+  /*! All related viewgrams correspond to the same view/segment/TOF numbers. The images have already been
+      pre-processed (if a pre-data processor is set).
+
+      Default implementation calls error().
+  */
+  virtual void actual_forward_project(const std::vector<RelatedViewgrams<float>*>& viewgrams_ptrs,
+                                      const std::vector<const DiscretisedDensity<3, float>*>& density_ptrs,
+                                      const int min_axial_pos_num,
+                                      const int max_axial_pos_num,
+                                      const int min_tangential_pos_num,
+                                      const int max_tangential_pos_num);
+
 #if 0 // disabled as currently not used. needs to be written in the new style anyway
     //! This virtual function has to be implemented by the derived class.
     virtual void actual_forward_project(Bin&,
@@ -74,6 +74,17 @@ private:
                               const int min_tangential_pos_num,
                               const int max_tangential_pos_num) override;
 
+  //! Returns \c true, as every row of the matrix can be used for multiple images
+  bool can_project_multiple_images_simultaneously() const override;
+
+  //! forward project several images, computing (and transforming) every row of the matrix only once
+  void actual_forward_project(const std::vector<RelatedViewgrams<float>*>& viewgrams_ptrs,
+                              const std::vector<const DiscretisedDensity<3, float>*>& image_ptrs,
+                              const int min_axial_pos_num,
+                              const int max_axial_pos_num,
+                              const int min_tangential_pos_num,
+                              const int max_tangential_pos_num) override;
+
 #if 0 // disabled as currently not used. needs to be written in the new style anyway
   void actual_forward_project(Bin&, const DiscretisedDensity<3,float>&);
 #endif
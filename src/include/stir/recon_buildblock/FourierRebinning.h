@@ -59,6 +59,7 @@ public:
 #ifdef PARALLEL
   friend PMessage& operator<<(PMessage&, PETCount_rebinned&);
   friend PMessage& operator>>(PMessage&, PETCount_rebinned&);
+#endif
 
   PETCount_rebinned& operator+=(const PETCount_rebinned& rebin)
   {
@@ -67,7 +68,6 @@ public:
     ssrb += rebin.ssrb;
     return *this;
   }
-#endif
   // Default constructor by initialising all the elements conter to null
   explicit PETCount_rebinned(int total_v = 0, int miss_v = 0, int ssrb_v = 0)
       : total(total_v),
@@ -182,9 +182,9 @@ private:
                  const float ratio_ring_spacing_to_ring_radius);
 
   /*!
-    \brief This method takes as input the real 3D data set
-    (in which the number of views have been extended to a number of power of 2)
-    and  returns the rebinned sinograms in Fourier space, their weighting factors
+    \brief This method takes as input one real sinogram
+    (merged with the one of the opposite segment, and in which the number of views has been extended to a number of power of 2)
+    and updates the rebinned sinograms in Fourier space, their weighting factors
     as well as the counter rebinned elements
 
     \b Rebinning <BR>
@@ -196,11 +196,11 @@ private:
   void do_rebinning(Array<3, std::complex<float>>& FT_rebinned_data,
                     Array<3, float>& Weights_for_FT_rebinned_data,
                     PETCount_rebinned& count_rebinned,
-                    const SegmentBySinogram<float>& segment,
+                    const Array<2, float>& sinogram,
+                    const int seg_num,
+                    const int axial_pos_num,
                     const int num_tang_poss_pow2,
                     const int num_views_pow2,
-                    const int num_planes,
-                    const float average_ring_difference_in_segment,
                     const float half_distance_between_rings,
                     const float sampling_distance_in_s,
                     const float radial_sampling_freq_w,
@@ -219,8 +219,14 @@ private:
   //! This is a function to display the current counter of all rebinned elements
   void do_display_count(PETCount_rebinned& num_rebinned_total);
 
-  //! This is a function to adjust the number of views of a segment to the next power of 2
-  void do_adjust_nb_views_to_pow2(SegmentBySinogram<float>& segment);
+  //! Read the sinograms for \a seg_num and \a -seg_num and merge them to a sinogram covering 360 degrees
+  /*! The number of views is then adjusted to \a num_views_pow2 by interpolation.
+      This function can be called from multiple threads (reading the data is serialised).
+  */
+  Array<2, float> get_merged_sinogram(const int seg_num, const int axial_pos_num, const int num_views_pow2) const;
+
+  //! Axial position of the middle of the LORs of a sinogram, relative to the first sinogram of segment 0
+  float get_z_in_mm(const int seg_num, const int axial_pos_num) const;
 
   //! This function checks if the steering and input paramters for FORE are inside the possible range of parameters
   Succeeded fore_check_parameters(int num_tang_poss_pow2, int num_views_pow2, int max_segment_num_to_process);
@@ -23,6 +23,9 @@ class ProjData;
  \brief Find normalisation factors using a maximum likelihood approach
 
   \ingroup recon_buildblock
+
+  If \a do_simultaneous_efficiencies_update is \c true, the efficiencies of all detectors are updated
+  simultaneously in every sub-iteration (see iterate_efficiencies()), which can be run in parallel over all rings.
 */
 void ML_estimate_component_based_normalisation(const std::string& out_filename_prefix,
                                                const ProjData& measured_data,
@@ -33,6 +36,7 @@ void ML_estimate_component_based_normalisation(const std::string& out_filename_p
                                                bool do_block,
                                                bool do_symmetry_per_block,
                                                bool do_KL,
-                                               bool do_display);
+                                               bool do_display,
+                                               bool do_simultaneous_efficiencies_update = false);
 
 END_NAMESPACE_STIR
@@ -41,8 +41,26 @@ START_NAMESPACE_STIR
   \brief a base class for LogLikelihood of independent Poisson variables
   where the mean values are linear combinations of the kinetic parameters.
 
-  \par Parameters for parsing
+  \par Sharing projections between frames
+
+  As the dynamic image is a linear combination of the parametric images, its forward projection
+  can be computed from the forward projections of the parametric images. Similarly, the gradient
+  w.r.t. the parametric images only needs a back projection per kinetic parameter.
+  The gradient (plus sensitivity) is therefore computed by forward projecting every parametric image
+  once (instead of every frame), and processing the data of all frames for one set of related viewgrams
+  before moving to the next (in parallel when using OpenMP). This needs memory for
+  2 projection data (of the size of one frame). Other computations (and the gradient without sensitivity)
+  are done frame by frame. As for PoissonLogLikelihoodWithLinearModelForMeanAndProjData, the normalisation
+  does not occur in the gradient plus sensitivity (only in the sensitivity), such that it can be shared between frames as well.
+
+  This is currently off by default, as it has not been validated as extensively as the frame-by-frame
+  computation.
 
+  \par Parameters for parsing
+  \verbatim
+  ; default is 0 (compute the gradient frame by frame). Set to 1 to share projections between frames
+  share projections between frames := 0
+  \endverbatim
 */
 
 template <typename TargetT>
@@ -108,6 +126,7 @@ public:
   const shared_ptr<ProjectorByBinPair>& get_projector_pair_sptr() const;
   const BinNormalisation& get_normalisation() const;
   const shared_ptr<BinNormalisation>& get_normalisation_sptr() const;
+  bool get_share_projections_between_frames() const;
   //@}
 
   /*! \name Functions to set parameters
@@ -126,6 +145,8 @@ public:
 
   void set_input_data(const shared_ptr<ExamData>&) override;
   const DynamicProjData& get_input_data() const override;
+  //! see class documentation
+  void set_share_projections_between_frames(const bool);
   //@}
 protected:
   //! Filename with input projection data
@@ -158,6 +179,8 @@ protected:
   shared_ptr<PatlakPlot> _patlak_plot_sptr;
   //! dynamic image template
   DynamicDiscretisedDensity _dyn_image_template;
+  //! see class documentation
+  bool _share_projections_between_frames;
 
   bool actual_subsets_are_approximately_balanced(std::string& warning_message) const override;
 
@@ -166,6 +189,12 @@ protected:
                                                       const int subset_num,
                                                       const bool add_sensitivity) override;
 
+  //! computes the subset gradient plus sensitivity, using the forward projections of the parametric images
+  /*! \see class documentation */
+  void compute_subset_gradient_plus_sensitivity_with_shared_projections(TargetT& gradient,
+                                                                        const TargetT& current_estimate,
+                                                                        const int subset_num);
+
   //! Sets defaults for parsing
   /*! Resets \c sensitivity_filename and \c sensitivity_sptr and
      \c recompute_sensitivity to \c false.
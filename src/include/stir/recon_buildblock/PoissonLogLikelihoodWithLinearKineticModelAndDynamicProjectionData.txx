@@ -4,7 +4,7 @@
 /*
   Copyright (C) 2006 - 2011-01-14 Hammersmith Imanet Ltd
   Copyright (C) 2011 Kris Thielemans
-  Copyright (C) 2013m 2018, University College London
+  Copyright (C) 2013m 2018, 2026 University College London
 
   This file is part of STIR.
 
@@ -42,6 +42,16 @@
 #endif
 #include "stir/recon_buildblock/ProjectorByBinPairUsingSeparateProjectors.h"
 #include "stir/recon_buildblock/BinNormalisationWithCalibration.h"
+#include "stir/recon_buildblock/ForwardProjectorByBin.h"
+#include "stir/recon_buildblock/BackProjectorByBin.h"
+#include "stir/recon_buildblock/find_basic_vs_nums_in_subsets.h"
+#include "stir/recon_array_functions.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/RelatedViewgrams.h"
+#include "stir/ViewSegmentNumbers.h"
+#include <boost/format.hpp>
+#include <utility>
+#include <vector>
 
 #include <algorithm>
 #include <string>
@@ -90,6 +100,7 @@ PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<TargetT>::set
 
   // Modelling Stuff
   this->_patlak_plot_sptr.reset();
+  this->_share_projections_between_frames = false;
 }
 
 template <typename TargetT>
@@ -116,6 +127,7 @@ PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<TargetT>::ini
 
   // Modelling Information
   this->parser.add_parsing_key("Kinetic Model Type", &this->_patlak_plot_sptr); // Do sth with dynamic_cast to get the PatlakPlot
+  this->parser.add_key("share projections between frames", &this->_share_projections_between_frames);
 
   // Regularization Information
   //  this->parser.add_parsing_key("prior type", &this->_prior_sptr);
@@ -291,9 +303,23 @@ PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<TargetT>::get
   return this->_normalisation_sptr;
 }
 
+template <typename TargetT>
+bool
+PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<TargetT>::get_share_projections_between_frames() const
+{
+  return this->_share_projections_between_frames;
+}
+
 /***************************************************************
   set_ functions
 ***************************************************************/
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<TargetT>::set_share_projections_between_frames(const bool arg)
+{
+  this->_share_projections_between_frames = arg;
+}
+
 template <typename TargetT>
 int
 PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<TargetT>::set_num_subsets(const int num_subsets)
@@ -429,8 +455,8 @@ void
 PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<TargetT>::set_normalisation_sptr(
     const shared_ptr<BinNormalisation>& arg)
 {
-  //  this->normalisation_sptr = arg;
-  error("Not implemeted yet");
+  this->already_set_up = false;
+  this->_normalisation_sptr = arg;
 }
 
 /*************************************************************************
@@ -445,6 +471,14 @@ PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<TargetT>::act
   if (subset_num < 0 || subset_num >= this->get_num_subsets())
     error("compute_sub_gradient_without_penalty subset_num out-of-range error");
 
+#ifndef STIR_MPI
+  if (add_sensitivity && this->_share_projections_between_frames)
+    {
+      this->compute_subset_gradient_plus_sensitivity_with_shared_projections(gradient, current_estimate, subset_num);
+      return;
+    }
+#endif
+
   DynamicDiscretisedDensity dyn_gradient = this->_dyn_image_template;
   DynamicDiscretisedDensity dyn_image_estimate = this->_dyn_image_template;
 
@@ -469,6 +503,155 @@ PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<TargetT>::act
   this->_patlak_plot_sptr->multiply_dynamic_image_with_model_gradient(gradient, dyn_gradient);
 }
 
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<
+    TargetT>::compute_subset_gradient_plus_sensitivity_with_shared_projections(TargetT& gradient,
+                                                                               const TargetT& current_estimate,
+                                                                               const int subset_num)
+{
+  // Note: as in RPC_process_related_viewgrams_gradient, the normalisation does not occur here.
+  // The mean of the data is modelled as norm*(forward projection + additive term), and therefore
+  // backproj[norm * y/ybar] = backproj[y/(forward projection + additive term)].
+  // The (frame-dependent) normalisation is only used for the sensitivity.
+  const unsigned int starting_frame = this->_patlak_plot_sptr->get_starting_frame();
+  const unsigned int ending_frame = this->_patlak_plot_sptr->get_ending_frame();
+  const Array<2, float> model_array
+      = this->_patlak_plot_sptr->get_model_matrix_for_dynamic_image(this->_dyn_image_template).get_model_array();
+  const int min_param_num = model_array.get_min_index();
+  const int max_param_num = model_array.get_max_index();
+
+  shared_ptr<ProjDataInfo> proj_data_info_sptr(
+      this->_dyn_proj_data_sptr->get_proj_data_sptr(starting_frame)->get_proj_data_info_sptr()->create_shared_clone());
+  proj_data_info_sptr->reduce_segment_range(-this->_max_segment_num_to_process, this->_max_segment_num_to_process);
+  const shared_ptr<const ExamInfo> exam_info_sptr = this->_dyn_proj_data_sptr->get_proj_data_sptr(starting_frame)->get_exam_info_sptr();
+
+  // forward project all parametric images (in one go, such that projectors can reuse their computations)
+  // These projection data will be overwritten with the data to back project below.
+  VectorWithOffset<shared_ptr<ProjDataInMemory>> param_proj_data_sptrs(min_param_num, max_param_num);
+  std::vector<typename TargetT::SingleDiscretisedDensityType> param_images;
+  for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+    {
+      param_proj_data_sptrs[param_num] = std::make_shared<ProjDataInMemory>(exam_info_sptr, proj_data_info_sptr);
+      param_images.push_back(current_estimate.construct_single_density(param_num));
+    }
+  {
+    std::vector<ProjData*> proj_data_ptrs;
+    std::vector<const DiscretisedDensity<3, float>*> image_ptrs;
+    for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+      {
+        proj_data_ptrs.push_back(param_proj_data_sptrs[param_num].get());
+        image_ptrs.push_back(&param_images[param_num - min_param_num]);
+      }
+    this->_projector_pair_ptr->get_forward_projector_sptr()->forward_project(
+        proj_data_ptrs, image_ptrs, subset_num, this->num_subsets);
+  }
+
+  // loop over all related viewgrams (and TOF bins), and handle all frames for each
+  const shared_ptr<DataSymmetriesForViewSegmentNumbers> symmetries_sptr(
+      this->_projector_pair_ptr->get_back_projector_sptr()->get_symmetries_used()->clone());
+  std::vector<std::pair<ViewSegmentNumbers, int>> tasks;
+  for (const auto& vs : detail::find_basic_vs_nums_in_subset(*proj_data_info_sptr,
+                                                            *symmetries_sptr,
+                                                            -this->_max_segment_num_to_process,
+                                                            this->_max_segment_num_to_process,
+                                                            subset_num,
+                                                            this->num_subsets))
+    for (int timing_pos_num = proj_data_info_sptr->get_min_tof_pos_num(); timing_pos_num <= proj_data_info_sptr->get_max_tof_pos_num();
+         ++timing_pos_num)
+      tasks.push_back(std::make_pair(vs, timing_pos_num));
+
+  int count = 0, count2 = 0;
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic) reduction(+ : count, count2)
+#endif
+  for (int i = 0; i < static_cast<int>(tasks.size()); ++i)
+    {
+      const ViewSegmentNumbers& vs = tasks[i].first;
+      const int timing_pos_num = tasks[i].second;
+
+      VectorWithOffset<RelatedViewgrams<float>> param_viewgrams(min_param_num, max_param_num);
+      VectorWithOffset<RelatedViewgrams<float>> back_projection_viewgrams(min_param_num, max_param_num);
+      for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+        {
+          param_viewgrams[param_num]
+              = param_proj_data_sptrs[param_num]->get_related_viewgrams(vs, symmetries_sptr, false, timing_pos_num);
+          back_projection_viewgrams[param_num] = param_viewgrams[param_num].get_empty_copy();
+        }
+
+      for (unsigned int frame_num = starting_frame; frame_num <= ending_frame; ++frame_num)
+        {
+          RelatedViewgrams<float> measured_viewgrams;
+          RelatedViewgrams<float> estimated_viewgrams = param_viewgrams[min_param_num].get_empty_copy();
+#ifdef STIR_OPENMP
+          // reading from streams is not safe in multi-threaded code
+#  pragma omp critical(KINETIC_VIEWGRAMS)
+#endif
+          {
+            measured_viewgrams = this->_dyn_proj_data_sptr->get_proj_data_sptr(frame_num)->get_related_viewgrams(
+                vs, symmetries_sptr, false, timing_pos_num);
+            if (!is_null_ptr(this->_additive_dyn_proj_data_sptr))
+              estimated_viewgrams = this->_additive_dyn_proj_data_sptr->get_proj_data_sptr(frame_num)->get_related_viewgrams(
+                  vs, symmetries_sptr, false, timing_pos_num);
+          }
+          if (vs.segment_num() == 0 && this->_zero_seg0_end_planes)
+            {
+              const int min_axial_pos_num = measured_viewgrams.get_min_axial_pos_num();
+              const int max_axial_pos_num = measured_viewgrams.get_max_axial_pos_num();
+              for (auto& viewgram : measured_viewgrams)
+                {
+                  viewgram[min_axial_pos_num].fill(0);
+                  viewgram[max_axial_pos_num].fill(0);
+                }
+              for (auto& viewgram : estimated_viewgrams)
+                {
+                  viewgram[min_axial_pos_num].fill(0);
+                  viewgram[max_axial_pos_num].fill(0);
+                }
+            }
+          // forward projection of the dynamic image for this frame (plus additive term)
+          for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+            {
+              RelatedViewgrams<float> tmp = param_viewgrams[param_num];
+              tmp *= model_array[param_num][frame_num];
+              estimated_viewgrams += tmp;
+            }
+
+          divide_and_truncate(measured_viewgrams, estimated_viewgrams, /* rim_truncation_sino */ 0, count, count2, nullptr);
+
+          // multiply with the model gradient
+          for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+            {
+              RelatedViewgrams<float> tmp = measured_viewgrams;
+              tmp *= model_array[param_num][frame_num];
+              back_projection_viewgrams[param_num] += tmp;
+            }
+        }
+
+      // store the result in the projection data (these viewgrams of the forward projection are no longer needed)
+      for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+        if (param_proj_data_sptrs[param_num]->set_related_viewgrams(back_projection_viewgrams[param_num]) != Succeeded::yes)
+          error("PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData: error storing viewgrams");
+    }
+  info(boost::format("Number of (cancelled) singularities: %1%\nNumber of (cancelled) negative numerators: %2%") % count % count2,
+       2);
+
+  // back project (re-using the images of the parametric estimate)
+  {
+    std::vector<DiscretisedDensity<3, float>*> image_ptrs;
+    std::vector<const ProjData*> proj_data_ptrs;
+    for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+      {
+        image_ptrs.push_back(&param_images[param_num - min_param_num]);
+        proj_data_ptrs.push_back(param_proj_data_sptrs[param_num].get());
+      }
+    this->_projector_pair_ptr->get_back_projector_sptr()->back_project(
+        image_ptrs, proj_data_ptrs, subset_num, this->num_subsets);
+  }
+  for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+    gradient.update_parametric_image(param_images[param_num - min_param_num], param_num);
+}
+
 template <typename TargetT>
 double
 PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<TargetT>::actual_compute_objective_function_without_penalty(
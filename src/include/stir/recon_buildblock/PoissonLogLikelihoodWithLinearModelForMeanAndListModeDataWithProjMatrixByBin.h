@@ -108,6 +108,14 @@ public:
 
   void set_skip_balanced_subsets(const bool arg);
 
+  //! Freeze the cache of the projection matrix once the gradient has been computed for every subset
+  /*! \see ProjMatrixByBin::freeze_cache() */
+  void set_freeze_proj_matrix_cache_after_first_pass(const bool arg);
+
+  //! Sort every batch of events by bin, and merge events in the same bin
+  /*! \see sort_and_merge_events */
+  void set_sort_and_merge_events(const bool arg);
+
 #if STIR_VERSION < 060000
   STIR_DEPRECATED
   void set_max_ring_difference(const int arg);
@@ -151,7 +159,27 @@ protected:
   //! Scanner geometry, you can skip future checks.
   bool skip_balanced_subsets;
 
+  //! If \c true, the ProjMatrixByBin cache becomes read-only after the gradient has been computed for every subset
+  /*! At that point, all rows needed for the current list-mode data are in the cache, such that further
+      lookups can be done without locking.
+  */
+  bool freeze_proj_matrix_cache_after_first_pass;
+
+  //! If \c true, every batch of events is sorted by bin, and events in the same bin are merged
+  /*! The merged record has a bin value equal to the number of events. The gradient computation then
+      needs only one row of the projection matrix per bin (instead of per event), and accesses
+      rows (and therefore the image) in a more regular order. This is particularly useful for
+      high-count acquisitions. Results are identical up to numerical rounding.
+  */
+  bool sort_and_merge_events;
+
 private:
+  //! Keeps track of which subsets have been processed since set_up()
+  std::vector<bool> subset_processed_for_proj_matrix_cache;
+  //! Reports the statistics of the projection matrix cache once all subsets have been processed since set_up()
+  /*! The cache is frozen at that point if \c freeze_proj_matrix_cache_after_first_pass is \c true. */
+  void update_proj_matrix_cache_state(const int subset_num);
+
   //! Cache of the current "batch" in the listmode file
   /*! \todo Move this higher-up in the hierarchy as it doesn't depend on ProjMatrixByBin
    */
@@ -167,6 +195,9 @@ private:
    */
   bool load_listmode_batch(unsigned int ibatch) const;
 
+  //! Sorts \c record_cache by bin and merges records with the same bin (used if \c sort_and_merge_events is \c true)
+  void sort_and_merge_record_cache() const;
+
   //! This function reads the next "batch" of data from the listmode file.
   /*!
     This function keeps on reading from the current position in the list-mode data and stores
@@ -114,6 +114,9 @@ class DistributedCachingInformation;
   ; see BinNormalisation hierarchy for possible values
   Bin Normalisation type :=
 
+  ; only used with OpenMP, see set_num_viewgrams_to_read_ahead()
+  number of viewgrams to read ahead := -1
+
   End PoissonLogLikelihoodWithLinearModelForMeanAndProjData Parameters :=
   \endverbatim
 */
@@ -184,6 +187,7 @@ public:
   const TimeFrameDefinitions& get_time_frame_definitions() const;
   const BinNormalisation& get_normalisation() const;
   const shared_ptr<BinNormalisation>& get_normalisation_sptr() const;
+  int get_num_viewgrams_to_read_ahead() const;
   //@}
   /*! \name Functions to set parameters
     This can be used as alternative to the parsing mechanism.
@@ -204,6 +208,14 @@ public:
   void set_frame_num(const int);
   void set_frame_definitions(const TimeFrameDefinitions&);
   void set_normalisation_sptr(const shared_ptr<BinNormalisation>&) override;
+  //! Set the number of RelatedViewgrams that are read ahead by one thread while the others compute
+  /*! Only used when compiled with OpenMP and using more than 1 thread.
+      0 disables reading ahead, a negative value (the default) uses twice the maximum number of threads.
+      \see distributable_computation()
+
+      This does not require calling set_up() again.
+  */
+  void set_num_viewgrams_to_read_ahead(const int);
 
   void set_input_data(const shared_ptr<ExamData>&) override;
   const ProjData& get_input_data() const override;
@@ -313,6 +325,9 @@ protected:
   //! Triggers calculation of sensitivity using time-of-flight
   bool use_tofsens;
 
+  //! number of RelatedViewgrams to read ahead (see set_num_viewgrams_to_read_ahead())
+  int num_viewgrams_to_read_ahead;
+
   //! name of file in which additive projection data are stored
   std::string additive_projection_data_filename;
 
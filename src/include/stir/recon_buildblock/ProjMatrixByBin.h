@@ -30,12 +30,14 @@
 #include "stir/ParsingObject.h"
 #include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
 #include "stir/recon_buildblock/DataSymmetriesForBins.h"
+#include "stir/recon_buildblock/CompactProjMatrixElemsStore.h"
 #include "stir/shared_ptr.h"
 #include "stir/VectorWithOffset.h"
 #include "stir/TimedObject.h"
 #include "stir/VoxelsOnCartesianGrid.h"
 #include "stir/numerics/FastErf.h"
 #include <cstdint>
+#include <vector>
 //#include <map>
 #include <unordered_map>
 #ifdef STIR_OPENMP
@@ -70,10 +72,27 @@ class Bin;
   \verbatim
   disable caching := false
   store only basic bins in cache := true
+  use compact cache := false
+  ; one of float, fp16, quantised
+  compact cache value encoding := float
   \endverbatim
   The 2nd option allows to cache the whole matrix. This results in the fastest
   behaviour IF your system does not start swapping. The default choice caches
   only the 'basic' bins, and computes symmetry related bins from the 'basic' ones.
+
+  When using the compact cache, rows are stored in a CompactProjMatrixElemsStore for every
+  (view,segment). This reduces memory usage by a factor 2-3 (depending on the value encoding),
+  at the expense of having to decode the row at every lookup. The \c fp16 and \c quantised value encodings
+  are lossy (with a relative precision of about 1e-3 and 1.5e-5 (w.r.t. the maximum in the row) respectively).
+
+  \par Multi-threading and cache freezing
+
+  When compiled with OpenMP, the cache for every (view,segment) is protected by a lock.
+  Once the cache is "warm" (i.e. all rows that will be needed have been computed once),
+  freeze_cache() can be called. The cache is then read-only and lookups no longer
+  need any locks. Rows that are not in a frozen cache are computed on-the-fly, but are not
+  added to the cache. Use get_cache_statistics() to find the hit-rate and the number of times
+  a thread had to wait for a lock.
 */
 class ProjMatrixByBin : public RegisteredObject<ProjMatrixByBin>, public TimedObject
 {
@@ -109,6 +128,13 @@ public:
   calculate_proj_matrix_elems_for_one_bin.*/
   inline void get_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin&, const Bin&) const;
 
+  //! An estimate of the maximum number of elements in a row of the matrix
+  /*! This can be used to reserve memory for a ProjMatrixElemsForOneBin object that is reused
+      for many bins, such that get_proj_matrix_elems_for_one_bin() does not need to reallocate.
+      Only valid after set_up(). The default implementation returns 0 (i.e. unknown).
+  */
+  virtual std::size_t get_max_num_elems_per_row_estimate() const;
+
 #if 0
   // TODO
   /*! \brief Facility to write the 'independent' part of the matrix to file.
@@ -132,13 +158,46 @@ public:
   void enable_cache(const bool v = true);
   void store_only_basic_bins_in_cache(const bool v = true);
 
+  //! Use a CompactProjMatrixElemsStore for the cache
+  /*! Has to be called before set_up() */
+  void enable_compact_cache(const bool v = true,
+                            const CompactProjMatrixElemsStore::ValueEncoding value_encoding
+                            = CompactProjMatrixElemsStore::ValueEncoding::float32);
+
   bool is_cache_enabled() const;
   bool does_cache_store_only_basic_bins() const;
+  bool is_cache_compact() const;
+  //! Number of bytes used by the compact cache (excluding its index), or 0 if the compact cache is not used
+  std::size_t get_compact_cache_num_bytes_used() const;
 
   // void reserve_num_elements_in_cache(const std::size_t);
   //! Remove all elements from the cache
+  /*! This also "unfreezes" the cache. */
   void clear_cache() const;
 
+  //! Make the cache read-only (or writable again when \a v is \c false)
+  /*! After freezing, the cache is no longer modified, such that lookups can be done without locking.
+      \warning This function must not be called while other threads are using this object.
+  */
+  void freeze_cache(const bool v = true) const;
+  bool is_cache_frozen() const;
+
+  //! Counters for the usage of the cache
+  struct CacheStatistics
+  {
+    std::uint64_t num_hits = 0;
+    std::uint64_t num_misses = 0;
+    //! number of times a thread had to wait for the lock of a (view,segment) cache
+    std::uint64_t num_lock_contentions = 0;
+
+    //! returns num_hits/(num_hits+num_misses), or 0 if there was no lookup
+    double get_hit_rate() const;
+  };
+  //! Get statistics accumulated over all threads since set_up() or reset_cache_statistics()
+  CacheStatistics get_cache_statistics() const;
+  //! Set all cache counters to zero
+  void reset_cache_statistics() const;
+
 protected:
   shared_ptr<DataSymmetriesForBins> symmetries_sptr;
 
@@ -173,6 +232,10 @@ protected:
 
   bool cache_disabled;
   bool cache_stores_only_basic_bins;
+  bool cache_is_compact;
+  CompactProjMatrixElemsStore::ValueEncoding compact_cache_value_encoding;
+  //! if \c true, the cache is read-only and will not be locked
+  mutable bool cache_frozen;
   //! If activated TOF reconstruction will be performed.
   bool tof_enabled;
 
@@ -210,10 +273,27 @@ private:
 
   //! collection of  ProjMatrixElemsForOneBin (internal cache )
   mutable VectorWithOffset<VectorWithOffset<MapProjMatrixElemsForOneBin>> cache_collection;
+  //! alternative collection used when cache_is_compact is \c true
+  mutable VectorWithOffset<VectorWithOffset<CompactProjMatrixElemsStore>> compact_cache_collection;
+  //! used for parsing
+  std::string compact_cache_value_encoding_as_string;
 #ifdef STIR_OPENMP
   mutable VectorWithOffset<VectorWithOffset<omp_lock_t>> cache_locks;
 #endif
 
+  //! CacheStatistics padded to a cache-line to avoid false sharing between threads
+  struct alignas(64) CacheStatisticsForOneThread
+  {
+    CacheStatistics stats;
+  };
+  //! counters, one per thread
+  mutable std::vector<CacheStatisticsForOneThread> cache_statistics_per_thread;
+  //! returns counters for the current thread, or 0 if there are more threads than at set_up()
+  CacheStatistics* get_cache_statistics_ptr_for_this_thread() const;
+
+  //! find \a bin in the cache and copy the row into \a probabilities. Does not lock.
+  bool find_in_cache(ProjMatrixElemsForOneBin& probabilities, const Bin& bin) const;
+
   //! create the key for caching
   // KT 15/05/2002 not static anymore as it uses cache_stores_only_basic_bins
   CacheKey cache_key(const Bin& bin) const;
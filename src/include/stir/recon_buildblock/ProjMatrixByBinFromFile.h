@@ -30,6 +30,7 @@
 
 START_NAMESPACE_STIR
 
+class MemoryMappedFile;
 template <int num_dimensions, typename elemT>
 class DiscretisedDensity;
 class Bin;
@@ -41,6 +42,21 @@ class Bin;
   and a binary file which stores the 'basic' elements in a sparse form,
   i.e. only the elements that cannot by constructed via symmetries.
 
+  \par File format versions
+  - Version 1.0: the whole binary file is read into the cache during set_up().
+  - Version 2.0: the binary file is the same as for version 1.0, but there is an additional
+    index file which stores the location of every row in the binary file (sorted by bin).
+    Both files are then memory-mapped (see MemoryMappedFile) and rows are decoded
+    on demand. This means that set_up() is nearly instantaneous, only those parts of the matrix
+    that are actually used will be read from disk, and that the operating system can share the
+    memory between all processes that use the same matrix (e.g. MPI processes on the same node).
+    As the decoding is fast, it is then recommended to disable caching.
+
+  The index file starts with the 8 characters \c STIRPMI1, followed by the number of entries
+  (as a 64-bit unsigned integer). Each entry consists of the segment, view, axial and tangential
+  position numbers (as 32-bit signed integers) and the offset of the row in the binary file
+  (as a 64-bit unsigned integer). All numbers use the native byte order.
+
   \todo this class currently only works with VoxelsOnCartesianGrid.
   To fix this, we would need a DiscretisedDensityInfo class, and be able
   to have constructed the appropriate symmetries object by parsing the
@@ -49,7 +65,9 @@ class Bin;
   \par Example .par file
   \verbatim
     ProjMatrixByBinFromFile Parameters:=
-      Version := 1.0
+      Version := 2.0
+      ; recommended for version 2.0
+      disable caching := 1
       symmetries type := PET_CartesianGrid
         PET_CartesianGrid symmetries parameters:=
           do_symmetry_90degrees_min_phi:= <bool>
@@ -64,6 +82,8 @@ class Bin;
       template density filename:= <filename>
       ; binary data with projection matrix elements
       data_filename:=<filename>
+      ; index into the binary data (only for version 2.0)
+      index_filename:=<filename>
      End ProjMatrixByBinFromFile Parameters:=
   \endverbatim
 */
@@ -75,8 +95,8 @@ public:
   static const char* const registered_name;
 
   //! Writes a projection matrix to file in a format such that this class can read it back
-  /*! Currently this will write an interfile-type header, a file with the binary data,
-      a template image and template sinogram. You will need all 4 to be able to read the
+  /*! Currently this will write an interfile-type header (using version 2.0), a file with the binary data,
+      an index file, a template image and template sinogram. You will need all 5 to be able to read the
       matrix back in.
   */
   static Succeeded write_to_file(const std::string& output_filename_prefix,
@@ -99,6 +119,7 @@ private:
   std::string template_density_filename;
   std::string template_proj_data_filename;
   std::string data_filename;
+  std::string index_filename;
 
   std::string symmetries_type;
   // should be in symmetries
@@ -116,6 +137,12 @@ private:
 
   shared_ptr<const ProjDataInfo> proj_data_info_ptr;
 
+  //! memory-mapped binary data (only used for version 2.0)
+  /*! Note that these are shared between clones */
+  shared_ptr<const MemoryMappedFile> data_mmap_sptr;
+  //! memory-mapped index (only used for version 2.0)
+  shared_ptr<const MemoryMappedFile> index_mmap_sptr;
+
   void calculate_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin&) const override;
 
   void set_defaults() override;
@@ -123,6 +150,8 @@ private:
   bool post_processing() override;
 
   Succeeded read_data();
+  //! map data and index files in memory (for version 2.0)
+  Succeeded map_data();
 };
 
 END_NAMESPACE_STIR
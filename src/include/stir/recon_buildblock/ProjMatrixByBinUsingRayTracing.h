@@ -25,6 +25,7 @@
 #include "stir/recon_buildblock/ProjMatrixByBin.h"
 #include "stir/CartesianCoordinate3D.h"
 #include "stir/shared_ptr.h"
+#include <vector>
 
 START_NAMESPACE_STIR
 
@@ -128,6 +129,9 @@ public:
 
   ProjMatrixByBinUsingRayTracing* clone() const override;
 
+  //! Estimate based on the number of voxels that a ray can intersect, the number of rays and the axial sampling
+  std::size_t get_max_num_elems_per_row_estimate() const override;
+
   //! \name If a cylindrical FOV or the whole image will be handled
   //!@{
   bool get_restrict_to_cylindrical_FOV() const;
@@ -187,6 +191,21 @@ private:
   CartesianCoordinate3D<int> min_index;
   CartesianCoordinate3D<int> max_index;
 
+  //! estimate of the maximum number of elements in a row, computed in set_up()
+  std::size_t max_num_elems_per_row_estimate;
+
+  //! rows used as temporary storage by calculate_proj_matrix_elems_for_one_bin()
+  /*! Padded to a cache-line to avoid false sharing between threads. */
+  struct alignas(64) WorkspaceForOneThread
+  {
+    ProjMatrixElemsForOneBin ray_traced_lor;
+    ProjMatrixElemsForOneBin lor_with_next_z;
+  };
+  //! workspaces, one per thread, allocated in set_up() such that no reallocations are necessary later on
+  mutable std::vector<WorkspaceForOneThread> workspace_per_thread;
+  //! returns the workspace for the current thread, or 0 if there is none (e.g. in nested parallel regions)
+  WorkspaceForOneThread* get_workspace_ptr_for_this_thread() const;
+
   void calculate_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin&) const override;
 
   void set_defaults() override;
@@ -29,6 +29,7 @@
 */
 
 #include "stir/recon_buildblock/ProjMatrixElemsForOneBinValue.h"
+#include "stir/recon_buildblock/DiscretisedDensityAccess.h"
 #include "stir/Bin.h"
 #include <vector>
 
@@ -188,6 +189,26 @@ public:
   //! forward project related bins (accumulates)
   void forward_project(RelatedBins&, const DiscretisedDensity<3, float>&) const;
 
+  //! forward project into a single bin (accumulates), using fast access to the image if possible
+  /*! If \a density_access.has_row_pointers(), the voxels are accessed via its table of row pointers,
+      which avoids most of the indirections of <code>density[z][y][x]</code>. Otherwise, this calls
+      forward_project(Bin&, const DiscretisedDensity<3, float>&).
+  */
+  void forward_project(Bin&, const DiscretisedDensityAccess& density_access) const;
+  //! back project a single bin (accumulates), using fast access to the image if possible
+  /*! \see forward_project(Bin&, const DiscretisedDensityAccess&) */
+  void back_project(const DiscretisedDensityAccess& density_access, const Bin&) const;
+
+  //! forward project several images into the same bin (accumulates)
+  /*! \a bin_values[n] is incremented with the forward projection of the image of \c density_accesses[n].
+      This is equivalent to calling forward_project(Bin&, const DiscretisedDensityAccess&) for every image,
+      but if all images have the same index range, the elements are traversed only once.
+  */
+  void forward_project(std::vector<float>& bin_values, const std::vector<DiscretisedDensityAccess>& density_accesses) const;
+  //! back project several values of the same bin into corresponding images (accumulates)
+  /*! \see forward_project(std::vector<float>&, const std::vector<DiscretisedDensityAccess>&) */
+  void back_project(const std::vector<DiscretisedDensityAccess>& density_accesses, const std::vector<float>& bin_values) const;
+
 private:
   std::vector<value_type> elements;
   Bin bin;
@@ -19,6 +19,9 @@
 
     See STIR/LICENSE.txt for details
 */
+#ifndef __stir_recon_buildblock_RayTraceVoxelsOnCartesianGrid_H__
+#define __stir_recon_buildblock_RayTraceVoxelsOnCartesianGrid_H__
+
 #include "stir/common.h"
 
 START_NAMESPACE_STIR
@@ -72,4 +75,32 @@ void RayTraceVoxelsOnCartesianGrid(ProjMatrixElemsForOneBin& lor,
                                    const CartesianCoordinate3D<float>& voxel_size,
                                    const float normalisation_constant = 1.F);
 
+/*! \ingroup recon_buildblock
+
+  \brief Finds the Length of Intersections (LOIs) of an LOR with a grid of voxels and calls a function for each of them
+
+  This is the implementation of RayTraceVoxelsOnCartesianGrid(), but instead of appending to a
+  ProjMatrixElemsForOneBin object, \a call_back is called as
+  \code
+  call_back(const CartesianCoordinate3D<int>& voxel_coords, const float LOI)
+  \endcode
+  for every voxel (in the order of the voxels along the ray). This can be used to compute
+  line integrals without storing the intersected voxels.
+
+  Arguments are as for RayTraceVoxelsOnCartesianGrid().
+
+  \return \c true if the LOR is in a plane between voxels. The function then traces 2 LORs (on each side of the plane,
+  with half the normalisation_constant), and voxels are therefore not in order.
+*/
+template <class CallBackT>
+inline bool ray_trace_voxels_on_cartesian_grid(CallBackT& call_back,
+                                               const CartesianCoordinate3D<float>& start_point,
+                                               const CartesianCoordinate3D<float>& end_point,
+                                               const CartesianCoordinate3D<float>& voxel_size,
+                                               const float normalisation_constant = 1.F);
+
 END_NAMESPACE_STIR
+
+#include "stir/recon_buildblock/RayTraceVoxelsOnCartesianGrid.inl"
+
+#endif
@@ -146,6 +146,12 @@ typedef void RPC_process_related_viewgrams_type(const shared_ptr<ForwardProjecto
   \param end_time_of_frame is passed to normalise_sptr
   \param RPC_process_related_viewgrams function that does the actual work.
   \param caching_info_ptr ignored unless STIR_MPI=1, in which case it enables caching of viewgrams at the slave side
+  \param num_viewgrams_to_prefetch number of RelatedViewgrams to read ahead. Only used when compiled with OpenMP
+         and using more than 1 thread. In that case, one thread reads the viewgrams (and computes the multiplicative
+         factors) for the next tasks into a queue of this size, while the other threads process them. This avoids
+         threads waiting for each other when reading the data is slow. The reading thread processes viewgrams itself
+         when the queue is full. 0 disables reading ahead, such that every thread reads its own viewgrams.
+         A negative value selects the default, i.e. twice the maximum number of threads.
   \warning There is NO check that the resulting subsets are balanced.
 
   \warning The function assumes that \a min_segment_num, \a max_segment_num are such that
@@ -180,7 +186,8 @@ void distributable_computation(const shared_ptr<ForwardProjectorByBin>& forward_
                                RPC_process_related_viewgrams_type* RPC_process_related_viewgrams,
                                DistributedCachingInformation* caching_info_ptr,
                                int min_timing_pos_num,
-                               int max_timing_pos_num);
+                               int max_timing_pos_num,
+                               const int num_viewgrams_to_prefetch = -1);
 
 /*!
   \brief This function essentially implements a loop over a cached listmode file
@@ -189,7 +196,9 @@ void distributable_computation(const shared_ptr<ForwardProjectorByBin>& forward_
   \param has_add if \c true, the additive term in \c record_cache is taken into account
   \param accumulate if \c true, add to  \c output_image_ptr, otherwise fill it with zeroes before doing anything.
   \param double_out_ptr accumulated value (for every event) computed by the call-back, unless the pointer is zero
-  \param call_back
+  \param call_back called for every event (in the subset) as
+     <code>call_back(output_image_access, row, add_term, measured_bin, input_image_access, double_ptr)</code>,
+     where the images are passed as DiscretisedDensityAccess objects (the output image is thread-local when using OpenMP)
 !*/
 template <typename CallBackT>
 void LM_distributable_computation(const shared_ptr<ProjMatrixByBin> PM_sptr,
@@ -28,6 +28,7 @@
 
 #include "stir/recon_buildblock/ProjMatrixByBin.h"
 #include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include "stir/recon_buildblock/DiscretisedDensityAccess.h"
 #include "stir/Bin.h"
 
 #include "stir/num_threads.h"
@@ -60,12 +61,15 @@ LM_distributable_computation(const shared_ptr<ProjMatrixByBin> PM_sptr,
     output_image_ptr->fill(0.F);
 
   std::vector<shared_ptr<DiscretisedDensity<3, float>>> local_output_image_sptrs;
+  // fast access to the images, see DiscretisedDensityAccess (constructed only once as this is not cheap)
+  std::vector<DiscretisedDensityAccess> local_output_image_accesses;
+  const DiscretisedDensityAccess input_image_access(*input_image_ptr);
   std::vector<double> local_double_outs;
   std::vector<double*> local_double_out_ptrs;
   std::vector<int> local_counts, local_count2s;
   std::vector<ProjMatrixElemsForOneBin> local_row;
 #ifdef STIR_OPENMP
-#  pragma omp parallel shared(local_output_image_sptrs, local_row, local_double_outs, local_counts, local_count2s)
+#  pragma omp parallel shared(local_output_image_sptrs, local_output_image_accesses, local_row, local_double_outs, local_counts, local_count2s)
 #endif
   // start of threaded section if openmp
   {
@@ -74,6 +78,7 @@ LM_distributable_computation(const shared_ptr<ProjMatrixByBin> PM_sptr,
     {
       info("Listmode gradient calculation: starting loop with " + std::to_string(omp_get_num_threads()) + " threads", 2);
       local_output_image_sptrs.resize(omp_get_max_threads(), shared_ptr<DiscretisedDensity<3, float>>());
+      local_output_image_accesses.resize(omp_get_max_threads());
       local_double_out_ptrs.resize(omp_get_max_threads(), 0);
       if (double_out_ptr)
         {
@@ -84,6 +89,9 @@ LM_distributable_computation(const shared_ptr<ProjMatrixByBin> PM_sptr,
       local_counts.resize(omp_get_max_threads(), 0);
       local_count2s.resize(omp_get_max_threads(), 0);
       local_row.resize(omp_get_max_threads(), ProjMatrixElemsForOneBin());
+      // reserve enough memory for the rows such that they do not need to be reallocated
+      for (auto& row : local_row)
+        row.reserve(PM_sptr->get_max_num_elems_per_row_estimate());
     }
 
 #  pragma omp for schedule(dynamic)
@@ -91,10 +99,14 @@ LM_distributable_computation(const shared_ptr<ProjMatrixByBin> PM_sptr,
     {
       info("Listmode gradient calculation: starting loop with 1 thread", 2);
       local_output_image_sptrs.resize(1, shared_ptr<DiscretisedDensity<3, float>>());
+      local_output_image_accesses.resize(1);
       local_double_out_ptrs.resize(1, double_out_ptr);
       local_counts.resize(1, 0);
       local_count2s.resize(1, 0);
       local_row.resize(1, ProjMatrixElemsForOneBin());
+      // reserve enough memory for the rows such that they do not need to be reallocated
+      for (auto& row : local_row)
+        row.reserve(PM_sptr->get_max_num_elems_per_row_estimate());
     }
 #endif
     // note: VC uses OpenMP 2.0, so need signed integer for loop
@@ -113,7 +125,10 @@ LM_distributable_computation(const shared_ptr<ProjMatrixByBin> PM_sptr,
         if (output_image_ptr != NULL)
           {
             if (is_null_ptr(local_output_image_sptrs[thread_num]))
-              local_output_image_sptrs[thread_num].reset(output_image_ptr->get_empty_copy());
+              {
+                local_output_image_sptrs[thread_num].reset(output_image_ptr->get_empty_copy());
+                local_output_image_accesses[thread_num] = DiscretisedDensityAccess(*local_output_image_sptrs[thread_num]);
+              }
           }
 
         const Bin& measured_bin = record.my_bin;
@@ -131,17 +146,17 @@ LM_distributable_computation(const shared_ptr<ProjMatrixByBin> PM_sptr,
           }
 
         PM_sptr->get_proj_matrix_elems_for_one_bin(local_row[thread_num], measured_bin);
-        call_back(*local_output_image_sptrs[thread_num],
+        call_back(local_output_image_accesses[thread_num],
                   local_row[thread_num],
                   has_add ? record.my_corr : 0.F,
                   measured_bin,
-                  *input_image_ptr,
+                  input_image_access,
                   local_double_out_ptrs[thread_num]);
       }
   }
-#ifdef STIR_OPENMP
   // flatten data constructed by threads
   {
+#ifdef STIR_OPENMP
     if (double_out_ptr != NULL)
       {
         for (int i = 0; i < static_cast<int>(local_double_outs.size()); ++i)
@@ -149,6 +164,8 @@ LM_distributable_computation(const shared_ptr<ProjMatrixByBin> PM_sptr,
       }
     // count += std::accumulate(local_counts.begin(), local_counts.end(), 0);
     // count2 += std::accumulate(local_count2s.begin(), local_count2s.end(), 0);
+#endif
+    // note: without OpenMP, the output is also computed in a separate image, so it needs to be added as well
 
     if (output_image_ptr != NULL)
       {
@@ -157,7 +174,6 @@ LM_distributable_computation(const shared_ptr<ProjMatrixByBin> PM_sptr,
             *output_image_ptr += *(local_output_image_sptrs[i]);
       }
   }
-#endif
   CPU_timer.stop();
   wall_clock_timer.stop();
   info(boost::format("Computation times for distributable_computation, CPU %1%s, wall-clock %2%s") % CPU_timer.value()
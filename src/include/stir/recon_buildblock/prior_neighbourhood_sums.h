@@ -0,0 +1,182 @@
+//
+//
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup priors
+
+  \brief Declaration and implementation of stir::detail::sum_prior_over_neighbourhoods and
+  stir::detail::compute_prior_neighbourhood_sums
+*/
+
+#ifndef __stir_recon_buildblock_prior_neighbourhood_sums_H__
+#define __stir_recon_buildblock_prior_neighbourhood_sums_H__
+
+#include "stir/Array.h"
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+START_NAMESPACE_STIR
+
+namespace detail
+{
+
+//! add the contributions of all neighbours to the voxels of one image row
+/*!
+  \ingroup priors
+
+  On return, <tt>row_sums[x-min_x]</tt> will have been incremented with
+  \f[ \sum_{dz,dy,dx} w_{dz,dy,dx} f(\lambda_{z,y,x}, \lambda_{z+dz,y+dy,x+dx}) \kappa_{z,y,x} \kappa_{z+dz,y+dy,x+dx} \f]
+  where pairs with the neighbour outside the image are excluded.
+
+  Instead of checking the neighbourhood range for every voxel, the loop runs over the
+  neighbours, and for each neighbour over the range of \c x for which it is inside the image.
+  The innermost loop is therefore over contiguous memory without any range checks, such that
+  the compiler can vectorise it. Neighbours with zero weight are skipped.
+*/
+template <bool do_kappa, typename elemT, typename FunctionT>
+inline void
+accumulate_prior_neighbourhood_row(double* const row_sums,
+                                   const Array<3, elemT>& image,
+                                   const Array<3, float>& weights,
+                                   const Array<3, elemT>* const kappa_ptr,
+                                   const int z,
+                                   const int y,
+                                   const FunctionT& f)
+{
+  const int min_dz = std::max(weights.get_min_index(), image.get_min_index() - z);
+  const int max_dz = std::min(weights.get_max_index(), image.get_max_index() - z);
+  const int min_dy = std::max(weights[0].get_min_index(), image[z].get_min_index() - y);
+  const int max_dy = std::min(weights[0].get_max_index(), image[z].get_max_index() - y);
+  // number of voxels in the row minus 1
+  const int last_x = image[z][y].get_max_index() - image[z][y].get_min_index();
+
+  const elemT* const centre = image[z][y].begin();
+  const elemT* const kappa_centre = do_kappa ? (*kappa_ptr)[z][y].begin() : nullptr;
+
+  for (int dz = min_dz; dz <= max_dz; ++dz)
+    for (int dy = min_dy; dy <= max_dy; ++dy)
+      {
+        const Array<1, float>& weights_row = weights[dz][dy];
+        const elemT* const neighbour = image[z + dz][y + dy].begin();
+        const elemT* const kappa_neighbour = do_kappa ? (*kappa_ptr)[z + dz][y + dy].begin() : nullptr;
+
+        for (int dx = weights_row.get_min_index(); dx <= weights_row.get_max_index(); ++dx)
+          {
+            const double weight = weights_row[dx];
+            if (weight == 0)
+              continue;
+            const int start_x = std::max(0, -dx);
+            const int end_x = last_x - std::max(0, dx);
+            for (int i = start_x; i <= end_x; ++i)
+              {
+                double current = weight * f(centre[i], neighbour[i + dx]);
+                if (do_kappa)
+                  current *= kappa_centre[i] * kappa_neighbour[i + dx];
+                row_sums[i] += current;
+              }
+          }
+      }
+}
+
+//! sum a function of all voxel-pairs in the neighbourhoods of an image
+/*!
+  \ingroup priors
+
+  Computes
+  \f[ \sum_{z,y,x} \sum_{dz,dy,dx} w_{dz,dy,dx} f(\lambda_{z,y,x}, \lambda_{z+dz,y+dy,x+dx})
+      \kappa_{z,y,x} \kappa_{z+dz,y+dy,x+dx} \f]
+  excluding voxel-pairs where the neighbour is outside the image. \a kappa_ptr can be 0, in which case
+  \f$\kappa\f$ is 1. This is the common part of \c compute_value() of priors such as
+  QuadraticPrior, LogcoshPrior and RelativeDifferencePrior.
+
+  \a f is called as <tt>f(elemT, elemT)</tt> and should return a \c double. It will be
+  called from multiple threads when OpenMP is enabled.
+
+  The weights and image (and \f$\kappa\f$) need to have regular index ranges.
+*/
+template <typename elemT, typename FunctionT>
+inline double
+sum_prior_over_neighbourhoods(const Array<3, elemT>& image,
+                              const Array<3, float>& weights,
+                              const Array<3, elemT>* const kappa_ptr,
+                              const FunctionT& f)
+{
+  double result = 0.;
+  const int min_z = image.get_min_index();
+  const int max_z = image.get_max_index();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for reduction(+ : result) schedule(dynamic)
+#endif
+  for (int z = min_z; z <= max_z; ++z)
+    {
+      std::vector<double> row_sums;
+      for (int y = image[z].get_min_index(); y <= image[z].get_max_index(); ++y)
+        {
+          row_sums.assign(image[z][y].size(), 0.);
+          if (kappa_ptr)
+            accumulate_prior_neighbourhood_row<true>(row_sums.data(), image, weights, kappa_ptr, z, y, f);
+          else
+            accumulate_prior_neighbourhood_row<false>(row_sums.data(), image, weights, kappa_ptr, z, y, f);
+          result += std::accumulate(row_sums.begin(), row_sums.end(), 0.);
+        }
+    }
+  return result;
+}
+
+//! compute for every voxel the sum of a function over its neighbourhood
+/*!
+  \ingroup priors
+
+  Sets
+  \f[ o_{z,y,x} = s \sum_{dz,dy,dx} w_{dz,dy,dx} f(\lambda_{z,y,x}, \lambda_{z+dz,y+dy,x+dx})
+      \kappa_{z,y,x} \kappa_{z+dz,y+dy,x+dx} \f]
+  with \f$s\f$ equal to \a scale. This is the common part of \c compute_gradient() and
+  \c parabolic_surrogate_curvature() of priors such as QuadraticPrior, LogcoshPrior and RelativeDifferencePrior.
+
+  See sum_prior_over_neighbourhoods() for more information.
+*/
+template <typename elemT, typename FunctionT>
+inline void
+compute_prior_neighbourhood_sums(Array<3, elemT>& output,
+                                 const Array<3, elemT>& image,
+                                 const Array<3, float>& weights,
+                                 const Array<3, elemT>* const kappa_ptr,
+                                 const double scale,
+                                 const FunctionT& f)
+{
+  const int min_z = image.get_min_index();
+  const int max_z = image.get_max_index();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int z = min_z; z <= max_z; ++z)
+    {
+      std::vector<double> row_sums;
+      for (int y = image[z].get_min_index(); y <= image[z].get_max_index(); ++y)
+        {
+          row_sums.assign(image[z][y].size(), 0.);
+          if (kappa_ptr)
+            accumulate_prior_neighbourhood_row<true>(row_sums.data(), image, weights, kappa_ptr, z, y, f);
+          else
+            accumulate_prior_neighbourhood_row<false>(row_sums.data(), image, weights, kappa_ptr, z, y, f);
+          elemT* const output_row = output[z][y].begin();
+          for (std::size_t i = 0; i < row_sums.size(); ++i)
+            output_row[i] = static_cast<elemT>(row_sums[i] * scale);
+        }
+    }
+}
+
+} // namespace detail
+
+END_NAMESPACE_STIR
+
+#endif
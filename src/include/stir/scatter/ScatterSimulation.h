@@ -240,6 +240,22 @@ public:
   //! Return if line integrals are cached or not
   bool get_use_cache() const;
 
+  //! Set the name of the file used to store the integrals over the attenuation image
+  /*! If set (and caching is enabled), set_up() will try to read the attenuation integrals
+      from this file. If the file does not exist, or was computed for another attenuation image,
+      other scatter points or another (downsampled) scanner, the integrals are computed and
+      written to the file.
+
+      Reusing the file is therefore only possible when the scatter points are not randomly placed
+      (see set_randomly_place_scatter_points()), for instance for the frames of a dynamic study
+      at the same bed position.
+
+      \warning The file is written in native byte order and float precision.
+  */
+  void set_attenuation_integrals_cache_filename(const std::string&);
+  //! Get the name of the file used to store the integrals over the attenuation image
+  const std::string& get_attenuation_integrals_cache_filename() const;
+
 protected:
   //! computes scatter for one viewgram
   /*! \return total scatter estimated for this viewgram */
@@ -301,6 +317,12 @@ protected:
 
   unsigned find_in_detection_points_vector(const CartesianCoordinate3D<float>& coord) const;
 
+  //! fill detection_points_vector by finding the detectors of all bins
+  /*! This is done in the order of the bins, such that the detector numbers do not depend on
+      the order in which bins are processed (e.g. when using multiple threads).
+  */
+  void find_all_detection_points();
+
   CartesianCoordinate3D<float> shift_detector_coordinates_to_origin;
 
   //! average detection efficiency of unscattered counts
@@ -359,6 +381,12 @@ protected:
       call remove_cache_for_scattpoint_det_integrals_over_activity() first.
   */
   void initialise_cache_for_scattpoint_det_integrals_over_activity();
+  //! compute the integrals over the attenuation image for all scatter points and detectors
+  /*! This is done in parallel when using OpenMP. If attenuation_integrals_cache_filename is
+      set, the integrals are read from file (if it matches), or written to it after computation.
+      Does nothing if caching is disabled or the cache is already filled.
+  */
+  void fill_cache_for_scattpoint_det_integrals_over_attenuation();
 
   //! Output proj_data fileanme prefix
   std::string output_proj_data_filename;
@@ -375,6 +403,8 @@ protected:
       of memory, you can switch this off, but performance will suffer dramatically.
   */
   bool use_cache;
+  //! Filename for reading/writing the integrals over the attenuation image
+  std::string attenuation_integrals_cache_filename;
   //! Filename for the initial activity estimate.
   std::string activity_image_filename;
   //! Zoom factor on plane XY. Defaults on 1.f.
@@ -398,6 +428,8 @@ private:
 
   Array<2, float> cached_activity_integral_scattpoint_det;
   Array<2, float> cached_attenuation_integral_scattpoint_det;
+  //! \c true if all integrals over the attenuation image have been computed (or read)
+  bool attenuation_integrals_cache_filled;
   shared_ptr<DiscretisedDensity<3, float>> density_image_for_scatter_points_sptr;
 
   // numbers that we don't want to recompute all the time
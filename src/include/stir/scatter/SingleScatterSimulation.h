@@ -71,9 +71,32 @@ protected:
 
   virtual void actual_scatter_estimate(double& scatter_ratio_singles, const unsigned det_num_A, const unsigned det_num_B);
 
+  //! removes the cached integrals, and the geometric factors for the scatter points and detectors
+  /*! Called by ScatterSimulation whenever scatter points or detection points change. */
+  void remove_cache_for_integrals_over_attenuation() override;
+
 private:
   //! larger angles will be ignored
   float max_single_scatter_cos_angle;
+
+  //! geometric factors for one scatter point and one detector, used for all LORs with that detector
+  struct ScatterPointDetectorFactors
+  {
+    //! unit vector from the scatter point to the detector
+    CartesianCoordinate3D<float> direction;
+    //! 1/(distance between scatter point and detector)^2
+    float inv_distance_squared;
+    //! cosine of the angle between the photon and the normal of the detector
+    float cos_incident_angle;
+  };
+  //! factors for all scatter points and detection points (stored as [scatter_point_num][det_num])
+  /*! Only computed by set_up() when the cache is used. When empty, the factors are computed for
+      every LOR (and scatter point).
+  */
+  std::vector<ScatterPointDetectorFactors> scatter_point_detector_factors;
+  std::size_t num_detection_points_for_factors = 0;
+
+  void compute_scatter_point_detector_factors();
 };
 
 END_NAMESPACE_STIR
@@ -30,6 +30,22 @@ VoxelsOnCartesianGrid<float> warp_image(const shared_ptr<DiscretisedDensity<3, f
                                         const BSpline::BSplineType spline_type,
                                         const bool extend_borders);
 
+//! Warp an image using already computed B-spline coefficients
+/*! The index range and grid spacing are taken from \a out_density. They have to be the same as for the image
+    used to construct \a density_interpolation. The index range of the motion images has to contain the one of
+    \a out_density (only that part of the motion images is used). If \a accumulate is \c true, the
+    warped image is added to \a out_density, otherwise \a out_density is overwritten.
+
+    This avoids recomputing the B-spline coefficients when warping the same image with several motion fields,
+    and allocating a temporary image when summing several warped images.
+*/
+void warp_image(DiscretisedDensity<3, float>& out_density,
+                const BSpline::BSplinesRegularGrid<3, float>& density_interpolation,
+                const DiscretisedDensity<3, float>& motion_x,
+                const DiscretisedDensity<3, float>& motion_y,
+                const DiscretisedDensity<3, float>& motion_z,
+                const bool accumulate = false);
+
 END_NAMESPACE_STIR
 
 #endif
@@ -40,6 +40,9 @@ public:
   void process_new_time_event(const ListTime& time_event) override;
   Succeeded set_up() override;
 
+  //! Returns \c false, as the bin depends on the motion at the current time
+  bool supports_parallel_histogramming() const override;
+
 protected:
   //! motion information
   shared_ptr<RigidObject3DMotion> ro3d_ptr;
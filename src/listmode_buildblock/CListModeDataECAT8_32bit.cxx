@@ -22,6 +22,7 @@
 #include "stir/warning.h"
 #include "stir/error.h"
 #include <boost/format.hpp>
+#include <fstream>
 
 START_NAMESPACE_STIR
 namespace ecat
@@ -72,14 +73,21 @@ CListModeDataECAT8_32bit::open_lm_file()
   filename = std::string(full_data_file_name);
 
   info(boost::format("CListModeDataECAT8_32bit: opening file %1%") % filename);
-  shared_ptr<std::istream> stream_ptr(new std::fstream(filename.c_str(), std::ios::in | std::ios::binary));
-  if (!(*stream_ptr))
-    {
-      warning("CListModeDataECAT8_32bit: cannot open file '%s'", filename.c_str());
-      return Succeeded::no;
-    }
-  current_lm_data_ptr.reset(new InputStreamWithRecords<CListRecordT, bool>(
-      stream_ptr, 4, 4, ByteOrder::little_endian != ByteOrder::get_native_order()));
+  {
+    std::ifstream test_stream(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!test_stream)
+      {
+        warning("CListModeDataECAT8_32bit: cannot open file '%s'", filename.c_str());
+        return Succeeded::no;
+      }
+  }
+  // use memory mapping for fast access
+  current_lm_data_ptr.reset(new InputStreamWithRecords<CListRecordT, bool>(filename,
+                                                                           4,
+                                                                           4,
+                                                                           ByteOrder::little_endian != ByteOrder::get_native_order(),
+                                                                           /* start_of_data = */ 0,
+                                                                           /* use_memory_mapping = */ true));
 
   return Succeeded::yes;
 }
@@ -91,6 +99,15 @@ CListModeDataECAT8_32bit::get_next_record(CListRecord& record_of_general_type) c
   return current_lm_data_ptr->get_next_record(record);
 }
 
+std::size_t
+CListModeDataECAT8_32bit::get_next_records(const std::vector<shared_ptr<ListRecord>>& records) const
+{
+  std::vector<CListRecordT*> record_ptrs(records.size());
+  for (std::size_t i = 0; i < records.size(); ++i)
+    record_ptrs[i] = static_cast<CListRecordT*>(records[i].get());
+  return current_lm_data_ptr->get_next_records(record_ptrs.data(), record_ptrs.size());
+}
+
 Succeeded
 CListModeDataECAT8_32bit::reset()
 {
@@ -109,5 +126,11 @@ CListModeDataECAT8_32bit::set_get_position(const CListModeDataECAT8_32bit::Saved
   return current_lm_data_ptr->set_get_position(pos);
 }
 
+Succeeded
+CListModeDataECAT8_32bit::overwrite_saved_get_position(const CListModeDataECAT8_32bit::SavedPosition& pos)
+{
+  return current_lm_data_ptr->overwrite_saved_get_position(pos);
+}
+
 } // namespace ecat
 END_NAMESPACE_STIR
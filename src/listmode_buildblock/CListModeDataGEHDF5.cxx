@@ -120,6 +120,12 @@ CListModeDataGEHDF5::set_get_position(const CListModeDataGEHDF5::SavedPosition&
   return current_lm_data_ptr->set_get_position(pos);
 }
 
+Succeeded
+CListModeDataGEHDF5::overwrite_saved_get_position(const CListModeDataGEHDF5::SavedPosition& pos)
+{
+  return current_lm_data_ptr->overwrite_saved_get_position(pos);
+}
+
 } // namespace RDF_HDF5
 } // namespace GE
 END_NAMESPACE_STIR
@@ -258,6 +258,12 @@ CListModeDataROOT::set_get_position(const CListModeDataROOT::SavedPosition& pos)
   return root_file_sptr->set_get_position(pos);
 }
 
+Succeeded
+CListModeDataROOT::overwrite_saved_get_position(const CListModeDataROOT::SavedPosition& pos)
+{
+  return root_file_sptr->overwrite_saved_get_position(pos);
+}
+
 void
 CListModeDataROOT::set_defaults()
 {
@@ -122,6 +122,16 @@ CListModeDataSAFIR<CListRecordT>::get_next_record(CListRecord& record_of_general
   return status;
 }
 
+template <class CListRecordT>
+std::size_t
+CListModeDataSAFIR<CListRecordT>::get_next_records(const std::vector<shared_ptr<ListRecord>>& records) const
+{
+  std::vector<CListRecordT*> record_ptrs(records.size());
+  for (std::size_t i = 0; i < records.size(); ++i)
+    record_ptrs[i] = static_cast<CListRecordT*>(records[i].get());
+  return current_lm_data_ptr->get_next_records(record_ptrs.data(), record_ptrs.size());
+}
+
 template <class CListRecordT>
 Succeeded
 CListModeDataSAFIR<CListRecordT>::reset()
@@ -53,6 +53,21 @@ ListModeData::get_proj_data_info_sptr() const
   return proj_data_info_sptr;
 }
 
+std::size_t
+ListModeData::get_next_records(const std::vector<shared_ptr<ListRecord>>& records) const
+{
+  std::size_t num_read = 0;
+  while (num_read < records.size() && this->get_next_record(*records[num_read]) == Succeeded::yes)
+    ++num_read;
+  return num_read;
+}
+
+Succeeded
+ListModeData::overwrite_saved_get_position(const SavedPosition&)
+{
+  return Succeeded::no;
+}
+
 #if 0
 std::time_t
 ListModeData::
@@ -74,10 +74,17 @@ typedef short elem_type;
 #include "stir/ParsingObject.h"
 #include "stir/TimeFrameDefinitions.h"
 #include "stir/CPUTimer.h"
+#include "stir/HighResWallClockTimer.h"
 #include "stir/recon_buildblock/TrivialBinNormalisation.h"
 #include "stir/is_null_ptr.h"
+#include "stir/num_threads.h"
+#include "stir/info.h"
 #include "stir/warning.h"
 #include "stir/error.h"
+#ifdef STIR_OPENMP
+#  include <omp.h>
+#endif
+#include <boost/format.hpp>
 
 #include <fstream>
 #include <iostream>
@@ -131,6 +138,9 @@ static shared_ptr<ProjData> construct_proj_data(shared_ptr<iostream>& output,
                                                 const string& output_filename,
                                                 const ExamInfo& exam_info,
                                                 const shared_ptr<const ProjDataInfo>& proj_data_info_ptr);
+// get_bin_efficiency() is not necessarily thread-safe (e.g. it might read from file), so this
+// function calls it in a critical section (unless the normalisation is trivial)
+static float get_bin_efficiency_in_critical_section(const BinNormalisation& normalisation, const Bin& bin);
 
 /**************************************************************
  set/get
@@ -251,6 +261,51 @@ LmToProjData::get_time_frame_definitions() const
   return frame_defs;
 }
 
+void
+LmToProjData::set_parallel_histogramming(bool v)
+{
+  if (v && !this->supports_parallel_histogramming())
+    error("LmToProjData: parallel histogramming is not supported by this class");
+  this->parallel_histogramming = v;
+}
+
+bool
+LmToProjData::get_parallel_histogramming() const
+{
+  return parallel_histogramming;
+}
+
+bool
+LmToProjData::supports_parallel_histogramming() const
+{
+  return true;
+}
+
+void
+LmToProjData::set_num_records_per_batch(int v)
+{
+  this->_already_setup = false;
+  this->num_records_per_batch = v;
+}
+
+int
+LmToProjData::get_num_records_per_batch() const
+{
+  return num_records_per_batch;
+}
+
+void
+LmToProjData::set_use_thread_local_buffers(bool v)
+{
+  this->use_thread_local_buffers = v;
+}
+
+bool
+LmToProjData::get_use_thread_local_buffers() const
+{
+  return use_thread_local_buffers;
+}
+
 /**************************************************************
  The 3 parsing functions
 ***************************************************************/
@@ -268,6 +323,9 @@ LmToProjData::set_defaults()
   do_pre_normalisation = 0;
   num_events_to_store = 0L;
   do_time_frame = false;
+  parallel_histogramming = false;
+  num_records_per_batch = 100000;
+  use_thread_local_buffers = true;
 }
 
 void
@@ -295,6 +353,9 @@ LmToProjData::initialise_keymap()
     // parser.add_key("increment to use for 'delayeds'",&delayed_increment);
   }
   parser.add_key("List event coordinates", &interactive);
+  parser.add_key("parallel histogramming", &parallel_histogramming);
+  parser.add_key("num records per batch for parallel histogramming", &num_records_per_batch);
+  parser.add_key("use thread-local buffers for parallel histogramming", &use_thread_local_buffers);
   parser.add_stop_key("END");
 }
 
@@ -386,6 +447,16 @@ LmToProjData::set_up()
       error("LmToProjData: num_timing_poss_in_memory cannot be 0");
     }
 
+  if (parallel_histogramming)
+    {
+      if (!supports_parallel_histogramming())
+        error("LmToProjData: parallel histogramming is not supported by this class");
+      if (num_records_per_batch <= 0)
+        error("LmToProjData: num_records_per_batch has to be positive");
+      if (interactive)
+        warning("LmToProjData: parallel histogramming is not used when listing event coordinates");
+    }
+
   // handle store_prompts and store_delayeds
 
   if (store_prompts)
@@ -494,7 +565,7 @@ LmToProjData::get_bin_from_event(Bin& bin, const ListEvent& event) const
       //     const double end_time =frame_defs.get_end_time(current_frame_num);
       //#endif
 
-      const float bin_efficiency = normalisation_ptr->get_bin_efficiency(uncompressed_bin);
+      const float bin_efficiency = get_bin_efficiency_in_critical_section(*normalisation_ptr, uncompressed_bin);
       // TODO remove arbitrary number. Supposes that these bin_efficiencies are around 1
       if (bin_efficiency < 1.E-10)
         {
@@ -549,7 +620,7 @@ LmToProjData::do_post_normalisation(Bin& bin) const
           //	  const double start_time = frame_defs.get_start_time(current_frame_num);
           //	  const double end_time =frame_defs.get_end_time(current_frame_num);
           //#endif
-          const float bin_efficiency = post_normalisation_ptr->get_bin_efficiency(bin);
+          const float bin_efficiency = get_bin_efficiency_in_critical_section(*post_normalisation_ptr, bin);
           // TODO remove arbitrary number. Supposes that these bin_efficiencies are around 1
           if (bin_efficiency < 1.E-10)
             {
@@ -749,9 +820,21 @@ LmToProjData::process_data()
                   // now save position such that we can go back
                   frame_start_positions[current_frame_num] = lm_data_ptr->save_get_position();
                 }
+              const bool histogram_in_parallel = parallel_histogramming && !interactive;
+              if (histogram_in_parallel)
+                histogram_events_in_parallel(segments,
+                                             start_timing_pos_index,
+                                             end_timing_pos_index,
+                                             start_segment_index,
+                                             end_segment_index,
+                                             end_time,
+                                             more_events,
+                                             num_stored_events,
+                                             num_prompts_in_frame,
+                                             num_delayeds_in_frame);
               {
-                // loop over all events in the listmode file
-                while (more_events)
+                // loop over all events in the listmode file (unless done in parallel above)
+                while (!histogram_in_parallel && more_events)
                   {
                     if (lm_data_ptr->get_next_record(record) == Succeeded::no)
                       {
@@ -898,6 +981,250 @@ LmToProjData::process_data()
   cerr << "\nThis took " << timer.value() << "s CPU time." << endl;
 }
 
+/**************************************************************
+ Parallel version of the loop over all events in process_data().
+
+ Records are read in batches. Timing records are handled serially to find
+ where the frame ends. Bins are then computed in parallel, after which a serial
+ pass handles num_events_to_store and the counters, and the events are
+ added to the segments in parallel.
+***************************************************************/
+void
+LmToProjData::histogram_events_in_parallel(VectorWithOffset<VectorWithOffset<segment_type*>>& segments,
+                                           const int start_timing_pos_index,
+                                           const int end_timing_pos_index,
+                                           const int start_segment_index,
+                                           const int end_segment_index,
+                                           const double end_time,
+                                           unsigned long int& more_events,
+                                           long& num_stored_events,
+                                           long& num_prompts_in_frame,
+                                           long& num_delayeds_in_frame)
+{
+  CPUTimer cpu_timer;
+  cpu_timer.start();
+  HighResWallClockTimer wall_clock_timer;
+  wall_clock_timer.start();
+
+  const int num_threads = get_max_num_threads();
+  // thread 0 uses the segments themselves, the others (if any) their own copy
+  std::vector<VectorWithOffset<VectorWithOffset<segment_type*>>> local_segments;
+  if (use_thread_local_buffers && num_threads > 1)
+    {
+      local_segments.resize(num_threads - 1, segments);
+      for (auto& local_segments_for_thread : local_segments)
+        allocate_segments(local_segments_for_thread,
+                          start_timing_pos_index,
+                          end_timing_pos_index,
+                          start_segment_index,
+                          end_segment_index,
+                          output_proj_data_sptr->get_proj_data_info_sptr());
+    }
+
+  const ProjDataInfo& proj_data_info = *output_proj_data_sptr->get_proj_data_info_sptr();
+  std::vector<shared_ptr<ListRecord>> records(num_records_per_batch);
+  for (auto& record_sptr : records)
+    record_sptr = lm_data_ptr->get_empty_record_sptr();
+  std::vector<Bin> bins(num_records_per_batch);
+  std::vector<int> event_increments(num_records_per_batch);
+  // 0: ignore, 1: counts for num_events_to_store but not in memory, 2: store
+  std::vector<char> event_status(num_records_per_batch);
+
+  // position of the start of the current batch, saved only once if the list mode data supports overwriting it
+  ListModeData::SavedPosition batch_start_position = 0;
+  bool batch_start_position_is_saved = false;
+  bool more_records = true;
+  while (more_events && more_records)
+    {
+      if (!batch_start_position_is_saved
+          || lm_data_ptr->overwrite_saved_get_position(batch_start_position) == Succeeded::no)
+        {
+          batch_start_position = lm_data_ptr->save_get_position();
+          batch_start_position_is_saved = true;
+        }
+      const std::size_t num_read = lm_data_ptr->get_next_records(records);
+      if (num_read < records.size())
+        more_records = false;
+
+      // handle timing records, and find how many records belong to the current frame.
+      // Note that the record with the first time past the end of the frame is consumed, as in the serial version.
+      const double time_at_start_of_batch = current_time;
+      std::size_t num_records_to_process = num_read;
+      std::size_t num_records_consumed = num_read;
+      for (std::size_t i = 0; i < num_read; ++i)
+        {
+          const ListRecord& record = *records[i];
+          if (record.is_time() && end_time > 0.01) // Direct comparison within doubles is unsafe.
+            {
+              current_time = record.time().get_time_in_secs();
+              if (do_time_frame && current_time >= end_time)
+                {
+                  num_records_to_process = i;
+                  num_records_consumed = i + 1;
+                  break;
+                }
+              process_new_time_event(record.time());
+            }
+        }
+
+      // find bins (in parallel)
+      bool geometry_error = false;
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(static)
+#endif
+      for (long i = 0; i < static_cast<long>(num_records_to_process); ++i)
+        {
+          event_status[i] = 0;
+          const ListRecord& record = *records[i];
+          if (!record.is_event())
+            continue;
+          Bin& bin = bins[i];
+          // set value in case the event decoder doesn't touch it
+          // otherwise it would be 0 and all events will be ignored
+          bin.set_bin_value(1.f);
+          bin.time_frame_num() = current_frame_num;
+          try
+            {
+              get_bin_from_event(bin, record.event());
+            }
+          catch (...)
+            {
+#ifdef STIR_OPENMP
+#  pragma omp critical(LMTOPROJDATA_GEOMETRY_ERROR)
+#endif
+              geometry_error = true;
+              continue;
+            }
+
+          // check if it's inside the range we want to store
+          if (bin.get_bin_value() > 0 && bin.tangential_pos_num() >= proj_data_info.get_min_tangential_pos_num()
+              && bin.tangential_pos_num() <= proj_data_info.get_max_tangential_pos_num()
+              && bin.axial_pos_num() >= proj_data_info.get_min_axial_pos_num(bin.segment_num())
+              && bin.axial_pos_num() <= proj_data_info.get_max_axial_pos_num(bin.segment_num())
+              && bin.timing_pos_num() >= proj_data_info.get_min_tof_pos_num()
+              && bin.timing_pos_num() <= proj_data_info.get_max_tof_pos_num())
+            {
+              // see if we increment or decrement the value in the sinogram
+              const int event_increment = record.event().is_prompt() ? (store_prompts ? 1 : 0) // it's a prompt
+                                                                     : delayed_increment; // it is a delayed-coincidence event
+              if (event_increment == 0)
+                continue;
+              event_increments[i] = event_increment;
+              event_status[i] = 1;
+              if (bin.timing_pos_num() >= start_timing_pos_index && bin.timing_pos_num() <= end_timing_pos_index
+                  && bin.segment_num() >= start_segment_index && bin.segment_num() <= end_segment_index)
+                {
+                  do_post_normalisation(bin);
+                  event_status[i] = 2;
+                }
+            }
+        }
+      if (geometry_error)
+        {
+          for (auto& local_segments_for_thread : local_segments)
+            for (int timing_pos_num = start_timing_pos_index; timing_pos_num <= end_timing_pos_index; timing_pos_num++)
+              for (int seg = start_segment_index; seg <= end_segment_index; seg++)
+                delete local_segments_for_thread[timing_pos_num][seg];
+          for (int timing_pos_num = start_timing_pos_index; timing_pos_num <= end_timing_pos_index; timing_pos_num++)
+            for (int seg = start_segment_index; seg <= end_segment_index; seg++)
+              delete segments[timing_pos_num][seg];
+          error("Something wrong with geometry.");
+        }
+
+      // count events (in order, such that we stop at the same event as the serial version)
+      for (std::size_t i = 0; i < num_records_to_process; ++i)
+        {
+          if (event_status[i] == 0)
+            continue;
+          if (!do_time_frame)
+            more_events -= event_increments[i];
+          if (event_status[i] == 2)
+            {
+              num_stored_events += event_increments[i];
+              if (records[i]->event().is_prompt())
+                ++num_prompts_in_frame;
+              else
+                ++num_delayeds_in_frame;
+            }
+          if (!more_events)
+            {
+              num_records_to_process = i + 1;
+              num_records_consumed = i + 1;
+              // find the time of the last timing record that we would have seen
+              current_time = time_at_start_of_batch;
+              for (std::size_t j = 0; j < num_records_consumed; ++j)
+                if (records[j]->is_time() && end_time > 0.01)
+                  current_time = records[j]->time().get_time_in_secs();
+              break;
+            }
+        }
+
+      // add events to the segments (in parallel)
+#ifdef STIR_OPENMP
+#  pragma omp parallel
+#endif
+      {
+#ifdef STIR_OPENMP
+        const int thread_num = omp_get_thread_num();
+#else
+        const int thread_num = 0;
+#endif
+        VectorWithOffset<VectorWithOffset<segment_type*>>& segments_for_thread
+            = (thread_num == 0 || local_segments.empty()) ? segments : local_segments[thread_num - 1];
+#ifdef STIR_OPENMP
+#  pragma omp for schedule(static)
+#endif
+        for (long i = 0; i < static_cast<long>(num_records_to_process); ++i)
+          {
+            if (event_status[i] != 2)
+              continue;
+            const Bin& bin = bins[i];
+            elem_type& elem = (*segments_for_thread[bin.timing_pos_num()][bin.segment_num()])[bin.view_num()][bin.axial_pos_num()]
+                                                                                               [bin.tangential_pos_num()];
+            const elem_type value = bin.get_bin_value() * event_increments[i];
+            if (local_segments.empty())
+              {
+#ifdef STIR_OPENMP
+#  pragma omp atomic
+#endif
+                elem += value;
+              }
+            else
+              elem += value;
+          }
+      }
+
+      info(boost::format("%1% events stored") % num_stored_events, 2);
+
+      if (num_records_consumed < num_read)
+        {
+          // we read too far. Go back such that the next read starts at the same record as in the serial version
+          if (lm_data_ptr->set_get_position(batch_start_position) == Succeeded::no)
+            error("LmToProjData: error going back to the start of the batch in the list mode data");
+          if (lm_data_ptr->get_next_records(std::vector<shared_ptr<ListRecord>>(records.begin(),
+                                                                                records.begin() + num_records_consumed))
+              != num_records_consumed)
+            error("LmToProjData: error repositioning in the list mode data");
+          break;
+        }
+    }
+
+  // merge thread-local buffers
+  for (auto& local_segments_for_thread : local_segments)
+    for (int timing_pos_num = start_timing_pos_index; timing_pos_num <= end_timing_pos_index; timing_pos_num++)
+      for (int seg = start_segment_index; seg <= end_segment_index; seg++)
+        {
+          *segments[timing_pos_num][seg] += *local_segments_for_thread[timing_pos_num][seg];
+          delete local_segments_for_thread[timing_pos_num][seg];
+        }
+
+  cpu_timer.stop();
+  wall_clock_timer.stop();
+  info(boost::format("LmToProjData: parallel histogramming with %1% threads took %2%s CPU time, %3%s wall-clock time")
+           % num_threads % cpu_timer.value() % wall_clock_timer.value(),
+       2);
+}
+
 #if 0
 void
 LmToProjData::run_tof_test_function()
@@ -1083,4 +1410,18 @@ construct_proj_data(shared_ptr<iostream>& output,
 #endif
 }
 
+static float
+get_bin_efficiency_in_critical_section(const BinNormalisation& normalisation, const Bin& bin)
+{
+  if (normalisation.is_trivial())
+    return normalisation.get_bin_efficiency(bin);
+
+  float bin_efficiency;
+#ifdef STIR_OPENMP
+#  pragma omp critical(LMTOPROJDATA_GET_BIN_EFFICIENCY)
+#endif
+  bin_efficiency = normalisation.get_bin_efficiency(bin);
+  return bin_efficiency;
+}
+
 END_NAMESPACE_STIR
@@ -97,6 +97,13 @@ LmToProjDataBootstrap<LmToProjDataT>::post_processing()
   return LmToProjDataT::post_processing();
 }
 
+template <typename LmToProjDataT>
+bool
+LmToProjDataBootstrap<LmToProjDataT>::supports_parallel_histogramming() const
+{
+  return false;
+}
+
 template <typename LmToProjDataT>
 Succeeded
 LmToProjDataBootstrap<LmToProjDataT>::set_up()
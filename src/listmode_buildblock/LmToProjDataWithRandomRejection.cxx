@@ -92,6 +92,13 @@ LmToProjDataWithRandomRejection<LmToProjDataT>::post_processing()
   return LmToProjDataT::post_processing();
 }
 
+template <typename LmToProjDataT>
+bool
+LmToProjDataWithRandomRejection<LmToProjDataT>::supports_parallel_histogramming() const
+{
+  return false;
+}
+
 template <typename LmToProjDataT>
 Succeeded
 LmToProjDataWithRandomRejection<LmToProjDataT>::set_up()
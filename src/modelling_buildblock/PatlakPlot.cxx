@@ -159,7 +159,7 @@ PatlakPlot::set_up()
 }
 
 void
-PatlakPlot::apply_linear_regression(ParametricVoxelsOnCartesianGrid& par_image, const DynamicDiscretisedDensity& dyn_image) const
+PatlakPlot::scale_model_matrix_for_dynamic_image(const DynamicDiscretisedDensity& dyn_image) const
 {
   if (!this->_in_correct_scale)
     {
@@ -177,6 +177,21 @@ PatlakPlot::apply_linear_regression(ParametricVoxelsOnCartesianGrid& par_image,
       this->_model_matrix.write_to_file("patlak_matrix_in_correct_scale.txt");
 #endif // NDEBUG
     }
+}
+
+ModelMatrix<2>
+PatlakPlot::get_model_matrix_for_dynamic_image(const DynamicDiscretisedDensity& dyn_image) const
+{
+  if (_matrix_is_stored == false)
+    error("It seems that ModelMatrix has not been set, yet. ");
+  this->scale_model_matrix_for_dynamic_image(dyn_image);
+  return this->_model_matrix;
+}
+
+void
+PatlakPlot::apply_linear_regression(ParametricVoxelsOnCartesianGrid& par_image, const DynamicDiscretisedDensity& dyn_image) const
+{
+  this->scale_model_matrix_for_dynamic_image(dyn_image);
   //  const DynamicDiscretisedDensity & dyn_image=this->_dyn_image;
   // TODO check consistency of time-frame definitions
   const unsigned int num_frames = (this->_frame_defs).get_num_frames();
@@ -248,22 +263,7 @@ void
 PatlakPlot::multiply_dynamic_image_with_model_gradient(ParametricVoxelsOnCartesianGrid& par_image,
                                                        const DynamicDiscretisedDensity& dyn_image) const
 {
-  if (!this->_in_correct_scale)
-    {
-#ifndef NDEBUG
-      this->_model_matrix.write_to_file("patlak_matrix_not_in_correct_scale.txt");
-#endif // NDEBUG
-      const DiscretisedDensityOnCartesianGrid<3, float>* image_cartesian_ptr
-          = dynamic_cast<DiscretisedDensityOnCartesianGrid<3, float>*>(((dyn_image.get_densities())[0]).get());
-      const BasicCoordinate<3, float> this_grid_spacing = image_cartesian_ptr->get_grid_spacing();
-      if (dyn_image.get_scanner_default_bin_size() <= 0)
-        error("PatlakPlot: The dynamic image currently needs to know the Scanner's default_bin_size. Did you set the "
-              "'originating system'?");
-      this->_model_matrix.scale_model_matrix(this_grid_spacing[2] / dyn_image.get_scanner_default_bin_size());
-#ifndef NDEBUG
-      this->_model_matrix.write_to_file("patlak_matrix_in_correct_scale.txt");
-#endif // NDEBUG
-    }
+  this->scale_model_matrix_for_dynamic_image(dyn_image);
   this->_model_matrix.multiply_dynamic_image_with_model(par_image, dyn_image);
 }
 
@@ -271,22 +271,7 @@ void
 PatlakPlot::multiply_dynamic_image_with_model_gradient_and_add_to_input(ParametricVoxelsOnCartesianGrid& par_image,
                                                                         const DynamicDiscretisedDensity& dyn_image) const
 {
-  if (!this->_in_correct_scale)
-    {
-#ifndef NDEBUG
-      this->_model_matrix.write_to_file("patlak_matrix_not_in_correct_scale.txt");
-#endif // NDEBUG
-      const DiscretisedDensityOnCartesianGrid<3, float>* image_cartesian_ptr
-          = dynamic_cast<DiscretisedDensityOnCartesianGrid<3, float>*>(((dyn_image.get_densities())[0]).get());
-      const BasicCoordinate<3, float> this_grid_spacing = image_cartesian_ptr->get_grid_spacing();
-      if (dyn_image.get_scanner_default_bin_size() <= 0)
-        error("PatlakPlot: The dynamic image currently needs to know the Scanner's default_bin_size. Did you set the "
-              "'originating system'?");
-      this->_model_matrix.scale_model_matrix(this_grid_spacing[2] / dyn_image.get_scanner_default_bin_size());
-#ifndef NDEBUG
-      this->_model_matrix.write_to_file("patlak_matrix_in_correct_scale.txt");
-#endif // NDEBUG
-    }
+  this->scale_model_matrix_for_dynamic_image(dyn_image);
   this->_model_matrix.multiply_dynamic_image_with_model_and_add_to_input(par_image, dyn_image);
 }
 // Should be a virtual function declared in the KineticModels or better to the LinearModels
@@ -294,22 +279,7 @@ void
 PatlakPlot::get_dynamic_image_from_parametric_image(DynamicDiscretisedDensity& dyn_image,
                                                     const ParametricVoxelsOnCartesianGrid& par_image) const
 {
-  if (!this->_in_correct_scale)
-    {
-#ifndef NDEBUG
-      this->_model_matrix.write_to_file("patlak_matrix_not_in_correct_scale.txt");
-#endif // NDEBUG
-      const DiscretisedDensityOnCartesianGrid<3, float>* image_cartesian_ptr
-          = dynamic_cast<DiscretisedDensityOnCartesianGrid<3, float>*>(((dyn_image.get_densities())[0]).get());
-      const BasicCoordinate<3, float> this_grid_spacing = image_cartesian_ptr->get_grid_spacing();
-      if (dyn_image.get_scanner_default_bin_size() <= 0)
-        error("PatlakPlot: The dynamic image currently needs to know the Scanner's default_bin_size. Did you set the "
-              "'originating system'?");
-      this->_model_matrix.scale_model_matrix(this_grid_spacing[2] / dyn_image.get_scanner_default_bin_size());
-#ifndef NDEBUG
-      this->_model_matrix.write_to_file("patlak_matrix_in_correct_scale.txt");
-#endif // NDEBUG
-    }
+  this->scale_model_matrix_for_dynamic_image(dyn_image);
 
   this->_model_matrix.multiply_parametric_image_with_model(dyn_image, par_image);
 }
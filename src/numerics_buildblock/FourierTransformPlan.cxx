@@ -0,0 +1,324 @@
+/*!
+  \file
+  \ingroup DFT
+  \brief Implementation of class stir::FourierTransformPlan
+
+  The mixed-radix algorithm follows the structure of KISS FFT by Mark Borgerding
+  (recursive decimation in time with radix-specific butterflies).
+*/
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+#include "stir/numerics/FourierTransformPlan.h"
+#include "stir/common.h"
+#include "stir/error.h"
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+START_NAMESPACE_STIR
+
+// largest radix for which we use butterfly_generic. Lengths with larger prime factors use Bluestein's algorithm.
+static const int max_generic_radix = 61;
+
+typedef std::map<std::pair<int, int>, shared_ptr<const FourierTransformPlan>> plan_cache_type;
+
+static plan_cache_type&
+get_plan_cache()
+{
+  static plan_cache_type cache;
+  return cache;
+}
+
+static std::mutex&
+get_plan_cache_mutex()
+{
+  static std::mutex m;
+  return m;
+}
+
+shared_ptr<const FourierTransformPlan>
+FourierTransformPlan::get_plan(const int length, const int sign)
+{
+  const auto key = std::make_pair(length, sign);
+  {
+    std::lock_guard<std::mutex> lock(get_plan_cache_mutex());
+    const auto iter = get_plan_cache().find(key);
+    if (iter != get_plan_cache().end())
+      return iter->second;
+  }
+  // Construct the plan without holding the lock, as this might call get_plan() (for Bluestein's algorithm).
+  // If another thread constructed the same plan in the mean time, we use that one.
+  const shared_ptr<const FourierTransformPlan> plan_sptr = std::make_shared<const FourierTransformPlan>(length, sign);
+  std::lock_guard<std::mutex> lock(get_plan_cache_mutex());
+  return get_plan_cache().emplace(key, plan_sptr).first->second;
+}
+
+void
+FourierTransformPlan::clear_cache()
+{
+  std::lock_guard<std::mutex> lock(get_plan_cache_mutex());
+  get_plan_cache().clear();
+}
+
+FourierTransformPlan::FourierTransformPlan(const int length_v, const int sign_v)
+    : length(length_v),
+      sign(sign_v),
+      use_bluestein(false)
+{
+  if (length <= 0)
+    error("FourierTransformPlan: length should be positive, but is " + std::to_string(length));
+  if (sign != 1 && sign != -1)
+    error("FourierTransformPlan: sign should be 1 or -1");
+
+  twiddles.resize(length);
+  for (int k = 0; k < length; ++k)
+    {
+      const double phase = sign * 2 * _PI * k / length;
+      twiddles[k] = complex_type(static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase)));
+    }
+  half_twiddles.resize(length / 2 + 1);
+  for (int k = 0; k <= length / 2; ++k)
+    {
+      const double phase = sign * _PI * k / length;
+      half_twiddles[k] = complex_type(static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase)));
+    }
+
+  // factorise the length: first factors 4, then 2, then odd numbers
+  {
+    int n = length;
+    int p = 4;
+    const int floor_sqrt = static_cast<int>(std::floor(std::sqrt(static_cast<double>(n))));
+    do
+      {
+        while (n % p)
+          {
+            switch (p)
+              {
+              case 4:
+                p = 2;
+                break;
+              case 2:
+                p = 3;
+                break;
+              default:
+                p += 2;
+                break;
+              }
+            if (p > floor_sqrt)
+              p = n;
+          }
+        n /= p;
+        factors.push_back(p);
+        factors.push_back(n);
+        if (p > max_generic_radix)
+          use_bluestein = true;
+    } while (n > 1);
+  }
+
+  if (use_bluestein)
+    {
+      // X_s = chirp_s \sum_r (x_r chirp_r) conj(chirp_{s-r})
+      // The convolution is computed via DFTs of a power of 2 length.
+      int convolution_length = 1;
+      while (convolution_length < 2 * length - 1)
+        convolution_length *= 2;
+      chirp.resize(length);
+      for (int k = 0; k < length; ++k)
+        {
+          // use k^2 modulo 2*length to avoid loss of precision for large k
+          const long long k2 = (static_cast<long long>(k) * k) % (2LL * length);
+          const double phase = sign * _PI * k2 / length;
+          chirp[k] = complex_type(static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase)));
+        }
+      convolution_forward_plan_sptr = get_plan(convolution_length, 1);
+      convolution_inverse_plan_sptr = get_plan(convolution_length, -1);
+      chirp_kernel_in_frequency_space.assign(convolution_length, complex_type(0.F));
+      chirp_kernel_in_frequency_space[0] = std::conj(chirp[0]);
+      for (int k = 1; k < length; ++k)
+        {
+          chirp_kernel_in_frequency_space[k] = std::conj(chirp[k]);
+          chirp_kernel_in_frequency_space[convolution_length - k] = std::conj(chirp[k]);
+        }
+      convolution_forward_plan_sptr->transform(chirp_kernel_in_frequency_space.data());
+      // include normalisation of the inverse DFT
+      for (auto& c : chirp_kernel_in_frequency_space)
+        c /= static_cast<float>(convolution_length);
+    }
+}
+
+void
+FourierTransformPlan::transform(complex_type* data) const
+{
+  if (length == 1)
+    return;
+  if (use_bluestein)
+    {
+      transform_using_bluestein(data);
+      return;
+    }
+  thread_local std::vector<complex_type> scratch;
+  scratch.assign(data, data + length);
+  transform(data, scratch.data(), 1);
+}
+
+void
+FourierTransformPlan::transform_many(complex_type* data, const int num_transforms, const std::ptrdiff_t distance) const
+{
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(static)
+#endif
+  for (int i = 0; i < num_transforms; ++i)
+    transform(data + i * distance);
+}
+
+void
+FourierTransformPlan::transform(complex_type* out, const complex_type* in, const std::ptrdiff_t in_stride) const
+{
+  work(out, in, 1, in_stride, factors.data());
+}
+
+void
+FourierTransformPlan::work(complex_type* out,
+                           const complex_type* in,
+                           const std::size_t fstride,
+                           const std::ptrdiff_t in_stride,
+                           const int* factors_ptr) const
+{
+  complex_type* const out_begin = out;
+  const int p = *factors_ptr++; // the radix
+  const int m = *factors_ptr++; // length of the DFTs at the next stage (i.e. length/p)
+  const complex_type* const out_end = out + p * m;
+
+  if (m == 1)
+    {
+      do
+        {
+          *out = *in;
+          in += fstride * in_stride;
+      } while (++out != out_end);
+    }
+  else
+    {
+      do
+        {
+          // recursive call to compute DFTs of length m
+          work(out, in, fstride * p, in_stride, factors_ptr);
+          in += fstride * in_stride;
+      } while ((out += m) != out_end);
+    }
+
+  out = out_begin;
+  switch (p)
+    {
+    case 2:
+      butterfly_2(out, fstride, m);
+      break;
+    case 4:
+      butterfly_4(out, fstride, m);
+      break;
+    default:
+      butterfly_generic(out, fstride, m, p);
+      break;
+    }
+}
+
+void
+FourierTransformPlan::butterfly_2(complex_type* out, const std::size_t fstride, const int m) const
+{
+  complex_type* out2 = out + m;
+  const complex_type* tw = twiddles.data();
+  for (int k = 0; k < m; ++k)
+    {
+      const complex_type t = out2[k] * *tw;
+      tw += fstride;
+      out2[k] = out[k] - t;
+      out[k] += t;
+    }
+}
+
+void
+FourierTransformPlan::butterfly_4(complex_type* out, const std::size_t fstride, const int m) const
+{
+  const complex_type* tw1 = twiddles.data();
+  const complex_type* tw2 = tw1;
+  const complex_type* tw3 = tw1;
+  const int m2 = 2 * m;
+  const int m3 = 3 * m;
+  // multiplication with sign*i
+  const float s = static_cast<float>(sign);
+
+  for (int k = 0; k < m; ++k, ++out)
+    {
+      const complex_type s0 = out[m] * *tw1;
+      const complex_type s1 = out[m2] * *tw2;
+      const complex_type s2 = out[m3] * *tw3;
+      tw1 += fstride;
+      tw2 += fstride * 2;
+      tw3 += fstride * 3;
+
+      const complex_type s5 = out[0] - s1;
+      out[0] += s1;
+      const complex_type s3 = s0 + s2;
+      const complex_type s4 = s0 - s2;
+      out[m2] = out[0] - s3;
+      out[0] += s3;
+      out[m] = complex_type(s5.real() - s * s4.imag(), s5.imag() + s * s4.real());
+      out[m3] = complex_type(s5.real() + s * s4.imag(), s5.imag() - s * s4.real());
+    }
+}
+
+void
+FourierTransformPlan::butterfly_generic(complex_type* out, const std::size_t fstride, const int m, const int p) const
+{
+  complex_type scratch[max_generic_radix];
+  assert(p <= max_generic_radix);
+  const std::size_t n = static_cast<std::size_t>(length);
+
+  for (int u = 0; u < m; ++u)
+    {
+      int k = u;
+      for (int q1 = 0; q1 < p; ++q1, k += m)
+        scratch[q1] = out[k];
+
+      k = u;
+      for (int q1 = 0; q1 < p; ++q1, k += m)
+        {
+          std::size_t twidx = 0;
+          out[k] = scratch[0];
+          for (int q = 1; q < p; ++q)
+            {
+              twidx += fstride * k;
+              if (twidx >= n)
+                twidx %= n;
+              out[k] += scratch[q] * twiddles[twidx];
+            }
+        }
+    }
+}
+
+void
+FourierTransformPlan::transform_using_bluestein(complex_type* data) const
+{
+  const int convolution_length = convolution_forward_plan_sptr->get_length();
+  thread_local std::vector<complex_type> buffer;
+  buffer.assign(convolution_length, complex_type(0.F));
+  for (int k = 0; k < length; ++k)
+    buffer[k] = data[k] * chirp[k];
+  convolution_forward_plan_sptr->transform(buffer.data());
+  for (int k = 0; k < convolution_length; ++k)
+    buffer[k] *= chirp_kernel_in_frequency_space[k];
+  convolution_inverse_plan_sptr->transform(buffer.data());
+  for (int k = 0; k < length; ++k)
+    data[k] = buffer[k] * chirp[k];
+}
+
+END_NAMESPACE_STIR
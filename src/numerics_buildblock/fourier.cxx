@@ -15,10 +15,13 @@
     See STIR/LICENSE.txt for details
 */
 #include "stir/numerics/fourier.h"
+#include "stir/numerics/FourierTransformPlan.h"
 #include "stir/round.h"
 #include "stir/modulo.h"
 #include "stir/array_index_functions.h"
 #include "stir/error.h"
+#include <algorithm>
+#include <vector>
 START_NAMESPACE_STIR
 
 template <typename T>
@@ -58,14 +61,15 @@ get_exparray(const int pow2k, const int sign)
    This is almost a straightforward 1D FFT implementation. The only tricky bit
    is to make sure that all operations are written in a way that is defined
    (and efficient) in the case that the element type is a vector again.
+
+   This version is only used for types that are not handled by the
+   specialisations of fourier_1d_auxiliary below.
 */
 
 template <typename T>
-void
-fourier_1d(T& c, const int sign)
+static void
+fourier_1d_generic(T& c, const int sign)
 {
-  if (c.size() == 0)
-    return;
   assert(c.get_min_index() == 0);
   assert(sign == 1 || sign == -1);
   bitreversal(c);
@@ -110,6 +114,98 @@ fourier_1d(T& c, const int sign)
 namespace detail
 {
 
+/* A class that selects the implementation of fourier_1d.
+
+   Arrays of std::complex<float> use a FourierTransformPlan, and can therefore
+   have any length.
+*/
+template <typename T>
+struct fourier_1d_auxiliary
+{
+  static void do_fourier_1d(T& c, const int sign) { fourier_1d_generic(c, sign); }
+};
+
+template <>
+struct fourier_1d_auxiliary<VectorWithOffset<std::complex<float>>>
+{
+  static void do_fourier_1d(VectorWithOffset<std::complex<float>>& c, const int sign)
+  {
+    assert(c.get_min_index() == 0);
+    FourierTransformPlan::get_plan(c.get_length(), sign)->transform(c.begin());
+  }
+};
+
+template <>
+struct fourier_1d_auxiliary<Array<1, std::complex<float>>>
+{
+  static void do_fourier_1d(Array<1, std::complex<float>>& c, const int sign)
+  {
+    assert(c.get_min_index() == 0);
+    FourierTransformPlan::get_plan(c.get_length(), sign)->transform(c.begin());
+  }
+};
+
+/* Multi-dimensional arrays: transform along the outer index.
+   Blocks of "columns" are copied to a contiguous buffer, transformed
+   (in parallel) and copied back.
+*/
+template <int num_dimensions>
+struct fourier_1d_auxiliary<VectorWithOffset<Array<num_dimensions, std::complex<float>>>>
+{
+  static void do_fourier_1d(VectorWithOffset<Array<num_dimensions, std::complex<float>>>& c, const int sign)
+  {
+    typedef typename Array<num_dimensions, std::complex<float>>::full_iterator inner_iterator;
+    assert(c.get_min_index() == 0);
+    const int n = c.get_length();
+    const std::size_t inner_size = c[0].size_all();
+    for (int i = 1; i < n; ++i)
+      if (c[i].size_all() != inner_size)
+        error("fourier_1d: array has to be regular");
+
+    const auto plan_sptr = FourierTransformPlan::get_plan(n, sign);
+    const std::size_t block_size = std::min(inner_size, std::size_t(256));
+    std::vector<std::complex<float>> buffer(block_size * n);
+    std::vector<inner_iterator> iters(n);
+    for (int i = 0; i < n; ++i)
+      iters[i] = c[i].begin_all();
+
+    for (std::size_t start = 0; start < inner_size; start += block_size)
+      {
+        const std::size_t this_block_size = std::min(block_size, inner_size - start);
+        const std::vector<inner_iterator> block_start_iters(iters);
+        for (int i = 0; i < n; ++i)
+          for (std::size_t b = 0; b < this_block_size; ++b, ++iters[i])
+            buffer[b * n + i] = *iters[i];
+        plan_sptr->transform_many(buffer.data(), static_cast<int>(this_block_size), n);
+        for (int i = 0; i < n; ++i)
+          {
+            inner_iterator iter = block_start_iters[i];
+            for (std::size_t b = 0; b < this_block_size; ++b, ++iter)
+              *iter = buffer[b * n + i];
+          }
+      }
+  }
+};
+
+template <int num_dimensions>
+struct fourier_1d_auxiliary<Array<num_dimensions, std::complex<float>>>
+    : public fourier_1d_auxiliary<VectorWithOffset<Array<num_dimensions - 1, std::complex<float>>>>
+{};
+
+} // end of namespace detail
+
+template <typename T>
+void
+fourier_1d(T& c, const int sign)
+{
+  if (c.size() == 0)
+    return;
+  detail::fourier_1d_auxiliary<T>::do_fourier_1d(c, sign);
+}
+
+namespace detail
+{
+
 /* A class that does the recursion for multi-dimensional arrays.
 
    This is done with a class because partial template specialisation is
@@ -121,9 +217,11 @@ struct fourier_auxiliary
   static void do_fourier(VectorWithOffset<elemT>& c, const int sign)
   {
     fourier_1d(c, sign);
-    const typename VectorWithOffset<elemT>::iterator iter_end = c.end();
-    for (typename VectorWithOffset<elemT>::iterator iter = c.begin(); iter != iter_end; ++iter)
-      fourier(*iter, sign);
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = c.get_min_index(); i <= c.get_max_index(); ++i)
+      fourier(c[i], sign);
   }
 };
 
@@ -178,6 +276,7 @@ fourier_1d_for_real_data(const Array<1, T>& v, const int sign)
   for (int i = 0; i < c.get_length(); ++i)
     c[i] = complex_t(v[2 * i] / 2, v[2 * i + 1] / 2);
 
+  const auto plan_sptr = FourierTransformPlan::get_plan(static_cast<int>(n), sign);
   fourier_1d(c, sign);
 
   // cout << "C: " << c;
@@ -185,10 +284,8 @@ fourier_1d_for_real_data(const Array<1, T>& v, const int sign)
   for (unsigned int i = 1; i <= n / 2; ++i)
     {
       const complex_t t1 = (c[i] + std::conj(c[n - i]));
-      // TODO could get exp() from static exparray
-      // the nice thing about this code that it works even when the length is not a power of 2
-      // (but of course, the call to fourier_1d would currently abort in that case)
-      const complex_t t2 = std::exp(complex_t(0, static_cast<T>(sign * (i * _PI) / n - _PI / 2))) * (c[i] - std::conj(c[n - i]));
+      // exp(i*(sign*i*pi/n - pi/2)) * (c[i] - conj(c[n-i]))
+      const complex_t t2 = complex_t(plan_sptr->get_half_twiddle(i)) * complex_t(0, -1) * (c[i] - std::conj(c[n - i]));
 
       c[i] = (t1 + t2);
       c[n - i] = std::conj(t1 - t2);
@@ -211,8 +308,8 @@ inverse_fourier_1d_for_real_data_corrupting_input(Array<1, std::complex<T>>& c,
   assert(c.get_min_index() == 0);
   assert(sign == 1 || sign == -1);
   const int n = c.get_length() - 1;
-  if (n % 2 != 0)
-    error("inverse_fourier_1d_of_real_data can only handle arrays of even length.\n");
+  if (n < 1)
+    error("inverse_fourier_1d_of_real_data needs an array of at least 2 elements.\n");
 
   /* Problematic asserts to check that the imaginary part of c[0] and c[n] is 0
      Trouble is that it could be only approximately 0 (e.g. when calling
@@ -225,11 +322,12 @@ inverse_fourier_1d_for_real_data_corrupting_input(Array<1, std::complex<T>>& c,
   */
   // assert(fabs(c[0].imag())<=.001*norm(c.begin_all(),c.end_all())/sqrt(n+1.)); // note divide by n+1 to avoid division by 0
   // assert(fabs(c[n].imag())<=.001*norm(c.begin_all(),c.end_all())/sqrt(n+1.));
+  const auto plan_sptr = FourierTransformPlan::get_plan(n, -sign);
   for (int i = 1; i <= n / 2; ++i)
     {
       const complex_t t1 = (c[i] + std::conj(c[n - i]));
-      // TODO could get exp() from static exparray
-      const complex_t t2 = std::exp(complex_t(0, static_cast<T>(-sign * (i * _PI) / n + _PI / 2))) * (c[i] - std::conj(c[n - i]));
+      // exp(i*(-sign*i*pi/n + pi/2)) * (c[i] - conj(c[n-i]))
+      const complex_t t2 = complex_t(plan_sptr->get_half_twiddle(i)) * complex_t(0, 1) * (c[i] - std::conj(c[n - i]));
 
       c[i] = (t1 + t2);
       c[n - i] = std::conj(t1 - t2);
@@ -284,6 +382,9 @@ struct fourier_for_real_data_auxiliary
     min_index[1] = c.get_min_index();
     max_index[1] = c.get_max_index();
     Array<num_dimensions, std::complex<elemT>> array(IndexRange<num_dimensions>(min_index, max_index));
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
     for (int i = c.get_min_index(); i <= c.get_max_index(); ++i)
       array[i] = fourier_for_real_data(c[i], sign);
     fourier_1d(array, sign);
@@ -303,6 +404,9 @@ struct fourier_for_real_data_auxiliary
     max_index[1] = c.get_max_index();
     Array<num_dimensions, elemT> array(IndexRange<num_dimensions>(min_index, max_index));
 
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
     for (int i = c.get_min_index(); i <= c.get_max_index(); ++i)
       array[i] = inverse_fourier_for_real_data_corrupting_input(c[i], sign);
     return array;
@@ -31,16 +31,37 @@
 #include "stir/error.h"
 #include "stir/is_null_ptr.h"
 #include "stir/DataProcessor.h"
+#include "stir/warning.h"
+#include "stir/HighResWallClockTimer.h"
 #include <vector>
 #ifdef STIR_OPENMP
 #  include "stir/is_null_ptr.h"
 #  include "stir/DiscretisedDensity.h"
+#  include <algorithm>
 #  include <omp.h>
 #endif
 #include <boost/format.hpp>
 
 START_NAMESPACE_STIR
 
+#ifdef STIR_OPENMP
+class BackProjectorByBin::LocalOutputImageGuard
+{
+public:
+  explicit LocalOutputImageGuard(BackProjectorByBin& back_projector)
+      : back_projector(back_projector),
+        image_num(back_projector.acquire_local_output_image())
+  {}
+  ~LocalOutputImageGuard() { back_projector.release_local_output_image(); }
+
+  LocalOutputImageGuard(const LocalOutputImageGuard&) = delete;
+  LocalOutputImageGuard& operator=(const LocalOutputImageGuard&) = delete;
+
+  BackProjectorByBin& back_projector;
+  const int image_num;
+};
+#endif
+
 BackProjectorByBin::BackProjectorByBin()
     : _already_set_up(false)
 {
@@ -54,6 +75,7 @@ void
 BackProjectorByBin::set_defaults()
 {
   _post_data_processor_sptr.reset();
+  _thread_local_images_memory_budget_in_MB = 0.F;
 }
 
 void
@@ -62,6 +84,32 @@ BackProjectorByBin::initialise_keymap()
   parser.add_start_key("Back Projector Parameters");
   parser.add_stop_key("End Back Projector Parameters");
   parser.add_parsing_key("post data processor", &_post_data_processor_sptr);
+  parser.add_key("memory budget for thread-local images (MB)", &_thread_local_images_memory_budget_in_MB);
+}
+
+bool
+BackProjectorByBin::post_processing()
+{
+  if (_thread_local_images_memory_budget_in_MB < 0)
+    {
+      warning("BackProjectorByBin: memory budget for thread-local images should not be negative");
+      return true;
+    }
+  return false;
+}
+
+void
+BackProjectorByBin::set_thread_local_images_memory_budget_in_MB(const float budget)
+{
+  if (budget < 0)
+    error("BackProjectorByBin: memory budget for thread-local images should not be negative");
+  _thread_local_images_memory_budget_in_MB = budget;
+}
+
+float
+BackProjectorByBin::get_thread_local_images_memory_budget_in_MB() const
+{
+  return _thread_local_images_memory_budget_in_MB;
 }
 
 void
@@ -73,11 +121,30 @@ BackProjectorByBin::set_up(const shared_ptr<const ProjDataInfo>& proj_data_info_
   _density_sptr.reset(density_info_sptr->clone());
 
 #ifdef STIR_OPENMP
+  int num_threads = 1;
 #  pragma omp parallel
   {
 #  pragma omp single
-    _local_output_image_sptrs.resize(omp_get_num_threads(), shared_ptr<DiscretisedDensity<3, float>>());
+    num_threads = omp_get_num_threads();
   }
+  int num_images = num_threads;
+  const double image_size_in_MB
+      = static_cast<double>(density_info_sptr->size_all()) * sizeof(float) / (1024. * 1024.);
+  if (_thread_local_images_memory_budget_in_MB > 0)
+    {
+      const int max_num_images = static_cast<int>(_thread_local_images_memory_budget_in_MB / image_size_in_MB);
+      if (max_num_images < 1)
+        warning(boost::format("BackProjectorByBin: memory budget for thread-local images (%1% MB) is smaller than the size of "
+                              "one image (%2% MB). Using 1 image.")
+                % _thread_local_images_memory_budget_in_MB % image_size_in_MB);
+      num_images = std::max(1, std::min(num_threads, max_num_images));
+    }
+  info(boost::format("BackProjectorByBin: using %1% thread-local images (%2% MB) for %3% threads") % num_images
+           % (num_images * image_size_in_MB) % num_threads,
+       2);
+  _local_output_image_sptrs.resize(num_images, shared_ptr<DiscretisedDensity<3, float>>());
+  _local_output_image_in_use.assign(num_images, 0);
+  _local_output_image_index_for_thread.assign(num_threads, -1);
   for (int i = 0; i < static_cast<int>(_local_output_image_sptrs.size()); ++i)
     if (!is_null_ptr(_local_output_image_sptrs[i])) // already created in previous run
       if (!_local_output_image_sptrs[i]->has_same_characteristics(*density_info_sptr))
@@ -228,6 +295,144 @@ BackProjectorByBin::back_project(const ProjData& proj_data, int subset_num, int
     }
 }
 
+void
+BackProjectorByBin::back_project(const std::vector<DiscretisedDensity<3, float>*>& density_ptrs,
+                                 const std::vector<const ProjData*>& proj_data_ptrs,
+                                 int subset_num,
+                                 int num_subsets)
+{
+  if (proj_data_ptrs.size() != density_ptrs.size())
+    error("back_project: the number of projection data and images should be the same");
+  if (proj_data_ptrs.empty())
+    return;
+  const std::size_t num_images = density_ptrs.size();
+  bool project_simultaneously = num_images > 1 && this->can_project_multiple_images_simultaneously();
+#ifdef STIR_OPENMP
+  const int num_threads = omp_get_max_threads();
+  if (project_simultaneously && _thread_local_images_memory_budget_in_MB > 0)
+    {
+      const double needed_MB
+          = static_cast<double>(num_threads) * num_images * density_ptrs[0]->size_all() * sizeof(float) / (1024. * 1024.);
+      if (needed_MB > _thread_local_images_memory_budget_in_MB)
+        {
+          info(boost::format("BackProjectorByBin: back projecting %1% images one by one, as the thread-local images would need "
+                             "%2% MB")
+                   % num_images % needed_MB,
+               2);
+          project_simultaneously = false;
+        }
+    }
+#endif
+  if (!project_simultaneously)
+    {
+      for (std::size_t n = 0; n < num_images; ++n)
+        back_project(*density_ptrs[n], *proj_data_ptrs[n], subset_num, num_subsets);
+      return;
+    }
+
+  const ProjData& first_proj_data = *proj_data_ptrs[0];
+  for (std::size_t n = 0; n < num_images; ++n)
+    {
+      if (*proj_data_ptrs[n]->get_proj_data_info_sptr() != *first_proj_data.get_proj_data_info_sptr())
+        error("back_project: all projection data should have the same characteristics");
+      check(*proj_data_ptrs[n]->get_proj_data_info_sptr(), *density_ptrs[n]);
+    }
+
+  shared_ptr<DataSymmetriesForViewSegmentNumbers> symmetries_sptr(this->get_symmetries_used()->clone());
+
+  const std::vector<ViewSegmentNumbers> vs_nums_to_process
+      = detail::find_basic_vs_nums_in_subset(*first_proj_data.get_proj_data_info_sptr(),
+                                             *symmetries_sptr,
+                                             first_proj_data.get_min_segment_num(),
+                                             first_proj_data.get_max_segment_num(),
+                                             subset_num,
+                                             num_subsets);
+  const int min_tof_pos_num = first_proj_data.get_proj_data_info_sptr()->get_min_tof_pos_num();
+  const int max_tof_pos_num = first_proj_data.get_proj_data_info_sptr()->get_max_tof_pos_num();
+
+#ifdef STIR_OPENMP
+  // every thread accumulates in its own set of images, allocated when the thread first needs them
+  std::vector<std::vector<shared_ptr<DiscretisedDensity<3, float>>>> local_image_sptrs(num_threads);
+#else
+  for (auto density_ptr : density_ptrs)
+    density_ptr->fill(0.F);
+#endif
+
+#ifdef STIR_OPENMP
+#  if _OPENMP < 201107
+#    pragma omp parallel for shared(proj_data_ptrs, symmetries_sptr, local_image_sptrs) schedule(dynamic)
+#  else
+// OpenMP loop over both vs_nums_to_process and tof_pos_num
+#    pragma omp parallel for shared(proj_data_ptrs, symmetries_sptr, local_image_sptrs) schedule(dynamic) collapse(2)
+#  endif
+#endif
+  // note: older versions of openmp need an int as loop
+  for (int i = 0; i < static_cast<int>(vs_nums_to_process.size()); ++i)
+    {
+      for (int k = min_tof_pos_num; k <= max_tof_pos_num; ++k)
+        {
+          const ViewSegmentNumbers vs = vs_nums_to_process[i];
+          std::vector<RelatedViewgrams<float>> all_viewgrams(num_images);
+          std::vector<const RelatedViewgrams<float>*> viewgrams_ptrs;
+#ifdef STIR_OPENMP
+#  pragma omp critical(BACKPROJECTORBYBIN_GETVIEWGRAMS)
+#endif
+          {
+            for (std::size_t n = 0; n < num_images; ++n)
+              all_viewgrams[n] = proj_data_ptrs[n]->get_related_viewgrams(vs, symmetries_sptr, false, k);
+          }
+          for (const auto& viewgrams : all_viewgrams)
+            viewgrams_ptrs.push_back(&viewgrams);
+          info(boost::format("Processing view %1% of segment %2%, TOF bin %3% for %4% images") % vs.view_num() % vs.segment_num()
+                   % k % num_images,
+               3);
+
+#ifdef STIR_OPENMP
+          auto& thread_image_sptrs = local_image_sptrs[omp_get_thread_num()];
+          if (thread_image_sptrs.empty())
+            for (auto density_ptr : density_ptrs)
+              thread_image_sptrs.push_back(shared_ptr<DiscretisedDensity<3, float>>(density_ptr->get_empty_copy()));
+          std::vector<DiscretisedDensity<3, float>*> target_ptrs;
+          for (const auto& image_sptr : thread_image_sptrs)
+            target_ptrs.push_back(image_sptr.get());
+#else
+          const std::vector<DiscretisedDensity<3, float>*>& target_ptrs = density_ptrs;
+#endif
+          actual_back_project(target_ptrs,
+                              viewgrams_ptrs,
+                              all_viewgrams[0].get_min_axial_pos_num(),
+                              all_viewgrams[0].get_max_axial_pos_num(),
+                              all_viewgrams[0].get_min_tangential_pos_num(),
+                              all_viewgrams[0].get_max_tangential_pos_num());
+        }
+    }
+
+#ifdef STIR_OPENMP
+  // "reduce" data constructed by threads, parallelising over planes
+  for (std::size_t n = 0; n < num_images; ++n)
+    {
+      DiscretisedDensity<3, float>& density = *density_ptrs[n];
+#  pragma omp parallel for schedule(static)
+      for (int z = density.get_min_index(); z <= density.get_max_index(); ++z)
+        {
+          density[z].fill(0.F);
+          for (const auto& thread_image_sptrs : local_image_sptrs)
+            if (!thread_image_sptrs.empty()) // only accumulate if this thread filled something in
+              density[z] += (*thread_image_sptrs[n])[z];
+        }
+    }
+#endif
+
+  // If a post-back-projection data processor has been set, apply it.
+  if (!is_null_ptr(_post_data_processor_sptr))
+    for (auto density_ptr : density_ptrs)
+      {
+        Succeeded success = _post_data_processor_sptr->apply(*density_ptr);
+        if (success != Succeeded::yes)
+          throw std::runtime_error("BackProjectorByBin::back_project(). Post-back-projection data processor failed.");
+      }
+}
+
 void
 BackProjectorByBin::back_project(const RelatedViewgrams<float>& viewgrams)
 {
@@ -265,11 +470,6 @@ BackProjectorByBin::back_project(const RelatedViewgrams<float>& viewgrams,
 
   check(*viewgrams.get_proj_data_info_sptr());
 
-#ifdef STIR_OPENMP
-  const int thread_num = omp_get_thread_num();
-  if (is_null_ptr(_local_output_image_sptrs[thread_num]))
-    _local_output_image_sptrs[thread_num].reset(_density_sptr->get_empty_copy());
-#endif
 
   // first check symmetries
   {
@@ -289,9 +489,64 @@ BackProjectorByBin::back_project(const RelatedViewgrams<float>& viewgrams,
       }
   }
 
+#ifdef STIR_OPENMP
+  const LocalOutputImageGuard image_guard(*this);
+  if (is_null_ptr(_local_output_image_sptrs[image_guard.image_num]))
+    _local_output_image_sptrs[image_guard.image_num].reset(_density_sptr->get_empty_copy());
+#endif
+
   actual_back_project(viewgrams, min_axial_pos_num, max_axial_pos_num, min_tangential_pos_num, max_tangential_pos_num);
 }
 
+#ifdef STIR_OPENMP
+int
+BackProjectorByBin::acquire_local_output_image()
+{
+  const int thread_num = omp_get_thread_num();
+  const int num_images = static_cast<int>(_local_output_image_sptrs.size());
+  if (thread_num >= static_cast<int>(_local_output_image_index_for_thread.size()))
+    error("BackProjectorByBin: more threads are used than when set_up() was called");
+  // one image per thread, so nothing to do
+  if (num_images == static_cast<int>(_local_output_image_index_for_thread.size()))
+    return thread_num;
+
+  int image_num = -1;
+  std::unique_lock<std::mutex> lock(_local_output_images_sync.mutex);
+  // wait until another thread has released an image
+  _local_output_images_sync.image_released.wait(lock, [&]() {
+    // start the search at a thread-dependent location to avoid all threads competing for the same image
+    for (int i = 0; i < num_images; ++i)
+      {
+        const int candidate = (thread_num + i) % num_images;
+        if (!_local_output_image_in_use[candidate])
+          {
+            _local_output_image_in_use[candidate] = 1;
+            image_num = candidate;
+            return true;
+          }
+      }
+    return false;
+  });
+  lock.unlock();
+  _local_output_image_index_for_thread[thread_num] = image_num;
+  return image_num;
+}
+
+void
+BackProjectorByBin::release_local_output_image()
+{
+  const int thread_num = omp_get_thread_num();
+  if (_local_output_image_sptrs.size() == _local_output_image_index_for_thread.size())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(_local_output_images_sync.mutex);
+    _local_output_image_in_use[_local_output_image_index_for_thread[thread_num]] = 0;
+  }
+  _local_output_image_index_for_thread[thread_num] = -1;
+  _local_output_images_sync.image_released.notify_one();
+}
+#endif
+
 void
 BackProjectorByBin::start_accumulating_in_new_target()
 {
@@ -325,12 +580,26 @@ BackProjectorByBin::get_output(DiscretisedDensity<3, float>& density) const
 
   // "reduce" data constructed by threads
   {
-    density.fill(0.F);
+    HighResWallClockTimer timer;
+    timer.start();
+    std::vector<shared_ptr<DiscretisedDensity<3, float>>> filled_image_sptrs;
     for (int i = 0; i < static_cast<int>(_local_output_image_sptrs.size()); ++i)
       {
         if (!is_null_ptr(_local_output_image_sptrs[i])) // only accumulate if a thread filled something in
-          density += *(_local_output_image_sptrs[i]);
+          filled_image_sptrs.push_back(_local_output_image_sptrs[i]);
       }
+    // parallelise over planes, such that every thread sums over all images for its planes
+#  pragma omp parallel for schedule(static)
+    for (int z = density.get_min_index(); z <= density.get_max_index(); ++z)
+      {
+        density[z].fill(0.F);
+        for (const auto& image_sptr : filled_image_sptrs)
+          density[z] += (*image_sptr)[z];
+      }
+    timer.stop();
+    info(boost::format("BackProjectorByBin: summing %1% thread-local images took %2% s") % filled_image_sptrs.size()
+             % timer.value(),
+         3);
   }
 #else
   std::copy(_density_sptr->begin_all(), _density_sptr->end_all(), density.begin_all());
@@ -351,6 +620,23 @@ BackProjectorByBin::set_post_data_processor(shared_ptr<DataProcessor<Discretised
   _post_data_processor_sptr = post_data_processor_sptr;
 }
 
+bool
+BackProjectorByBin::can_project_multiple_images_simultaneously() const
+{
+  return false;
+}
+
+void
+BackProjectorByBin::actual_back_project(const std::vector<DiscretisedDensity<3, float>*>&,
+                                        const std::vector<const RelatedViewgrams<float>*>&,
+                                        const int,
+                                        const int,
+                                        const int,
+                                        const int)
+{
+  error("BackProjectorByBin::actual_back_project() for multiple images is not implemented for this projector.");
+}
+
 void
 BackProjectorByBin::actual_back_project(
     DiscretisedDensity<3, float>&, const RelatedViewgrams<float>&, const int, const int, const int, const int)
@@ -368,7 +654,10 @@ BackProjectorByBin::actual_back_project(const RelatedViewgrams<float>& viewgrams
   shared_ptr<DiscretisedDensity<3, float>> density_sptr = _density_sptr;
 #ifdef STIR_OPENMP
   const int thread_num = omp_get_thread_num();
-  density_sptr = _local_output_image_sptrs[thread_num];
+  if (_local_output_image_sptrs.size() == _local_output_image_index_for_thread.size())
+    density_sptr = _local_output_image_sptrs[thread_num];
+  else
+    density_sptr = _local_output_image_sptrs[_local_output_image_index_for_thread[thread_num]];
 #endif
   actual_back_project(
       *density_sptr, viewgrams, min_axial_pos_num, max_axial_pos_num, min_tangential_pos_num, max_tangential_pos_num);
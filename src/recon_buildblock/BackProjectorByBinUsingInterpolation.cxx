@@ -67,6 +67,7 @@ BackProjectorByBinUsingInterpolation::set_defaults()
   // next 2 can be set to false but are ignored anyway
   do_symmetry_swap_s = true;
   do_symmetry_shift_z = true;
+  BackProjectorByBin::set_defaults();
 }
 
 void
@@ -84,6 +85,7 @@ BackProjectorByBinUsingInterpolation::initialise_keymap()
   parser.add_key("do_symmetry_swap_s", &do_symmetry_swap_s);
   parser.add_key("do_symmetry_shift_z", &do_symmetry_shift_z);
 #endif
+  BackProjectorByBin::initialise_keymap();
 }
 
 const DataSymmetriesForViewSegmentNumbers*
@@ -63,8 +63,8 @@ BackProjectorByBinUsingProjMatrixByBin::initialise_keymap()
 bool
 BackProjectorByBinUsingProjMatrixByBin::post_processing()
 {
-  // if (BackProjectorByBin::post_processing() == true)
-  //   return true;
+  if (BackProjectorByBin::post_processing() == true)
+    return true;
   if (is_null_ptr(proj_matrix_ptr))
     {
       warning("BackProjectorByBinUsingProjMatrixByBin: matrix not set.\n");
@@ -102,6 +102,12 @@ BackProjectorByBinUsingProjMatrixByBin::get_symmetries_used() const
   return proj_matrix_ptr->get_symmetries_ptr();
 }
 
+bool
+BackProjectorByBinUsingProjMatrixByBin::can_project_multiple_images_simultaneously() const
+{
+  return true;
+}
+
 void
 BackProjectorByBinUsingProjMatrixByBin::actual_back_project(DiscretisedDensity<3, float>& image,
                                                             const RelatedViewgrams<float>& viewgrams,
@@ -110,6 +116,47 @@ BackProjectorByBinUsingProjMatrixByBin::actual_back_project(DiscretisedDensity<3
                                                             const int min_tangential_pos_num,
                                                             const int max_tangential_pos_num)
 {
+  actual_back_project(vector<DiscretisedDensity<3, float>*>(1, &image),
+                      vector<const RelatedViewgrams<float>*>(1, &viewgrams),
+                      min_axial_pos_num,
+                      max_axial_pos_num,
+                      min_tangential_pos_num,
+                      max_tangential_pos_num);
+}
+
+void
+BackProjectorByBinUsingProjMatrixByBin::actual_back_project(const vector<DiscretisedDensity<3, float>*>& image_ptrs,
+                                                            const vector<const RelatedViewgrams<float>*>& viewgrams_ptrs,
+                                                            const int min_axial_pos_num,
+                                                            const int max_axial_pos_num,
+                                                            const int min_tangential_pos_num,
+                                                            const int max_tangential_pos_num)
+{
+  assert(viewgrams_ptrs.size() == image_ptrs.size());
+  if (viewgrams_ptrs.empty())
+    return;
+  const std::size_t num_images = image_ptrs.size();
+  // all viewgrams have the same coordinates, so we use the first one to find those
+  const RelatedViewgrams<float>& first_viewgrams = *viewgrams_ptrs[0];
+  // values of the current bin for every image
+  vector<float> bin_values(num_images);
+  // construct these only once, as setting up the table of row pointers is not cheap
+  vector<DiscretisedDensityAccess> image_accesses;
+  for (const auto image_ptr : image_ptrs)
+    image_accesses.push_back(DiscretisedDensityAccess(*image_ptr));
+  // reserve enough memory for the rows such that they do not need to be reallocated
+  const int row_capacity = static_cast<int>(proj_matrix_ptr->get_max_num_elems_per_row_estimate());
+  // fills bin_values and returns true if any of them is non-zero
+  auto get_bin_values = [&](const int viewgram_num, const int ax_pos, const int tang_pos) {
+    bool any_non_zero = false;
+    for (std::size_t n = 0; n < num_images; ++n)
+      {
+        bin_values[n] = (*(viewgrams_ptrs[n]->begin() + viewgram_num))[ax_pos][tang_pos];
+        any_non_zero = any_non_zero || bin_values[n] != 0;
+      }
+    return any_non_zero;
+  };
+
   if (proj_matrix_ptr->is_cache_enabled()/* &&
 					    !proj_matrix_ptr->does_cache_store_only_basic_bins()*/)
     {
@@ -117,13 +164,11 @@ BackProjectorByBinUsingProjMatrixByBin::actual_back_project(DiscretisedDensity<3
       // symmetries
       // would be slow if there's no caching at all, but is very fast if everything is cached
 
-      ProjMatrixElemsForOneBin proj_matrix_row;
-
-      RelatedViewgrams<float>::const_iterator r_viewgrams_iter = viewgrams.begin();
+      ProjMatrixElemsForOneBin proj_matrix_row(Bin(), row_capacity);
 
-      while (r_viewgrams_iter != viewgrams.end())
+      for (int viewgram_num = 0; viewgram_num < first_viewgrams.get_num_viewgrams(); ++viewgram_num)
         {
-          const Viewgram<float>& viewgram = *r_viewgrams_iter;
+          const Viewgram<float>& viewgram = *(first_viewgrams.begin() + viewgram_num);
           const int view_num = viewgram.get_view_num();
           const int segment_num = viewgram.get_segment_num();
           const int timing_num = viewgram.get_timing_pos_num();
@@ -132,21 +177,20 @@ BackProjectorByBinUsingProjMatrixByBin::actual_back_project(DiscretisedDensity<3
             for (int ax_pos = min_axial_pos_num; ax_pos <= max_axial_pos_num; ++ax_pos)
               {
                 // KT 21/02/2002 added check on 0
-                if (viewgram[ax_pos][tang_pos] == 0)
+                if (!get_bin_values(viewgram_num, ax_pos, tang_pos))
                   continue;
-                Bin bin(segment_num, view_num, ax_pos, tang_pos, timing_num, viewgram[ax_pos][tang_pos]);
+                Bin bin(segment_num, view_num, ax_pos, tang_pos, timing_num);
                 proj_matrix_ptr->get_proj_matrix_elems_for_one_bin(proj_matrix_row, bin);
-                proj_matrix_row.back_project(image, bin);
+                proj_matrix_row.back_project(image_accesses, bin_values);
               }
-          ++r_viewgrams_iter;
         }
     }
   else
     {
       // complicated version which handles the symmetries explicitly
       // faster when no caching is performed, about just as fast when there is caching
-      ProjMatrixElemsForOneBin proj_matrix_row;
-      ProjMatrixElemsForOneBin proj_matrix_row_copy;
+      ProjMatrixElemsForOneBin proj_matrix_row(Bin(), row_capacity);
+      ProjMatrixElemsForOneBin proj_matrix_row_copy(Bin(), row_capacity);
       const DataSymmetriesForBins* symmetries = proj_matrix_ptr->get_symmetries_ptr();
 
       Array<2, int> already_processed(
@@ -159,11 +203,11 @@ BackProjectorByBinUsingProjMatrixByBin::actual_back_project(DiscretisedDensity<3
             if (already_processed[ax_pos][tang_pos])
               continue;
 
-            Bin basic_bin(viewgrams.get_basic_segment_num(),
-                          viewgrams.get_basic_view_num(),
+            Bin basic_bin(first_viewgrams.get_basic_segment_num(),
+                          first_viewgrams.get_basic_view_num(),
                           ax_pos,
                           tang_pos,
-                          viewgrams.get_basic_timing_pos_num());
+                          first_viewgrams.get_basic_timing_pos_num());
             symmetries->find_basic_bin(basic_bin);
 
             proj_matrix_ptr->get_proj_matrix_elems_for_one_bin(proj_matrix_row, basic_bin);
@@ -189,19 +233,18 @@ BackProjectorByBinUsingProjMatrixByBin::actual_back_project(DiscretisedDensity<3
 
                 already_processed[axial_pos_tmp][tang_pos_tmp] = 1;
 
-                for (RelatedViewgrams<float>::const_iterator viewgram_iter = viewgrams.begin(); viewgram_iter != viewgrams.end();
-                     ++viewgram_iter)
+                for (int viewgram_num = 0; viewgram_num < first_viewgrams.get_num_viewgrams(); ++viewgram_num)
                   {
                     // KT 21/02/2002 added check on 0
-                    if ((*viewgram_iter)[axial_pos_tmp][tang_pos_tmp] == 0)
+                    if (!get_bin_values(viewgram_num, axial_pos_tmp, tang_pos_tmp))
                       continue;
+                    const Viewgram<float>& viewgram = *(first_viewgrams.begin() + viewgram_num);
                     proj_matrix_row_copy = proj_matrix_row;
-                    Bin bin(viewgram_iter->get_segment_num(),
-                            viewgram_iter->get_view_num(),
+                    Bin bin(viewgram.get_segment_num(),
+                            viewgram.get_view_num(),
                             axial_pos_tmp,
                             tang_pos_tmp,
-                            viewgram_iter->get_timing_pos_num(),
-                            (*viewgram_iter)[axial_pos_tmp][tang_pos_tmp]);
+                            viewgram.get_timing_pos_num());
 
                     unique_ptr<SymmetryOperation> symm_op_ptr = symmetries->find_symmetry_operation_from_basic_bin(bin);
                     // TODO replace with Bin::compare_coordinates or so
@@ -211,8 +254,9 @@ BackProjectorByBinUsingProjMatrixByBin::actual_back_project(DiscretisedDensity<3
                     assert(bin.tangential_pos_num() == basic_bin.tangential_pos_num());
                     assert(bin.timing_pos_num() == basic_bin.timing_pos_num());
 
+                    // the transformed row is used for all images
                     symm_op_ptr->transform_proj_matrix_elems_for_one_bin(proj_matrix_row_copy);
-                    proj_matrix_row_copy.back_project(image, bin);
+                    proj_matrix_row_copy.back_project(image_accesses, bin_values);
                   }
               }
           }
@@ -224,7 +268,7 @@ BackProjectorByBinUsingProjMatrixByBin::actual_back_project(DiscretisedDensity<3
 void
 BackProjectorByBinUsingProjMatrixByBin::actual_back_project(DiscretisedDensity<3, float>& image, const Bin& bin)
 {
-  ProjMatrixElemsForOneBin proj_matrix_row;
+  ProjMatrixElemsForOneBin proj_matrix_row(Bin(), static_cast<int>(proj_matrix_ptr->get_max_num_elems_per_row_estimate()));
   proj_matrix_ptr->get_proj_matrix_elems_for_one_bin(proj_matrix_row, bin);
   proj_matrix_row.back_project(image, bin);
 }
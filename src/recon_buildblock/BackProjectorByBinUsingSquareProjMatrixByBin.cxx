@@ -38,6 +38,7 @@ void
 BackProjectorByBinUsingSquareProjMatrixByBin::set_defaults()
 {
   this->proj_matrix_ptr.reset();
+  BackProjectorByBin::set_defaults();
 }
 
 BackProjectorByBinUsingSquareProjMatrixByBin::BackProjectorByBinUsingSquareProjMatrixByBin(
@@ -108,6 +109,7 @@ BackProjectorByBinUsingSquareProjMatrixByBin::initialise_keymap()
   parser.add_start_key("Back Projector ( Square) Using Matrix Parameters");
   parser.add_stop_key("End Back Projector ( Square) Using Matrix Parameters");
   parser.add_parsing_key("matrix type", &proj_matrix_ptr);
+  BackProjectorByBin::initialise_keymap();
 }
 
 BackProjectorByBinUsingSquareProjMatrixByBin::BackProjectorByBinUsingSquareProjMatrixByBin()
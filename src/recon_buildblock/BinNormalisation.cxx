@@ -2,7 +2,7 @@
 //
 /*
     Copyright (C) 2003- 2007, Hammersmith Imanet Ltd
-    Copyright (C) 2014, 2018 University College London
+    Copyright (C) 2014, 2018, 2026 University College London
     This file is part of STIR.
 
     SPDX-License-Identifier: Apache-2.0
@@ -22,23 +22,80 @@
 #include "stir/recon_buildblock/TrivialDataSymmetriesForBins.h"
 #include "stir/recon_buildblock/find_basic_vs_nums_in_subsets.h"
 #include "stir/RelatedViewgrams.h"
+#include "stir/Viewgram.h"
+#include "stir/ProjDataInfo.h"
 #include "stir/Bin.h"
 #include "stir/ProjData.h"
 #include "stir/is_null_ptr.h"
 #include "stir/Succeeded.h"
 #include "stir/error.h"
+#include "stir/info.h"
+#include "stir/numerics/half_float.h"
 #include <boost/format.hpp>
+#include <algorithm>
+#include <cmath>
 
 START_NAMESPACE_STIR
 
+//! efficiencies for one viewgram, stored as float or fp16
+/*! For fp16, values are divided by the maximum (absolute) value in the viewgram to avoid overflow. */
+class BinNormalisation::CachedViewgramEfficiencies
+{
+public:
+  int min_axial_pos_num;
+  int max_axial_pos_num;
+  int min_tangential_pos_num;
+  int max_tangential_pos_num;
+  std::vector<float> values;
+  std::vector<std::uint16_t> half_values;
+  float scale_factor_for_half_values;
+
+  int get_num_tangential_poss() const { return max_tangential_pos_num - min_tangential_pos_num + 1; }
+
+  bool has_same_ranges(const Viewgram<float>& viewgram) const
+  {
+    return min_axial_pos_num == viewgram.get_min_axial_pos_num() && max_axial_pos_num == viewgram.get_max_axial_pos_num()
+           && min_tangential_pos_num == viewgram.get_min_tangential_pos_num()
+           && max_tangential_pos_num == viewgram.get_max_tangential_pos_num();
+  }
+
+  //! get the efficiency for the \a i-th bin (in axial-tangential order)
+  float get(const std::size_t i) const
+  {
+    return values.empty() ? half_to_float(half_values[i]) * scale_factor_for_half_values : values[i];
+  }
+
+  std::size_t num_bytes() const
+  {
+    return sizeof(*this) + values.size() * sizeof(float) + half_values.size() * sizeof(std::uint16_t);
+  }
+};
+
 BinNormalisation::BinNormalisation()
-    : _already_set_up(false)
+    : _already_set_up(false),
+      _cache_bin_efficiencies(false),
+      _cached_bin_efficiencies_memory_budget_in_MB(0),
+      _store_cached_bin_efficiencies_as_fp16(false),
+      _cached_efficiencies_num_bytes(0),
+      _cached_efficiencies_memory_budget_reached(false)
 {}
 
 void
 BinNormalisation::set_defaults()
 {
   this->_already_set_up = false;
+  this->_cache_bin_efficiencies = false;
+  this->_cached_bin_efficiencies_memory_budget_in_MB = 0;
+  this->_store_cached_bin_efficiencies_as_fp16 = false;
+  this->clear_cached_efficiencies();
+}
+
+void
+BinNormalisation::initialise_keymap()
+{
+  this->parser.add_key("cache bin efficiencies", &this->_cache_bin_efficiencies);
+  this->parser.add_key("memory budget for cached bin efficiencies (MB)", &this->_cached_bin_efficiencies_memory_budget_in_MB);
+  this->parser.add_key("store cached bin efficiencies as fp16", &this->_store_cached_bin_efficiencies_as_fp16);
 }
 
 BinNormalisation::~BinNormalisation()
@@ -56,6 +113,45 @@ BinNormalisation::get_exam_info_sptr() const
   return this->exam_info_sptr;
 }
 
+void
+BinNormalisation::set_cache_bin_efficiencies(const bool arg)
+{
+  this->_cache_bin_efficiencies = arg;
+  this->clear_cached_efficiencies();
+}
+
+bool
+BinNormalisation::get_cache_bin_efficiencies() const
+{
+  return this->_cache_bin_efficiencies;
+}
+
+void
+BinNormalisation::set_cached_bin_efficiencies_memory_budget_in_MB(const double arg)
+{
+  this->_cached_bin_efficiencies_memory_budget_in_MB = arg;
+  this->clear_cached_efficiencies();
+}
+
+double
+BinNormalisation::get_cached_bin_efficiencies_memory_budget_in_MB() const
+{
+  return this->_cached_bin_efficiencies_memory_budget_in_MB;
+}
+
+void
+BinNormalisation::set_store_cached_bin_efficiencies_as_fp16(const bool arg)
+{
+  this->_store_cached_bin_efficiencies_as_fp16 = arg;
+  this->clear_cached_efficiencies();
+}
+
+bool
+BinNormalisation::get_store_cached_bin_efficiencies_as_fp16() const
+{
+  return this->_store_cached_bin_efficiencies_as_fp16;
+}
+
 Succeeded
 BinNormalisation::set_up(const shared_ptr<const ExamInfo>& exam_info_sptr_v,
                          const shared_ptr<const ProjDataInfo>& proj_data_info_sptr_v)
@@ -63,9 +159,122 @@ BinNormalisation::set_up(const shared_ptr<const ExamInfo>& exam_info_sptr_v,
   _already_set_up = true;
   this->proj_data_info_sptr = proj_data_info_sptr_v;
   this->exam_info_sptr = exam_info_sptr_v;
+  this->clear_cached_efficiencies();
   return Succeeded::yes;
 }
 
+void
+BinNormalisation::clear_cached_efficiencies()
+{
+  this->_cached_efficiencies.clear();
+  this->_cached_efficiencies_num_bytes = 0;
+  this->_cached_efficiencies_memory_budget_reached = false;
+}
+
+int
+BinNormalisation::get_cache_index(const Viewgram<float>& viewgram) const
+{
+  const ProjDataInfo& pdi = *this->proj_data_info_sptr;
+  const int segment_num = viewgram.get_segment_num();
+  const int view_num = viewgram.get_view_num();
+  const int timing_pos_num = viewgram.get_timing_pos_num();
+  if (segment_num < pdi.get_min_segment_num() || segment_num > pdi.get_max_segment_num() || view_num < pdi.get_min_view_num()
+      || view_num > pdi.get_max_view_num() || timing_pos_num < pdi.get_min_tof_pos_num()
+      || timing_pos_num > pdi.get_max_tof_pos_num())
+    return -1;
+  return ((timing_pos_num - pdi.get_min_tof_pos_num()) * pdi.get_num_segments() + (segment_num - pdi.get_min_segment_num()))
+             * pdi.get_num_views()
+         + (view_num - pdi.get_min_view_num());
+}
+
+shared_ptr<const BinNormalisation::CachedViewgramEfficiencies>
+BinNormalisation::get_cached_efficiencies(const Viewgram<float>& viewgram) const
+{
+  if (!this->_cache_bin_efficiencies)
+    return shared_ptr<const CachedViewgramEfficiencies>();
+  const int cache_index = this->get_cache_index(viewgram);
+  if (cache_index < 0)
+    return shared_ptr<const CachedViewgramEfficiencies>();
+
+  shared_ptr<const CachedViewgramEfficiencies> cached_sptr;
+  bool budget_reached;
+#ifdef STIR_OPENMP
+#  pragma omp critical(BINNORMALISATION_CACHE)
+#endif
+  {
+    if (this->_cached_efficiencies.empty())
+      this->_cached_efficiencies.resize(static_cast<std::size_t>(this->proj_data_info_sptr->get_num_tof_poss())
+                                        * this->proj_data_info_sptr->get_num_segments()
+                                        * this->proj_data_info_sptr->get_num_views());
+    cached_sptr = this->_cached_efficiencies[cache_index];
+    budget_reached = this->_cached_efficiencies_memory_budget_reached;
+  }
+  if (!is_null_ptr(cached_sptr))
+    return cached_sptr->has_same_ranges(viewgram) ? cached_sptr : shared_ptr<const CachedViewgramEfficiencies>();
+  if (budget_reached)
+    return cached_sptr;
+
+  // compute the efficiencies (without holding the lock, such that other threads can do the same)
+  auto new_sptr = std::make_shared<CachedViewgramEfficiencies>();
+  new_sptr->min_axial_pos_num = viewgram.get_min_axial_pos_num();
+  new_sptr->max_axial_pos_num = viewgram.get_max_axial_pos_num();
+  new_sptr->min_tangential_pos_num = viewgram.get_min_tangential_pos_num();
+  new_sptr->max_tangential_pos_num = viewgram.get_max_tangential_pos_num();
+  std::vector<float> values;
+  values.reserve(static_cast<std::size_t>(new_sptr->max_axial_pos_num - new_sptr->min_axial_pos_num + 1)
+                 * new_sptr->get_num_tangential_poss());
+  Bin bin(viewgram.get_segment_num(), viewgram.get_view_num(), 0, 0, viewgram.get_timing_pos_num());
+  for (bin.axial_pos_num() = new_sptr->min_axial_pos_num; bin.axial_pos_num() <= new_sptr->max_axial_pos_num;
+       ++bin.axial_pos_num())
+    for (bin.tangential_pos_num() = new_sptr->min_tangential_pos_num;
+         bin.tangential_pos_num() <= new_sptr->max_tangential_pos_num;
+         ++bin.tangential_pos_num())
+      values.push_back(this->get_bin_efficiency(bin));
+
+  if (this->_store_cached_bin_efficiencies_as_fp16)
+    {
+      float max_value = 0.F;
+      for (const float value : values)
+        max_value = std::max(max_value, std::abs(value));
+      new_sptr->scale_factor_for_half_values = max_value > 0 ? max_value : 1.F;
+      new_sptr->half_values.reserve(values.size());
+      for (const float value : values)
+        new_sptr->half_values.push_back(float_to_half(value / new_sptr->scale_factor_for_half_values));
+    }
+  else
+    {
+      new_sptr->scale_factor_for_half_values = 1.F;
+      new_sptr->values.swap(values);
+    }
+
+  const std::size_t memory_budget
+      = static_cast<std::size_t>(this->_cached_bin_efficiencies_memory_budget_in_MB * 1024 * 1024);
+#ifdef STIR_OPENMP
+#  pragma omp critical(BINNORMALISATION_CACHE)
+#endif
+  {
+    if (!is_null_ptr(this->_cached_efficiencies[cache_index]))
+      {
+        // another thread was faster
+      }
+    else if (memory_budget > 0 && this->_cached_efficiencies_num_bytes + new_sptr->num_bytes() > memory_budget)
+      {
+        if (!this->_cached_efficiencies_memory_budget_reached)
+          info(boost::format("BinNormalisation: memory budget for cached bin efficiencies (%1% MB) reached. "
+                             "Remaining efficiencies will not be cached.")
+                   % this->_cached_bin_efficiencies_memory_budget_in_MB,
+               2);
+        this->_cached_efficiencies_memory_budget_reached = true;
+      }
+    else
+      {
+        this->_cached_efficiencies[cache_index] = new_sptr;
+        this->_cached_efficiencies_num_bytes += new_sptr->num_bytes();
+      }
+  }
+  return new_sptr;
+}
+
 void
 BinNormalisation::check(const ProjDataInfo& proj_data_info) const
 {
@@ -93,6 +302,15 @@ BinNormalisation::apply(RelatedViewgrams<float>& viewgrams) const
   this->check(*viewgrams.get_proj_data_info_sptr());
   for (RelatedViewgrams<float>::iterator iter = viewgrams.begin(); iter != viewgrams.end(); ++iter)
     {
+      const auto cached_sptr = this->get_cached_efficiencies(*iter);
+      if (!is_null_ptr(cached_sptr))
+        {
+          std::size_t i = 0;
+          for (int a = iter->get_min_axial_pos_num(); a <= iter->get_max_axial_pos_num(); ++a)
+            for (int t = iter->get_min_tangential_pos_num(); t <= iter->get_max_tangential_pos_num(); ++t, ++i)
+              (*iter)[a][t] /= std::max(1.E-20F, cached_sptr->get(i));
+          continue;
+        }
       Bin bin(iter->get_segment_num(), iter->get_view_num(), 0, 0, iter->get_timing_pos_num());
       for (bin.axial_pos_num() = iter->get_min_axial_pos_num(); bin.axial_pos_num() <= iter->get_max_axial_pos_num();
            ++bin.axial_pos_num())
@@ -109,6 +327,15 @@ BinNormalisation::undo(RelatedViewgrams<float>& viewgrams) const
   this->check(*viewgrams.get_proj_data_info_sptr());
   for (RelatedViewgrams<float>::iterator iter = viewgrams.begin(); iter != viewgrams.end(); ++iter)
     {
+      const auto cached_sptr = this->get_cached_efficiencies(*iter);
+      if (!is_null_ptr(cached_sptr))
+        {
+          std::size_t i = 0;
+          for (int a = iter->get_min_axial_pos_num(); a <= iter->get_max_axial_pos_num(); ++a)
+            for (int t = iter->get_min_tangential_pos_num(); t <= iter->get_max_tangential_pos_num(); ++t, ++i)
+              (*iter)[a][t] *= cached_sptr->get(i);
+          continue;
+        }
       Bin bin(iter->get_segment_num(), iter->get_view_num(), 0, 0, iter->get_timing_pos_num());
       for (bin.axial_pos_num() = iter->get_min_axial_pos_num(); bin.axial_pos_num() <= iter->get_max_axial_pos_num();
            ++bin.axial_pos_num())
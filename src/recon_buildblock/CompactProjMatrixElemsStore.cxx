@@ -0,0 +1,276 @@
+//
+//
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup projection
+
+  \brief Implementation of class stir::CompactProjMatrixElemsStore
+*/
+
+#include "stir/recon_buildblock/CompactProjMatrixElemsStore.h"
+#include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include "stir/Coordinate3D.h"
+#include "stir/numerics/half_float.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+START_NAMESPACE_STIR
+
+namespace
+{
+// smallest and largest size of a memory block
+const std::size_t min_block_size = 4096;
+const std::size_t max_block_size = 1 << 20;
+// max number of bytes needed for a varint-encoded 32-bit integer
+const std::size_t max_varint_size = 5;
+
+inline unsigned char*
+write_varint(unsigned char* ptr, std::uint32_t v)
+{
+  while (v >= 0x80)
+    {
+      *ptr++ = static_cast<unsigned char>(v | 0x80);
+      v >>= 7;
+    }
+  *ptr++ = static_cast<unsigned char>(v);
+  return ptr;
+}
+
+inline const unsigned char*
+read_varint(const unsigned char* ptr, std::uint32_t& v)
+{
+  v = 0;
+  int shift = 0;
+  while (*ptr & 0x80)
+    {
+      v |= static_cast<std::uint32_t>(*ptr++ & 0x7f) << shift;
+      shift += 7;
+    }
+  v |= static_cast<std::uint32_t>(*ptr++) << shift;
+  return ptr;
+}
+
+// map signed to unsigned such that small absolute values give small numbers
+inline std::uint32_t
+zigzag_encode(const int v)
+{
+  return (static_cast<std::uint32_t>(v) << 1) ^ static_cast<std::uint32_t>(v >> 31);
+}
+
+inline int
+zigzag_decode(const std::uint32_t v)
+{
+  return static_cast<int>(v >> 1) ^ -static_cast<int>(v & 1);
+}
+
+inline unsigned char*
+write_float(unsigned char* ptr, const float v)
+{
+  std::memcpy(ptr, &v, sizeof(float));
+  return ptr + sizeof(float);
+}
+
+inline const unsigned char*
+read_float(const unsigned char* ptr, float& v)
+{
+  std::memcpy(&v, ptr, sizeof(float));
+  return ptr + sizeof(float);
+}
+
+inline unsigned char*
+write_uint16(unsigned char* ptr, const std::uint16_t v)
+{
+  std::memcpy(ptr, &v, sizeof(v));
+  return ptr + sizeof(v);
+}
+
+inline const unsigned char*
+read_uint16(const unsigned char* ptr, std::uint16_t& v)
+{
+  std::memcpy(&v, ptr, sizeof(v));
+  return ptr + sizeof(v);
+}
+
+} // namespace
+
+std::string
+CompactProjMatrixElemsStore::value_encoding_to_string(const ValueEncoding value_encoding)
+{
+  switch (value_encoding)
+    {
+    case ValueEncoding::float32:
+      return "float";
+    case ValueEncoding::float16:
+      return "fp16";
+    case ValueEncoding::quantised16:
+      return "quantised";
+    }
+  return "unknown"; // never reached
+}
+
+CompactProjMatrixElemsStore::CompactProjMatrixElemsStore(const ValueEncoding value_encoding)
+    : value_encoding(value_encoding),
+      num_bytes_used_in_last_block(0)
+{}
+
+void
+CompactProjMatrixElemsStore::clear()
+{
+  // swap with empty containers to make sure that memory is deallocated
+  std::vector<std::vector<unsigned char>>().swap(blocks);
+  std::unordered_map<key_type, std::uint64_t>().swap(offsets);
+  num_bytes_used_in_last_block = 0;
+}
+
+std::size_t
+CompactProjMatrixElemsStore::get_num_bytes_used() const
+{
+  std::size_t num_bytes = 0;
+  for (const auto& block : blocks)
+    num_bytes += block.size();
+  return num_bytes;
+}
+
+unsigned char*
+CompactProjMatrixElemsStore::get_space(const std::size_t num_bytes)
+{
+  if (blocks.empty() || blocks.back().size() - num_bytes_used_in_last_block < num_bytes)
+    {
+      // allocate a new block, doubling the size of the previous one up to a maximum
+      const std::size_t preferred_size = blocks.empty() ? min_block_size : std::min(2 * blocks.back().size(), max_block_size);
+      blocks.emplace_back(std::max(preferred_size, num_bytes));
+      num_bytes_used_in_last_block = 0;
+    }
+  return blocks.back().data() + num_bytes_used_in_last_block;
+}
+
+void
+CompactProjMatrixElemsStore::insert(const key_type key, const ProjMatrixElemsForOneBin& lor)
+{
+  if (offsets.find(key) != offsets.end())
+    return;
+
+  const std::size_t value_size = value_encoding == ValueEncoding::float32 ? sizeof(float) : sizeof(std::uint16_t);
+  const std::size_t max_num_bytes = max_varint_size + 2 * sizeof(float) + lor.size() * (3 * max_varint_size + value_size);
+  unsigned char* const start_ptr = get_space(max_num_bytes);
+  unsigned char* ptr = start_ptr;
+
+  ptr = write_varint(ptr, static_cast<std::uint32_t>(lor.size()));
+
+  float min_value = 0.F;
+  float scale = 1.F;
+  if (value_encoding == ValueEncoding::quantised16 && lor.size() > 0)
+    {
+      float max_value = lor.begin()->get_value();
+      min_value = max_value;
+      for (ProjMatrixElemsForOneBin::const_iterator iter = lor.begin(); iter != lor.end(); ++iter)
+        {
+          min_value = std::min(min_value, iter->get_value());
+          max_value = std::max(max_value, iter->get_value());
+        }
+      scale = max_value > min_value ? (max_value - min_value) / 65535.F : 1.F;
+      ptr = write_float(ptr, min_value);
+      ptr = write_float(ptr, scale);
+    }
+
+  int prev_c1 = 0, prev_c2 = 0, prev_c3 = 0;
+  for (ProjMatrixElemsForOneBin::const_iterator iter = lor.begin(); iter != lor.end(); ++iter)
+    {
+      const int c1 = iter->coord1();
+      const int c2 = iter->coord2();
+      const int c3 = iter->coord3();
+      ptr = write_varint(ptr, zigzag_encode(c1 - prev_c1));
+      ptr = write_varint(ptr, zigzag_encode(c2 - prev_c2));
+      ptr = write_varint(ptr, zigzag_encode(c3 - prev_c3));
+      prev_c1 = c1;
+      prev_c2 = c2;
+      prev_c3 = c3;
+      const float value = iter->get_value();
+      switch (value_encoding)
+        {
+        case ValueEncoding::float32:
+          ptr = write_float(ptr, value);
+          break;
+        case ValueEncoding::float16:
+          ptr = write_uint16(ptr, float_to_half(value));
+          break;
+        case ValueEncoding::quantised16:
+          ptr = write_uint16(ptr, static_cast<std::uint16_t>(std::lround((value - min_value) / scale)));
+          break;
+        }
+    }
+
+  const std::uint64_t offset = (static_cast<std::uint64_t>(blocks.size() - 1) << 32)
+                               | static_cast<std::uint64_t>(num_bytes_used_in_last_block);
+  num_bytes_used_in_last_block += static_cast<std::size_t>(ptr - start_ptr);
+  offsets.insert(std::make_pair(key, offset));
+}
+
+bool
+CompactProjMatrixElemsStore::find(const key_type key, ProjMatrixElemsForOneBin& lor) const
+{
+  const auto pos = offsets.find(key);
+  if (pos == offsets.end())
+    return false;
+
+  const std::uint64_t offset = pos->second;
+  const unsigned char* ptr = blocks[static_cast<std::size_t>(offset >> 32)].data() + (offset & 0xffffffffu);
+
+  std::uint32_t num_elements;
+  ptr = read_varint(ptr, num_elements);
+
+  float min_value = 0.F;
+  float scale = 1.F;
+  if (value_encoding == ValueEncoding::quantised16 && num_elements > 0)
+    {
+      ptr = read_float(ptr, min_value);
+      ptr = read_float(ptr, scale);
+    }
+
+  lor.erase();
+  lor.reserve(num_elements);
+  Coordinate3D<int> coords(0, 0, 0);
+  for (std::uint32_t i = 0; i < num_elements; ++i)
+    {
+      std::uint32_t v;
+      ptr = read_varint(ptr, v);
+      coords[1] += zigzag_decode(v);
+      ptr = read_varint(ptr, v);
+      coords[2] += zigzag_decode(v);
+      ptr = read_varint(ptr, v);
+      coords[3] += zigzag_decode(v);
+      float value;
+      switch (value_encoding)
+        {
+        case ValueEncoding::float32:
+          ptr = read_float(ptr, value);
+          break;
+        case ValueEncoding::float16: {
+          std::uint16_t h;
+          ptr = read_uint16(ptr, h);
+          value = half_to_float(h);
+          break;
+        }
+        case ValueEncoding::quantised16:
+        default: {
+          std::uint16_t q;
+          ptr = read_uint16(ptr, q);
+          value = min_value + q * scale;
+          break;
+        }
+        }
+      lor.push_back(ProjMatrixElemsForOneBin::value_type(coords, value));
+    }
+  return true;
+}
+
+END_NAMESPACE_STIR
@@ -228,6 +228,110 @@ ForwardProjectorByBin::forward_project(ProjData& proj_data, int subset_num, int
     }
 }
 
+void
+ForwardProjectorByBin::forward_project(const std::vector<ProjData*>& proj_data_ptrs,
+                                       const std::vector<const DiscretisedDensity<3, float>*>& density_ptrs,
+                                       int subset_num,
+                                       int num_subsets,
+                                       bool zero)
+{
+  if (proj_data_ptrs.size() != density_ptrs.size())
+    error("forward_project: the number of projection data and images should be the same");
+  if (proj_data_ptrs.empty())
+    return;
+  if (proj_data_ptrs.size() == 1 || !this->can_project_multiple_images_simultaneously())
+    {
+      for (std::size_t n = 0; n < proj_data_ptrs.size(); ++n)
+        forward_project(*proj_data_ptrs[n], *density_ptrs[n], subset_num, num_subsets, zero);
+      return;
+    }
+
+  if (subset_num < 0)
+    error(boost::format("forward_project: wrong subset number %1%") % subset_num);
+  if (subset_num > num_subsets - 1)
+    error(boost::format("forward_project: wrong subset number %1% (must be less than the number of subsets %2%)") % subset_num
+          % num_subsets);
+
+  // set (and pre-process) all images. Every call to set_input() creates a new object, so we can keep them all.
+  std::vector<shared_ptr<const DiscretisedDensity<3, float>>> input_sptrs;
+  std::vector<const DiscretisedDensity<3, float>*> input_ptrs;
+  for (std::size_t n = 0; n < density_ptrs.size(); ++n)
+    {
+      set_input(*density_ptrs[n]);
+      input_sptrs.push_back(_density_sptr);
+      input_ptrs.push_back(input_sptrs.back().get());
+    }
+
+  const ProjData& first_proj_data = *proj_data_ptrs[0];
+  for (std::size_t n = 0; n < proj_data_ptrs.size(); ++n)
+    {
+      ProjData& proj_data = *proj_data_ptrs[n];
+      if (*proj_data.get_proj_data_info_sptr() != *first_proj_data.get_proj_data_info_sptr())
+        error("forward_project: all projection data should have the same characteristics");
+      if (input_ptrs[n]->get_exam_info().imaging_modality.is_unknown() || proj_data.get_exam_info().imaging_modality.is_unknown())
+        warning("forward_project. Imaging modality unknown for either the image or the projection data or both.\n"
+                "Going ahead anyway.");
+      else if (input_ptrs[n]->get_exam_info().imaging_modality != proj_data.get_exam_info().imaging_modality)
+        error("forward_project: Imaging modality should be the same for the image and the projection data");
+      check(*proj_data.get_proj_data_info_sptr(), *input_ptrs[n]);
+      if (zero && num_subsets > 1)
+        proj_data.fill(0.0);
+    }
+
+  shared_ptr<DataSymmetriesForViewSegmentNumbers> symmetries_sptr(this->get_symmetries_used()->clone());
+
+  const std::vector<ViewSegmentNumbers> vs_nums_to_process
+      = detail::find_basic_vs_nums_in_subset(*first_proj_data.get_proj_data_info_sptr(),
+                                             *symmetries_sptr,
+                                             first_proj_data.get_min_segment_num(),
+                                             first_proj_data.get_max_segment_num(),
+                                             subset_num,
+                                             num_subsets);
+  const int min_tof_pos_num = first_proj_data.get_proj_data_info_sptr()->get_min_tof_pos_num();
+  const int max_tof_pos_num = first_proj_data.get_proj_data_info_sptr()->get_max_tof_pos_num();
+#ifdef STIR_OPENMP
+#  if _OPENMP < 201107
+#    pragma omp parallel for shared(proj_data_ptrs, symmetries_sptr, input_ptrs) schedule(dynamic)
+#  else
+// OpenMP loop over both vs_nums_to_process and tof_pos_num
+#    pragma omp parallel for shared(proj_data_ptrs, symmetries_sptr, input_ptrs) schedule(dynamic) collapse(2)
+#  endif
+#endif
+  // note: older versions of openmp need an int as loop
+  for (int i = 0; i < static_cast<int>(vs_nums_to_process.size()); ++i)
+    {
+      for (int k = min_tof_pos_num; k <= max_tof_pos_num; ++k)
+        {
+          const ViewSegmentNumbers vs = vs_nums_to_process[i];
+          info(boost::format("Processing view %1% of segment %2% of TOF bin %3% for %4% images") % vs.view_num()
+                   % vs.segment_num() % k % proj_data_ptrs.size(),
+               3);
+          std::vector<RelatedViewgrams<float>> all_viewgrams;
+          all_viewgrams.reserve(proj_data_ptrs.size());
+          std::vector<RelatedViewgrams<float>*> viewgrams_ptrs;
+          for (const auto proj_data_ptr : proj_data_ptrs)
+            {
+              all_viewgrams.push_back(proj_data_ptr->get_empty_related_viewgrams(vs, symmetries_sptr, false, k));
+              viewgrams_ptrs.push_back(&all_viewgrams.back());
+            }
+          actual_forward_project(viewgrams_ptrs,
+                                 input_ptrs,
+                                 all_viewgrams[0].get_min_axial_pos_num(),
+                                 all_viewgrams[0].get_max_axial_pos_num(),
+                                 all_viewgrams[0].get_min_tangential_pos_num(),
+                                 all_viewgrams[0].get_max_tangential_pos_num());
+#ifdef STIR_OPENMP
+#  pragma omp critical(FORWARDPROJ_SETVIEWGRAMS)
+#endif
+          {
+            for (std::size_t n = 0; n < proj_data_ptrs.size(); ++n)
+              if (!(proj_data_ptrs[n]->set_related_viewgrams(all_viewgrams[n]) == Succeeded::yes))
+                error("Error set_related_viewgrams in forward projecting");
+          }
+        }
+    }
+}
+
 void
 ForwardProjectorByBin::forward_project(RelatedViewgrams<float>& viewgrams)
 {
@@ -302,6 +406,23 @@ ForwardProjectorByBin::actual_forward_project(RelatedViewgrams<float>& viewgrams
       viewgrams, *_density_sptr, min_axial_pos_num, max_axial_pos_num, min_tangential_pos_num, max_tangential_pos_num);
 }
 
+bool
+ForwardProjectorByBin::can_project_multiple_images_simultaneously() const
+{
+  return false;
+}
+
+void
+ForwardProjectorByBin::actual_forward_project(const std::vector<RelatedViewgrams<float>*>&,
+                                              const std::vector<const DiscretisedDensity<3, float>*>&,
+                                              const int,
+                                              const int,
+                                              const int,
+                                              const int)
+{
+  error("ForwardProjectorByBin::actual_forward_project() for multiple images is not implemented for this projector.");
+}
+
 void
 ForwardProjectorByBin::set_input(const DiscretisedDensity<3, float>& density)
 {
@@ -98,6 +98,12 @@ ForwardProjectorByBinUsingProjMatrixByBin::get_symmetries_used() const
   return proj_matrix_ptr->get_symmetries_ptr();
 }
 
+bool
+ForwardProjectorByBinUsingProjMatrixByBin::can_project_multiple_images_simultaneously() const
+{
+  return true;
+}
+
 void
 ForwardProjectorByBinUsingProjMatrixByBin::actual_forward_project(RelatedViewgrams<float>& viewgrams,
                                                                   const DiscretisedDensity<3, float>& image,
@@ -106,6 +112,37 @@ ForwardProjectorByBinUsingProjMatrixByBin::actual_forward_project(RelatedViewgra
                                                                   const int min_tangential_pos_num,
                                                                   const int max_tangential_pos_num)
 {
+  actual_forward_project(vector<RelatedViewgrams<float>*>(1, &viewgrams),
+                         vector<const DiscretisedDensity<3, float>*>(1, &image),
+                         min_axial_pos_num,
+                         max_axial_pos_num,
+                         min_tangential_pos_num,
+                         max_tangential_pos_num);
+}
+
+void
+ForwardProjectorByBinUsingProjMatrixByBin::actual_forward_project(const vector<RelatedViewgrams<float>*>& viewgrams_ptrs,
+                                                                  const vector<const DiscretisedDensity<3, float>*>& image_ptrs,
+                                                                  const int min_axial_pos_num,
+                                                                  const int max_axial_pos_num,
+                                                                  const int min_tangential_pos_num,
+                                                                  const int max_tangential_pos_num)
+{
+  assert(viewgrams_ptrs.size() == image_ptrs.size());
+  if (viewgrams_ptrs.empty())
+    return;
+  const std::size_t num_images = image_ptrs.size();
+  // all viewgrams have the same coordinates, so we use the first one to find those
+  const RelatedViewgrams<float>& first_viewgrams = *viewgrams_ptrs[0];
+  // every row will be applied to all images, which will give us a value for the current bin for each image
+  vector<float> bin_values(num_images);
+  // construct these only once, as setting up the table of row pointers is not cheap
+  vector<DiscretisedDensityAccess> image_accesses;
+  for (const auto image_ptr : image_ptrs)
+    image_accesses.push_back(DiscretisedDensityAccess(*image_ptr));
+  // reserve enough memory for the rows such that they do not need to be reallocated
+  const int row_capacity = static_cast<int>(proj_matrix_ptr->get_max_num_elems_per_row_estimate());
+
   if (proj_matrix_ptr->is_cache_enabled()/* &&
 					    !proj_matrix_ptr->does_cache_store_only_basic_bins()*/)
     {
@@ -113,13 +150,11 @@ ForwardProjectorByBinUsingProjMatrixByBin::actual_forward_project(RelatedViewgra
       // symmetries
       // would be slow if there's no caching at all, but is very fast if everything is cached
 
-      ProjMatrixElemsForOneBin proj_matrix_row;
-
-      RelatedViewgrams<float>::iterator r_viewgrams_iter = viewgrams.begin();
+      ProjMatrixElemsForOneBin proj_matrix_row(Bin(), row_capacity);
 
-      while (r_viewgrams_iter != viewgrams.end())
+      for (int viewgram_num = 0; viewgram_num < first_viewgrams.get_num_viewgrams(); ++viewgram_num)
         {
-          Viewgram<float>& viewgram = *r_viewgrams_iter;
+          const Viewgram<float>& viewgram = *(first_viewgrams.begin() + viewgram_num);
           const int view_num = viewgram.get_view_num();
           const int segment_num = viewgram.get_segment_num();
           const int timing_num = viewgram.get_timing_pos_num();
@@ -129,10 +164,11 @@ ForwardProjectorByBinUsingProjMatrixByBin::actual_forward_project(RelatedViewgra
               {
                 Bin bin(segment_num, view_num, ax_pos, tang_pos, timing_num, 0.f);
                 proj_matrix_ptr->get_proj_matrix_elems_for_one_bin(proj_matrix_row, bin);
-                proj_matrix_row.forward_project(bin, image);
-                viewgram[ax_pos][tang_pos] = bin.get_bin_value();
+                std::fill(bin_values.begin(), bin_values.end(), 0.F);
+                proj_matrix_row.forward_project(bin_values, image_accesses);
+                for (std::size_t n = 0; n < num_images; ++n)
+                  (*(viewgrams_ptrs[n]->begin() + viewgram_num))[ax_pos][tang_pos] = bin_values[n];
               }
-          ++r_viewgrams_iter;
         }
     }
   else
@@ -142,8 +178,8 @@ ForwardProjectorByBinUsingProjMatrixByBin::actual_forward_project(RelatedViewgra
       // Faster when no caching is performed, about just as fast when there is caching,
       // but of only basic bins.
 
-      ProjMatrixElemsForOneBin proj_matrix_row;
-      ProjMatrixElemsForOneBin proj_matrix_row_copy;
+      ProjMatrixElemsForOneBin proj_matrix_row(Bin(), row_capacity);
+      ProjMatrixElemsForOneBin proj_matrix_row_copy(Bin(), row_capacity);
       const DataSymmetriesForBins* symmetries = proj_matrix_ptr->get_symmetries_ptr();
 
       Array<2, int> already_processed(
@@ -155,11 +191,11 @@ ForwardProjectorByBinUsingProjMatrixByBin::actual_forward_project(RelatedViewgra
             if (already_processed[ax_pos][tang_pos])
               continue;
 
-            Bin basic_bin(viewgrams.get_basic_segment_num(),
-                          viewgrams.get_basic_view_num(),
+            Bin basic_bin(first_viewgrams.get_basic_segment_num(),
+                          first_viewgrams.get_basic_view_num(),
                           ax_pos,
                           tang_pos,
-                          viewgrams.get_basic_timing_pos_num());
+                          first_viewgrams.get_basic_timing_pos_num());
             symmetries->find_basic_bin(basic_bin);
 
             proj_matrix_ptr->get_proj_matrix_elems_for_one_bin(proj_matrix_row, basic_bin);
@@ -180,24 +216,26 @@ ForwardProjectorByBinUsingProjMatrixByBin::actual_forward_project(RelatedViewgra
 
                 already_processed[axial_pos_tmp][tang_pos_tmp] = 1;
 
-                for (RelatedViewgrams<float>::iterator viewgram_iter = viewgrams.begin(); viewgram_iter != viewgrams.end();
-                     ++viewgram_iter)
+                for (int viewgram_num = 0; viewgram_num < first_viewgrams.get_num_viewgrams(); ++viewgram_num)
                   {
-                    Viewgram<float>& viewgram = *viewgram_iter;
+                    const Viewgram<float>& viewgram = *(first_viewgrams.begin() + viewgram_num);
                     proj_matrix_row_copy = proj_matrix_row;
-                    Bin bin(viewgram_iter->get_segment_num(),
-                            viewgram_iter->get_view_num(),
+                    Bin bin(viewgram.get_segment_num(),
+                            viewgram.get_view_num(),
                             axial_pos_tmp,
                             tang_pos_tmp,
-                            viewgram_iter->get_timing_pos_num());
+                            viewgram.get_timing_pos_num());
 
                     unique_ptr<SymmetryOperation> symm_op_ptr = symmetries->find_symmetry_operation_from_basic_bin(bin);
                     assert(bin == basic_bin);
 
+                    // the transformed row is used for all images
                     symm_op_ptr->transform_proj_matrix_elems_for_one_bin(proj_matrix_row_copy);
-                    proj_matrix_row_copy.forward_project(bin, image);
+                    std::fill(bin_values.begin(), bin_values.end(), 0.F);
+                    proj_matrix_row_copy.forward_project(bin_values, image_accesses);
 
-                    viewgram[axial_pos_tmp][tang_pos_tmp] = bin.get_bin_value();
+                    for (std::size_t n = 0; n < num_images; ++n)
+                      (*(viewgrams_ptrs[n]->begin() + viewgram_num))[axial_pos_tmp][tang_pos_tmp] = bin_values[n];
                   }
               }
           }
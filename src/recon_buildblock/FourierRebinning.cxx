@@ -27,17 +27,26 @@
 #include "stir/ProjDataInfoCylindrical.h"
 #include "stir/ProjDataInterfile.h"
 #include "stir/SegmentBySinogram.h"
+#include "stir/Sinogram.h"
 #include "stir/Bin.h"
 #include "stir/IndexRange3D.h"
 #include "stir/IndexRange2D.h"
 #include "stir/Succeeded.h"
 #include "stir/round.h"
 #include "stir/display.h"
+#include "stir/is_null_ptr.h"
+#include "stir/num_threads.h"
 #include <iostream>
 #include <fstream>
 #include <numeric>
 #include <ctime>
 #include <complex>
+#include <utility>
+#include <vector>
+#include <exception>
+#ifdef STIR_OPENMP
+#  include <omp.h>
+#endif
 #include <boost/format.hpp>
 #include "stir/numerics/fourier.h"
 #include "stir/interpolate.h"
@@ -173,91 +182,114 @@ FourierRebinning::rebin()
       error("FORE Rebinning :: Setup failed ");
     };
 
-  // CON Loop over all positive segments. Negative segments (those with negative (opposite) ring differences
-  // CON will be merged with the positive segment 180 degree sinograms to form a 360 degree segment.
+  // CON Each pair of sinograms with opposite ring difference is a separate task. Sinograms are read one by one
+  // CON (instead of a whole segment), such that memory stays bounded. When using OpenMP, threads process
+  // CON different tasks, such that reading by one thread overlaps with the FFTs and rebinning in others.
+  // CON Every thread accumulates in its own FT_rebinned_data and weights, which are summed at the end.
+  std::vector<std::pair<int, int>> seg_and_axial_pos_nums;
   for (int seg_num = 0; seg_num <= max_segment_num_to_process; seg_num++)
+    for (int axial_pos_num = proj_data_sptr->get_min_axial_pos_num(seg_num);
+         axial_pos_num <= proj_data_sptr->get_max_axial_pos_num(seg_num);
+         axial_pos_num++)
+      seg_and_axial_pos_nums.push_back(std::make_pair(seg_num, axial_pos_num));
+
+  // CON The rebinning kernel needs an integer z-position for every sinogram. Check this before the
+  // CON (parallel) loop, such that the error does not have to cross the OpenMP region.
+  for (const auto& seg_and_axial_pos_num : seg_and_axial_pos_nums)
     {
+      const float z_in_mm = get_z_in_mm(seg_and_axial_pos_num.first, seg_and_axial_pos_num.second);
+      if (fabs(z_in_mm / half_distance_between_rings - round(z_in_mm / half_distance_between_rings)) > .005F)
+        error(boost::format("FORE Rebinning :: rebinning kernel expected integer z coordinate but found a non integer value %1% "
+                            "(segment %2%, axial position %3%)")
+              % z_in_mm % seg_and_axial_pos_num.first % seg_and_axial_pos_num.second);
+    }
 
-      info(boost::format("FORE Rebinning :: Processing segment No %1% *") % seg_num);
-
-      // TODO at present, the processing is done by segment. However, it's fairly easy to
-      // change this to by sinogram (the rebinning call below will do everything
-      // as a loop over axial_pos anyway).
-      // This would save some memory overhead, and increase potential for parallelisation later.
-      // (The parallelised version of FORE in PARAPET was organised this way).
-
-      // CON get one (positive) segment
-      SegmentBySinogram<float> segment = proj_data_sptr->get_segment_by_sinogram(seg_num);
-
-      // CON Retrieve some segment dependent properties needed for the rebinning kernel
-      const ProjDataInfoCylindrical& proj_data_info_cylindrical
-          = dynamic_cast<const ProjDataInfoCylindrical&>(*segment.get_proj_data_info_sptr());
-      const float average_ring_difference_in_segment
-          = proj_data_info_cylindrical.get_average_ring_difference(segment.get_segment_num());
-
-      // CL Form a 360 degree sinogram by merging two 180 degree segments  with opposite ring difference
-      // CL to get a new segment sampled over 2*pi (where 0 < view < pi)
-      // CON See DeFrise paper (exact and approximate rebinning algorithms for 3D PET data), Sec IV,C (p153)
-      // KT TODO this is currently not a good idea, as all ProjDataInfo classes assume that
-      // KT views go from 0 to Pi.
-      // CON Get the corresponding (negative) segment with the same absolute but opposite obliqueness
-      const SegmentBySinogram<float> segment_neg = proj_data_sptr->get_segment_by_sinogram(-seg_num);
-      // CON Expand the (positive) segment such that the two segments can be merged
-      segment.grow(IndexRange3D(segment.get_min_axial_pos_num(),
-                                segment.get_max_axial_pos_num(),
-                                0,
-                                2 * segment.get_num_views() - 1,
-                                segment.get_min_tangential_pos_num(),
-                                segment.get_max_tangential_pos_num()));
-
-      // CON merge the two segments to form "360 degrees" sinograms
-      const int min_tangential_pos_num
-          = std::max(segment_neg.get_min_tangential_pos_num(), -segment.get_max_tangential_pos_num());
-
-      const int max_tangential_pos_num
-          = std::min(segment_neg.get_max_tangential_pos_num(), -segment.get_min_tangential_pos_num());
-
-      for (int ring = segment.get_min_axial_pos_num(); ring <= segment.get_max_axial_pos_num(); ring++)
-        for (int view = segment_neg.get_min_view_num(); view <= segment_neg.get_max_view_num(); view++)
-          for (int tangential_pos_num = min_tangential_pos_num; tangential_pos_num <= max_tangential_pos_num;
-               tangential_pos_num++)
-            segment[ring][view + segment_neg.get_num_views()][tangential_pos_num] = segment_neg[ring][view][-tangential_pos_num];
-
-      // CON in debug mode visualize the segment
-      if (fore_debug_level >= 2)
+  const int num_threads = get_max_num_threads();
+  info(boost::format("FORE Rebinning :: Processing %1% sinogram pairs using %2% threads") % seg_and_axial_pos_nums.size()
+           % num_threads,
+       2);
+  // CON accumulators for threads other than the first. Allocated when a thread first needs it.
+  std::vector<shared_ptr<Array<3, std::complex<float>>>> local_FT_rebinned_data(num_threads);
+  std::vector<shared_ptr<Array<3, float>>> local_Weights_for_FT_rebinned_data(num_threads);
+  std::vector<PETCount_rebinned> local_num_rebinned(num_threads);
+  // CON exceptions cannot cross the OpenMP parallel region, so we store the first one and rethrow it after the loop
+  std::exception_ptr exception_ptr;
+
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic) if (fore_debug_level < 2)
+#endif
+  for (int task_num = 0; task_num < static_cast<int>(seg_and_axial_pos_nums.size()); ++task_num)
+    {
+      try
+        {
+          const int seg_num = seg_and_axial_pos_nums[task_num].first;
+          const int axial_pos_num = seg_and_axial_pos_nums[task_num].second;
+#ifdef STIR_OPENMP
+          const int thread_num = omp_get_thread_num();
+#else
+          const int thread_num = 0;
+#endif
+          if (axial_pos_num == proj_data_sptr->get_min_axial_pos_num(seg_num))
+            info(boost::format("FORE Rebinning :: Processing segment No %1% *") % seg_num);
+
+          // CON get the sinogram pair, merged to "360 degrees", with the number of views extended to num_views_pow2
+          const Array<2, float> sinogram = get_merged_sinogram(seg_num, axial_pos_num, num_views_pow2);
+
+          if (thread_num > 0 && is_null_ptr(local_FT_rebinned_data[thread_num]))
+            {
+              local_FT_rebinned_data[thread_num].reset(new Array<3, std::complex<float>>(FT_rebinned_data.get_index_range()));
+              local_Weights_for_FT_rebinned_data[thread_num].reset(
+                  new Array<3, float>(Weights_for_FT_rebinned_data.get_index_range()));
+            }
+
+          // CON The sinogram data is now in the required format and ready for rebinning.
+          // CON The rebinned data is stored in a 3 dimensional array of complex numbers (FT_rebinned_data).
+          // CON FT_rebinned_data[plane][w(FT of s)][k(FT of phi)]
+          // CON Weight has the same dimensions. It stores normalisation factors (floats)
+          // CON to take into account the variable number of contributions to each frequency.
+          do_rebinning(thread_num == 0 ? FT_rebinned_data : *local_FT_rebinned_data[thread_num],
+                       thread_num == 0 ? Weights_for_FT_rebinned_data : *local_Weights_for_FT_rebinned_data[thread_num],
+                       local_num_rebinned[thread_num],
+                       sinogram,
+                       seg_num,
+                       axial_pos_num,
+                       num_tang_poss_pow2,
+                       num_views_pow2,
+                       half_distance_between_rings,
+                       sampling_distance_in_s,
+                       radial_sampling_freq_w,
+                       R_field_of_view_mm,
+                       ratio_ring_spacing_to_ring_radius);
+        }
+      catch (...)
         {
-          char s[100];
-          sprintf(s, "(extended) segment by sinogram %d", segment.get_segment_num());
-          display(segment, segment.find_max(), s);
+#ifdef STIR_OPENMP
+#  pragma omp critical(FOREEXCEPTION)
+#endif
+          if (!exception_ptr)
+            exception_ptr = std::current_exception();
         }
+    } // CON end loop over sinograms.
+  if (exception_ptr)
+    std::rethrow_exception(exception_ptr);
 
-      // CON the sinogramm dimensions need to have a dimension which is a power of 2 (required by the FFT algorithm)
-      // CON for s (radial coordinate) pad the sinogramm with zeros to form a larger array.
-      // CON the phi (azimuthal cordinate (view)) coordinate is periodic. The samples need to be interpolated to the
-      // CON to the new matrix size. Do this by linear interpolation.
-      // CON -> DeFrise p. 153 Sec IV.C
-      do_adjust_nb_views_to_pow2(segment);
-
-      // CON The sinogramm data is now in the required format and ready for rebinning.
-      // CON The rebinned data is stored in a 3 dimensional array of complex numbers (FT_rebinned_data).
-      // CON FT_rebinned_data[plane][w(FT of s)][k(FT of phi)]
-      // CON Weight has the same dimensions. It stores normalisation factors (floats)
-      // CON to take into account the variable number of contributions to each frequency.
-      do_rebinning(FT_rebinned_data,
-                   Weights_for_FT_rebinned_data,
-                   num_rebinned,
-                   segment,
-                   num_tang_poss_pow2,
-                   num_views_pow2,
-                   num_planes,
-                   average_ring_difference_in_segment,
-                   half_distance_between_rings,
-                   sampling_distance_in_s,
-                   radial_sampling_freq_w,
-                   R_field_of_view_mm,
-                   ratio_ring_spacing_to_ring_radius);
-
-    } // CON end loop over segments.
+  // CON sum the results of all threads
+  for (int thread_num = 0; thread_num < num_threads; ++thread_num)
+    {
+      num_rebinned += local_num_rebinned[thread_num];
+      if (is_null_ptr(local_FT_rebinned_data[thread_num]))
+        continue;
+#ifdef STIR_OPENMP
+#  pragma omp parallel for
+#endif
+      for (int plane = 0; plane < num_planes; ++plane)
+        {
+          FT_rebinned_data[plane] += (*local_FT_rebinned_data[thread_num])[plane];
+          Weights_for_FT_rebinned_data[plane] += (*local_Weights_for_FT_rebinned_data[thread_num])[plane];
+        }
+      local_FT_rebinned_data[thread_num].reset();
+      local_Weights_for_FT_rebinned_data[thread_num].reset();
+    }
 
   // CON Some statistics
   std::cout << "\nFORE Rebinning :: Total rebinning count: \n";
@@ -267,61 +299,76 @@ FourierRebinning::rebin()
   // CL now finally fill in the new sinogram s
   SegmentBySinogram<float> sino2D_rebinned = rebinned_proj_data_sptr->get_empty_segment_by_sinogram(0);
 
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic) if (fore_debug_level < 3)
+#endif
   for (int plane = FT_rebinned_data.get_min_index(); plane <= FT_rebinned_data.get_max_index(); plane++)
     {
-
-      if (plane % 10 == 0)
-        info(boost::format("FORE Rebinning :: Inv FFT rebinned z-position (slice) = %1%") % plane);
-
-      // CON Create a temporary 2D array of complex numbers to store the rebinned and summed fourier coefficients for one slice.
-      // CON This data is then inverse FFTd and copied to a sinogram data structure.
-      // CON Strictly seen this temporary data structure is no longer necessary because the inv. FFT could now be
-      // CON be done on FT_rebinned_data itself. Since one has to anyway access the full FTdata matrix to apply
-      // CON the rebinning weights
-      // CON before the inv. FFT can be applied this is not much overhead and it can be left like it was done when still
-      // CON using the numerical receipies FFT code.
-      Array<2, std::complex<float>> FT_rebinned_sinogram(IndexRange2D(0, num_tang_poss_pow2 - 1, 0, num_views_pow2 / 2));
-      // CON fourier_for_real_data will resize the array to its appropriate dimensions
-      Array<2, float> rebinned_sinogram(IndexRange2D(0, 1, 0, 1));
-
-      // CON Normalise the rebinned sinograms by applying the weight factors
-      // CON See DeFrise IV.D p154.
-      for (int j = 0; j < num_tang_poss_pow2; j++)
+      try
         {
-          for (int i = 0; i <= num_views_pow2 / 2; i++)
+          if (plane % 10 == 0)
+            info(boost::format("FORE Rebinning :: Inv FFT rebinned z-position (slice) = %1%") % plane);
+
+          // CON Create a temporary 2D array of complex numbers to store the rebinned and summed fourier coefficients for one
+          // CON slice.
+          // CON This data is then inverse FFTd and copied to a sinogram data structure.
+          // CON Strictly seen this temporary data structure is no longer necessary because the inv. FFT could now be
+          // CON be done on FT_rebinned_data itself. Since one has to anyway access the full FTdata matrix to apply
+          // CON the rebinning weights
+          // CON before the inv. FFT can be applied this is not much overhead and it can be left like it was done when still
+          // CON using the numerical receipies FFT code.
+          Array<2, std::complex<float>> FT_rebinned_sinogram(IndexRange2D(0, num_tang_poss_pow2 - 1, 0, num_views_pow2 / 2));
+          // CON fourier_for_real_data will resize the array to its appropriate dimensions
+          Array<2, float> rebinned_sinogram(IndexRange2D(0, 1, 0, 1));
+
+          // CON Normalise the rebinned sinograms by applying the weight factors
+          // CON See DeFrise IV.D p154.
+          for (int j = 0; j < num_tang_poss_pow2; j++)
             {
-              const float Actual_Weight
-                  = (Weights_for_FT_rebinned_data[plane][i][j] == 0) ? 0 : 1.F / (Weights_for_FT_rebinned_data[plane][i][j]);
-              FT_rebinned_sinogram[j][i] = FT_rebinned_data[plane][i][j] * Actual_Weight;
+              for (int i = 0; i <= num_views_pow2 / 2; i++)
+                {
+                  const float Actual_Weight
+                      = (Weights_for_FT_rebinned_data[plane][i][j] == 0) ? 0 : 1.F / (Weights_for_FT_rebinned_data[plane][i][j]);
+                  FT_rebinned_sinogram[j][i] = FT_rebinned_data[plane][i][j] * Actual_Weight;
+                }
             }
-        }
 
-      if (fore_debug_level >= 3)
-        {
-          char s[100];
-          Array<2, float> real(FT_rebinned_sinogram.get_index_range());
-          for (int i = 0; i < num_views_pow2; i++)
-            for (int j = 0; j <= num_tang_poss_pow2 / 2; j++)
-              real[i][j] = FT_rebinned_sinogram[i][j].real();
-          sprintf(s, "real part of FT of rebinned (extended) sinogram %d", plane);
-          display(real, s, real.find_max());
-          for (int i = 0; i < num_views_pow2; i++)
-            for (int j = 0; j <= num_tang_poss_pow2 / 2; j++)
-              real[i][j] = FT_rebinned_sinogram[i][j].imag();
-          sprintf(s, "imag part of FT of rebinned (extended) sinogram %d", plane);
-          display(real, s, real.find_max());
-        }
-
-      // CON inverse FFT the rebinned sinograms
-      rebinned_sinogram = inverse_fourier_for_real_data(FT_rebinned_sinogram);
+          if (fore_debug_level >= 3)
+            {
+              char s[100];
+              Array<2, float> real(FT_rebinned_sinogram.get_index_range());
+              for (int i = 0; i < num_views_pow2; i++)
+                for (int j = 0; j <= num_tang_poss_pow2 / 2; j++)
+                  real[i][j] = FT_rebinned_sinogram[i][j].real();
+              sprintf(s, "real part of FT of rebinned (extended) sinogram %d", plane);
+              display(real, s, real.find_max());
+              for (int i = 0; i < num_views_pow2; i++)
+                for (int j = 0; j <= num_tang_poss_pow2 / 2; j++)
+                  real[i][j] = FT_rebinned_sinogram[i][j].imag();
+              sprintf(s, "imag part of FT of rebinned (extended) sinogram %d", plane);
+              display(real, s, real.find_max());
+            }
 
-      // CL Keep only one half of data [o.._PI]
-      for (int i = 0; i < (int)(num_views_pow2 / 2); i++)
-        for (int j = 0; j < num_tang_poss_pow2; j++)
-          if ((j + sino2D_rebinned.get_min_tangential_pos_num()) <= sino2D_rebinned.get_max_tangential_pos_num())
-            sino2D_rebinned[plane][i][j + sino2D_rebinned.get_min_tangential_pos_num()] = rebinned_sinogram[j][i];
+          // CON inverse FFT the rebinned sinograms
+          rebinned_sinogram = inverse_fourier_for_real_data(FT_rebinned_sinogram);
 
+          // CL Keep only one half of data [o.._PI]
+          for (int i = 0; i < (int)(num_views_pow2 / 2); i++)
+            for (int j = 0; j < num_tang_poss_pow2; j++)
+              if ((j + sino2D_rebinned.get_min_tangential_pos_num()) <= sino2D_rebinned.get_max_tangential_pos_num())
+                sino2D_rebinned[plane][i][j + sino2D_rebinned.get_min_tangential_pos_num()] = rebinned_sinogram[j][i];
+        }
+      catch (...)
+        {
+#ifdef STIR_OPENMP
+#  pragma omp critical(FOREEXCEPTION)
+#endif
+          if (!exception_ptr)
+            exception_ptr = std::current_exception();
+        }
     } // CON end loop over planes
+  if (exception_ptr)
+    std::rethrow_exception(exception_ptr);
 
   info(boost::format("FORE Rebinning :: 2D Rebinned sinograms => Min = %1%, Max= %2%, Sum = %3%") % sino2D_rebinned.find_min()
        % sino2D_rebinned.find_max() % sino2D_rebinned.sum());
@@ -340,15 +387,79 @@ FourierRebinning::rebin()
   return success;
 }
 
+Array<2, float>
+FourierRebinning::get_merged_sinogram(const int seg_num, const int axial_pos_num, const int num_views_pow2) const
+{
+  // CL Form a 360 degree sinogram by merging two 180 degree sinograms with opposite ring difference
+  // CL to get a new sinogram sampled over 2*pi (where 0 < view < pi)
+  // CON See DeFrise paper (exact and approximate rebinning algorithms for 3D PET data), Sec IV,C (p153)
+  shared_ptr<Sinogram<float>> sinogram_sptr;
+  shared_ptr<Sinogram<float>> sinogram_neg_sptr;
+  // CON reading from the same ProjData is serialised
+#ifdef STIR_OPENMP
+#  pragma omp critical(FOREREAD)
+#endif
+  {
+    sinogram_sptr.reset(new Sinogram<float>(proj_data_sptr->get_sinogram(axial_pos_num, seg_num)));
+    sinogram_neg_sptr.reset(new Sinogram<float>(proj_data_sptr->get_sinogram(axial_pos_num, -seg_num)));
+  }
+  const Sinogram<float>& sinogram = *sinogram_sptr;
+  const Sinogram<float>& sinogram_neg = *sinogram_neg_sptr;
+
+  const int num_views = sinogram.get_num_views();
+  const int min_tangential_pos_num_out = sinogram.get_min_tangential_pos_num();
+  const int max_tangential_pos_num_out = sinogram.get_max_tangential_pos_num();
+  Array<2, float> merged_sinogram(IndexRange2D(0, 2 * num_views - 1, min_tangential_pos_num_out, max_tangential_pos_num_out));
+  for (int view = 0; view < num_views; view++)
+    merged_sinogram[view] = sinogram[view + sinogram.get_min_view_num()];
+
+  // CON merge the two sinograms to form "360 degrees" sinograms
+  const int min_tangential_pos_num = std::max(sinogram_neg.get_min_tangential_pos_num(), -max_tangential_pos_num_out);
+  const int max_tangential_pos_num = std::min(sinogram_neg.get_max_tangential_pos_num(), -min_tangential_pos_num_out);
+  for (int view = 0; view < num_views; view++)
+    for (int tangential_pos_num = min_tangential_pos_num; tangential_pos_num <= max_tangential_pos_num; tangential_pos_num++)
+      merged_sinogram[view + num_views][tangential_pos_num]
+          = sinogram_neg[view + sinogram_neg.get_min_view_num()][-tangential_pos_num];
+
+  // CON in debug mode visualize the sinogram
+  if (fore_debug_level >= 2)
+    {
+      char s[100];
+      sprintf(s, "(extended) sinogram %d of segment %d", axial_pos_num, seg_num);
+      display(merged_sinogram, s, merged_sinogram.find_max());
+    }
+
+  // CON the sinogramm dimensions need to have a dimension which is a power of 2 (required by the FFT algorithm)
+  // CON for s (radial coordinate) pad the sinogramm with zeros to form a larger array.
+  // CON the phi (azimuthal cordinate (view)) coordinate is periodic. The samples need to be interpolated to the
+  // CON to the new matrix size. Do this by linear interpolation.
+  // CON -> DeFrise p. 153 Sec IV.C
+  if (num_views_pow2 == 2 * num_views)
+    return merged_sinogram;
+
+  Array<2, float> out_sinogram(IndexRange2D(0, num_views_pow2 - 1, min_tangential_pos_num_out, max_tangential_pos_num_out));
+  const float extension_factor = static_cast<float>(num_views_pow2) / static_cast<float>(2 * num_views);
+  const float offset_for_overlap_interpolate = 0.F;
+  overlap_interpolate(out_sinogram, merged_sinogram, extension_factor, offset_for_overlap_interpolate, true);
+  return out_sinogram;
+}
+
+float
+FourierRebinning::get_z_in_mm(const int seg_num, const int axial_pos_num) const
+{
+  const ProjDataInfo& proj_data_info = *proj_data_sptr->get_proj_data_info_sptr();
+  return proj_data_info.get_m(Bin(seg_num, 0, axial_pos_num, 0)) - proj_data_info.get_m(Bin(0, 0, 0, 0));
+}
+
 void
 FourierRebinning::do_rebinning(Array<3, std::complex<float>>& FT_rebinned_data,
                                Array<3, float>& Weights_for_FT_rebinned_data,
                                PETCount_rebinned& count_rebinned,
-                               const SegmentBySinogram<float>& segment,
+                               const Array<2, float>& sinogram,
+                               const int seg_num,
+                               const int axial_pos_num,
                                const int num_tang_poss_pow2,
                                const int num_views_pow2,
-                               const int num_planes,
-                               const float average_ring_difference_in_segment,
                                const float half_distance_between_rings,
                                const float sampling_distance_in_s,
                                const float radial_sampling_freq_w,
@@ -356,58 +467,41 @@ FourierRebinning::do_rebinning(Array<3, std::complex<float>>& FT_rebinned_data,
                                const float ratio_ring_spacing_to_ring_radius)
 
 {
-  const int local_rebinned = count_rebinned.total;
-  const int local_miss = count_rebinned.miss;
-  const int local_ssrb = count_rebinned.ssrb;
-
-  // CON Loop over all slices, FFT the sinograms and call the actual rebinning kernel.
-  for (int axial_pos_num = segment.get_min_axial_pos_num(); axial_pos_num <= segment.get_max_axial_pos_num(); axial_pos_num++)
-    {
-
-      if (axial_pos_num % 10 == 0)
-        info(boost::format("FORE Rebinning z (slice) = %1%") % axial_pos_num);
-      Array<2, float> current_sinogram(IndexRange2D(0, num_tang_poss_pow2 - 1, 0, num_views_pow2 - 1));
-
-      // CL Calculate the 2D FFT of P(w,k) of the merged segment
-      // CON copy the sinogram data of slice axial_pos_num from the segment array to slicedata
-      // CON the sinogram is flipped. This will taken account for in the rebinning, where the assignment of the FFT
-      // CON coefficients are assigned opposite.
-      for (int j = 0; j < segment.get_num_tangential_poss(); j++)
-        for (int i = 0; i < num_views_pow2; i++)
-          current_sinogram[j][i] = segment[axial_pos_num][i][j + segment.get_min_tangential_pos_num()];
-
-      // CON FFT slicedata
-      const Array<2, std::complex<float>> FT_current_sinogram = fourier_for_real_data(current_sinogram);
-
-      // CON determine the axial position of the middle of the LOR in mm relative to Bin(segment=0,view=0,axial_pos=0,tang_pos=0)
-      const ProjDataInfo& proj_data_info = *segment.get_proj_data_info_sptr();
-      const float z_in_mm
-          = proj_data_info.get_m(Bin(segment.get_segment_num(), 0, axial_pos_num, 0)) - proj_data_info.get_m(Bin(0, 0, 0, 0));
-
-      // CON Call the rebinning kernel.
-      rebinning(FT_rebinned_data,
-                Weights_for_FT_rebinned_data,
-                count_rebinned,
-                FT_current_sinogram,
-                z_in_mm,
-                average_ring_difference_in_segment,
-                num_views_pow2,
-                num_tang_poss_pow2,
-                half_distance_between_rings,
-                sampling_distance_in_s,
-                radial_sampling_freq_w,
-                R_field_of_view_mm,
-                ratio_ring_spacing_to_ring_radius);
-
-    } // CL End of loop of axial_pos_num
-
-  if (fore_debug_level > 0)
-    {
-      info(boost::format("Total rebinned: %1%\n"
-                         "Total missed: %2%\n"
-                         "Total rebinned SSRB: %3%")
-           % (count_rebinned.total - local_rebinned) % (count_rebinned.miss - local_miss) % (count_rebinned.ssrb - local_ssrb));
-    }
+  const ProjDataInfoCylindrical& proj_data_info
+      = dynamic_cast<const ProjDataInfoCylindrical&>(*proj_data_sptr->get_proj_data_info_sptr());
+  const float average_ring_difference_in_segment = proj_data_info.get_average_ring_difference(seg_num);
+
+  Array<2, float> current_sinogram(IndexRange2D(0, num_tang_poss_pow2 - 1, 0, num_views_pow2 - 1));
+
+  // CL Calculate the 2D FFT of P(w,k) of the merged sinogram
+  // CON copy the sinogram data to slicedata
+  // CON the sinogram is flipped. This will taken account for in the rebinning, where the assignment of the FFT
+  // CON coefficients are assigned opposite.
+  const int min_tangential_pos_num = sinogram[0].get_min_index();
+  for (int j = 0; j < sinogram[0].get_length(); j++)
+    for (int i = 0; i < num_views_pow2; i++)
+      current_sinogram[j][i] = sinogram[i][j + min_tangential_pos_num];
+
+  // CON FFT slicedata
+  const Array<2, std::complex<float>> FT_current_sinogram = fourier_for_real_data(current_sinogram);
+
+  // CON determine the axial position of the middle of the LOR in mm relative to Bin(segment=0,view=0,axial_pos=0,tang_pos=0)
+  const float z_in_mm = get_z_in_mm(seg_num, axial_pos_num);
+
+  // CON Call the rebinning kernel.
+  rebinning(FT_rebinned_data,
+            Weights_for_FT_rebinned_data,
+            count_rebinned,
+            FT_current_sinogram,
+            z_in_mm,
+            average_ring_difference_in_segment,
+            num_views_pow2,
+            num_tang_poss_pow2,
+            half_distance_between_rings,
+            sampling_distance_in_s,
+            radial_sampling_freq_w,
+            R_field_of_view_mm,
+            ratio_ring_spacing_to_ring_radius);
 }
 
 void
@@ -428,10 +522,8 @@ FourierRebinning::rebinning(Array<3, std::complex<float>>& FT_rebinned_data,
 
   // CON prevent rebinning to non existing z-positions (sinograms)
   const int maxplane = FT_rebinned_data.get_max_index();
-  // CON determine z position (sino identifier)
+  // CON determine z position (sino identifier). rebin() checked that this is an integer.
   const int z = round(z_in_mm / half_distance_between_rings);
-  if (fabs(static_cast<float>(z_in_mm / half_distance_between_rings - z)) > .005F)
-    error("FORE rebinning :: rebinning kernel expected integer z coordinate but found a non integer value %g\n", z_in_mm);
 
   // CL t is the tangent of the angle theta between the LOR and the transaxial plane
   const float t = delta * ratio_ring_spacing_to_ring_radius / 2.F;
@@ -618,36 +710,6 @@ FourierRebinning::do_display_count(PETCount_rebinned& count)
   std::cout << "FORE Rebinning :: Total rebinned SSRB: " << count.ssrb << std::endl;
 }
 
-void
-FourierRebinning::do_adjust_nb_views_to_pow2(SegmentBySinogram<float>& segment)
-{
-  // Adjustment of the number of views to a power of two
-  // CON Use the STIR overlap_interpolate method and remove the simlar private implementation (adjust_pow2) here.
-  const int num_views_pow2 = stir::round(pow(2., ((int)ceil(log((float)segment.get_num_views()) / log(2.)))));
-  const float offset_for_overlap_interpolate = 0.F;
-
-  if (num_views_pow2 == segment.get_num_views())
-    return;
-
-  // CON Create the projection data info ptr for the resized segment
-  shared_ptr<ProjDataInfo> out_proj_data_info_sptr(segment.get_proj_data_info_sptr()->clone());
-  out_proj_data_info_sptr->set_num_views(num_views_pow2);
-  // CON the re-dimensioned segment
-  SegmentBySinogram<float> out_segment = out_proj_data_info_sptr->get_empty_segment_by_sinogram(segment.get_segment_num());
-
-  for (int axial_pos_num = segment.get_min_axial_pos_num(); axial_pos_num <= segment.get_max_axial_pos_num(); axial_pos_num++)
-    {
-      const Sinogram<float> sino2D = segment.get_sinogram(axial_pos_num);
-      Sinogram<float> out_sino2D = out_segment.get_sinogram(axial_pos_num);
-
-      float extension_factor = static_cast<float>(out_sino2D.get_num_views()) / static_cast<float>(sino2D.get_num_views());
-      overlap_interpolate(out_sino2D, sino2D, extension_factor, offset_for_overlap_interpolate, true);
-
-      out_segment.set_sinogram(out_sino2D);
-    }
-  segment = out_segment;
-}
-
 Succeeded
 FourierRebinning::fore_check_parameters(int num_tang_poss_pow2, int num_views_pow2, int max_segment_num_to_process)
 {
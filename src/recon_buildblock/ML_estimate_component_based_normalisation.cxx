@@ -45,7 +45,8 @@ ML_estimate_component_based_normalisation(const std::string& out_filename_prefix
                                           bool do_block,
                                           bool do_symmetry_per_block,
                                           bool do_KL,
-                                          bool do_display)
+                                          bool do_display,
+                                          bool do_simultaneous_efficiencies_update)
 {
 
   const int num_transaxial_blocks = measured_data.get_proj_data_info_sptr()->get_scanner_sptr()->get_num_transaxial_blocks();
@@ -174,7 +175,7 @@ ML_estimate_component_based_normalisation(const std::string& out_filename_prefix
             display(fan_data, "model*geo*block");
           for (int eff_iter_num = 1; eff_iter_num <= num_eff_iterations; ++eff_iter_num)
             {
-              iterate_efficiencies(efficiencies, data_fan_sums, fan_data);
+              iterate_efficiencies(efficiencies, data_fan_sums, fan_data, do_simultaneous_efficiencies_update);
               {
                 char* out_filename = new char[out_filename_prefix.size() + 30];
                 sprintf(out_filename, "%s_%s_%d_%d.out", out_filename_prefix.c_str(), "eff", iter_num, eff_iter_num);
@@ -51,6 +51,7 @@ BackProjectorByBinNiftyPET::initialise_keymap()
   parser.add_stop_key("End Back Projector Using NiftyPET Parameters");
   parser.add_key("CUDA device", &_cuda_device);
   parser.add_key("verbosity", &_cuda_verbosity);
+  BackProjectorByBin::initialise_keymap();
 }
 
 void
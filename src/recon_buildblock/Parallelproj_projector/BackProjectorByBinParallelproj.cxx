@@ -64,6 +64,7 @@ BackProjectorByBinParallelproj::initialise_keymap()
   parser.add_stop_key("End Back Projector Using Parallelproj Parameters");
   parser.add_key("verbosity", &_cuda_verbosity);
   parser.add_key("num_gpu_chunks", &_num_gpu_chunks);
+  BackProjectorByBin::initialise_keymap();
 }
 
 void
@@ -71,6 +72,7 @@ BackProjectorByBinParallelproj::set_defaults()
 {
   _cuda_verbosity = true;
   _num_gpu_chunks = 1;
+  BackProjectorByBin::set_defaults();
 }
 
 void
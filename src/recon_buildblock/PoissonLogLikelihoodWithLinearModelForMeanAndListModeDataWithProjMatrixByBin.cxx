@@ -22,6 +22,7 @@
 #include "stir/recon_buildblock/PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin.h"
 #include "stir/recon_buildblock/ProjMatrixByBinUsingRayTracing.h"
 #include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include "stir/recon_buildblock/DiscretisedDensityAccess.h"
 #include "stir/recon_buildblock/ProjectorByBinPairUsingProjMatrixByBin.h"
 #include "stir/ProjDataInfoCylindrical.h"
 #include "stir/ProjData.h"
@@ -32,6 +33,7 @@
 #include "stir/error.h"
 #include <boost/format.hpp>
 #include "stir/HighResWallClockTimer.h"
+#include "stir/CPUTimer.h"
 #include "stir/Viewgram.h"
 #include "stir/RelatedViewgrams.h"
 #include "stir/ViewSegmentNumbers.h"
@@ -91,6 +93,8 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<Tar
 
   this->use_tofsens = false;
   skip_balanced_subsets = false;
+  freeze_proj_matrix_cache_after_first_pass = false;
+  sort_and_merge_events = false;
 }
 
 template <typename TargetT>
@@ -108,6 +112,8 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<Tar
 
   this->parser.add_key("num_events_to_use", &this->num_events_to_use);
   this->parser.add_key("skip checking balanced subsets", &skip_balanced_subsets);
+  this->parser.add_key("freeze projection matrix cache after first pass", &freeze_proj_matrix_cache_after_first_pass);
+  this->parser.add_key("sort and merge events in each batch", &sort_and_merge_events);
 }
 
 template <typename TargetT>
@@ -155,6 +161,50 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<Tar
   skip_balanced_subsets = arg;
 }
 
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::set_freeze_proj_matrix_cache_after_first_pass(
+    const bool arg)
+{
+  freeze_proj_matrix_cache_after_first_pass = arg;
+}
+
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::set_sort_and_merge_events(const bool arg)
+{
+  sort_and_merge_events = arg;
+}
+
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::update_proj_matrix_cache_state(
+    const int subset_num)
+{
+  if (this->subset_processed_for_proj_matrix_cache.size() != static_cast<std::size_t>(this->num_subsets))
+    this->subset_processed_for_proj_matrix_cache.assign(this->num_subsets, false);
+  const bool first_time_for_this_subset = !this->subset_processed_for_proj_matrix_cache[subset_num];
+  this->subset_processed_for_proj_matrix_cache[subset_num] = true;
+  if (std::find(this->subset_processed_for_proj_matrix_cache.begin(), this->subset_processed_for_proj_matrix_cache.end(), false)
+      != this->subset_processed_for_proj_matrix_cache.end())
+    return;
+
+  // report the statistics only once, at the end of the first pass over all subsets after set_up()
+  if (first_time_for_this_subset)
+    {
+      const ProjMatrixByBin::CacheStatistics stats = this->PM_sptr->get_cache_statistics();
+      info(boost::format("Projection matrix cache after the first pass over all subsets: %1% hits, %2% misses (hit rate %3%), "
+                         "%4% lock contentions")
+               % stats.num_hits % stats.num_misses % stats.get_hit_rate() % stats.num_lock_contentions,
+           2);
+    }
+  if (this->freeze_proj_matrix_cache_after_first_pass && this->PM_sptr->is_cache_enabled() && !this->PM_sptr->is_cache_frozen())
+    {
+      info("Projection matrix cache is now complete for the list-mode data. Making it read-only.", 2);
+      this->PM_sptr->freeze_cache();
+    }
+}
+
 #if STIR_VERSION < 060000
 template <typename TargetT>
 void
@@ -270,6 +320,7 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<Tar
 
   // set projector to be used for the calculations
   this->PM_sptr->set_up(this->proj_data_info_sptr->create_shared_clone(), target_sptr);
+  this->subset_processed_for_proj_matrix_cache.assign(this->num_subsets, false);
 
   shared_ptr<ForwardProjectorByBin> forward_projector_ptr(new ForwardProjectorByBinUsingProjMatrixByBin(this->PM_sptr));
   shared_ptr<BackProjectorByBin> back_projector_ptr(new BackProjectorByBinUsingProjMatrixByBin(this->PM_sptr));
@@ -552,49 +603,61 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<Tar
   if (this->has_add)
     {
       info(boost::format("Caching Additive corrections for : %1% events.") % record_cache.size(), 2);
-
-#ifdef STIR_OPENMP
-#  pragma omp parallel
-      {
-#  pragma omp single
+      CPUTimer CPU_timer;
+      CPU_timer.start();
+      HighResWallClockTimer wall_clock_timer;
+      wall_clock_timer.start();
+
+      // First sort events into buckets per segment and TOF bin, such that we need to read every segment only once,
+      // and every event is handled only once. Events in segments/TOF bins that are not in the additive data
+      // get a zero additive term.
+      const int min_segment_num = this->additive_proj_data_sptr->get_min_segment_num();
+      const int max_segment_num = this->additive_proj_data_sptr->get_max_segment_num();
+      const int min_timing_pos_num = this->additive_proj_data_sptr->get_min_tof_pos_num();
+      const int max_timing_pos_num = this->additive_proj_data_sptr->get_max_tof_pos_num();
+      // if the additive term is non-TOF, use it for all TOF bins
+      const bool add_is_tof = this->additive_proj_data_sptr->get_proj_data_info_sptr()->is_tof_data();
+      const int num_timing_poss = max_timing_pos_num - min_timing_pos_num + 1;
+      const int num_buckets = (max_segment_num - min_segment_num + 1) * num_timing_poss;
+      std::vector<std::vector<std::size_t>> buckets(num_buckets);
+      for (std::size_t ie = 0; ie < record_cache.size(); ++ie)
         {
-          info("Caching add background with " + std::to_string(omp_get_num_threads()) + " threads", 2);
+          BinAndCorr& cur_bin = record_cache[ie];
+          const int seg = cur_bin.my_bin.segment_num();
+          const int timing_pos_num = add_is_tof ? cur_bin.my_bin.timing_pos_num() : 0;
+          if (seg < min_segment_num || seg > max_segment_num || timing_pos_num < min_timing_pos_num
+              || timing_pos_num > max_timing_pos_num)
+            {
+              cur_bin.my_corr = 0.F;
+              continue;
+            }
+          buckets[(seg - min_segment_num) * num_timing_poss + (timing_pos_num - min_timing_pos_num)].push_back(ie);
         }
-      }
-#endif
-
-#ifdef STIR_OPENMP
-#  if _OPENMP < 201107
-#    pragma omp parallel for schedule(dynamic)
-#  else
-#    pragma omp parallel for collapse(2) schedule(dynamic)
-#  endif
-#endif
-      for (int seg = this->additive_proj_data_sptr->get_min_segment_num();
-           seg <= this->additive_proj_data_sptr->get_max_segment_num();
-           ++seg)
-        for (int timing_pos_num = this->additive_proj_data_sptr->get_min_tof_pos_num();
-             timing_pos_num <= this->additive_proj_data_sptr->get_max_tof_pos_num();
-             ++timing_pos_num)
-          {
-            const auto segment(this->additive_proj_data_sptr->get_segment_by_view(seg, timing_pos_num));
 
-            for (BinAndCorr& cur_bin : record_cache)
-              {
-                if (cur_bin.my_bin.segment_num() == seg)
-                  {
+      // every event is in only one bucket, so threads can write without synchronisation
 #ifdef STIR_OPENMP
-#  if _OPENMP >= 201012
-#    pragma omp atomic write
-#  else
-#    pragma omp critical(PLogLikListModePMBAddSinoCaching)
-#  endif
+#  pragma omp parallel for schedule(dynamic)
 #endif
-                    cur_bin.my_corr
-                        = segment[cur_bin.my_bin.view_num()][cur_bin.my_bin.axial_pos_num()][cur_bin.my_bin.tangential_pos_num()];
-                  }
-              }
-          }
+      for (int bucket_num = 0; bucket_num < num_buckets; ++bucket_num)
+        {
+          const std::vector<std::size_t>& bucket = buckets[bucket_num];
+          if (bucket.empty())
+            continue;
+          const int seg = min_segment_num + bucket_num / num_timing_poss;
+          const int timing_pos_num = min_timing_pos_num + bucket_num % num_timing_poss;
+          const auto segment(this->additive_proj_data_sptr->get_segment_by_view(seg, timing_pos_num));
+          for (const std::size_t ie : bucket)
+            {
+              BinAndCorr& cur_bin = record_cache[ie];
+              cur_bin.my_corr
+                  = segment[cur_bin.my_bin.view_num()][cur_bin.my_bin.axial_pos_num()][cur_bin.my_bin.tangential_pos_num()];
+            }
+        }
+      CPU_timer.stop();
+      wall_clock_timer.stop();
+      info(boost::format("Computation times for caching additive corrections, CPU %1%s, wall-clock %2%s") % CPU_timer.value()
+               % wall_clock_timer.value(),
+           2);
     } // end additive correction
   return stop_caching;
 }
@@ -604,14 +667,58 @@ bool
 PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::load_listmode_batch(
     unsigned int ibatch) const
 {
-  if (this->cache_lm_file)
-    {
-      return this->load_listmode_cache_file(ibatch);
-    }
-  else
+  const bool stop = this->cache_lm_file ? this->load_listmode_cache_file(ibatch) : this->read_listmode_batch(ibatch);
+  // Note: we merge after reading such that cache files still contain one record per event
+  if (this->sort_and_merge_events)
+    this->sort_and_merge_record_cache();
+  return stop;
+}
+
+namespace
+{
+// compare bins on segment, view, axial, tangential and timing position (ignoring the value)
+// returns -1, 0, 1 for "smaller", "equal", "larger" respectively
+inline int
+compare_bin_coordinates(const Bin& b1, const Bin& b2)
+{
+  if (b1.segment_num() != b2.segment_num())
+    return b1.segment_num() < b2.segment_num() ? -1 : 1;
+  if (b1.view_num() != b2.view_num())
+    return b1.view_num() < b2.view_num() ? -1 : 1;
+  if (b1.axial_pos_num() != b2.axial_pos_num())
+    return b1.axial_pos_num() < b2.axial_pos_num() ? -1 : 1;
+  if (b1.tangential_pos_num() != b2.tangential_pos_num())
+    return b1.tangential_pos_num() < b2.tangential_pos_num() ? -1 : 1;
+  if (b1.timing_pos_num() != b2.timing_pos_num())
+    return b1.timing_pos_num() < b2.timing_pos_num() ? -1 : 1;
+  return 0;
+}
+} // namespace
+
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::sort_and_merge_record_cache() const
+{
+  if (record_cache.empty())
+    return;
+
+  const std::size_t num_events = record_cache.size();
+  std::sort(record_cache.begin(), record_cache.end(), [](const BinAndCorr& a, const BinAndCorr& b) {
+    return compare_bin_coordinates(a.my_bin, b.my_bin) < 0;
+  });
+
+  // merge consecutive records with the same bin, adding their bin values (i.e. counts).
+  // The additive term only depends on the bin, so we can keep the one of the first record.
+  std::vector<BinAndCorr>::iterator out_iter = record_cache.begin();
+  for (std::vector<BinAndCorr>::const_iterator iter = record_cache.begin() + 1; iter != record_cache.end(); ++iter)
     {
-      return this->read_listmode_batch(ibatch);
+      if (compare_bin_coordinates(iter->my_bin, out_iter->my_bin) == 0)
+        out_iter->my_bin.set_bin_value(out_iter->my_bin.get_bin_value() + iter->my_bin.get_bin_value());
+      else
+        *(++out_iter) = *iter;
     }
+  record_cache.erase(out_iter + 1, record_cache.end());
+  info(boost::format("Merged %1% events into %2% unique bins") % num_events % record_cache.size(), 2);
 }
 
 template <typename TargetT>
@@ -750,14 +857,18 @@ constexpr float max_quotient = 10000.F;
 /* gradient without the sensitivity term
 
 \sum_e A_e^t (y_e/(A_e lambda+ c))
+
+Note that y_e is the bin value of the measured bin, i.e. the number of events in this bin.
+This is normally 1, unless events were merged (see sort_and_merge_events). The check for
+the singularity is done per event, such that results do not depend on merging.
 */
 template <bool do_gradient, bool do_value>
 inline void
-LM_gradient_and_value(DiscretisedDensity<3, float>& output_image,
+LM_gradient_and_value(const DiscretisedDensityAccess& output_image,
                       const ProjMatrixElemsForOneBin& row,
                       const float add_term,
                       const Bin& measured_bin,
-                      const DiscretisedDensity<3, float>& input_image,
+                      const DiscretisedDensityAccess& input_image,
                       double* value_ptr)
 {
   Bin fwd_bin = measured_bin;
@@ -765,14 +876,14 @@ LM_gradient_and_value(DiscretisedDensity<3, float>& output_image,
   row.forward_project(fwd_bin, input_image);
   const auto fwd = fwd_bin.get_bin_value() + add_term;
 
-  if (measured_bin.get_bin_value() > max_quotient * fwd)
+  if (1.F > max_quotient * fwd)
     {
       // cancel singularity
       if (do_value)
         {
           assert(value_ptr);
           const auto num = measured_bin.get_bin_value();
-          *value_ptr -= num * log(double(num / max_quotient));
+          *value_ptr -= num * log(double(1.F / max_quotient));
           return;
         }
     }
@@ -792,20 +903,20 @@ LM_gradient_and_value(DiscretisedDensity<3, float>& output_image,
 \sum_e -A_e^t (y_e/(A_e lambda+ c)^2 A_e rhs)
 */
 inline void
-LM_Hessian(DiscretisedDensity<3, float>& output_image,
+LM_Hessian(const DiscretisedDensityAccess& output_image,
            const ProjMatrixElemsForOneBin& row,
            const float add_term,
            const Bin& measured_bin,
-           const DiscretisedDensity<3, float>& input_image,
-           const DiscretisedDensity<3, float>& rhs)
+           const DiscretisedDensityAccess& input_image,
+           const DiscretisedDensityAccess& rhs)
 {
   Bin fwd_bin = measured_bin;
   fwd_bin.set_bin_value(0.0f);
   row.forward_project(fwd_bin, input_image);
   const auto fwd = fwd_bin.get_bin_value() + add_term;
 
-  if (measured_bin.get_bin_value() > max_quotient * fwd)
-    return; // cancel singularity
+  if (1.F > max_quotient * fwd)
+    return; // cancel singularity (per event, see LM_gradient_and_value)
   const auto measured_div_fwd2 = -measured_bin.get_bin_value() / square(fwd);
 
   // forward project rhs
@@ -856,7 +967,8 @@ LM_Hessian_distributable_computation(const shared_ptr<ProjMatrixByBin> PM_sptr,
                                      const bool accumulate)
 {
   using namespace std::placeholders;
-  auto H_func = std::bind(LM_Hessian, _1, _2, _3, _4, _5, std::cref(*rhs_ptr));
+  const DiscretisedDensityAccess rhs_access(*rhs_ptr);
+  auto H_func = std::bind(LM_Hessian, _1, _2, _3, _4, _5, std::cref(rhs_access));
   LM_distributable_computation(PM_sptr,
                                proj_data_info_sptr,
                                output_image_ptr,
@@ -942,6 +1054,7 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<
       if (stop)
         break;
     }
+  this->update_proj_matrix_cache_state(subset_num);
 
   if (!add_sensitivity)
     {
@@ -97,6 +97,7 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::set_defaults()
   this->proj_data_sptr.reset(); // MJ added
   this->zero_seg0_end_planes = 0;
   this->use_tofsens = false;
+  this->num_viewgrams_to_read_ahead = -1;
 
   this->additive_projection_data_filename = "0";
   this->additive_proj_data_sptr.reset();
@@ -156,6 +157,7 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::initialise_keyma
   this->parser.add_key("time frame definition filename", &this->frame_definition_filename);
   this->parser.add_key("time frame number", &this->frame_num);
   this->parser.add_parsing_key("Bin Normalisation type", &this->normalisation_sptr);
+  this->parser.add_key("number of viewgrams to read ahead", &this->num_viewgrams_to_read_ahead);
 
 #ifdef STIR_MPI
   // distributed stuff
@@ -325,6 +327,13 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::get_zero_seg0_en
   return this->zero_seg0_end_planes;
 }
 
+template <typename TargetT>
+int
+PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::get_num_viewgrams_to_read_ahead() const
+{
+  return this->num_viewgrams_to_read_ahead;
+}
+
 template <typename TargetT>
 const ProjData&
 PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::get_additive_proj_data() const
@@ -426,6 +435,13 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::set_zero_seg0_en
   this->zero_seg0_end_planes = arg;
 }
 
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::set_num_viewgrams_to_read_ahead(const int arg)
+{
+  this->num_viewgrams_to_read_ahead = arg;
+}
+
 template <typename TargetT>
 void
 PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::set_additive_proj_data_sptr(const shared_ptr<ExamData>& arg)
@@ -731,7 +747,8 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::actual_compute_s
                                  caching_info_ptr,
                                  -this->max_timing_pos_num_to_process,
                                  this->max_timing_pos_num_to_process,
-                                 add_sensitivity);
+                                 add_sensitivity,
+                                 this->num_viewgrams_to_read_ahead);
 }
 
 template <typename TargetT>
@@ -775,7 +792,8 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::actual_compute_o
                                          this->get_time_frame_definitions().get_end_time(this->get_time_frame_num()),
                                          this->caching_info_ptr,
                                          -this->max_timing_pos_num_to_process,
-                                         this->max_timing_pos_num_to_process);
+                                         this->max_timing_pos_num_to_process,
+                                         this->num_viewgrams_to_read_ahead);
 
   return accum;
 }
@@ -891,7 +909,8 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::add_subset_sensi
                                         this->get_time_frame_definitions().get_end_time(this->get_time_frame_num()),
                                         this->caching_info_ptr,
                                         use_tofsens ? -this->max_timing_pos_num_to_process : 0,
-                                        use_tofsens ? this->max_timing_pos_num_to_process : 0);
+                                        use_tofsens ? this->max_timing_pos_num_to_process : 0,
+                                        this->num_viewgrams_to_read_ahead);
 
   std::transform(sensitivity.begin_all(),
                  sensitivity.end_all(),
@@ -1253,7 +1272,8 @@ distributable_compute_gradient(const shared_ptr<ForwardProjectorByBin>& forward_
                                DistributedCachingInformation* caching_info_ptr,
                                int min_timing_pos_num,
                                int max_timing_pos_num,
-                               const bool add_sensitivity)
+                               const bool add_sensitivity,
+                               const int num_viewgrams_to_prefetch)
 {
   if (add_sensitivity)
     {
@@ -1278,7 +1298,8 @@ distributable_compute_gradient(const shared_ptr<ForwardProjectorByBin>& forward_
                                 &RPC_process_related_viewgrams_gradient<true>,
                                 caching_info_ptr,
                                 min_timing_pos_num,
-                                max_timing_pos_num);
+                                max_timing_pos_num,
+                                num_viewgrams_to_prefetch);
     }
   else if (!add_sensitivity)
     {
@@ -1303,7 +1324,8 @@ distributable_compute_gradient(const shared_ptr<ForwardProjectorByBin>& forward_
                                 &RPC_process_related_viewgrams_gradient<false>,
                                 caching_info_ptr,
                                 min_timing_pos_num,
-                                max_timing_pos_num);
+                                max_timing_pos_num,
+                                num_viewgrams_to_prefetch);
     }
 }
 
@@ -1325,7 +1347,8 @@ distributable_accumulate_loglikelihood(const shared_ptr<ForwardProjectorByBin>&
                                        const double end_time_of_frame,
                                        DistributedCachingInformation* caching_info_ptr,
                                        int min_timing_pos_num,
-                                       int max_timing_pos_num)
+                                       int max_timing_pos_num,
+                                       const int num_viewgrams_to_prefetch)
 
 {
   distributable_computation(forward_projector_sptr,
@@ -1348,7 +1371,8 @@ distributable_accumulate_loglikelihood(const shared_ptr<ForwardProjectorByBin>&
                             &RPC_process_related_viewgrams_accumulate_loglikelihood,
                             caching_info_ptr,
                             min_timing_pos_num,
-                            max_timing_pos_num);
+                            max_timing_pos_num,
+                            num_viewgrams_to_prefetch);
 }
 
 void
@@ -1369,7 +1393,8 @@ distributable_sensitivity_computation(const shared_ptr<BackProjectorByBin>& back
                                       const double end_time_of_frame,
                                       DistributedCachingInformation* caching_info_ptr,
                                       int min_timing_pos_num,
-                                      int max_timing_pos_num)
+                                      int max_timing_pos_num,
+                                      const int num_viewgrams_to_prefetch)
 
 {
   distributable_computation(0,
@@ -1392,7 +1417,8 @@ distributable_sensitivity_computation(const shared_ptr<BackProjectorByBin>& back
                             &RPC_process_related_viewgrams_sensitivity_computation,
                             caching_info_ptr,
                             min_timing_pos_num,
-                            max_timing_pos_num);
+                            max_timing_pos_num,
+                            num_viewgrams_to_prefetch);
 }
 
 //////////// RPC functions
@@ -31,7 +31,7 @@ void
 PostsmoothingBackProjectorByBin::set_defaults()
 {
   original_back_projector_ptr.reset();
-  _post_data_processor_sptr.reset();
+  BackProjectorByBin::set_defaults();
 }
 
 void
@@ -41,11 +41,14 @@ PostsmoothingBackProjectorByBin::initialise_keymap()
   parser.add_stop_key("End Post Smoothing Back Projector Parameters");
   parser.add_parsing_key("Original Back projector type", &original_back_projector_ptr);
   parser.add_parsing_key("filter type", &_post_data_processor_sptr);
+  BackProjectorByBin::initialise_keymap();
 }
 
 bool
 PostsmoothingBackProjectorByBin::post_processing()
 {
+  if (BackProjectorByBin::post_processing() == true)
+    return true;
   if (is_null_ptr(original_back_projector_ptr))
     {
       warning("Pre Smoothing Back Projector: original back projector needs to be set");
@@ -27,6 +27,8 @@
 #include "stir/recon_buildblock/ProjMatrixByBin.h"
 #include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
 #include "stir/TOF_conversions.h"
+#include "stir/num_threads.h"
+#include "stir/warning.h"
 
 START_NAMESPACE_STIR
 
@@ -35,6 +37,10 @@ ProjMatrixByBin::set_defaults()
 {
   cache_disabled = false;
   cache_stores_only_basic_bins = true;
+  cache_frozen = false;
+  cache_is_compact = false;
+  compact_cache_value_encoding = CompactProjMatrixElemsStore::ValueEncoding::float32;
+  compact_cache_value_encoding_as_string = CompactProjMatrixElemsStore::value_encoding_to_string(compact_cache_value_encoding);
   gauss_sigma_in_mm = 0.f;
   r_sqrt2_gauss_sigma = 0.f;
 }
@@ -44,11 +50,24 @@ ProjMatrixByBin::initialise_keymap()
 {
   parser.add_key("disable caching", &cache_disabled);
   parser.add_key("store_only_basic_bins_in_cache", &cache_stores_only_basic_bins);
+  parser.add_key("use compact cache", &cache_is_compact);
+  parser.add_key("compact cache value encoding", &compact_cache_value_encoding_as_string);
 }
 
 bool
 ProjMatrixByBin::post_processing()
 {
+  if (compact_cache_value_encoding_as_string == "float")
+    compact_cache_value_encoding = CompactProjMatrixElemsStore::ValueEncoding::float32;
+  else if (compact_cache_value_encoding_as_string == "fp16")
+    compact_cache_value_encoding = CompactProjMatrixElemsStore::ValueEncoding::float16;
+  else if (compact_cache_value_encoding_as_string == "quantised")
+    compact_cache_value_encoding = CompactProjMatrixElemsStore::ValueEncoding::quantised16;
+  else
+    {
+      warning("ProjMatrixByBin: \"compact cache value encoding\" has to be one of float, fp16 or quantised");
+      return true;
+    }
   return false;
 }
 
@@ -63,6 +82,12 @@ ProjMatrixByBin::enable_cache(const bool v)
   cache_disabled = !v;
 }
 
+std::size_t
+ProjMatrixByBin::get_max_num_elems_per_row_estimate() const
+{
+  return 0;
+}
+
 void
 ProjMatrixByBin::enable_tof(const shared_ptr<const ProjDataInfo>& _proj_data_info_sptr, const bool v)
 {
@@ -80,6 +105,30 @@ ProjMatrixByBin::store_only_basic_bins_in_cache(const bool v)
   cache_stores_only_basic_bins = v;
 }
 
+void
+ProjMatrixByBin::enable_compact_cache(const bool v, const CompactProjMatrixElemsStore::ValueEncoding value_encoding)
+{
+  cache_is_compact = v;
+  compact_cache_value_encoding = value_encoding;
+  compact_cache_value_encoding_as_string = CompactProjMatrixElemsStore::value_encoding_to_string(value_encoding);
+}
+
+bool
+ProjMatrixByBin::is_cache_compact() const
+{
+  return cache_is_compact;
+}
+
+std::size_t
+ProjMatrixByBin::get_compact_cache_num_bytes_used() const
+{
+  std::size_t num_bytes = 0;
+  for (int i = this->compact_cache_collection.get_min_index(); i <= this->compact_cache_collection.get_max_index(); ++i)
+    for (int j = this->compact_cache_collection[i].get_min_index(); j <= this->compact_cache_collection[i].get_max_index(); ++j)
+      num_bytes += this->compact_cache_collection[i][j].get_num_bytes_used();
+  return num_bytes;
+}
+
 bool
 ProjMatrixByBin::is_cache_enabled() const
 {
@@ -105,6 +154,65 @@ ProjMatrixByBin::clear_cache() const
           this->cache_collection[i][j].clear();
         }
     }
+  for (int i = this->compact_cache_collection.get_min_index(); i <= this->compact_cache_collection.get_max_index(); ++i)
+    {
+      for (int j = this->compact_cache_collection[i].get_min_index(); j <= this->compact_cache_collection[i].get_max_index();
+           ++j)
+        {
+          this->compact_cache_collection[i][j].clear();
+        }
+    }
+  this->cache_frozen = false;
+}
+
+void
+ProjMatrixByBin::freeze_cache(const bool v) const
+{
+  this->cache_frozen = v;
+}
+
+bool
+ProjMatrixByBin::is_cache_frozen() const
+{
+  return this->cache_frozen;
+}
+
+double
+ProjMatrixByBin::CacheStatistics::get_hit_rate() const
+{
+  const std::uint64_t num_lookups = num_hits + num_misses;
+  return num_lookups == 0 ? 0. : static_cast<double>(num_hits) / num_lookups;
+}
+
+ProjMatrixByBin::CacheStatistics
+ProjMatrixByBin::get_cache_statistics() const
+{
+  CacheStatistics total;
+  for (const auto& s : this->cache_statistics_per_thread)
+    {
+      total.num_hits += s.stats.num_hits;
+      total.num_misses += s.stats.num_misses;
+      total.num_lock_contentions += s.stats.num_lock_contentions;
+    }
+  return total;
+}
+
+void
+ProjMatrixByBin::reset_cache_statistics() const
+{
+  for (auto& s : this->cache_statistics_per_thread)
+    s.stats = CacheStatistics();
+}
+
+ProjMatrixByBin::CacheStatistics*
+ProjMatrixByBin::get_cache_statistics_ptr_for_this_thread() const
+{
+#ifdef STIR_OPENMP
+  const std::size_t thread_num = static_cast<std::size_t>(omp_get_thread_num());
+#else
+  const std::size_t thread_num = 0;
+#endif
+  return thread_num < this->cache_statistics_per_thread.size() ? &this->cache_statistics_per_thread[thread_num].stats : 0;
 }
 
 /*
@@ -154,8 +262,14 @@ ProjMatrixByBin::set_up(const shared_ptr<const ProjDataInfo>& proj_data_info_spt
       tof_enabled = false;
     }
 
+  this->cache_frozen = false;
   this->cache_collection.recycle();
-  this->cache_collection.resize(min_view_num, max_view_num);
+  this->compact_cache_collection.recycle();
+  if (this->cache_is_compact)
+    this->compact_cache_collection.resize(min_view_num, max_view_num);
+  else
+    this->cache_collection.resize(min_view_num, max_view_num);
+  this->cache_statistics_per_thread.assign(static_cast<std::size_t>(get_max_num_threads()), CacheStatisticsForOneThread());
 #ifdef STIR_OPENMP
   this->cache_locks.recycle();
   this->cache_locks.resize(min_view_num, max_view_num);
@@ -163,7 +277,15 @@ ProjMatrixByBin::set_up(const shared_ptr<const ProjDataInfo>& proj_data_info_spt
 
   for (int view_num = min_view_num; view_num <= max_view_num; ++view_num)
     {
-      this->cache_collection[view_num].resize(min_segment_num, max_segment_num);
+      if (this->cache_is_compact)
+        {
+          this->compact_cache_collection[view_num].resize(min_segment_num, max_segment_num);
+          for (int seg_num = min_segment_num; seg_num <= max_segment_num; ++seg_num)
+            this->compact_cache_collection[view_num][seg_num]
+                = CompactProjMatrixElemsStore(this->compact_cache_value_encoding);
+        }
+      else
+        this->cache_collection[view_num].resize(min_segment_num, max_segment_num);
 #ifdef STIR_OPENMP
       this->cache_locks[view_num].resize(min_segment_num, max_segment_num);
       for (int seg_num = min_segment_num; seg_num <= max_segment_num; ++seg_num)
@@ -201,22 +323,46 @@ ProjMatrixByBin::cache_key(const Bin& bin) const
 void
 ProjMatrixByBin::cache_proj_matrix_elems_for_one_bin(const ProjMatrixElemsForOneBin& probabilities) const
 {
-  if (cache_disabled)
+  if (cache_disabled || cache_frozen)
     return;
 
   // std::cerr << "cached lor size " << probabilities.size() << " capacity " << probabilities.capacity() << std::endl;
   //  insert probabilities into the collection
   const Bin bin = probabilities.get_bin();
 #ifdef STIR_OPENMP
-  omp_set_lock(&this->cache_locks[bin.view_num()][bin.segment_num()]);
+  omp_lock_t& lock = this->cache_locks[bin.view_num()][bin.segment_num()];
+  if (!omp_test_lock(&lock))
+    {
+      if (CacheStatistics* stats_ptr = get_cache_statistics_ptr_for_this_thread())
+        ++stats_ptr->num_lock_contentions;
+      omp_set_lock(&lock);
+    }
 #endif
-  cache_collection[bin.view_num()][bin.segment_num()].insert(
-      MapProjMatrixElemsForOneBin::value_type(cache_key(bin), probabilities));
+  if (cache_is_compact)
+    compact_cache_collection[bin.view_num()][bin.segment_num()].insert(cache_key(bin), probabilities);
+  else
+    cache_collection[bin.view_num()][bin.segment_num()].insert(
+        MapProjMatrixElemsForOneBin::value_type(cache_key(bin), probabilities));
 #ifdef STIR_OPENMP
-  omp_unset_lock(&this->cache_locks[bin.view_num()][bin.segment_num()]);
+  omp_unset_lock(&lock);
 #endif
 }
 
+bool
+ProjMatrixByBin::find_in_cache(ProjMatrixElemsForOneBin& probabilities, const Bin& bin) const
+{
+  if (cache_is_compact)
+    return compact_cache_collection[bin.view_num()][bin.segment_num()].find(cache_key(bin), probabilities);
+
+  const MapProjMatrixElemsForOneBin& cache = cache_collection[bin.view_num()][bin.segment_num()];
+  const_MapProjMatrixElemsForOneBinIterator pos = cache.find(cache_key(bin));
+  if (pos == cache.end())
+    return false;
+  // cout << Key << " =========>> entry found in cache " <<  endl;
+  probabilities = pos->second;
+  return true;
+}
+
 Succeeded
 ProjMatrixByBin::get_cached_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin& probabilities) const
 {
@@ -235,25 +381,35 @@ ProjMatrixByBin::get_cached_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneB
 #endif
 
   bool found = false;
+  if (cache_frozen)
+    {
+      // the cache is read-only, so we can look-up without locking
+      found = find_in_cache(probabilities, bin);
+    }
+  else
+    {
 #ifdef STIR_OPENMP
-  omp_set_lock(&this->cache_locks[bin.view_num()][bin.segment_num()]);
+      omp_lock_t& lock = this->cache_locks[bin.view_num()][bin.segment_num()];
+      if (!omp_test_lock(&lock))
+        {
+          if (CacheStatistics* stats_ptr = get_cache_statistics_ptr_for_this_thread())
+            ++stats_ptr->num_lock_contentions;
+          omp_set_lock(&lock);
+        }
 #endif
-
-  {
-    const_MapProjMatrixElemsForOneBinIterator pos = cache_collection[bin.view_num()][bin.segment_num()].find(cache_key(bin));
-
-    if (pos != cache_collection[bin.view_num()][bin.segment_num()].end())
-      {
-        // cout << Key << " =========>> entry found in cache " <<  endl;
-        probabilities = pos->second;
-        // note: cannot return from inside an OPENMP critical section
-        // return Succeeded::yes;
-        found = true;
-      }
-  }
+      // note: cannot return from inside an OPENMP critical section
+      found = find_in_cache(probabilities, bin);
 #ifdef STIR_OPENMP
-  omp_unset_lock(&this->cache_locks[bin.view_num()][bin.segment_num()]);
+      omp_unset_lock(&lock);
 #endif
+    }
+  if (CacheStatistics* stats_ptr = get_cache_statistics_ptr_for_this_thread())
+    {
+      if (found)
+        ++stats_ptr->num_hits;
+      else
+        ++stats_ptr->num_misses;
+    }
   if (found)
     return Succeeded::yes;
   else
@@ -32,6 +32,7 @@
 #include "stir/Succeeded.h"
 #include "stir/is_null_ptr.h"
 #include "stir/Coordinate3D.h"
+#include "stir/MemoryMappedFile.h"
 //#include "boost/format.hpp"
 //#include "stir/info.h"
 #include "boost/cstdint.hpp"
@@ -40,6 +41,8 @@
 #include "stir/error.h"
 #include <fstream>
 #include <algorithm>
+#include <vector>
+#include <cstring>
 
 using std::string;
 
@@ -61,6 +64,7 @@ ProjMatrixByBinFromFile::initialise_keymap()
   parser.add_key("template_density_filename", &template_density_filename);
   parser.add_key("template_proj_data_filename", &template_proj_data_filename);
   parser.add_key("data_filename", &data_filename);
+  parser.add_key("index_filename", &index_filename);
 
   parser.add_key("Version", &this->parsed_version);
   parser.add_key("symmetries type", &this->symmetries_type);
@@ -84,6 +88,9 @@ ProjMatrixByBinFromFile::set_defaults()
   template_density_filename = "";
   template_proj_data_filename = "";
   data_filename = "";
+  index_filename = "";
+  data_mmap_sptr.reset();
+  index_mmap_sptr.reset();
 
   do_symmetry_90degrees_min_phi = true;
   do_symmetry_180degrees_min_phi = true;
@@ -98,9 +105,9 @@ ProjMatrixByBinFromFile::post_processing()
   if (ProjMatrixByBin::post_processing() == true)
     return true;
 
-  if (this->parsed_version != "1.0")
+  if (this->parsed_version != "1.0" && this->parsed_version != "2.0")
     {
-      warning("version has to be 1.0");
+      warning("version has to be 1.0 or 2.0");
       return true;
     }
   this->symmetries_type = standardise_interfile_keyword(this->symmetries_type);
@@ -125,6 +132,11 @@ ProjMatrixByBinFromFile::post_processing()
       warning("data_filename has to be specified.\n");
       return true;
     }
+  if (this->parsed_version == "2.0" && index_filename.size() == 0)
+    {
+      warning("index_filename has to be specified for version 2.0.\n");
+      return true;
+    }
   {
     shared_ptr<ProjData> proj_data_sptr = ProjData::read_from_file(template_proj_data_filename);
     this->proj_data_info_ptr.reset(proj_data_sptr->get_proj_data_info_sptr()->clone());
@@ -195,8 +207,16 @@ ProjMatrixByBinFromFile::set_up(const shared_ptr<const ProjDataInfo>& proj_data_
   // every LOR that's in the file in the cache
   ProjMatrixByBin::set_up(this->proj_data_info_ptr, density_info_ptr);
 
-  if (read_data() == Succeeded::no)
-    error("Something wrong reading the matrix from file. Exiting.");
+  if (this->parsed_version == "1.0")
+    {
+      if (read_data() == Succeeded::no)
+        error("Something wrong reading the matrix from file. Exiting.");
+    }
+  else
+    {
+      if (map_data() == Succeeded::no)
+        error("Something wrong mapping the matrix from file. Exiting.");
+    }
 }
 
 ProjMatrixByBinFromFile*
@@ -327,6 +347,72 @@ read_lor(std::istream& fst, ProjMatrixElemsForOneBin& lor)
     }
   return readReturnType::ok;
 }
+
+// entry in the index file (version 2.0)
+struct IndexEntry
+{
+  boost::int32_t segment_num;
+  boost::int32_t view_num;
+  boost::int32_t axial_pos_num;
+  boost::int32_t tangential_pos_num;
+  boost::uint64_t offset;
+
+  bool operator<(const IndexEntry& e) const
+  {
+    if (segment_num != e.segment_num)
+      return segment_num < e.segment_num;
+    if (view_num != e.view_num)
+      return view_num < e.view_num;
+    if (axial_pos_num != e.axial_pos_num)
+      return axial_pos_num < e.axial_pos_num;
+    return tangential_pos_num < e.tangential_pos_num;
+  }
+};
+static_assert(sizeof(IndexEntry) == 24, "IndexEntry should not have any padding");
+
+const char index_magic[] = "STIRPMI1";
+const std::size_t index_magic_size = 8;
+const std::size_t index_header_size = index_magic_size + sizeof(boost::uint64_t);
+// size of a row in the data file without its elements
+const std::size_t lor_header_size = 4 * sizeof(boost::int32_t) + sizeof(boost::uint32_t);
+// size of one element in the data file
+const std::size_t lor_element_size = 3 * sizeof(boost::int16_t) + sizeof(float);
+
+template <typename T>
+inline const char*
+read_from_memory(const char* ptr, T& v)
+{
+  std::memcpy(&v, ptr, sizeof(T));
+  return ptr + sizeof(T);
+}
+
+// decode a row from memory (in the same format as written by write_lor()), but keep the bin of lor
+Succeeded
+read_lor_from_memory(const char* ptr, const char* const end_ptr, ProjMatrixElemsForOneBin& lor)
+{
+  lor.erase();
+  if (end_ptr - ptr < static_cast<std::ptrdiff_t>(lor_header_size))
+    return Succeeded::no;
+  ptr += 4 * sizeof(boost::int32_t);
+  boost::uint32_t count;
+  ptr = read_from_memory(ptr, count);
+  if (static_cast<std::size_t>(end_ptr - ptr) < count * lor_element_size)
+    return Succeeded::no;
+
+  lor.reserve(count);
+  for (boost::uint32_t i = 0; i < count; ++i)
+    {
+      boost::int16_t c1, c2, c3;
+      float value;
+      ptr = read_from_memory(ptr, c1);
+      ptr = read_from_memory(ptr, c2);
+      ptr = read_from_memory(ptr, c3);
+      ptr = read_from_memory(ptr, value);
+      lor.push_back(ProjMatrixElemsForOneBin::value_type(Coordinate3D<int>(c1, c2, c3), value));
+    }
+  return Succeeded::yes;
+}
+
 } // end of anonymous namespace
 
 Succeeded
@@ -351,11 +437,15 @@ ProjMatrixByBinFromFile::write_to_file(const std::string& output_filename_prefix
     shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo);
     ProjDataInterfile template_projdata(exam_info_sptr, proj_data_info_sptr, template_proj_data_filename);
   }
+  // ProjDataInterfile writes the header with extension .hs
+  replace_extension(template_proj_data_filename, ".hs");
 
   string header_filename = output_filename_prefix;
   replace_extension(header_filename, ".hpm");
   string data_filename = output_filename_prefix;
   add_extension(data_filename, ".pm");
+  string index_filename = output_filename_prefix;
+  add_extension(index_filename, ".pmi");
 
   {
     std::ofstream header(header_filename.c_str());
@@ -366,7 +456,9 @@ ProjMatrixByBinFromFile::write_to_file(const std::string& output_filename_prefix
       }
 
     header << "Projection Matrix By Bin From File Parameters:=\n"
-           << "Version := 1.0\n";
+           << "Version := 2.0\n"
+           << "; rows are read on demand from the memory-mapped data, so caching is not very useful\n"
+           << "disable caching := 1\n";
     // TODO symmetries should not be hard-coded
     if (!is_null_ptr(dynamic_cast<const DataSymmetriesForBins_PET_CartesianGrid* const>(proj_matrix.get_symmetries_ptr())))
       {
@@ -396,6 +488,7 @@ ProjMatrixByBinFromFile::write_to_file(const std::string& output_filename_prefix
     header << "template density filename:=" << template_density_filename << '\n';
 
     header << "data_filename:=" << data_filename << '\n';
+    header << "index_filename:=" << index_filename << '\n';
 
     header << "End Projection Matrix By Bin From File Parameters:=";
   }
@@ -403,6 +496,8 @@ ProjMatrixByBinFromFile::write_to_file(const std::string& output_filename_prefix
   std::ofstream fst;
   open_write_binary(fst, data_filename.c_str());
 
+  std::vector<IndexEntry> index;
+
   // loop over bins
   // the complication here is that we cannot just test if each bin in the range is 'basic'
   // and write only those. The reason is that symmetry operations can construct a
@@ -482,10 +577,37 @@ ProjMatrixByBinFromFile::write_to_file(const std::string& output_filename_prefix
               //   continue;
 
               proj_matrix.get_proj_matrix_elems_for_one_bin(lor, bin);
+              {
+                const Bin stored_bin = lor.get_bin();
+                IndexEntry entry;
+                entry.segment_num = stored_bin.segment_num();
+                entry.view_num = stored_bin.view_num();
+                entry.axial_pos_num = stored_bin.axial_pos_num();
+                entry.tangential_pos_num = stored_bin.tangential_pos_num();
+                entry.offset = static_cast<boost::uint64_t>(fst.tellp());
+                index.push_back(entry);
+              }
               if (write_lor(fst, lor) == Succeeded::no)
                 return Succeeded::no;
             }
   }
+
+  // write index, sorted such that we can use a binary search when reading
+  {
+    std::sort(index.begin(), index.end());
+    std::ofstream index_fst;
+    open_write_binary(index_fst, index_filename.c_str());
+    index_fst.write(index_magic, index_magic_size);
+    const boost::uint64_t num_entries = index.size();
+    index_fst.write((const char*)&num_entries, sizeof(num_entries));
+    if (!index.empty())
+      index_fst.write((const char*)index.data(), static_cast<std::streamsize>(index.size() * sizeof(IndexEntry)));
+    if (!index_fst)
+      {
+        warning("Error writing index file %s", index_filename.c_str());
+        return Succeeded::no;
+      }
+  }
   return Succeeded::yes;
 }
 
@@ -509,10 +631,67 @@ ProjMatrixByBinFromFile::read_data()
   return Succeeded::yes;
 }
 
+Succeeded
+ProjMatrixByBinFromFile::map_data()
+{
+  // files are only mapped once, and then shared between clones
+  if (!is_null_ptr(data_mmap_sptr) && !is_null_ptr(index_mmap_sptr))
+    return Succeeded::yes;
+
+  shared_ptr<MemoryMappedFile> index_sptr(new MemoryMappedFile(index_filename));
+  if (index_sptr->size() < index_header_size
+      || std::memcmp(index_sptr->get_const_data_ptr(), index_magic, index_magic_size) != 0)
+    {
+      warning("ProjMatrixByBinFromFile: %s is not a valid index file", index_filename.c_str());
+      return Succeeded::no;
+    }
+  boost::uint64_t num_entries;
+  read_from_memory(index_sptr->get_const_data_ptr() + index_magic_size, num_entries);
+  if (index_sptr->size() != index_header_size + num_entries * sizeof(IndexEntry))
+    {
+      warning("ProjMatrixByBinFromFile: size of index file %s does not match its number of entries", index_filename.c_str());
+      return Succeeded::no;
+    }
+  this->index_mmap_sptr = index_sptr;
+  this->data_mmap_sptr.reset(new MemoryMappedFile(data_filename));
+  return Succeeded::yes;
+}
+
 void
 ProjMatrixByBinFromFile::calculate_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin& lor) const
 {
-  // error("ProjMatrixByBinFromFile element not found in cache (and hence file)");
-  lor.erase();
+  if (is_null_ptr(this->index_mmap_sptr))
+    {
+      // version 1.0: everything was already in the cache
+      // error("ProjMatrixByBinFromFile element not found in cache (and hence file)");
+      lor.erase();
+      return;
+    }
+
+  // find the bin in the (sorted) index
+  // Note: the index file starts with a 16-byte header and the mapping is page-aligned,
+  // so entries are suitably aligned.
+  const IndexEntry* const index_begin
+      = reinterpret_cast<const IndexEntry*>(this->index_mmap_sptr->get_const_data_ptr() + index_header_size);
+  const IndexEntry* const index_end
+      = index_begin + (this->index_mmap_sptr->size() - index_header_size) / sizeof(IndexEntry);
+  const Bin bin = lor.get_bin();
+  IndexEntry key;
+  key.segment_num = bin.segment_num();
+  key.view_num = bin.view_num();
+  key.axial_pos_num = bin.axial_pos_num();
+  key.tangential_pos_num = bin.tangential_pos_num();
+  const IndexEntry* const entry_ptr = std::lower_bound(index_begin, index_end, key);
+  if (entry_ptr == index_end || key < *entry_ptr)
+    {
+      // not in file, so all elements are zero
+      lor.erase();
+      return;
+    }
+
+  const char* const data_ptr = this->data_mmap_sptr->get_const_data_ptr();
+  if (entry_ptr->offset >= this->data_mmap_sptr->size()
+      || read_lor_from_memory(data_ptr + entry_ptr->offset, data_ptr + this->data_mmap_sptr->size(), lor) == Succeeded::no)
+    error("ProjMatrixByBinFromFile: data file " + data_filename + " is inconsistent with its index file");
 }
 END_NAMESPACE_STIR
@@ -50,6 +50,7 @@
 #include "stir/recon_buildblock/RayTraceVoxelsOnCartesianGrid.h"
 #include "stir/ProjDataInfoCylindricalNoArcCorr.h"
 #include "stir/round.h"
+#include "stir/num_threads.h"
 #include "stir/modulo.h"
 #include "stir/stream.h"
 #include <algorithm>
@@ -400,10 +401,56 @@ ProjMatrixByBinUsingRayTracing::set_up(
   }
 #endif
 
+  // estimate the maximum number of elements in a row, such that we can reserve enough memory
+  {
+    int max_num_lors_per_axial_pos = 1;
+    for (int segment_num = proj_data_info_sptr->get_min_segment_num(); segment_num <= proj_data_info_sptr->get_max_segment_num();
+         ++segment_num)
+      {
+        const Bin bin(segment_num, 0, proj_data_info_sptr->get_min_axial_pos_num(segment_num), 0);
+        const float costheta = 1 / sqrt(1 + square(proj_data_info_sptr->get_tantheta(bin)));
+        max_num_lors_per_axial_pos = std::max(
+            max_num_lors_per_axial_pos,
+            static_cast<int>(ceil(proj_data_info_sptr->get_sampling_in_t(bin) / costheta / voxel_size.z() - 1.E-3)));
+      }
+    // a single ray intersects at most this many voxels
+    const int max_num_voxels_per_ray
+        = (max_index.x() - min_index.x() + 1) + (max_index.y() - min_index.y() + 1) + (max_index.z() - min_index.z() + 1);
+    // note: +1 for the extra plane added by add_adjacent_z
+    this->max_num_elems_per_row_estimate
+        = static_cast<std::size_t>(max_num_voxels_per_ray) * num_tangential_LORs * (max_num_lors_per_axial_pos + 1);
+  }
+  this->workspace_per_thread.assign(static_cast<std::size_t>(get_max_num_threads()), WorkspaceForOneThread());
+  for (auto& workspace : this->workspace_per_thread)
+    {
+      workspace.ray_traced_lor.reserve(this->max_num_elems_per_row_estimate / num_tangential_LORs);
+      workspace.lor_with_next_z.reserve(this->max_num_elems_per_row_estimate);
+    }
+
   this->already_setup = true;
   this->clear_cache();
 };
 
+std::size_t
+ProjMatrixByBinUsingRayTracing::get_max_num_elems_per_row_estimate() const
+{
+  return this->max_num_elems_per_row_estimate;
+}
+
+ProjMatrixByBinUsingRayTracing::WorkspaceForOneThread*
+ProjMatrixByBinUsingRayTracing::get_workspace_ptr_for_this_thread() const
+{
+#ifdef STIR_OPENMP
+  // threads in a nested parallel region have the same thread number as other threads
+  if (omp_get_level() > 1)
+    return 0;
+  const std::size_t thread_num = static_cast<std::size_t>(omp_get_thread_num());
+#else
+  const std::size_t thread_num = 0;
+#endif
+  return thread_num < this->workspace_per_thread.size() ? &this->workspace_per_thread[thread_num] : 0;
+}
+
 ProjMatrixByBinUsingRayTracing*
 ProjMatrixByBinUsingRayTracing::clone() const
 {
@@ -734,6 +781,11 @@ ProjMatrixByBinUsingRayTracing::calculate_proj_matrix_elems_for_one_bin(ProjMatr
     }
 #endif
 
+  // use preallocated rows for temporary storage if possible
+  WorkspaceForOneThread* const workspace_ptr = get_workspace_ptr_for_this_thread();
+  WorkspaceForOneThread local_workspace;
+  WorkspaceForOneThread& workspace = workspace_ptr ? *workspace_ptr : local_workspace;
+
   if (num_tangential_LORs == 1)
     {
       ray_trace_one_lor(lor,
@@ -751,7 +803,7 @@ ProjMatrixByBinUsingRayTracing::calculate_proj_matrix_elems_for_one_bin(ProjMatr
     }
   else
     {
-      ProjMatrixElemsForOneBin ray_traced_lor;
+      ProjMatrixElemsForOneBin& ray_traced_lor = workspace.ray_traced_lor;
 
       // get_sampling_in_s returns sampling in interleaved case
       // interleaved case has a sampling which is twice as high
@@ -801,7 +853,8 @@ ProjMatrixByBinUsingRayTracing::calculate_proj_matrix_elems_for_one_bin(ProjMatr
 #endif
           {
             // make copy of LOR that will be used to add adjacent z
-            ProjMatrixElemsForOneBin lor_with_next_z = lor;
+            ProjMatrixElemsForOneBin& lor_with_next_z = workspace.lor_with_next_z;
+            lor_with_next_z = lor;
             // reserve enough memory to avoid reallocations
             lor.reserve(lor.size() * num_lors_per_axial_pos);
             // now add adjacent z
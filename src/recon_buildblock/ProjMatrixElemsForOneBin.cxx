@@ -370,6 +370,138 @@ ProjMatrixElemsForOneBin::forward_project(Bin& single, const DiscretisedDensity<
   }
 }
 
+void
+ProjMatrixElemsForOneBin::forward_project(Bin& single, const DiscretisedDensityAccess& density_access) const
+{
+  if (!density_access.has_row_pointers())
+    {
+      forward_project(single, density_access.get_density());
+      return;
+    }
+  const int min_z = density_access.get_min_z();
+  const int max_z = density_access.get_max_z();
+  float bin_value = single.get_bin_value();
+  for (const_iterator element_ptr = begin(); element_ptr != end(); ++element_ptr)
+    {
+      const int z = element_ptr->coord1();
+      if (z >= min_z && z <= max_z)
+        bin_value += density_access.get_const_row_ptr(density_access.get_row_index(z, element_ptr->coord2()))[element_ptr->coord3()]
+                     * element_ptr->get_value();
+    }
+  single.set_bin_value(bin_value);
+}
+
+void
+ProjMatrixElemsForOneBin::back_project(const DiscretisedDensityAccess& density_access, const Bin& single) const
+{
+  const float data = single.get_bin_value();
+  if (data == 0)
+    return;
+  if (!density_access.has_row_pointers())
+    {
+      back_project(density_access.get_modifiable_density(), single);
+      return;
+    }
+  // check if we can write to the image (the rest of this function uses the row pointers only)
+  density_access.get_modifiable_density();
+  const int min_z = density_access.get_min_z();
+  const int max_z = density_access.get_max_z();
+  for (const_iterator element_ptr = begin(); element_ptr != end(); ++element_ptr)
+    {
+      const int z = element_ptr->coord1();
+      if (z >= min_z && z <= max_z)
+        density_access.get_row_ptr(density_access.get_row_index(z, element_ptr->coord2()))[element_ptr->coord3()]
+            += element_ptr->get_value() * data;
+    }
+}
+
+//! returns true if all accesses have row pointers for the same index range
+static bool
+have_same_range(const std::vector<DiscretisedDensityAccess>& density_accesses)
+{
+  return std::all_of(density_accesses.begin(), density_accesses.end(), [&](const DiscretisedDensityAccess& density_access) {
+    return density_access.has_same_range(density_accesses[0]);
+  });
+}
+
+void
+ProjMatrixElemsForOneBin::forward_project(std::vector<float>& bin_values,
+                                          const std::vector<DiscretisedDensityAccess>& density_accesses) const
+{
+  assert(bin_values.size() == density_accesses.size());
+  if (density_accesses.empty())
+    return;
+  const std::size_t num_densities = density_accesses.size();
+  if (!have_same_range(density_accesses))
+    {
+      for (std::size_t n = 0; n < num_densities; ++n)
+        {
+          Bin bin;
+          bin.set_bin_value(bin_values[n]);
+          forward_project(bin, density_accesses[n]);
+          bin_values[n] = bin.get_bin_value();
+        }
+      return;
+    }
+
+  const DiscretisedDensityAccess& first_access = density_accesses[0];
+  const int min_z = first_access.get_min_z();
+  const int max_z = first_access.get_max_z();
+
+  for (const_iterator element_ptr = begin(); element_ptr != end(); ++element_ptr)
+    {
+      const int z = element_ptr->coord1();
+      if (z < min_z || z > max_z)
+        continue;
+      const std::size_t row_index = first_access.get_row_index(z, element_ptr->coord2());
+      const int x = element_ptr->coord3();
+      const float value = element_ptr->get_value();
+      for (std::size_t n = 0; n < num_densities; ++n)
+        bin_values[n] += density_accesses[n].get_const_row_ptr(row_index)[x] * value;
+    }
+}
+
+void
+ProjMatrixElemsForOneBin::back_project(const std::vector<DiscretisedDensityAccess>& density_accesses,
+                                       const std::vector<float>& bin_values) const
+{
+  assert(bin_values.size() == density_accesses.size());
+  if (density_accesses.empty())
+    return;
+  if (std::all_of(bin_values.begin(), bin_values.end(), [](const float data) { return data == 0; }))
+    return;
+  const std::size_t num_densities = density_accesses.size();
+  if (!have_same_range(density_accesses))
+    {
+      for (std::size_t n = 0; n < num_densities; ++n)
+        {
+          Bin bin;
+          bin.set_bin_value(bin_values[n]);
+          back_project(density_accesses[n], bin);
+        }
+      return;
+    }
+
+  const DiscretisedDensityAccess& first_access = density_accesses[0];
+  const int min_z = first_access.get_min_z();
+  const int max_z = first_access.get_max_z();
+  // check if we can write to the images (the rest of this function uses the row pointers only)
+  for (const auto& density_access : density_accesses)
+    density_access.get_modifiable_density();
+
+  for (const_iterator element_ptr = begin(); element_ptr != end(); ++element_ptr)
+    {
+      const int z = element_ptr->coord1();
+      if (z < min_z || z > max_z)
+        continue;
+      const std::size_t row_index = first_access.get_row_index(z, element_ptr->coord2());
+      const int x = element_ptr->coord3();
+      const float value = element_ptr->get_value();
+      for (std::size_t n = 0; n < num_densities; ++n)
+        density_accesses[n].get_row_ptr(row_index)[x] += value * bin_values[n];
+    }
+}
+
 void
 ProjMatrixElemsForOneBin::back_project(DiscretisedDensity<3, float>& density, const RelatedBins& r_bins) const
 {
@@ -19,6 +19,7 @@
 */
 
 #include "stir/recon_buildblock/QuadraticPrior.h"
+#include "stir/recon_buildblock/prior_neighbourhood_sums.h"
 #include "stir/Succeeded.h"
 #include "stir/DiscretisedDensityOnCartesianGrid.h"
 #include "stir/IndexRange3D.h"
@@ -246,54 +247,16 @@ QuadraticPrior<elemT>::compute_value(const DiscretisedDensity<3, elemT>& current
       compute_weights(this->weights, current_image_cast.get_grid_spacing(), this->only_2D);
     }
 
-  const bool do_kappa = !is_null_ptr(kappa_ptr);
-
-  double result = 0.;
-  const int min_z = current_image_estimate.get_min_index();
-  const int max_z = current_image_estimate.get_max_index();
-  for (int z = min_z; z <= max_z; z++)
-    {
-      const int min_dz = max(weights.get_min_index(), min_z - z);
-      const int max_dz = min(weights.get_max_index(), max_z - z);
-
-      const int min_y = current_image_estimate[z].get_min_index();
-      const int max_y = current_image_estimate[z].get_max_index();
-
-      for (int y = min_y; y <= max_y; y++)
-        {
-          const int min_dy = max(weights[0].get_min_index(), min_y - y);
-          const int max_dy = min(weights[0].get_max_index(), max_y - y);
-
-          const int min_x = current_image_estimate[z][y].get_min_index();
-          const int max_x = current_image_estimate[z][y].get_max_index();
-
-          for (int x = min_x; x <= max_x; x++)
-            {
-              const int min_dx = max(weights[0][0].get_min_index(), min_x - x);
-              const int max_dx = min(weights[0][0].get_max_index(), max_x - x);
-
-              /* formula:
-                sum_dx,dy,dz
-                 1/4 weights[dz][dy][dx] *
-                 (current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx])^2 *
-                 (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
-              */
-              for (int dz = min_dz; dz <= max_dz; ++dz)
-                for (int dy = min_dy; dy <= max_dy; ++dy)
-                  for (int dx = min_dx; dx <= max_dx; ++dx)
-                    {
-                      double current = weights[dz][dy][dx]
-                                       * square(current_image_estimate[z][y][x] - current_image_estimate[z + dz][y + dy][x + dx])
-                                       / 4;
-
-                      if (do_kappa)
-                        current *= (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z + dz][y + dy][x + dx];
-
-                      result += current;
-                    }
-            }
-        }
-    }
+  /* formula:
+    sum_dx,dy,dz
+     1/4 weights[dz][dy][dx] *
+     (current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx])^2 *
+     (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
+  */
+  const double result = detail::sum_prior_over_neighbourhoods(
+      current_image_estimate, this->weights, this->kappa_ptr.get(), [](const elemT x_j, const elemT x_k) {
+        return square(static_cast<double>(x_j - x_k)) / 4;
+      });
   return result * this->penalisation_factor;
 }
 
@@ -319,54 +282,18 @@ QuadraticPrior<elemT>::compute_gradient(DiscretisedDensity<3, elemT>& prior_grad
       compute_weights(this->weights, current_image_cast.get_grid_spacing(), this->only_2D);
     }
 
-  const bool do_kappa = !is_null_ptr(kappa_ptr);
-
-  const int min_z = current_image_estimate.get_min_index();
-  const int max_z = current_image_estimate.get_max_index();
-  for (int z = min_z; z <= max_z; z++)
-    {
-      const int min_dz = max(weights.get_min_index(), min_z - z);
-      const int max_dz = min(weights.get_max_index(), max_z - z);
-
-      const int min_y = current_image_estimate[z].get_min_index();
-      const int max_y = current_image_estimate[z].get_max_index();
-
-      for (int y = min_y; y <= max_y; y++)
-        {
-          const int min_dy = max(weights[0].get_min_index(), min_y - y);
-          const int max_dy = min(weights[0].get_max_index(), max_y - y);
-
-          const int min_x = current_image_estimate[z][y].get_min_index();
-          const int max_x = current_image_estimate[z][y].get_max_index();
-
-          for (int x = min_x; x <= max_x; x++)
-            {
-              const int min_dx = max(weights[0][0].get_min_index(), min_x - x);
-              const int max_dx = min(weights[0][0].get_max_index(), max_x - x);
-
-              /* formula:
-                sum_dx,dy,dz
-                 weights[dz][dy][dx] *
-                 (current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx]) *
-                 (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
-              */
-              double gradient = 0.;
-              for (int dz = min_dz; dz <= max_dz; ++dz)
-                for (int dy = min_dy; dy <= max_dy; ++dy)
-                  for (int dx = min_dx; dx <= max_dx; ++dx)
-                    {
-                      double current = weights[dz][dy][dx]
-                                       * (current_image_estimate[z][y][x] - current_image_estimate[z + dz][y + dy][x + dx]);
-
-                      if (do_kappa)
-                        current *= (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z + dz][y + dy][x + dx];
-
-                      gradient += current;
-                    }
-              prior_gradient[z][y][x] = static_cast<elemT>(gradient * this->penalisation_factor);
-            }
-        }
-    }
+  /* formula:
+    sum_dx,dy,dz
+     weights[dz][dy][dx] *
+     (current_image_estimate[z][y][x] - current_image_estimate[z+dz][y+dy][x+dx]) *
+     (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z+dz][y+dy][x+dx];
+  */
+  detail::compute_prior_neighbourhood_sums(prior_gradient,
+                                           current_image_estimate,
+                                           this->weights,
+                                           this->kappa_ptr.get(),
+                                           this->penalisation_factor,
+                                           [](const elemT x_j, const elemT x_k) { return static_cast<double>(x_j - x_k); });
 
   info(boost::format("Prior gradient max %1%, min %2%\n") % prior_gradient.find_max() % prior_gradient.find_min());
 
@@ -476,48 +403,13 @@ QuadraticPrior<elemT>::parabolic_surrogate_curvature(DiscretisedDensity<3, elemT
       compute_weights(weights, current_image_cast.get_grid_spacing(), this->only_2D);
     }
 
-  const bool do_kappa = !is_null_ptr(kappa_ptr);
-
-  const int min_z = current_image_estimate.get_min_index();
-  const int max_z = current_image_estimate.get_max_index();
-  for (int z = min_z; z <= max_z; z++)
-    {
-      const int min_dz = max(weights.get_min_index(), min_z - z);
-      const int max_dz = min(weights.get_max_index(), max_z - z);
-
-      const int min_y = current_image_estimate[z].get_min_index();
-      const int max_y = current_image_estimate[z].get_max_index();
-
-      for (int y = min_y; y <= max_y; y++)
-        {
-          const int min_dy = max(weights[0].get_min_index(), min_y - y);
-          const int max_dy = min(weights[0].get_max_index(), max_y - y);
-
-          const int min_x = current_image_estimate[z][y].get_min_index();
-          const int max_x = current_image_estimate[z][y].get_max_index();
-          for (int x = min_x; x <= max_x; x++)
-            {
-              const int min_dx = max(weights[0][0].get_min_index(), min_x - x);
-              const int max_dx = min(weights[0][0].get_max_index(), max_x - x);
-
-              elemT gradient = 0;
-              for (int dz = min_dz; dz <= max_dz; ++dz)
-                for (int dy = min_dy; dy <= max_dy; ++dy)
-                  for (int dx = min_dx; dx <= max_dx; ++dx)
-                    {
-                      // 1 comes from omega = psi'(t)/t = 2*t/2t =1
-                      elemT current = weights[dz][dy][dx] * 1;
-
-                      if (do_kappa)
-                        current *= (*kappa_ptr)[z][y][x] * (*kappa_ptr)[z + dz][y + dy][x + dx];
-
-                      gradient += current;
-                    }
-
-              parabolic_surrogate_curvature[z][y][x] = gradient * this->penalisation_factor;
-            }
-        }
-    }
+  // 1 comes from omega = psi'(t)/t = 2*t/2t =1
+  detail::compute_prior_neighbourhood_sums(parabolic_surrogate_curvature,
+                                           current_image_estimate,
+                                           this->weights,
+                                           this->kappa_ptr.get(),
+                                           this->penalisation_factor,
+                                           [](const elemT, const elemT) { return 1.; });
 
   info(boost::format("parabolic_surrogate_curvature max %1%, min %2%\n") % parabolic_surrogate_curvature.find_max()
        % parabolic_surrogate_curvature.find_min());
@@ -69,6 +69,10 @@
 #    error Cannot use both OPENMP and MP
 #  endif
 #  include <omp.h>
+#  include <condition_variable>
+#  include <deque>
+#  include <mutex>
+#  include <utility>
 #endif
 #include "stir/num_threads.h"
 
@@ -224,6 +228,156 @@ get_viewgrams(shared_ptr<RelatedViewgrams<float>>& y,
     }
 }
 
+#ifdef STIR_OPENMP
+namespace
+{
+//! all viewgrams needed to process one (view, segment, TOF) task
+struct ViewgramsForTask
+{
+  ViewSegmentNumbers view_segment_num;
+  int timing_pos_num;
+  shared_ptr<RelatedViewgrams<float>> y;
+  shared_ptr<RelatedViewgrams<float>> additive_binwise_correction_viewgrams;
+  shared_ptr<RelatedViewgrams<float>> mult_viewgrams_sptr;
+};
+
+//! a bounded queue of ViewgramsForTask which can be used by multiple threads
+class ViewgramsForTaskQueue
+{
+public:
+  explicit ViewgramsForTaskQueue(const std::size_t max_size)
+      : max_size(max_size),
+        all_pushed(false)
+  {}
+
+  //! add to the queue. If the queue is now too large, the oldest element is returned in \a overflow
+  bool push(ViewgramsForTask&& task, ViewgramsForTask& overflow)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back(std::move(task));
+    not_empty.notify_one();
+    if (queue.size() <= max_size)
+      return false;
+    overflow = std::move(queue.front());
+    queue.pop_front();
+    return true;
+  }
+
+  //! no more elements will be pushed, wake up all waiting threads
+  void set_all_pushed()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    all_pushed = true;
+    not_empty.notify_all();
+  }
+
+  //! wait for an element. Returns \c false if the queue is empty and all elements have been pushed.
+  bool pop(ViewgramsForTask& task)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_empty.wait(lock, [this] { return !queue.empty() || all_pushed; });
+    if (queue.empty())
+      return false;
+    task = std::move(queue.front());
+    queue.pop_front();
+    return true;
+  }
+
+private:
+  const std::size_t max_size;
+  bool all_pushed;
+  std::deque<ViewgramsForTask> queue;
+  std::mutex mutex;
+  std::condition_variable not_empty;
+};
+
+//! Loop over all tasks where the first thread reads the viewgrams ahead while the other threads process them
+/*! The reading thread processes viewgrams itself when the queue is full, and after all viewgrams have been read.
+ */
+void
+process_viewgrams_with_prefetching(const int num_viewgrams_to_prefetch,
+                                   const std::vector<std::pair<ViewSegmentNumbers, int>>& tasks,
+                                   const shared_ptr<ForwardProjectorByBin>& forward_projector_ptr,
+                                   const shared_ptr<BackProjectorByBin>& back_projector_ptr,
+                                   const shared_ptr<DataSymmetriesForViewSegmentNumbers>& symmetries_ptr,
+                                   const shared_ptr<ProjData>& proj_dat_ptr,
+                                   const bool read_from_proj_dat,
+                                   const bool zero_seg0_end_planes,
+                                   const bool accumulate_log_likelihood,
+                                   const shared_ptr<ProjData>& binwise_correction,
+                                   const shared_ptr<BinNormalisation>& normalisation_sptr,
+                                   const double start_time_of_frame,
+                                   const double end_time_of_frame,
+                                   RPC_process_related_viewgrams_type* RPC_process_related_viewgrams,
+                                   std::vector<double>& local_log_likelihoods,
+                                   std::vector<int>& local_counts,
+                                   std::vector<int>& local_count2s)
+{
+  ViewgramsForTaskQueue queue(static_cast<std::size_t>(num_viewgrams_to_prefetch));
+
+#  pragma omp parallel shared(queue, local_log_likelihoods, local_counts, local_count2s)
+  {
+    const int thread_num = omp_get_thread_num();
+#  pragma omp single
+    {
+      info(boost::format("Starting loop with %1% threads, reading up to %2% viewgrams ahead") % omp_get_num_threads()
+               % num_viewgrams_to_prefetch,
+           2);
+      local_log_likelihoods.resize(omp_get_max_threads(), 0.);
+      local_counts.resize(omp_get_max_threads(), 0);
+      local_count2s.resize(omp_get_max_threads(), 0);
+    }
+
+    auto process = [&](ViewgramsForTask& task) {
+      info(boost::format("Thread %d/%d calculating segment_num: %d, view_num: %d, timing_pos_num: %d") % thread_num
+               % omp_get_num_threads() % task.view_segment_num.segment_num() % task.view_segment_num.view_num()
+               % task.timing_pos_num,
+           3);
+      RPC_process_related_viewgrams(forward_projector_ptr,
+                                    back_projector_ptr,
+                                    task.y.get(),
+                                    local_counts[thread_num],
+                                    local_count2s[thread_num],
+                                    accumulate_log_likelihood ? &local_log_likelihoods[thread_num] : NULL,
+                                    task.additive_binwise_correction_viewgrams.get(),
+                                    task.mult_viewgrams_sptr.get());
+    };
+
+    if (thread_num == 0)
+      {
+        for (const auto& vs_and_timing_pos_num : tasks)
+          {
+            ViewgramsForTask task;
+            task.view_segment_num = vs_and_timing_pos_num.first;
+            task.timing_pos_num = vs_and_timing_pos_num.second;
+            get_viewgrams(task.y,
+                          task.additive_binwise_correction_viewgrams,
+                          task.mult_viewgrams_sptr,
+                          proj_dat_ptr,
+                          read_from_proj_dat,
+                          zero_seg0_end_planes,
+                          binwise_correction,
+                          normalisation_sptr,
+                          start_time_of_frame,
+                          end_time_of_frame,
+                          symmetries_ptr,
+                          task.view_segment_num,
+                          task.timing_pos_num);
+            ViewgramsForTask overflow;
+            if (queue.push(std::move(task), overflow))
+              process(overflow);
+          }
+        queue.set_all_pushed();
+      }
+
+    ViewgramsForTask task;
+    while (queue.pop(task))
+      process(task);
+  }
+}
+} // namespace
+#endif
+
 #ifdef STIR_MPI
 void
 send_viewgrams(const shared_ptr<RelatedViewgrams<float>>& y,
@@ -290,7 +444,8 @@ distributable_computation(const shared_ptr<ForwardProjectorByBin>& forward_proje
                           RPC_process_related_viewgrams_type* RPC_process_related_viewgrams,
                           DistributedCachingInformation* caching_info_ptr,
                           int min_timing_pos_num,
-                          int max_timing_pos_num)
+                          int max_timing_pos_num,
+                          const int num_viewgrams_to_prefetch_arg)
 
 {
 #ifdef STIR_MPI
@@ -415,6 +570,34 @@ distributable_computation(const shared_ptr<ForwardProjectorByBin>& forward_proje
 #ifdef STIR_OPENMP
   std::vector<double> local_log_likelihoods;
   std::vector<int> local_counts, local_count2s;
+  const int num_viewgrams_to_prefetch
+      = num_viewgrams_to_prefetch_arg < 0 ? (get_max_num_threads() > 1 ? 2 * get_max_num_threads() : 0)
+                                          : num_viewgrams_to_prefetch_arg;
+  if (num_viewgrams_to_prefetch > 0 && get_max_num_threads() > 1)
+    {
+      std::vector<std::pair<ViewSegmentNumbers, int>> tasks;
+      for (int timing_pos_num = min_timing_pos_num; timing_pos_num <= max_timing_pos_num; ++timing_pos_num)
+        for (const auto& view_segment_num : vs_nums_to_process)
+          tasks.push_back(std::make_pair(view_segment_num, timing_pos_num));
+      process_viewgrams_with_prefetching(num_viewgrams_to_prefetch,
+                                         tasks,
+                                         forward_projector_ptr,
+                                         back_projector_ptr,
+                                         symmetries_ptr,
+                                         proj_dat_ptr,
+                                         read_from_proj_dat,
+                                         zero_seg0_end_planes,
+                                         !is_null_ptr(log_likelihood_ptr),
+                                         binwise_correction,
+                                         normalisation_sptr,
+                                         start_time_of_frame,
+                                         end_time_of_frame,
+                                         RPC_process_related_viewgrams,
+                                         local_log_likelihoods,
+                                         local_counts,
+                                         local_count2s);
+    }
+  else
 #  pragma omp parallel shared(local_log_likelihoods, local_counts, local_count2s)
 #endif
 
@@ -0,0 +1,178 @@
+//
+//
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup test
+
+  \brief Test program for the caching of efficiencies in stir::BinNormalisation
+*/
+
+#include "stir/recon_buildblock/BinNormalisation.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/ExamInfo.h"
+#include "stir/Scanner.h"
+#include "stir/Bin.h"
+#include "stir/RunTests.h"
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <cmath>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief A BinNormalisation with (reproducible) efficiencies that differ for every bin
+
+  It does not override apply() and undo(), such that the base-class cache is used.
+*/
+class BinNormalisationForTests : public BinNormalisation
+{
+public:
+  std::string get_registered_name() const override { return "test"; }
+
+  float get_bin_efficiency(const Bin& bin) const override
+  {
+    // values vary within a viewgram, and their scale varies between segments (checks the fp16 scaling)
+    return (1.F + bin.segment_num() * bin.segment_num())
+           * (1.F + 0.5F * std::sin(0.3F * bin.view_num() + 0.17F * bin.axial_pos_num() + 0.11F * bin.tangential_pos_num()));
+  }
+};
+
+/*!
+  \ingroup test
+  \brief Test class for the cache of efficiencies in BinNormalisation
+
+  Checks if apply() and undo() give the same results with and without the cache (within the
+  expected precision when storing as fp16), also when the memory budget is reached part-way.
+*/
+class BinNormalisationTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  shared_ptr<const ExamInfo> exam_info_sptr;
+  shared_ptr<const ProjDataInfo> proj_data_info_sptr;
+
+  //! fill \a proj_data with some (reproducible) values
+  static void fill_proj_data(ProjDataInMemory& proj_data);
+  //! compare data, using a tolerance relative to every element of \a org
+  void check_proj_data(const ProjDataInMemory& org,
+                       const ProjDataInMemory& other,
+                       const float rel_tolerance,
+                       const std::string& str);
+  void run_tests_for_cache(const std::string& name,
+                           const bool store_as_fp16,
+                           const double memory_budget_in_MB,
+                           const float rel_tolerance);
+};
+
+void
+BinNormalisationTests::fill_proj_data(ProjDataInMemory& proj_data)
+{
+  int i = 0;
+  for (auto iter = proj_data.begin(); iter != proj_data.end(); ++iter, ++i)
+    *iter = 1.F + (i % 17);
+}
+
+void
+BinNormalisationTests::check_proj_data(const ProjDataInMemory& org,
+                                       const ProjDataInMemory& other,
+                                       const float rel_tolerance,
+                                       const std::string& str)
+{
+  float max_rel_diff = 0.F;
+  for (auto iter = org.begin(), other_iter = other.begin(); iter != org.end(); ++iter, ++other_iter)
+    max_rel_diff = std::max(max_rel_diff, std::fabs(*iter - *other_iter) / std::fabs(*iter));
+  if (!check(max_rel_diff <= rel_tolerance, str))
+    std::cerr << "maximum relative difference " << max_rel_diff << '\n';
+}
+
+void
+BinNormalisationTests::run_tests_for_cache(const std::string& name,
+                                           const bool store_as_fp16,
+                                           const double memory_budget_in_MB,
+                                           const float rel_tolerance)
+{
+  std::cerr << "Testing cache " << name << '\n';
+  BinNormalisationForTests norm;
+  norm.set_up(exam_info_sptr, proj_data_info_sptr);
+  BinNormalisationForTests norm_cached;
+  norm_cached.set_cache_bin_efficiencies(true);
+  norm_cached.set_store_cached_bin_efficiencies_as_fp16(store_as_fp16);
+  norm_cached.set_cached_bin_efficiencies_memory_budget_in_MB(memory_budget_in_MB);
+  norm_cached.set_up(exam_info_sptr, proj_data_info_sptr);
+
+  ProjDataInMemory org(exam_info_sptr, proj_data_info_sptr);
+  fill_proj_data(org);
+
+  ProjDataInMemory undone(org);
+  norm.undo(undone);
+  ProjDataInMemory applied(org);
+  norm.apply(applied);
+
+  // 1st pass fills the cache, 2nd pass uses it
+  for (int pass = 0; pass < 2; ++pass)
+    {
+      const std::string pass_str = " (pass " + std::to_string(pass) + ")";
+      ProjDataInMemory undone_cached(org);
+      norm_cached.undo(undone_cached);
+      check_proj_data(undone, undone_cached, rel_tolerance, "undo with cache " + name + pass_str);
+      ProjDataInMemory applied_cached(org);
+      norm_cached.apply(applied_cached);
+      check_proj_data(applied, applied_cached, rel_tolerance, "apply with cache " + name + pass_str);
+    }
+
+  // set_up should clear the cache
+  norm_cached.set_up(exam_info_sptr, proj_data_info_sptr);
+  ProjDataInMemory undone_cached(org);
+  norm_cached.undo(undone_cached);
+  check_proj_data(undone, undone_cached, rel_tolerance, "undo with cache " + name + " after set_up");
+}
+
+void
+BinNormalisationTests::run_tests()
+{
+  std::cerr << "Tests for caching of efficiencies in BinNormalisation\n";
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+  proj_data_info_sptr = ProjDataInfo::construct_proj_data_info(scanner_sptr,
+                                                               /*span*/ 1,
+                                                               /*max_delta*/ 5,
+                                                               /*views*/ 24,
+                                                               /*tang_pos*/ 32,
+                                                               /*arc_corrected*/ false);
+  shared_ptr<ExamInfo> exam_info_sptr_v(new ExamInfo);
+  exam_info_sptr_v->imaging_modality = ImagingModality::PT;
+  exam_info_sptr = exam_info_sptr_v;
+
+  // data (and therefore cache) size is about 4 bytes per bin. Use a budget that only allows caching part of it
+  const double data_size_in_MB = static_cast<double>(proj_data_info_sptr->size_all()) * sizeof(float) / (1024 * 1024);
+
+  run_tests_for_cache("as float", /*store_as_fp16*/ false, /*memory_budget_in_MB*/ 0, 0.F);
+  run_tests_for_cache("as fp16", /*store_as_fp16*/ true, /*memory_budget_in_MB*/ 0, 2e-3F);
+  run_tests_for_cache("as float with memory budget", /*store_as_fp16*/ false, data_size_in_MB / 3, 0.F);
+  run_tests_for_cache("as fp16 with memory budget", /*store_as_fp16*/ true, data_size_in_MB / 3, 2e-3F);
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  BinNormalisationTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -0,0 +1,194 @@
+//
+//
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup test
+
+  \brief Test program for stir::CompactProjMatrixElemsStore and its use in stir::ProjMatrixByBin
+*/
+
+#include "stir/recon_buildblock/CompactProjMatrixElemsStore.h"
+#include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include "stir/recon_buildblock/ProjMatrixByBinUsingRayTracing.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/Scanner.h"
+#include "stir/Coordinate3D.h"
+#include "stir/RunTests.h"
+#include <iostream>
+#include <cmath>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for CompactProjMatrixElemsStore
+
+  Checks if rows are restored (exactly, or within the expected precision for lossy encodings),
+  and if ProjMatrixByBinUsingRayTracing gives the same rows with and without the compact cache.
+*/
+class CompactProjMatrixElemsStoreTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  //! construct a row with some (reproducible) values
+  static ProjMatrixElemsForOneBin make_row(const int row_num);
+  void run_tests_for_encoding(const CompactProjMatrixElemsStore::ValueEncoding value_encoding, const float rel_tolerance);
+  void run_tests_for_proj_matrix(const CompactProjMatrixElemsStore::ValueEncoding value_encoding, const float rel_tolerance);
+  //! compare rows, using a tolerance relative to the maximum value in \a org
+  void check_rows(const ProjMatrixElemsForOneBin& org, const ProjMatrixElemsForOneBin& restored, const float rel_tolerance);
+};
+
+ProjMatrixElemsForOneBin
+CompactProjMatrixElemsStoreTests::make_row(const int row_num)
+{
+  ProjMatrixElemsForOneBin row;
+  Coordinate3D<int> c(row_num % 7 - 3, -20 + row_num % 5, 15);
+  for (int i = 0; i < 100 + row_num % 40; ++i)
+    {
+      // mostly small steps, but also some large and negative ones
+      c[3] -= 1;
+      if (i % 3 == 0)
+        c[2] += 1;
+      if (i % 37 == 0)
+        c[1] += 200;
+      row.push_back(ProjMatrixElemsForOneBin::value_type(c, 0.1F + std::fabs(std::sin(0.37F * (i + row_num)))));
+    }
+  return row;
+}
+
+void
+CompactProjMatrixElemsStoreTests::check_rows(const ProjMatrixElemsForOneBin& org,
+                                             const ProjMatrixElemsForOneBin& restored,
+                                             const float rel_tolerance)
+{
+  if (!check_if_equal(org.size(), restored.size(), "number of elements in row"))
+    return;
+  float max_value = 0.F;
+  for (ProjMatrixElemsForOneBin::const_iterator iter = org.begin(); iter != org.end(); ++iter)
+    max_value = std::max(max_value, iter->get_value());
+
+  ProjMatrixElemsForOneBin::const_iterator restored_iter = restored.begin();
+  for (ProjMatrixElemsForOneBin::const_iterator iter = org.begin(); iter != org.end(); ++iter, ++restored_iter)
+    {
+      if (!check_if_equal(iter->get_coords(), restored_iter->get_coords(), "coordinates of element"))
+        return;
+      if (!check(std::fabs(iter->get_value() - restored_iter->get_value()) <= rel_tolerance * max_value, "value of element"))
+        {
+          std::cerr << "original " << iter->get_value() << ", restored " << restored_iter->get_value() << '\n';
+          return;
+        }
+    }
+}
+
+void
+CompactProjMatrixElemsStoreTests::run_tests_for_encoding(const CompactProjMatrixElemsStore::ValueEncoding value_encoding,
+                                                         const float rel_tolerance)
+{
+  std::cerr << "Testing value encoding " << CompactProjMatrixElemsStore::value_encoding_to_string(value_encoding) << '\n';
+  CompactProjMatrixElemsStore store(value_encoding);
+  // enough rows to need multiple memory blocks
+  const int num_rows = 2000;
+  for (int row_num = 0; row_num < num_rows; ++row_num)
+    store.insert(static_cast<CompactProjMatrixElemsStore::key_type>(3 * row_num), make_row(row_num));
+  check_if_equal(store.size(), static_cast<std::size_t>(num_rows), "number of rows in store");
+
+  // inserting again should not do anything
+  store.insert(0, make_row(1));
+  check_if_equal(store.size(), static_cast<std::size_t>(num_rows), "number of rows in store after inserting existing key");
+
+  ProjMatrixElemsForOneBin restored;
+  for (int row_num = 0; row_num < num_rows; ++row_num)
+    {
+      if (!check(store.find(static_cast<CompactProjMatrixElemsStore::key_type>(3 * row_num), restored), "find existing row"))
+        return;
+      check_rows(make_row(row_num), restored, rel_tolerance);
+    }
+  check(!store.find(1, restored), "find non-existing row");
+
+  // empty row
+  store.insert(1, ProjMatrixElemsForOneBin());
+  check(store.find(1, restored), "find empty row");
+  check_if_equal(restored.size(), static_cast<std::size_t>(0), "size of empty row");
+
+  store.clear();
+  check_if_equal(store.size(), static_cast<std::size_t>(0), "number of rows after clear()");
+  check(!store.find(0, restored), "find after clear()");
+}
+
+void
+CompactProjMatrixElemsStoreTests::run_tests_for_proj_matrix(const CompactProjMatrixElemsStore::ValueEncoding value_encoding,
+                                                            const float rel_tolerance)
+{
+  std::cerr << "Testing ProjMatrixByBinUsingRayTracing with compact cache, value encoding "
+            << CompactProjMatrixElemsStore::value_encoding_to_string(value_encoding) << '\n';
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+  shared_ptr<ProjDataInfo> proj_data_info_sptr(ProjDataInfo::ProjDataInfoCTI(scanner_sptr,
+                                                                             /*span*/ 1,
+                                                                             /*max_delta*/ 5,
+                                                                             scanner_sptr->get_num_detectors_per_ring() / 8,
+                                                                             /*num_tang_poss*/ 32,
+                                                                             /*arc_corrected*/ false));
+  shared_ptr<DiscretisedDensity<3, float>> density_sptr(
+      new VoxelsOnCartesianGrid<float>(*proj_data_info_sptr, 1.F, CartesianCoordinate3D<float>(0, 0, 0)));
+
+  ProjMatrixByBinUsingRayTracing proj_matrix;
+  proj_matrix.enable_cache(false);
+  proj_matrix.set_up(proj_data_info_sptr, density_sptr);
+  ProjMatrixByBinUsingRayTracing proj_matrix_compact;
+  proj_matrix_compact.enable_compact_cache(true, value_encoding);
+  proj_matrix_compact.set_up(proj_data_info_sptr, density_sptr);
+
+  ProjMatrixElemsForOneBin row, row_compact;
+  for (int pass = 0; pass < 2; ++pass) // 2nd pass uses the cache
+    for (int segment_num = proj_data_info_sptr->get_min_segment_num(); segment_num <= proj_data_info_sptr->get_max_segment_num();
+         ++segment_num)
+      for (int view_num = proj_data_info_sptr->get_min_view_num(); view_num <= proj_data_info_sptr->get_max_view_num();
+           view_num += 3)
+        for (int tang_pos_num = proj_data_info_sptr->get_min_tangential_pos_num();
+             tang_pos_num <= proj_data_info_sptr->get_max_tangential_pos_num();
+             tang_pos_num += 5)
+          {
+            const Bin bin(segment_num, view_num, proj_data_info_sptr->get_min_axial_pos_num(segment_num) + 2, tang_pos_num);
+            proj_matrix.get_proj_matrix_elems_for_one_bin(row, bin);
+            proj_matrix_compact.get_proj_matrix_elems_for_one_bin(row_compact, bin);
+            check_rows(row, row_compact, rel_tolerance);
+            if (!is_everything_ok())
+              return;
+          }
+  check(proj_matrix_compact.get_compact_cache_num_bytes_used() > 0, "compact cache should be used");
+}
+
+void
+CompactProjMatrixElemsStoreTests::run_tests()
+{
+  std::cerr << "Tests for CompactProjMatrixElemsStore\n";
+  run_tests_for_encoding(CompactProjMatrixElemsStore::ValueEncoding::float32, 1e-6F);
+  run_tests_for_encoding(CompactProjMatrixElemsStore::ValueEncoding::float16, 1e-3F);
+  run_tests_for_encoding(CompactProjMatrixElemsStore::ValueEncoding::quantised16, 2e-5F);
+  run_tests_for_proj_matrix(CompactProjMatrixElemsStore::ValueEncoding::float32, 1e-6F);
+  run_tests_for_proj_matrix(CompactProjMatrixElemsStore::ValueEncoding::float16, 1e-3F);
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  CompactProjMatrixElemsStoreTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -0,0 +1,121 @@
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup recon_test
+  \brief Test program for stir::FourierRebinning
+
+  Checks that FORE gives the same result when using multiple threads as when using a single thread.
+  Without OpenMP, this only checks that rebinning succeeds.
+*/
+
+#include "stir/recon_buildblock/FourierRebinning.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/ExamInfo.h"
+#include "stir/SegmentBySinogram.h"
+#include "stir/Scanner.h"
+#include "stir/Succeeded.h"
+#include "stir/num_threads.h"
+#include "stir/RunTests.h"
+#include <iostream>
+#include <string>
+#include <cmath>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup recon_test
+  \brief Test class for FourierRebinning
+*/
+class FourierRebinningTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  //! rebin the data using \a num_threads and return the rebinned data
+  shared_ptr<ProjData> rebin(const shared_ptr<ProjData>& proj_data_sptr, const int num_threads);
+};
+
+shared_ptr<ProjData>
+FourierRebinningTests::rebin(const shared_ptr<ProjData>& proj_data_sptr, const int num_threads)
+{
+#ifdef STIR_OPENMP
+  set_num_threads(num_threads);
+#endif
+  const std::string output_filename_prefix = "test_FourierRebinning_" + std::to_string(num_threads) + "threads";
+  FourierRebinning fore;
+  fore.set_input_proj_data_sptr(proj_data_sptr);
+  fore.set_output_filename_prefix(output_filename_prefix);
+  fore.set_max_segment_num_to_process(proj_data_sptr->get_max_segment_num());
+  fore.set_kmin(2);
+  fore.set_wmin(2);
+  fore.set_deltamin(2);
+  fore.set_kc(8);
+  if (!check(fore.set_up() == Succeeded::yes, "set_up with " + std::to_string(num_threads) + " threads")
+      || !check(fore.rebin() == Succeeded::yes, "rebin with " + std::to_string(num_threads) + " threads"))
+    return shared_ptr<ProjData>();
+  return ProjData::read_from_file(output_filename_prefix + ".hs");
+}
+
+void
+FourierRebinningTests::run_tests()
+{
+  std::cerr << "Tests for FourierRebinning\n";
+
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E931));
+  shared_ptr<ProjDataInfo> proj_data_info_sptr(ProjDataInfo::ProjDataInfoCTI(scanner_sptr,
+                                                                             /*span*/ 1,
+                                                                             /*max_delta*/ 3,
+                                                                             scanner_sptr->get_num_detectors_per_ring() / 4,
+                                                                             /*num_tang_poss*/ 64,
+                                                                             /*arc_corrected*/ false));
+  shared_ptr<ProjData> proj_data_sptr(
+      new ProjDataInMemory(std::make_shared<ExamInfo>(ImagingModality::PT), proj_data_info_sptr));
+  // fill with some smooth, positive data that is different for every sinogram
+  for (int seg_num = proj_data_sptr->get_min_segment_num(); seg_num <= proj_data_sptr->get_max_segment_num(); ++seg_num)
+    {
+      SegmentBySinogram<float> segment = proj_data_sptr->get_empty_segment_by_sinogram(seg_num);
+      for (int ax = segment.get_min_axial_pos_num(); ax <= segment.get_max_axial_pos_num(); ++ax)
+        for (int view = segment.get_min_view_num(); view <= segment.get_max_view_num(); ++view)
+          for (int tang = segment.get_min_tangential_pos_num(); tang <= segment.get_max_tangential_pos_num(); ++tang)
+            segment[ax][view][tang]
+                = 2.F + std::cos(0.05F * tang) + 0.3F * std::sin(0.1F * view + 0.2F * ax) + 0.1F * seg_num * std::cos(0.3F * ax);
+      proj_data_sptr->set_segment(segment);
+    }
+
+#ifdef STIR_OPENMP
+  const int org_num_threads = get_max_num_threads();
+#endif
+  const shared_ptr<ProjData> serial_sptr = rebin(proj_data_sptr, 1);
+  const shared_ptr<ProjData> parallel_sptr = rebin(proj_data_sptr, 3);
+#ifdef STIR_OPENMP
+  set_num_threads(org_num_threads);
+#endif
+  if (!serial_sptr || !parallel_sptr)
+    return;
+
+  const SegmentBySinogram<float> serial_segment = serial_sptr->get_segment_by_sinogram(0);
+  check(serial_segment.find_max() > 0, "rebinned data should not be zero");
+  // threads sum their contributions in a different order, so allow for rounding errors
+  check_if_equal(serial_segment, parallel_sptr->get_segment_by_sinogram(0), "rebinning with 1 and 3 threads");
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  FourierRebinningTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
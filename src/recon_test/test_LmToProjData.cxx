@@ -0,0 +1,218 @@
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup recon_test
+
+  \brief Test program for stir::LmToProjData
+
+  Currently only checks if parallel histogramming gives the same result as serial histogramming.
+
+  \par Usage
+
+  <pre>
+  test_LmToProjData lm_data_filename
+  </pre>
+  where the list mode file is for instance recon_test_pack/PET_ACQ_small.l.hdr.STIR.
+*/
+
+#include "stir/listmode/LmToProjData.h"
+#include "stir/listmode/ListModeData.h"
+#include "stir/recon_buildblock/BinNormalisation.h"
+#include "stir/ProjData.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/SegmentByView.h"
+#include "stir/TimeFrameDefinitions.h"
+#include "stir/Scanner.h"
+#include "stir/Bin.h"
+#include "stir/IO/read_from_file.h"
+#include "stir/Succeeded.h"
+#include "stir/RunTests.h"
+#include <boost/format.hpp>
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+START_NAMESPACE_STIR
+
+//! gives access to members that cannot be set otherwise than by parsing
+class LmToProjDataForTests : public LmToProjData
+{
+public:
+  void set_pre_normalisation_sptr(const shared_ptr<BinNormalisation>& arg)
+  {
+    this->normalisation_ptr = arg;
+    this->do_pre_normalisation = true;
+  }
+  void set_post_normalisation_sptr(const shared_ptr<BinNormalisation>& arg) { this->post_normalisation_ptr = arg; }
+};
+
+//! A BinNormalisation with (reproducible) efficiencies that differ for every bin
+class BinNormalisationForTests : public BinNormalisation
+{
+public:
+  std::string get_registered_name() const override { return "test"; }
+
+  float get_bin_efficiency(const Bin& bin) const override
+  {
+    return 1.F + 0.5F * std::sin(0.3F * bin.view_num() + 0.17F * bin.axial_pos_num() + 0.11F * bin.tangential_pos_num());
+  }
+};
+
+/*!
+  \ingroup recon_test
+  \brief Test class for LmToProjData
+
+  Histograms the list mode data serially and in parallel, using several time frames (with a gap)
+  or a number of events to store, and pre- or post-normalisation. Only a single segment is kept in
+  memory, and batches are small, such that the list mode data has to be repositioned often.
+*/
+class LmToProjDataTests : public RunTests
+{
+public:
+  explicit LmToProjDataTests(const std::string& lm_data_filename)
+      : lm_data_filename(lm_data_filename)
+  {}
+
+  void run_tests() override;
+
+private:
+  std::string lm_data_filename;
+  shared_ptr<const ProjDataInfo> template_proj_data_info_sptr;
+
+  //! histogram the data and return the output filename prefix
+  std::string histogram(const std::string& name,
+                        const bool parallel_histogramming,
+                        const TimeFrameDefinitions& frame_defs,
+                        const long num_events_to_store,
+                        const shared_ptr<BinNormalisation>& pre_normalisation_sptr,
+                        const shared_ptr<BinNormalisation>& post_normalisation_sptr);
+
+  void run_tests_for_options(const std::string& name,
+                             const TimeFrameDefinitions& frame_defs,
+                             const long num_events_to_store,
+                             const shared_ptr<BinNormalisation>& pre_normalisation_sptr,
+                             const shared_ptr<BinNormalisation>& post_normalisation_sptr);
+};
+
+std::string
+LmToProjDataTests::histogram(const std::string& name,
+                             const bool parallel_histogramming,
+                             const TimeFrameDefinitions& frame_defs,
+                             const long num_events_to_store,
+                             const shared_ptr<BinNormalisation>& pre_normalisation_sptr,
+                             const shared_ptr<BinNormalisation>& post_normalisation_sptr)
+{
+  const std::string output_filename_prefix
+      = "test_LmToProjData_" + name + (parallel_histogramming ? "_parallel" : "_serial");
+  LmToProjDataForTests lm_to_projdata;
+  lm_to_projdata.set_input_data(lm_data_filename);
+  lm_to_projdata.set_template_proj_data_info_sptr(template_proj_data_info_sptr);
+  lm_to_projdata.set_output_filename_prefix(output_filename_prefix);
+  lm_to_projdata.set_time_frame_definitions(frame_defs);
+  lm_to_projdata.set_num_events_to_store(num_events_to_store);
+  lm_to_projdata.set_num_segments_in_memory(1);
+  lm_to_projdata.set_parallel_histogramming(parallel_histogramming);
+  lm_to_projdata.set_num_records_per_batch(997);
+  if (pre_normalisation_sptr)
+    lm_to_projdata.set_pre_normalisation_sptr(pre_normalisation_sptr);
+  if (post_normalisation_sptr)
+    lm_to_projdata.set_post_normalisation_sptr(post_normalisation_sptr);
+  if (!check(lm_to_projdata.set_up() == Succeeded::yes, "set_up " + name))
+    return output_filename_prefix;
+  lm_to_projdata.process_data();
+  return output_filename_prefix;
+}
+
+void
+LmToProjDataTests::run_tests_for_options(const std::string& name,
+                                         const TimeFrameDefinitions& frame_defs,
+                                         const long num_events_to_store,
+                                         const shared_ptr<BinNormalisation>& pre_normalisation_sptr,
+                                         const shared_ptr<BinNormalisation>& post_normalisation_sptr)
+{
+  std::cerr << "Comparing serial and parallel histogramming (" << name << ")\n";
+  const std::string serial_prefix
+      = histogram(name, false, frame_defs, num_events_to_store, pre_normalisation_sptr, post_normalisation_sptr);
+  const std::string parallel_prefix
+      = histogram(name, true, frame_defs, num_events_to_store, pre_normalisation_sptr, post_normalisation_sptr);
+
+  const unsigned int num_frames = std::max(frame_defs.get_num_frames(), 1U);
+  for (unsigned int frame_num = 1; frame_num <= num_frames; ++frame_num)
+    {
+      const std::string suffix = boost::str(boost::format("_f%1%g1d0b0.hs") % frame_num);
+      shared_ptr<ProjData> serial_sptr = ProjData::read_from_file(serial_prefix + suffix);
+      shared_ptr<ProjData> parallel_sptr = ProjData::read_from_file(parallel_prefix + suffix);
+      // events are added in a different order, so allow for rounding errors
+      float max_abs_value = 0.F;
+      float max_abs_diff = 0.F;
+      for (int seg_num = serial_sptr->get_min_segment_num(); seg_num <= serial_sptr->get_max_segment_num(); ++seg_num)
+        {
+          const SegmentByView<float> serial_segment = serial_sptr->get_segment_by_view(seg_num);
+          const SegmentByView<float> parallel_segment = parallel_sptr->get_segment_by_view(seg_num);
+          for (auto iter = serial_segment.begin_all(), parallel_iter = parallel_segment.begin_all();
+               iter != serial_segment.end_all();
+               ++iter, ++parallel_iter)
+            {
+              max_abs_value = std::max(max_abs_value, std::fabs(*iter));
+              max_abs_diff = std::max(max_abs_diff, std::fabs(*iter - *parallel_iter));
+            }
+        }
+      const std::string str = name + ", frame " + std::to_string(frame_num);
+      check(max_abs_value > 0, "sinogram should not be zero for " + str);
+      if (!check(max_abs_diff <= 1e-5F * max_abs_value, "serial and parallel histogramming for " + str))
+        std::cerr << "maximum difference " << max_abs_diff << ", maximum value " << max_abs_value << '\n';
+    }
+}
+
+void
+LmToProjDataTests::run_tests()
+{
+  std::cerr << "Tests for LmToProjData\n";
+  shared_ptr<ListModeData> lm_data_sptr = read_from_file<ListModeData>(lm_data_filename);
+  shared_ptr<Scanner> scanner_sptr(new Scanner(lm_data_sptr->get_scanner()));
+  // use a few segments and view mashing to keep the output small
+  template_proj_data_info_sptr = ProjDataInfo::construct_proj_data_info(scanner_sptr,
+                                                                        /*span*/ 1,
+                                                                        /*max_delta*/ 1,
+                                                                        scanner_sptr->get_num_detectors_per_ring() / 8,
+                                                                        scanner_sptr->get_max_num_non_arccorrected_bins(),
+                                                                        /*arc_corrected*/ false);
+
+  // frames with a gap in between. The data is about 0.6s long
+  const std::vector<std::pair<double, double>> frame_times{ { 0.05, 0.2 }, { 0.2, 0.35 }, { 0.4, 0.55 } };
+  const TimeFrameDefinitions frame_defs(frame_times);
+  const shared_ptr<BinNormalisation> norm_sptr(new BinNormalisationForTests);
+
+  run_tests_for_options("frames", frame_defs, 0L, nullptr, nullptr);
+  run_tests_for_options("frames_post_norm", frame_defs, 0L, nullptr, norm_sptr);
+  run_tests_for_options("frames_pre_norm", frame_defs, 0L, norm_sptr, nullptr);
+  run_tests_for_options("num_events_post_norm", TimeFrameDefinitions(), 1000L, nullptr, norm_sptr);
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main(int argc, char** argv)
+{
+  if (argc != 2)
+    {
+      std::cerr << "Usage: " << argv[0] << " lm_data_filename\n";
+      return EXIT_FAILURE;
+    }
+  LmToProjDataTests tests(argv[1]);
+  tests.run_tests();
+  return tests.main_return_value();
+}
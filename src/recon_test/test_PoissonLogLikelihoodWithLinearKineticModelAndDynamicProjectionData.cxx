@@ -0,0 +1,216 @@
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup recon_test
+
+  \brief Test program for stir::PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData
+
+  Currently only checks if the gradient (plus sensitivity) is the same when sharing projections between frames
+  and when computing it frame by frame.
+*/
+
+#include "stir/recon_buildblock/PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData.h"
+#include "stir/recon_buildblock/ProjMatrixByBinUsingRayTracing.h"
+#include "stir/recon_buildblock/ProjectorByBinPairUsingProjMatrixByBin.h"
+#include "stir/recon_buildblock/BinNormalisationFromProjData.h"
+#include "stir/modelling/ParametricDiscretisedDensity.h"
+#include "stir/modelling/PatlakPlot.h"
+#include "stir/modelling/ModelMatrix.h"
+#include "stir/DynamicProjData.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/ExamInfo.h"
+#include "stir/TimeFrameDefinitions.h"
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/SegmentByView.h"
+#include "stir/Scanner.h"
+#include "stir/Succeeded.h"
+#include "stir/Verbosity.h"
+#include "stir/RunTests.h"
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+START_NAMESPACE_STIR
+
+typedef PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData<ParametricVoxelsOnCartesianGrid> KineticObjFunc;
+
+//! gives access to members that cannot be set otherwise than by parsing
+class KineticObjFuncForTests : public KineticObjFunc
+{
+public:
+  void set_patlak_plot_sptr(const shared_ptr<PatlakPlot>& arg) { this->_patlak_plot_sptr = arg; }
+  void set_projector_pair_sptr(const shared_ptr<ProjectorByBinPair>& arg) { this->_projector_pair_ptr = arg; }
+  void set_zero_seg0_end_planes(const bool arg) { this->_zero_seg0_end_planes = arg; }
+};
+
+/*!
+  \ingroup recon_test
+  \brief Test class for PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData
+
+  Uses a small scanner, 4 frames (of which the last 3 are used by the model), a non-trivial normalisation
+  and additive data.
+*/
+class PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionDataTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  //! fill \a proj_data with some (reproducible and positive) values
+  static void fill_proj_data(ProjData& proj_data, const float scale);
+  void run_tests_for_shared_projections(const bool zero_seg0_end_planes);
+};
+
+void
+PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionDataTests::fill_proj_data(ProjData& proj_data, const float scale)
+{
+  for (int seg_num = proj_data.get_min_segment_num(); seg_num <= proj_data.get_max_segment_num(); ++seg_num)
+    {
+      SegmentByView<float> segment = proj_data.get_empty_segment_by_view(seg_num);
+      int i = 0;
+      for (auto iter = segment.begin_all(); iter != segment.end_all(); ++iter, ++i)
+        *iter = scale * (1.F + 0.5F * std::sin(0.37F * i + seg_num));
+      proj_data.set_segment(segment);
+    }
+}
+
+void
+PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionDataTests::run_tests_for_shared_projections(
+    const bool zero_seg0_end_planes)
+{
+  std::cerr << "Comparing gradient with and without sharing projections between frames"
+            << (zero_seg0_end_planes ? " (zeroing end planes)" : "") << '\n';
+
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+  scanner_sptr->set_num_rings(5);
+  shared_ptr<ProjDataInfo> proj_data_info_sptr(ProjDataInfo::ProjDataInfoCTI(scanner_sptr,
+                                                                             /*span=*/3,
+                                                                             /*max_delta=*/4,
+                                                                             /*num_views=*/16,
+                                                                             /*num_tang_poss=*/16));
+  const unsigned int num_frames = 4;
+  const unsigned int starting_frame = 2;
+  std::vector<double> start_times, durations;
+  for (unsigned int frame_num = 1; frame_num <= num_frames; ++frame_num)
+    {
+      start_times.push_back(100. * (frame_num - 1));
+      durations.push_back(100.);
+    }
+  const TimeFrameDefinitions frame_defs(start_times, durations);
+
+  shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo(ImagingModality::PT));
+  exam_info_sptr->set_time_frame_definitions(frame_defs);
+  shared_ptr<DynamicProjData> dyn_proj_data_sptr(new DynamicProjData(exam_info_sptr, num_frames));
+  shared_ptr<DynamicProjData> additive_dyn_proj_data_sptr(new DynamicProjData(exam_info_sptr, num_frames));
+  for (unsigned int frame_num = 1; frame_num <= num_frames; ++frame_num)
+    {
+      shared_ptr<ProjData> proj_data_sptr(new ProjDataInMemory(exam_info_sptr, proj_data_info_sptr));
+      fill_proj_data(*proj_data_sptr, 10.F * frame_num);
+      dyn_proj_data_sptr->set_proj_data_sptr(proj_data_sptr, frame_num);
+      shared_ptr<ProjData> additive_proj_data_sptr(new ProjDataInMemory(exam_info_sptr, proj_data_info_sptr));
+      fill_proj_data(*additive_proj_data_sptr, 0.1F * frame_num);
+      additive_dyn_proj_data_sptr->set_proj_data_sptr(additive_proj_data_sptr, frame_num);
+    }
+
+  // non-trivial normalisation
+  shared_ptr<ProjData> norm_proj_data_sptr(new ProjDataInMemory(exam_info_sptr, proj_data_info_sptr));
+  fill_proj_data(*norm_proj_data_sptr, 1.F);
+  shared_ptr<BinNormalisation> norm_sptr(new BinNormalisationFromProjData(norm_proj_data_sptr));
+
+  // Patlak model with arbitrary (but positive) values
+  shared_ptr<PatlakPlot> patlak_plot_sptr(new PatlakPlot);
+  {
+    Array<2, float> model_array(IndexRange2D(1, 2, starting_frame, num_frames));
+    for (unsigned int frame_num = starting_frame; frame_num <= num_frames; ++frame_num)
+      {
+        model_array[1][frame_num] = 1.F + frame_num;
+        model_array[2][frame_num] = 2.F / frame_num;
+      }
+    ModelMatrix<2> model_matrix;
+    model_matrix.set_model_array(model_array);
+    model_matrix.set_is_in_correct_scale(true);
+    patlak_plot_sptr->set_model_matrix(model_matrix);
+    patlak_plot_sptr->_in_correct_scale = true;
+    patlak_plot_sptr->_starting_frame = starting_frame;
+    patlak_plot_sptr->_frame_defs = frame_defs;
+  }
+
+  shared_ptr<ProjMatrixByBin> proj_matrix_sptr(new ProjMatrixByBinUsingRayTracing());
+  shared_ptr<ProjectorByBinPair> proj_pair_sptr(new ProjectorByBinPairUsingProjMatrixByBin(proj_matrix_sptr));
+
+  KineticObjFuncForTests obj_func;
+  obj_func.set_input_data(dyn_proj_data_sptr);
+  obj_func.set_additive_proj_data_sptr(additive_dyn_proj_data_sptr);
+  obj_func.set_normalisation_sptr(norm_sptr);
+  obj_func.set_patlak_plot_sptr(patlak_plot_sptr);
+  obj_func.set_projector_pair_sptr(proj_pair_sptr);
+  obj_func.set_zero_seg0_end_planes(zero_seg0_end_planes);
+  obj_func.set_num_subsets(2);
+
+  const VoxelsOnCartesianGrid<float> single_image(exam_info_sptr, *proj_data_info_sptr);
+  shared_ptr<ParametricVoxelsOnCartesianGrid> estimate_sptr(new ParametricVoxelsOnCartesianGrid(single_image));
+  {
+    int i = 0;
+    for (auto iter = estimate_sptr->begin_all(); iter != estimate_sptr->end_all(); ++iter, ++i)
+      *iter = 1.F + 0.5F * std::sin(0.11F * i);
+  }
+  if (!check(obj_func.set_up(estimate_sptr) == Succeeded::yes, "set-up of objective function"))
+    return;
+
+  for (int subset_num = 0; subset_num < obj_func.get_num_subsets(); ++subset_num)
+    {
+      shared_ptr<ParametricVoxelsOnCartesianGrid> gradient_sptr(estimate_sptr->get_empty_copy());
+      shared_ptr<ParametricVoxelsOnCartesianGrid> gradient_shared_sptr(estimate_sptr->get_empty_copy());
+      obj_func.set_share_projections_between_frames(false);
+      obj_func.compute_sub_gradient_without_penalty_plus_sensitivity(*gradient_sptr, *estimate_sptr, subset_num);
+      obj_func.set_share_projections_between_frames(true);
+      obj_func.compute_sub_gradient_without_penalty_plus_sensitivity(*gradient_shared_sptr, *estimate_sptr, subset_num);
+
+      float max_abs_value = 0.F;
+      float max_abs_diff = 0.F;
+      for (auto iter = gradient_sptr->begin_all_const(), shared_iter = gradient_shared_sptr->begin_all_const();
+           iter != gradient_sptr->end_all_const();
+           ++iter, ++shared_iter)
+        {
+          max_abs_value = std::max(max_abs_value, std::fabs(*iter));
+          max_abs_diff = std::max(max_abs_diff, std::fabs(*iter - *shared_iter));
+        }
+      check(max_abs_value > 0, "gradient should not be zero");
+      if (!check(max_abs_diff <= 1e-4F * max_abs_value, "gradient plus sensitivity with and without sharing projections"))
+        std::cerr << "subset " << subset_num << ": maximum difference " << max_abs_diff << ", maximum value " << max_abs_value
+                  << '\n';
+    }
+}
+
+void
+PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionDataTests::run_tests()
+{
+  std::cerr << "Tests for PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionData\n";
+  const int verbosity_default = Verbosity::get();
+  Verbosity::set(0);
+  run_tests_for_shared_projections(/* zero_seg0_end_planes = */ false);
+  run_tests_for_shared_projections(/* zero_seg0_end_planes = */ true);
+  Verbosity::set(verbosity_default);
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  PoissonLogLikelihoodWithLinearKineticModelAndDynamicProjectionDataTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -50,6 +50,7 @@
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/variate_generator.hpp>
 #include <iostream>
+#include <cstdio>
 #include <memory>
 
 START_NAMESPACE_STIR
@@ -103,9 +104,14 @@ protected:
   shared_ptr<ProjData> mult_proj_data_sptr;
   shared_ptr<ProjData> add_proj_data_sptr;
   shared_ptr<PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<target_type>> objective_function_sptr;
+  shared_ptr<ProjMatrixByBin> proj_matrix_sptr;
 
   //! run the test
   void run_tests_for_objective_function(objective_function_type& objective_function, target_type& target);
+  //! check that a frozen ProjMatrixByBin cache gives the same gradient, without any misses
+  void test_proj_matrix_cache_freezing(target_type& target);
+  //! check that sorting and merging events does not change the gradient and value
+  void test_sort_and_merge_events(target_type& target);
 };
 
 PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTests::
@@ -129,6 +135,54 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTest
   test_Hessian("PoissonLLListModeData", objective_function, target, 0.5F);
 }
 
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTests::test_proj_matrix_cache_freezing(
+    target_type& target)
+{
+  std::cerr << "----- testing freezing of the projection matrix cache\n";
+  auto& objective_function = *this->objective_function_sptr;
+  const int num_subsets = objective_function.get_num_subsets();
+  objective_function.set_freeze_proj_matrix_cache_after_first_pass(true);
+  shared_ptr<target_type> gradient_sptr(target.get_empty_copy());
+  shared_ptr<target_type> gradient_frozen_sptr(target.get_empty_copy());
+  for (int subset_num = 0; subset_num < num_subsets; ++subset_num)
+    objective_function.compute_sub_gradient_without_penalty(*gradient_sptr, target, subset_num);
+  if (!check(proj_matrix_sptr->is_cache_frozen(), "cache should be frozen after processing all subsets"))
+    return;
+
+  proj_matrix_sptr->reset_cache_statistics();
+  objective_function.compute_sub_gradient_without_penalty(*gradient_frozen_sptr, target, num_subsets - 1);
+  const ProjMatrixByBin::CacheStatistics stats = proj_matrix_sptr->get_cache_statistics();
+  check(stats.num_hits > 0, "frozen cache should be used");
+  check_if_equal(stats.num_misses, std::uint64_t(0), "frozen cache should contain all rows");
+  check_if_equal(stats.num_lock_contentions, std::uint64_t(0), "frozen cache should not be locked");
+  check_if_equal(*gradient_sptr, *gradient_frozen_sptr, "gradient with frozen cache");
+
+  proj_matrix_sptr->freeze_cache(false);
+  objective_function.set_freeze_proj_matrix_cache_after_first_pass(false);
+}
+
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTests::test_sort_and_merge_events(target_type& target)
+{
+  std::cerr << "----- testing sorting and merging of events\n";
+  auto& objective_function = *this->objective_function_sptr;
+  const int subset_num = 0;
+  shared_ptr<target_type> gradient_sptr(target.get_empty_copy());
+  shared_ptr<target_type> gradient_merged_sptr(target.get_empty_copy());
+
+  objective_function.compute_sub_gradient_without_penalty(*gradient_sptr, target, subset_num);
+  const double value = objective_function.compute_objective_function_without_penalty(target, subset_num);
+
+  objective_function.set_sort_and_merge_events(true);
+  objective_function.compute_sub_gradient_without_penalty(*gradient_merged_sptr, target, subset_num);
+  const double value_merged = objective_function.compute_objective_function_without_penalty(target, subset_num);
+  objective_function.set_sort_and_merge_events(false);
+
+  check_if_equal(*gradient_sptr, *gradient_merged_sptr, "gradient with merged events");
+  check_if_equal(value, value_merged, "value with merged events");
+}
+
 void
 PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTests::construct_input_data(
     shared_ptr<target_type>& density_sptr)
@@ -144,7 +198,11 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTest
 
       density_sptr.reset(new VoxelsOnCartesianGrid<float>(
           lm_data_sptr->get_exam_info_sptr(), *lm_data_sptr->get_proj_data_info_sptr(), zoom, origin));
-      write_to_file("target.hv", *density_sptr);
+      // check that the image can be written, using a temporary file
+      write_to_file("test_PoissonLL_LM_target.hv", *density_sptr);
+      std::remove("test_PoissonLL_LM_target.hv");
+      std::remove("test_PoissonLL_LM_target.ahv");
+      std::remove("test_PoissonLL_LM_target.v");
       // fill with random numbers between 0 and 1
       typedef boost::mt19937 base_generator_type;
       // initialize by reproducible seed
@@ -232,7 +290,7 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTest
   objective_function.set_input_data(lm_data_sptr);
   objective_function.set_use_subset_sensitivities(true);
   objective_function.set_max_segment_num_to_process(1);
-  shared_ptr<ProjMatrixByBin> proj_matrix_sptr(new ProjMatrixByBinUsingRayTracing());
+  proj_matrix_sptr.reset(new ProjMatrixByBinUsingRayTracing());
   objective_function.set_proj_matrix(proj_matrix_sptr);
   objective_function.set_normalisation_sptr(bin_norm_sptr);
   objective_function.set_additive_proj_data_sptr(add_proj_data_sptr);
@@ -252,6 +310,8 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBinTest
   shared_ptr<target_type> density_sptr;
   construct_input_data(density_sptr);
   this->run_tests_for_objective_function(*this->objective_function_sptr, *density_sptr);
+  this->test_proj_matrix_cache_freezing(*density_sptr);
+  this->test_sort_and_merge_events(*density_sptr);
 #else
   // alternative that gets the objective function from an OSMAPOSL .par file
   // currently disabled
@@ -44,6 +44,7 @@
 #include "stir/IO/read_from_file.h"
 #include "stir/IO/write_to_file.h"
 #include "stir/info.h"
+#include "stir/warning.h"
 #include "stir/Succeeded.h"
 #include "stir/num_threads.h"
 #include <boost/random/uniform_01.hpp>
@@ -111,6 +112,10 @@ protected:
 
   //! Test the approximate Hessian of the objective function by testing the (x^T Hx > 0) condition
   void test_approximate_Hessian_concavity(objective_function_type& objective_function, target_type& target);
+
+  //! Test that the gradient is the same with and without reading viewgrams ahead
+  /*! \see PoissonLogLikelihoodWithLinearModelForMeanAndProjData::set_num_viewgrams_to_read_ahead() */
+  void test_gradient_with_prefetching(objective_function_type& objective_function, target_type& target);
 };
 
 PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests::PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests(
@@ -126,6 +131,9 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests::run_tests_for_object
   std::cerr << "----- testing Gradient\n";
   test_gradient("PoissonLLProjData", objective_function, target, 0.01F);
 
+  std::cerr << "----- testing Gradient with and without prefetching of viewgrams\n";
+  test_gradient_with_prefetching(objective_function, target);
+
   std::cerr << "----- testing concavity via Hessian-vector product (accumulate_Hessian_times_input)\n";
   test_Hessian_concavity("PoissonLLProjData", objective_function, target);
 
@@ -145,6 +153,60 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests::run_tests_for_object
     }
 }
 
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests::test_gradient_with_prefetching(
+    objective_function_type& objective_function, target_type& target)
+{
+  // restores the number of threads and read-ahead setting on every return
+  // (note: projectors need to be set-up again when the number of threads changes)
+  class RestoreSettings
+  {
+  public:
+    RestoreSettings(objective_function_type& objective_function, const target_type& target)
+        : objective_function(objective_function),
+          target(target),
+          org_num_viewgrams_to_read_ahead(objective_function.get_num_viewgrams_to_read_ahead()),
+          org_num_threads(get_max_num_threads())
+    {}
+    ~RestoreSettings()
+    {
+      objective_function.set_num_viewgrams_to_read_ahead(org_num_viewgrams_to_read_ahead);
+      if (get_max_num_threads() != org_num_threads)
+        {
+          set_num_threads(org_num_threads);
+          if (objective_function.set_up(shared_ptr<target_type>(target.clone())) != Succeeded::yes)
+            warning("set-up of objective function with original number of threads failed");
+        }
+    }
+
+  private:
+    objective_function_type& objective_function;
+    const target_type& target;
+    const int org_num_viewgrams_to_read_ahead;
+    const int org_num_threads;
+  } restore_settings(objective_function, target);
+
+#ifdef STIR_OPENMP
+  // viewgrams are only read ahead when using multiple threads
+  if (get_max_num_threads() < 3)
+    {
+      set_num_threads(3);
+      if (!check(objective_function.set_up(shared_ptr<target_type>(target.clone())) == Succeeded::yes,
+                 "set-up of objective function with more threads"))
+        return;
+    }
+#endif
+  shared_ptr<target_type> gradient_without_prefetching_sptr(target.get_empty_copy());
+  objective_function.set_num_viewgrams_to_read_ahead(0);
+  objective_function.compute_sub_gradient(*gradient_without_prefetching_sptr, target, 0);
+
+  shared_ptr<target_type> gradient_sptr(target.get_empty_copy());
+  // use the default (which reads ahead when using multiple threads)
+  objective_function.set_num_viewgrams_to_read_ahead(-1);
+  objective_function.compute_sub_gradient(*gradient_sptr, target, 0);
+  check_if_equal(*gradient_without_prefetching_sptr, *gradient_sptr, "gradient with and without prefetching of viewgrams");
+}
+
 void
 PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests::test_approximate_Hessian_concavity(
     objective_function_type& objective_function, target_type& target)
@@ -0,0 +1,188 @@
+//
+//
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup test
+
+  \brief Test program for stir::ProjMatrixByBinFromFile
+
+  Writes a ray-tracing matrix to file, reads it back (using both the memory-mapped
+  version 2.0 and the old version 1.0 of the header) and compares rows.
+*/
+
+#include "stir/recon_buildblock/ProjMatrixByBinFromFile.h"
+#include "stir/recon_buildblock/ProjMatrixByBinUsingRayTracing.h"
+#include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/IndexRange3D.h"
+#include "stir/Scanner.h"
+#include "stir/Succeeded.h"
+#include "stir/RunTests.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for ProjMatrixByBinFromFile
+*/
+class ProjMatrixByBinFromFileTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  shared_ptr<const ProjDataInfo> proj_data_info_sptr;
+  shared_ptr<const DiscretisedDensity<3, float>> density_sptr;
+
+  //! compare rows of both matrices for a subset of bins
+  void compare_matrices(const ProjMatrixByBin& org, const ProjMatrixByBin& from_file, const std::string& str);
+  //! read the matrix written with \a prefix in both versions and compare with \a proj_matrix
+  void run_tests_for_reading(const ProjMatrixByBin& proj_matrix, const std::string& prefix);
+  //! remove all files written by ProjMatrixByBinFromFile::write_to_file()
+  static void remove_files(const std::string& prefix);
+};
+
+void
+ProjMatrixByBinFromFileTests::compare_matrices(const ProjMatrixByBin& org,
+                                               const ProjMatrixByBin& from_file,
+                                               const std::string& str)
+{
+  ProjMatrixElemsForOneBin row, row_from_file;
+  for (int segment_num = proj_data_info_sptr->get_min_segment_num(); segment_num <= proj_data_info_sptr->get_max_segment_num();
+       ++segment_num)
+    for (int axial_pos_num = proj_data_info_sptr->get_min_axial_pos_num(segment_num);
+         axial_pos_num <= proj_data_info_sptr->get_max_axial_pos_num(segment_num);
+         axial_pos_num += 3)
+      for (int view_num = proj_data_info_sptr->get_min_view_num(); view_num <= proj_data_info_sptr->get_max_view_num();
+           view_num += 5)
+        for (int tang_pos_num = proj_data_info_sptr->get_min_tangential_pos_num();
+             tang_pos_num <= proj_data_info_sptr->get_max_tangential_pos_num();
+             tang_pos_num += 3)
+          {
+            const Bin bin(segment_num, view_num, axial_pos_num, tang_pos_num);
+            org.get_proj_matrix_elems_for_one_bin(row, bin);
+            from_file.get_proj_matrix_elems_for_one_bin(row_from_file, bin);
+            if (!check(row == row_from_file, str + ": rows should be equal"))
+              {
+                std::cerr << "bin (s,a,v,t) = (" << segment_num << ',' << axial_pos_num << ',' << view_num << ',' << tang_pos_num
+                          << ")\n";
+                return;
+              }
+          }
+}
+
+void
+ProjMatrixByBinFromFileTests::remove_files(const std::string& prefix)
+{
+  for (const char* const suffix : { ".hpm",
+                                    ".pm",
+                                    ".pmi",
+                                    "_template_proj_data.hs",
+                                    "_template_proj_data.s",
+                                    "_template_density.hv",
+                                    "_template_density.ahv",
+                                    "_template_density.v" })
+    std::remove((prefix + suffix).c_str());
+}
+
+void
+ProjMatrixByBinFromFileTests::run_tests()
+{
+  std::cerr << "Tests for ProjMatrixByBinFromFile\n";
+
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+  proj_data_info_sptr.reset(ProjDataInfo::ProjDataInfoCTI(scanner_sptr,
+                                                          /*span*/ 1,
+                                                          /*max_delta*/ 2,
+                                                          scanner_sptr->get_num_detectors_per_ring() / 8,
+                                                          /*num_tang_poss*/ 32,
+                                                          /*arc_corrected*/ false));
+  // use "round" voxel sizes such that they survive writing to an Interfile header
+  const float z_voxel_size = scanner_sptr->get_ring_spacing() / 2;
+  density_sptr.reset(new VoxelsOnCartesianGrid<float>(IndexRange3D(0, 2 * scanner_sptr->get_num_rings() - 2, -15, 15, -15, 15),
+                                                      CartesianCoordinate3D<float>(0, 0, 0),
+                                                      CartesianCoordinate3D<float>(z_voxel_size, 4.F, 4.F)));
+
+  ProjMatrixByBinUsingRayTracing proj_matrix;
+  proj_matrix.set_up(proj_data_info_sptr, density_sptr);
+
+  const std::string prefix = "test_ProjMatrixByBinFromFile";
+  if (!check(ProjMatrixByBinFromFile::write_to_file(prefix, proj_matrix, proj_data_info_sptr, *density_sptr) == Succeeded::yes,
+             "writing matrix to file"))
+    {
+      remove_files(prefix);
+      return;
+    }
+
+  run_tests_for_reading(proj_matrix, prefix);
+  remove_files(prefix);
+}
+
+void
+ProjMatrixByBinFromFileTests::run_tests_for_reading(const ProjMatrixByBin& proj_matrix, const std::string& prefix)
+{
+  {
+    std::cerr << "Reading back (version 2.0)\n";
+    ProjMatrixByBinFromFile proj_matrix_from_file;
+    if (!check(proj_matrix_from_file.parse((prefix + ".hpm").c_str()), "parsing header (version 2.0)"))
+      return;
+    proj_matrix_from_file.set_up(proj_data_info_sptr, density_sptr);
+    compare_matrices(proj_matrix, proj_matrix_from_file, "version 2.0");
+
+    // clones share the mapped files
+    shared_ptr<ProjMatrixByBin> clone_sptr(proj_matrix_from_file.clone());
+    clone_sptr->set_up(proj_data_info_sptr, density_sptr);
+    compare_matrices(proj_matrix, *clone_sptr, "clone of version 2.0");
+  }
+  {
+    std::cerr << "Reading back (version 1.0)\n";
+    // construct a version 1.0 header from the one that was written
+    std::string header;
+    {
+      std::ifstream header_stream((prefix + ".hpm").c_str());
+      std::stringstream s;
+      s << header_stream.rdbuf();
+      header = s.str();
+    }
+    const std::string version_key = "Version := 2.0";
+    const std::string::size_type pos = header.find(version_key);
+    if (!check(pos != std::string::npos, "finding version in header"))
+      return;
+    header.replace(pos, version_key.size(), "Version := 1.0");
+    std::istringstream header_stream(header);
+
+    ProjMatrixByBinFromFile proj_matrix_from_file;
+    if (!check(proj_matrix_from_file.parse(header_stream), "parsing header (version 1.0)"))
+      return;
+    proj_matrix_from_file.enable_cache(true);
+    proj_matrix_from_file.set_up(proj_data_info_sptr, density_sptr);
+    compare_matrices(proj_matrix, proj_matrix_from_file, "version 1.0");
+  }
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  ProjMatrixByBinFromFileTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -0,0 +1,285 @@
+//
+//
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup test
+
+  \brief Test program for forward and back projecting multiple images at once
+
+  Checks that ForwardProjectorByBin::forward_project() and BackProjectorByBin::back_project()
+  for multiple images give the same result as projecting the images one by one, for
+  the matrix-based projectors (with and without caching of the matrix).
+
+  Also checks that the ProjMatrixElemsForOneBin functions using a DiscretisedDensityAccess
+  give the same result as the ones using the image, and that back projection with a memory budget
+  for the thread-local images (such that threads have to share images) gives the same result.
+*/
+
+#include "stir/recon_buildblock/ForwardProjectorByBinUsingProjMatrixByBin.h"
+#include "stir/recon_buildblock/BackProjectorByBinUsingProjMatrixByBin.h"
+#include "stir/recon_buildblock/BackProjectorByBinUsingInterpolation.h"
+#include "stir/recon_buildblock/ProjMatrixByBinUsingRayTracing.h"
+#include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include "stir/recon_buildblock/DiscretisedDensityAccess.h"
+#include "stir/Bin.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/ExamInfo.h"
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/IndexRange3D.h"
+#include "stir/Scanner.h"
+#include "stir/num_threads.h"
+#include "stir/RunTests.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for projecting multiple images at once
+*/
+class ProjectorsWithMultipleImagesTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  shared_ptr<const ProjDataInfo> proj_data_info_sptr;
+  shared_ptr<const ExamInfo> exam_info_sptr;
+  std::vector<VoxelsOnCartesianGrid<float>> images;
+
+  void run_tests_for_matrix(const bool cache_enabled);
+  void run_tests_for_density_access();
+  void run_tests_for_memory_budget();
+};
+
+void
+ProjectorsWithMultipleImagesTests::run_tests_for_density_access()
+{
+  std::cerr << "Testing projection of single rows using DiscretisedDensityAccess\n";
+
+  ProjMatrixByBinUsingRayTracing proj_matrix;
+  shared_ptr<const DiscretisedDensity<3, float>> density_info_sptr(images[0].get_empty_copy());
+  proj_matrix.set_up(proj_data_info_sptr, density_info_sptr);
+
+  const DiscretisedDensityAccess image_access(images[0]);
+  check(image_access.has_row_pointers(), "image should be accessible via row pointers");
+  VoxelsOnCartesianGrid<float> back_projection = images[0];
+  back_projection.fill(0.F);
+  VoxelsOnCartesianGrid<float> back_projection_via_access = back_projection;
+  const DiscretisedDensityAccess back_projection_access(back_projection_via_access);
+
+  ProjMatrixElemsForOneBin row;
+  const int segment_num = proj_data_info_sptr->get_max_segment_num();
+  for (int view_num = proj_data_info_sptr->get_min_view_num(); view_num <= proj_data_info_sptr->get_max_view_num(); view_num += 3)
+    for (int axial_pos_num = proj_data_info_sptr->get_min_axial_pos_num(segment_num);
+         axial_pos_num <= proj_data_info_sptr->get_max_axial_pos_num(segment_num);
+         axial_pos_num += 4)
+      for (int tang_pos_num = proj_data_info_sptr->get_min_tangential_pos_num();
+           tang_pos_num <= proj_data_info_sptr->get_max_tangential_pos_num();
+           tang_pos_num += 2)
+        {
+          Bin bin(segment_num, view_num, axial_pos_num, tang_pos_num, 0.F);
+          proj_matrix.get_proj_matrix_elems_for_one_bin(row, bin);
+          Bin bin_via_access = bin;
+          row.forward_project(bin, images[0]);
+          row.forward_project(bin_via_access, image_access);
+          if (!check_if_equal(bin.get_bin_value(), bin_via_access.get_bin_value(), "forward projection of a single bin"))
+            return;
+          row.back_project(back_projection, bin);
+          row.back_project(back_projection_access, bin_via_access);
+        }
+  check_if_equal(back_projection, back_projection_via_access, "back projection of single bins");
+}
+
+void
+ProjectorsWithMultipleImagesTests::run_tests_for_matrix(const bool cache_enabled)
+{
+  const std::string str = cache_enabled ? "with caching" : "without caching";
+  std::cerr << "Testing matrix projectors " << str << "\n";
+
+  auto proj_matrix_sptr = std::make_shared<ProjMatrixByBinUsingRayTracing>();
+  proj_matrix_sptr->enable_cache(cache_enabled);
+  ForwardProjectorByBinUsingProjMatrixByBin forward_projector(proj_matrix_sptr);
+  BackProjectorByBinUsingProjMatrixByBin back_projector(proj_matrix_sptr);
+  shared_ptr<const DiscretisedDensity<3, float>> density_info_sptr(images[0].get_empty_copy());
+  forward_projector.set_up(proj_data_info_sptr, density_info_sptr);
+  back_projector.set_up(proj_data_info_sptr, density_info_sptr);
+
+  const std::size_t num_images = images.size();
+  for (int num_subsets = 1; num_subsets <= 3; num_subsets += 2)
+    {
+      const int subset_num = num_subsets - 1;
+      const std::string subset_str = str + ", subset " + std::to_string(subset_num) + " of " + std::to_string(num_subsets);
+
+      // forward projection
+      std::vector<ProjDataInMemory> proj_data(num_images, ProjDataInMemory(exam_info_sptr, proj_data_info_sptr));
+      std::vector<ProjData*> proj_data_ptrs;
+      std::vector<const DiscretisedDensity<3, float>*> image_ptrs;
+      for (std::size_t n = 0; n < num_images; ++n)
+        {
+          proj_data_ptrs.push_back(&proj_data[n]);
+          image_ptrs.push_back(&images[n]);
+        }
+      forward_projector.forward_project(proj_data_ptrs, image_ptrs, subset_num, num_subsets);
+      for (std::size_t n = 0; n < num_images; ++n)
+        {
+          ProjDataInMemory org_proj_data(exam_info_sptr, proj_data_info_sptr);
+          forward_projector.forward_project(org_proj_data, images[n], subset_num, num_subsets);
+          check_if_equal(org_proj_data, proj_data[n], "forward projection of image " + std::to_string(n) + ", " + subset_str);
+        }
+
+      // back projection
+      std::vector<VoxelsOnCartesianGrid<float>> back_projections(num_images, images[0]);
+      std::vector<DiscretisedDensity<3, float>*> back_projection_ptrs;
+      std::vector<const ProjData*> const_proj_data_ptrs;
+      for (std::size_t n = 0; n < num_images; ++n)
+        {
+          // note: contains the image, which should be overwritten
+          back_projection_ptrs.push_back(&back_projections[n]);
+          const_proj_data_ptrs.push_back(&proj_data[n]);
+        }
+      back_projector.back_project(back_projection_ptrs, const_proj_data_ptrs, subset_num, num_subsets);
+      for (std::size_t n = 0; n < num_images; ++n)
+        {
+          VoxelsOnCartesianGrid<float> org_back_projection = images[0];
+          back_projector.back_project(org_back_projection, proj_data[n], subset_num, num_subsets);
+          check_if_equal(
+              org_back_projection, back_projections[n], "back projection of image " + std::to_string(n) + ", " + subset_str);
+        }
+    }
+}
+
+void
+ProjectorsWithMultipleImagesTests::run_tests_for_memory_budget()
+{
+  std::cerr << "Testing back projection with a memory budget for the thread-local images\n";
+
+  {
+    // check that the keyword is parsed also by back projectors that are not matrix-based
+    BackProjectorByBinUsingInterpolation interpolation_back_projector;
+    std::istringstream parameters("Back Projector Using Interpolation Parameters:=\n"
+                                  "memory budget for thread-local images (MB):=3\n"
+                                  "End Back Projector Using Interpolation Parameters:=\n");
+    check(interpolation_back_projector.parse(parameters), "parsing interpolation back projector parameters");
+    check_if_equal(interpolation_back_projector.get_thread_local_images_memory_budget_in_MB(),
+                   3.F,
+                   "memory budget parsed by interpolation back projector");
+  }
+
+  // use more threads than images fit in the budget, such that threads have to share the images
+#ifdef STIR_OPENMP
+  const int org_num_threads = get_max_num_threads();
+  set_num_threads(4);
+#endif
+
+  auto proj_matrix_sptr = std::make_shared<ProjMatrixByBinUsingRayTracing>();
+  shared_ptr<const DiscretisedDensity<3, float>> density_info_sptr(images[0].get_empty_copy());
+  ForwardProjectorByBinUsingProjMatrixByBin forward_projector(proj_matrix_sptr);
+  forward_projector.set_up(proj_data_info_sptr, density_info_sptr);
+  const std::size_t num_images = images.size();
+  std::vector<ProjDataInMemory> proj_data(num_images, ProjDataInMemory(exam_info_sptr, proj_data_info_sptr));
+  std::vector<VoxelsOnCartesianGrid<float>> org_back_projections(num_images, images[0]);
+  BackProjectorByBinUsingProjMatrixByBin org_back_projector(proj_matrix_sptr);
+  org_back_projector.set_up(proj_data_info_sptr, density_info_sptr);
+  for (std::size_t n = 0; n < num_images; ++n)
+    {
+      forward_projector.forward_project(proj_data[n], images[n]);
+      org_back_projector.back_project(org_back_projections[n], proj_data[n]);
+    }
+
+  const double image_size_in_MB = static_cast<double>(images[0].size_all()) * sizeof(float) / (1024. * 1024.);
+  // budget for 2 images, and for less than 1 image (which will use 1 image)
+  for (const double num_images_in_budget : { 2.5, .5 })
+    {
+      const std::string str = "memory budget for " + std::to_string(num_images_in_budget) + " images";
+      BackProjectorByBinUsingProjMatrixByBin back_projector(proj_matrix_sptr);
+      back_projector.set_thread_local_images_memory_budget_in_MB(static_cast<float>(num_images_in_budget * image_size_in_MB));
+      back_projector.set_up(proj_data_info_sptr, density_info_sptr);
+      for (std::size_t n = 0; n < num_images; ++n)
+        {
+          VoxelsOnCartesianGrid<float> back_projection = images[0];
+          back_projector.back_project(back_projection, proj_data[n]);
+          check_if_equal(org_back_projections[n], back_projection, "back projection of image " + std::to_string(n) + ", " + str);
+        }
+
+      // multiple images at once (needs too much memory, so will be done one by one)
+      std::vector<VoxelsOnCartesianGrid<float>> back_projections(num_images, images[0]);
+      std::vector<DiscretisedDensity<3, float>*> back_projection_ptrs;
+      std::vector<const ProjData*> proj_data_ptrs;
+      for (std::size_t n = 0; n < num_images; ++n)
+        {
+          back_projection_ptrs.push_back(&back_projections[n]);
+          proj_data_ptrs.push_back(&proj_data[n]);
+        }
+      back_projector.back_project(back_projection_ptrs, proj_data_ptrs);
+      for (std::size_t n = 0; n < num_images; ++n)
+        check_if_equal(org_back_projections[n],
+                       back_projections[n],
+                       "back projection of multiple images, image " + std::to_string(n) + ", " + str);
+    }
+
+#ifdef STIR_OPENMP
+  set_num_threads(org_num_threads);
+#endif
+}
+
+void
+ProjectorsWithMultipleImagesTests::run_tests()
+{
+  std::cerr << "Tests for projecting multiple images at once\n";
+
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E962));
+  proj_data_info_sptr.reset(ProjDataInfo::ProjDataInfoCTI(scanner_sptr,
+                                                          /*span*/ 1,
+                                                          /*max_delta*/ 1,
+                                                          scanner_sptr->get_num_detectors_per_ring() / 2,
+                                                          /*num_tang_poss*/ 16,
+                                                          /*arc_corrected*/ false));
+  exam_info_sptr = std::make_shared<ExamInfo>(ImagingModality::PT);
+
+  const VoxelsOnCartesianGrid<float> image_template(exam_info_sptr,
+                                                    IndexRange3D(0, 2 * scanner_sptr->get_num_rings() - 2, -15, 15, -15, 15),
+                                                    CartesianCoordinate3D<float>(0, 0, 0),
+                                                    CartesianCoordinate3D<float>(scanner_sptr->get_ring_spacing() / 2, 4.F, 4.F));
+  // a few (positive) images that are different from each other
+  // (note: this scanner has no phi offset and we do not mash views, such that the symmetries are used)
+  for (int n = 0; n < 3; ++n)
+    {
+      VoxelsOnCartesianGrid<float> image = image_template;
+      for (int z = image.get_min_z(); z <= image.get_max_z(); ++z)
+        for (int y = image.get_min_y(); y <= image.get_max_y(); ++y)
+          for (int x = image.get_min_x(); x <= image.get_max_x(); ++x)
+            image[z][y][x] = 1.F + ((n + 1) * (z + 2 * y + 3 * x + 100)) % 7 + (n == 2 ? z : 0);
+      images.push_back(image);
+    }
+
+  run_tests_for_density_access();
+  run_tests_for_matrix(true);
+  run_tests_for_matrix(false);
+  run_tests_for_memory_budget();
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  ProjectorsWithMultipleImagesTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -40,6 +40,8 @@
 #include "stir/ArrayFunction.h"
 #include "stir/NumericInfo.h"
 #include "stir/SegmentByView.h"
+#include "stir/SegmentBySinogram.h"
+#include "stir/apply_to_proj_data.h"
 #include "stir/VoxelsOnCartesianGrid.h"
 #include "stir/warning.h"
 #include "stir/error.h"
@@ -705,10 +707,10 @@ ScatterEstimation::set_up_iterative(shared_ptr<IterativeReconstruction<Discretis
             // Crucial: Avoid divisions by zero!!
             // This should be resolved after https://github.com/UCL/STIR/issues/348
             pow_times_add min_threshold(0.0f, 1.0f, 1.0f, 1E-20f, NumericInfo<float>().max_value());
-            apply_to_proj_data(*norm_projdata_2d_sptr, min_threshold);
-
             pow_times_add invert(0.0f, 1.0f, -1.0f, NumericInfo<float>().min_value(), NumericInfo<float>().max_value());
-            apply_to_proj_data(*norm_projdata_2d_sptr, invert);
+            // do both in a single pass over the data
+            in_place_apply_to_proj_data(*norm_projdata_2d_sptr,
+                                        elementwise_function([&](float& value) { value = invert(min_threshold(value)); }));
 
             norm_coeff_2d_sptr.reset(new BinNormalisationFromProjData(norm_projdata_2d_sptr));
           }
@@ -996,11 +998,12 @@ ScatterEstimation::process_data()
               temp_projdata->fill(*scaled_est_projdata_sptr);
               pow_times_add min_threshold(0.0f, 1.0f, 1.0f, 1e-9f, NumericInfo<float>().max_value());
               pow_times_add add_scalar(-1e-9f, 1.0f, 1.0f, NumericInfo<float>().min_value(), NumericInfo<float>().max_value());
-              apply_to_proj_data(*temp_projdata, min_threshold);
-              apply_to_proj_data(*temp_projdata, add_scalar);
               // threshold back to 0 to avoid getting tiny negatives (due to numerical precision errors)
               pow_times_add min_threshold_zero(0.0f, 1.0f, 1.0f, 0.f, NumericInfo<float>().max_value());
-              apply_to_proj_data(*temp_projdata, min_threshold_zero);
+              // do all of these in a single pass over the data
+              in_place_apply_to_proj_data(
+                  *temp_projdata,
+                  elementwise_function([&](float& value) { value = min_threshold_zero(add_scalar(min_threshold(value))); }));
 
               // ok, we can multiply with the norm
               normalisation_factors_sptr->apply(*temp_projdata);
@@ -1154,19 +1157,10 @@ ScatterEstimation::add_proj_data(ProjData& first_addend, const ProjData& second_
 {
   assert(first_addend.get_min_segment_num() == second_addend.get_min_segment_num());
   assert(first_addend.get_max_segment_num() == second_addend.get_max_segment_num());
-  for (int segment_num = first_addend.get_min_segment_num(); segment_num <= first_addend.get_max_segment_num(); ++segment_num)
-    {
-      SegmentByView<float> first_segment_by_view = first_addend.get_segment_by_view(segment_num);
-
-      SegmentByView<float> sec_segment_by_view = second_addend.get_segment_by_view(segment_num);
-
-      first_segment_by_view += sec_segment_by_view;
-
-      if (!(first_addend.set_segment(first_segment_by_view) == Succeeded::yes))
-        {
-          error("Error set_segment %d", segment_num);
-        }
-    }
+  auto add = [](SegmentBySinogram<float>& first_segment, const SegmentBySinogram<float>& sec_segment) {
+    first_segment += sec_segment;
+  };
+  in_place_apply_to_proj_data(first_addend, add, second_addend);
 }
 
 void
@@ -1174,19 +1168,10 @@ ScatterEstimation::subtract_proj_data(ProjData& minuend, const ProjData& subtrac
 {
   assert(minuend.get_min_segment_num() == subtracted.get_min_segment_num());
   assert(minuend.get_max_segment_num() == subtracted.get_max_segment_num());
-  for (int segment_num = minuend.get_min_segment_num(); segment_num <= minuend.get_max_segment_num(); ++segment_num)
-    {
-      SegmentByView<float> first_segment_by_view = minuend.get_segment_by_view(segment_num);
-
-      SegmentByView<float> sec_segment_by_view = subtracted.get_segment_by_view(segment_num);
-
-      first_segment_by_view -= sec_segment_by_view;
-
-      if (!(minuend.set_segment(first_segment_by_view) == Succeeded::yes))
-        {
-          error("ScatterEstimation: Error set_segment %d", segment_num);
-        }
-    }
+  auto subtract = [](SegmentBySinogram<float>& first_segment, const SegmentBySinogram<float>& sec_segment) {
+    first_segment -= sec_segment;
+  };
+  in_place_apply_to_proj_data(minuend, subtract, subtracted);
 
   // Filter negative values:
   //    pow_times_add zero_threshold (0.0f, 1.0f, 1.0f, 0.0f, NumericInfo<float>().max_value());
@@ -1196,17 +1181,7 @@ ScatterEstimation::subtract_proj_data(ProjData& minuend, const ProjData& subtrac
 void
 ScatterEstimation::apply_to_proj_data(ProjData& data, const pow_times_add& func)
 {
-  for (int segment_num = data.get_min_segment_num(); segment_num <= data.get_max_segment_num(); ++segment_num)
-    {
-      SegmentByView<float> segment_by_view = data.get_segment_by_view(segment_num);
-
-      in_place_apply_function(segment_by_view, func);
-
-      if (!(data.set_segment(segment_by_view) == Succeeded::yes))
-        {
-          error("ScatterEstimation: Error set_segment %d", segment_num);
-        }
-    }
+  in_place_apply_to_proj_data(data, elementwise_function([&func](float& value) { value = func(value); }));
 }
 
 Succeeded
@@ -76,6 +76,8 @@ ScatterSimulation::set_use_cache(bool value)
   this->remove_cache_for_integrals_over_activity();
   this->remove_cache_for_integrals_over_attenuation();
   this->use_cache = value;
+  // caches are initialised by set_up()
+  this->_already_set_up = false;
 }
 
 Succeeded
@@ -220,6 +222,7 @@ ScatterSimulation::set_defaults()
   this->attenuation_threshold = 0.01f;
   this->randomly_place_scatter_points = true;
   this->use_cache = true;
+  this->attenuation_integrals_cache_filename = "";
   this->zoom_xy = -1.f;
   this->zoom_z = -1.f;
   this->zoom_size_xy = -1;
@@ -272,6 +275,7 @@ ScatterSimulation::initialise_keymap()
   this->parser.add_key("downsample scanner", &this->downsample_scanner_bool);
   this->parser.add_key("randomly place scatter points", &this->randomly_place_scatter_points);
   this->parser.add_key("use cache", &this->use_cache);
+  this->parser.add_key("attenuation integrals cache filename", &this->attenuation_integrals_cache_filename);
 }
 
 bool
@@ -402,6 +406,10 @@ ScatterSimulation::set_up()
 
   this->_already_set_up = true;
 
+  if (this->detection_points_vector.empty())
+    this->find_all_detection_points();
+  this->fill_cache_for_scattpoint_det_integrals_over_attenuation();
+
   return Succeeded::yes;
 }
 
@@ -989,7 +997,21 @@ ScatterSimulation::set_randomly_place_scatter_points(const bool arg)
 void
 ScatterSimulation::set_cache_enabled(const bool arg)
 {
-  use_cache = arg;
+  // removes the caches when the value changes
+  this->set_use_cache(arg);
+  this->_already_set_up = false;
+}
+
+void
+ScatterSimulation::set_attenuation_integrals_cache_filename(const std::string& filename)
+{
+  this->attenuation_integrals_cache_filename = filename;
+}
+
+const std::string&
+ScatterSimulation::get_attenuation_integrals_cache_filename() const
+{
+  return this->attenuation_integrals_cache_filename;
 }
 
 void
@@ -65,7 +65,21 @@ SingleScatterSimulation::set_up()
   // set to negative value such that this will be recomputed
   this->max_single_scatter_cos_angle = -1.F;
 
-  return base_type::set_up();
+  if (base_type::set_up() == Succeeded::no)
+    return Succeeded::no;
+
+  if (this->use_cache && this->scatter_point_detector_factors.empty())
+    this->compute_scatter_point_detector_factors();
+  return Succeeded::yes;
+}
+
+void
+SingleScatterSimulation::remove_cache_for_integrals_over_attenuation()
+{
+  base_type::remove_cache_for_integrals_over_attenuation();
+  this->scatter_point_detector_factors.clear();
+  this->scatter_point_detector_factors.shrink_to_fit();
+  this->num_detection_points_for_factors = 0;
 }
 
 Succeeded
@@ -21,15 +21,56 @@
 #include "stir/scatter/ScatterSimulation.h"
 #include "stir/IndexRange.h"
 #include "stir/Coordinate2D.h"
+#include "stir/IO/read_data.h"
+#include "stir/IO/write_data.h"
+#include "stir/HighResWallClockTimer.h"
+#include "stir/info.h"
+#include "stir/warning.h"
+#include <boost/format.hpp>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
 
 START_NAMESPACE_STIR
 
 const float cache_init_value = -1234567.89E10F; // an arbitrary value that should never occur
 
+// identifies files written by fill_cache_for_scattpoint_det_integrals_over_attenuation()
+static const char attenuation_integrals_file_signature[] = "STIR scatter attenuation integrals v1";
+
+namespace
+{
+// helper class to compute a (64-bit FNV-1a) hash of the data used to compute the attenuation integrals
+class HashForScatterIntegrals
+{
+public:
+  template <class T>
+  void add(const T& value)
+  {
+    const unsigned char* ptr = reinterpret_cast<const unsigned char*>(&value);
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+      {
+        hash ^= ptr[i];
+        hash *= 1099511628211ULL;
+      }
+  }
+  void add(const CartesianCoordinate3D<float>& coord)
+  {
+    add(coord.z());
+    add(coord.y());
+    add(coord.x());
+  }
+
+  std::uint64_t hash = 14695981039346656037ULL;
+};
+} // namespace
+
 void
 ScatterSimulation::remove_cache_for_integrals_over_attenuation()
 {
   this->cached_attenuation_integral_scattpoint_det.recycle();
+  this->attenuation_integrals_cache_filled = false;
 }
 
 void
@@ -51,6 +92,109 @@ ScatterSimulation::initialise_cache_for_scattpoint_det_integrals_over_attenuatio
 
   this->cached_attenuation_integral_scattpoint_det.resize(range);
   this->cached_attenuation_integral_scattpoint_det.fill(cache_init_value);
+  this->attenuation_integrals_cache_filled = false;
+}
+
+void
+ScatterSimulation::fill_cache_for_scattpoint_det_integrals_over_attenuation()
+{
+  if (!this->use_cache || this->attenuation_integrals_cache_filled)
+    return;
+
+  const int num_scatter_points = static_cast<int>(this->scatt_points_vector.size());
+  if (num_scatter_points == 0)
+    {
+      this->attenuation_integrals_cache_filled = true;
+      return;
+    }
+  const int num_detection_points = static_cast<int>(this->detection_points_vector.size());
+  Array<2, float>& cache = this->cached_attenuation_integral_scattpoint_det;
+
+  // find hash of everything that determines the integrals, i.e. the image and the end-points
+  std::uint64_t hash;
+  {
+    HashForScatterIntegrals hasher;
+    const VoxelsOnCartesianGrid<float>& image = dynamic_cast<const VoxelsOnCartesianGrid<float>&>(*this->density_image_sptr);
+    BasicCoordinate<3, int> min_indices, max_indices;
+    if (!image.get_regular_range(min_indices, max_indices))
+      error("ScatterSimulation: attenuation image should have a regular range");
+    for (int d = 1; d <= 3; ++d)
+      {
+        hasher.add(min_indices[d]);
+        hasher.add(max_indices[d]);
+      }
+    hasher.add(image.get_origin());
+    hasher.add(image.get_voxel_size());
+    for (auto iter = image.begin_all_const(); iter != image.end_all_const(); ++iter)
+      hasher.add(*iter);
+    for (const auto& scatter_point : this->scatt_points_vector)
+      hasher.add(scatter_point.coord);
+    for (const auto& detection_point : this->detection_points_vector)
+      hasher.add(detection_point);
+    hash = hasher.hash;
+  }
+
+  const std::string& filename = this->attenuation_integrals_cache_filename;
+  if (!filename.empty())
+    {
+      std::ifstream s(filename.c_str(), std::ios::in | std::ios::binary);
+      if (s)
+        {
+          char signature[sizeof(attenuation_integrals_file_signature)];
+          std::uint64_t hash_in_file = 0;
+          std::int32_t sizes_in_file[2] = { -1, -1 };
+          s.read(signature, sizeof(signature));
+          s.read(reinterpret_cast<char*>(&hash_in_file), sizeof(hash_in_file));
+          s.read(reinterpret_cast<char*>(sizes_in_file), sizeof(sizes_in_file));
+          if (s && std::memcmp(signature, attenuation_integrals_file_signature, sizeof(signature)) == 0 && hash_in_file == hash
+              && sizes_in_file[0] == cache.get_length() && sizes_in_file[1] == cache[0].get_length())
+            {
+              if (read_data(s, cache) == Succeeded::yes)
+                {
+                  info(boost::format("ScatterSimulation: attenuation integrals read from %1%") % filename, 2);
+                  this->attenuation_integrals_cache_filled = true;
+                  return;
+                }
+              warning(boost::format("ScatterSimulation: error reading attenuation integrals from %1%. Recomputing.") % filename);
+            }
+          else
+            info(boost::format("ScatterSimulation: attenuation integrals in %1% do not correspond to current data. Recomputing.")
+                     % filename,
+                 2);
+        }
+    }
+
+  HighResWallClockTimer timer;
+  timer.start();
+  // note: detection_points_vector could be smaller than the cache (if not all detectors occur in the data)
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int scatter_point_num = 0; scatter_point_num < num_scatter_points; ++scatter_point_num)
+    {
+      const CartesianCoordinate3D<float>& scatter_point = this->scatt_points_vector[scatter_point_num].coord;
+      for (int det_num = 0; det_num < num_detection_points; ++det_num)
+        cache[scatter_point_num][det_num]
+            = exp_integral_over_attenuation_image_between_scattpoint_det(scatter_point, this->detection_points_vector[det_num]);
+    }
+  timer.stop();
+  info(boost::format("ScatterSimulation: computed attenuation integrals for %1% scatter points and %2% detectors in %3% s")
+           % num_scatter_points % num_detection_points % timer.value(),
+       2);
+  this->attenuation_integrals_cache_filled = true;
+
+  if (!filename.empty())
+    {
+      std::ofstream s(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+      const std::int32_t sizes[2] = { cache.get_length(), cache[0].get_length() };
+      s.write(attenuation_integrals_file_signature, sizeof(attenuation_integrals_file_signature));
+      s.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+      s.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+      if (!s || write_data(s, cache) == Succeeded::no)
+        warning(boost::format("ScatterSimulation: error writing attenuation integrals to %1%") % filename);
+      else
+        info(boost::format("ScatterSimulation: attenuation integrals written to %1%") % filename, 2);
+    }
 }
 
 void
@@ -127,48 +271,15 @@ float
 ScatterSimulation::cached_exp_integral_over_attenuation_image_between_scattpoint_det(const unsigned scatter_point_num,
                                                                                      const unsigned det_num)
 {
-  float* location_in_cache = this->use_cache ? &cached_attenuation_integral_scattpoint_det[scatter_point_num][det_num] : 0;
-
-  float value;
+  // the cache is filled by set_up(), so no need for atomic access
   if (this->use_cache)
     {
-#if defined(STIR_OPENMP)
-#  if _OPENMP >= 201012
-#    pragma omp atomic read
-#  else
-#    pragma omp critical(STIRSCATTERESTIMATIONREADCACHEATTENINT)
-      {
-#  endif
-#endif
-      value = *location_in_cache;
-#if defined(STIR_OPENMP) && (_OPENMP < 201012)
+      assert(this->attenuation_integrals_cache_filled);
+      return cached_attenuation_integral_scattpoint_det[scatter_point_num][det_num];
     }
-#endif
-}
-
-if (this->use_cache && value != cache_init_value)
-  {
-    return *location_in_cache;
-  }
-else
-  {
-    const float result = exp_integral_over_attenuation_image_between_scattpoint_det(scatt_points_vector[scatter_point_num].coord,
-                                                                                    detection_points_vector[det_num]);
-    if (this->use_cache)
-#ifdef STIR_OPENMP
-#  if _OPENMP >= 201012
-#    pragma omp atomic write
-#  else
-#    pragma omp critical(STIRSCATTERESTIMATIONREADCACHEATTENINT)
-        {
-#  endif
-#endif
-      *location_in_cache = result;
-#if defined(STIR_OPENMP) && (_OPENMP < 201012)
-  }
-#endif
-return result;
-}
+  else
+    return exp_integral_over_attenuation_image_between_scattpoint_det(scatt_points_vector[scatter_point_num].coord,
+                                                                      detection_points_vector[det_num]);
 }
 
 END_NAMESPACE_STIR
@@ -86,6 +86,31 @@ ScatterSimulation::find_detectors(unsigned& det_num_A, unsigned& det_num_B, cons
   det_num_B = this->find_in_detection_points_vector(detector_coord_B + this->shift_detector_coordinates_to_origin);
 }
 
+void
+ScatterSimulation::find_all_detection_points()
+{
+  this->detection_points_vector.clear();
+  unsigned det_num_A, det_num_B;
+  Bin bin;
+  for (bin.segment_num() = this->proj_data_info_sptr->get_min_segment_num();
+       bin.segment_num() <= this->proj_data_info_sptr->get_max_segment_num();
+       ++bin.segment_num())
+    for (bin.view_num() = this->proj_data_info_sptr->get_min_view_num();
+         bin.view_num() <= this->proj_data_info_sptr->get_max_view_num();
+         ++bin.view_num())
+      for (bin.axial_pos_num() = this->proj_data_info_sptr->get_min_axial_pos_num(bin.segment_num());
+           bin.axial_pos_num() <= this->proj_data_info_sptr->get_max_axial_pos_num(bin.segment_num());
+           ++bin.axial_pos_num())
+        for (bin.tangential_pos_num() = this->proj_data_info_sptr->get_min_tangential_pos_num();
+             bin.tangential_pos_num() <= this->proj_data_info_sptr->get_max_tangential_pos_num();
+             ++bin.tangential_pos_num())
+          {
+            this->find_detectors(det_num_A, det_num_B, bin);
+            if (this->detection_points_vector.size() == static_cast<std::size_t>(this->total_detectors))
+              return;
+          }
+}
+
 float
 ScatterSimulation::compute_emis_to_det_points_solid_angle_factor(const CartesianCoordinate3D<float>& emis_point,
                                                                  const CartesianCoordinate3D<float>& detector_coord)
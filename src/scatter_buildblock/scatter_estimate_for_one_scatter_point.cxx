@@ -29,11 +29,40 @@
 
 #include "stir/round.h"
 #include <math.h>
+#include <cassert>
 using namespace std;
 START_NAMESPACE_STIR
 
 static const float total_Compton_cross_section_511keV = ScatterSimulation::total_Compton_cross_section(511.F);
 
+void
+SingleScatterSimulation::compute_scatter_point_detector_factors()
+{
+  const int num_scatter_points = static_cast<int>(this->scatt_points_vector.size());
+  this->num_detection_points_for_factors = this->detection_points_vector.size();
+  this->scatter_point_detector_factors.resize(num_scatter_points * this->num_detection_points_for_factors);
+
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(static)
+#endif
+  for (int scatter_point_num = 0; scatter_point_num < num_scatter_points; ++scatter_point_num)
+    {
+      const CartesianCoordinate3D<float>& scatter_point = this->scatt_points_vector[scatter_point_num].coord;
+      ScatterPointDetectorFactors* factors_ptr
+          = &this->scatter_point_detector_factors[scatter_point_num * this->num_detection_points_for_factors];
+      for (std::size_t det_num = 0; det_num < this->num_detection_points_for_factors; ++det_num, ++factors_ptr)
+        {
+          const CartesianCoordinate3D<float>& detector_coord = this->detection_points_vector[det_num];
+          const CartesianCoordinate3D<float> det_to_ring_center(0, -detector_coord[2], -detector_coord[3]);
+          const CartesianCoordinate3D<float> diff = detector_coord - scatter_point;
+          const float distance_squared = static_cast<float>(norm_squared(diff));
+          factors_ptr->direction = diff / std::sqrt(distance_squared);
+          factors_ptr->inv_distance_squared = 1.F / distance_squared;
+          factors_ptr->cos_incident_angle = static_cast<float>(cos_angle(scatter_point - detector_coord, det_to_ring_center));
+        }
+    }
+}
+
 double
 SingleScatterSimulation::simulate_for_one_scatter_point(const std::size_t scatter_point_num,
                                                         const unsigned det_num_A,
@@ -51,8 +80,24 @@ SingleScatterSimulation::simulate_for_one_scatter_point(const std::size_t scatte
   const CartesianCoordinate3D<float>& scatter_point = this->scatt_points_vector[scatter_point_num].coord;
   const CartesianCoordinate3D<float>& detector_coord_A = this->detection_points_vector[det_num_A];
   const CartesianCoordinate3D<float>& detector_coord_B = this->detection_points_vector[det_num_B];
+  // use precomputed factors for this scatter point and the detectors (if available)
+  const bool use_factors = this->use_cache && !this->scatter_point_detector_factors.empty()
+                           && det_num_A < this->num_detection_points_for_factors
+                           && det_num_B < this->num_detection_points_for_factors;
+  const ScatterPointDetectorFactors* factors_A_ptr = nullptr;
+  const ScatterPointDetectorFactors* factors_B_ptr = nullptr;
+  if (use_factors)
+    {
+      assert((scatter_point_num + 1) * this->num_detection_points_for_factors <= this->scatter_point_detector_factors.size());
+      const ScatterPointDetectorFactors* const factors_ptr
+          = &this->scatter_point_detector_factors[scatter_point_num * this->num_detection_points_for_factors];
+      factors_A_ptr = factors_ptr + det_num_A;
+      factors_B_ptr = factors_ptr + det_num_B;
+    }
   // note: costheta is -cos_angle such that it is 1 for zero scatter angle
-  const float costheta = static_cast<float>(-cos_angle(detector_coord_A - scatter_point, detector_coord_B - scatter_point));
+  const float costheta = use_factors
+                             ? -inner_product(factors_A_ptr->direction, factors_B_ptr->direction)
+                             : static_cast<float>(-cos_angle(detector_coord_A - scatter_point, detector_coord_B - scatter_point));
   // note: costheta is identical for scatter to A or scatter to B
   // Hence, the Compton_cross_section and energy are identical for both cases as well.
   if (this->max_single_scatter_cos_angle > costheta)
@@ -74,8 +119,10 @@ SingleScatterSimulation::simulate_for_one_scatter_point(const std::size_t scatte
 
   const float dif_Compton_cross_section_value = dif_Compton_cross_section(costheta, 511.F);
 
-  const float rA_squared = static_cast<float>(norm_squared(scatter_point - detector_coord_A));
-  const float rB_squared = static_cast<float>(norm_squared(scatter_point - detector_coord_B));
+  const float inv_rA_squared
+      = use_factors ? factors_A_ptr->inv_distance_squared : 1.F / static_cast<float>(norm_squared(scatter_point - detector_coord_A));
+  const float inv_rB_squared
+      = use_factors ? factors_B_ptr->inv_distance_squared : 1.F / static_cast<float>(norm_squared(scatter_point - detector_coord_B));
 
   const float scatter_point_mu = scatt_points_vector[scatter_point_num].mu_value;
 
@@ -98,14 +145,23 @@ SingleScatterSimulation::simulate_for_one_scatter_point(const std::size_t scatte
   double scatter_ratio = 0;
 
   scatter_ratio
-      = (emiss_to_detA * (1. / rB_squared) * pow(atten_to_detB, total_Compton_cross_section_relative_to_511keV(new_energy) - 1)
-         + emiss_to_detB * (1. / rA_squared) * pow(atten_to_detA, total_Compton_cross_section_relative_to_511keV(new_energy) - 1))
+      = (emiss_to_detA * inv_rB_squared * pow(atten_to_detB, total_Compton_cross_section_relative_to_511keV(new_energy) - 1)
+         + emiss_to_detB * inv_rA_squared * pow(atten_to_detA, total_Compton_cross_section_relative_to_511keV(new_energy) - 1))
         * atten_to_detB * atten_to_detA * scatter_point_mu * detection_efficiency_scatter;
 
-  const CartesianCoordinate3D<float> detA_to_ring_center(0, -detector_coord_A[2], -detector_coord_A[3]);
-  const CartesianCoordinate3D<float> detB_to_ring_center(0, -detector_coord_B[2], -detector_coord_B[3]);
-  const float cos_incident_angle_AS = static_cast<float>(cos_angle(scatter_point - detector_coord_A, detA_to_ring_center));
-  const float cos_incident_angle_BS = static_cast<float>(cos_angle(scatter_point - detector_coord_B, detB_to_ring_center));
+  float cos_incident_angle_AS, cos_incident_angle_BS;
+  if (use_factors)
+    {
+      cos_incident_angle_AS = factors_A_ptr->cos_incident_angle;
+      cos_incident_angle_BS = factors_B_ptr->cos_incident_angle;
+    }
+  else
+    {
+      const CartesianCoordinate3D<float> detA_to_ring_center(0, -detector_coord_A[2], -detector_coord_A[3]);
+      const CartesianCoordinate3D<float> detB_to_ring_center(0, -detector_coord_B[2], -detector_coord_B[3]);
+      cos_incident_angle_AS = static_cast<float>(cos_angle(scatter_point - detector_coord_A, detA_to_ring_center));
+      cos_incident_angle_BS = static_cast<float>(cos_angle(scatter_point - detector_coord_B, detB_to_ring_center));
+    }
 
   return scatter_ratio * cos_incident_angle_AS * cos_incident_angle_BS * dif_Compton_cross_section_value;
 }
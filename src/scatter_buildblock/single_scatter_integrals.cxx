@@ -24,7 +24,6 @@
   */
 #include "stir/scatter/ScatterSimulation.h"
 #include "stir/VoxelsOnCartesianGrid.h"
-#include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
 #include "stir/recon_buildblock/RayTraceVoxelsOnCartesianGrid.h"
 START_NAMESPACE_STIR
 
@@ -72,43 +71,32 @@ ScatterSimulation::integral_between_2_points(const DiscretisedDensity<3, float>&
   CartesianCoordinate3D<float> origin = image.get_origin();
   const float z_to_middle = (image.get_max_index() + image.get_min_index()) * voxel_size.z() / 2.F;
   origin.z() -= z_to_middle;
+  // find index range of the image once, such that checking if a voxel is inside the image is cheap
+  const int min_z = image.get_min_z();
+  const int max_z = image.get_max_z();
+  const int min_y = image.get_min_y();
+  const int max_y = image.get_max_y();
+  const int min_x = image.get_min_x();
+  const int max_x = image.get_max_x();
+
+  // add up values along LOR while ray tracing, i.e. without storing the voxels
+  float sum = 0;
+  auto add_voxel = [&](const CartesianCoordinate3D<int>& coords, const float LOI) {
+    if (coords.z() >= min_z && coords.z() <= max_z && coords.y() >= min_y && coords.y() <= max_y && coords.x() >= min_x
+        && coords.x() <= max_x)
+      sum += image[coords.z()][coords.y()][coords.x()] * LOI;
+  };
   /* TODO replace with image.get_index_coordinates_for_physical_coordinates */
-  ProjMatrixElemsForOneBin lor;
-  RayTraceVoxelsOnCartesianGrid(lor,
-                                (scatter_point - origin) / voxel_size,  // should be in voxel units
-                                (detector_coord - origin) / voxel_size, // should be in voxel units
-                                voxel_size,                             // should be in mm
+  ray_trace_voxels_on_cartesian_grid(add_voxel,
+                                     (scatter_point - origin) / voxel_size,  // should be in voxel units
+                                     (detector_coord - origin) / voxel_size, // should be in voxel units
+                                     voxel_size,                             // should be in mm
 #ifdef NEWSCALE
-                                1.F // normalise to mm
+                                     1.F // normalise to mm
 #else
-                                1 / voxel_size.x() // normalise to some kind of 'pixel units'
+                                     1 / voxel_size.x() // normalise to some kind of 'pixel units'
 #endif
   );
-  lor.sort();
-  float sum = 0; // add up values along LOR
-  {
-    ProjMatrixElemsForOneBin::iterator element_ptr = lor.begin();
-    bool we_have_been_within_the_image = false;
-    while (element_ptr != lor.end())
-      {
-        const BasicCoordinate<3, int> coords = element_ptr->get_coords();
-        if (coords[1] >= image.get_min_index() && coords[1] <= image.get_max_index()
-            && coords[2] >= image[coords[1]].get_min_index() && coords[2] <= image[coords[1]].get_max_index()
-            && coords[3] >= image[coords[1]][coords[2]].get_min_index()
-            && coords[3] <= image[coords[1]][coords[2]].get_max_index())
-          {
-            we_have_been_within_the_image = true;
-            sum += image[coords] * element_ptr->get_value();
-          }
-        else if (we_have_been_within_the_image)
-          {
-            // we jump out of the loop as we are now at the other side of
-            // the image
-            //                                  break;
-          }
-        ++element_ptr;
-      }
-  }
   return sum;
 }
 END_NAMESPACE_STIR
@@ -171,12 +171,22 @@ void
 GatedSpatialTransformation::accumulate_warp_image(DiscretisedDensity<3, float>& new_reference_image,
                                                   const GatedDiscretisedDensity& gated_image) const
 {
-  GatedDiscretisedDensity new_gated_image(gated_image);
-  new_gated_image.fill_with_zero();
-  this->warp_image(new_gated_image, gated_image);
+  assert(gated_image.get_time_gate_definitions().get_num_gates()
+         == this->_spatial_transformation_x.get_time_gate_definitions().get_num_gates());
+  if (!this->_spatial_transformations_are_stored)
+    error("The transformation fields haven't been set properly yet.\n");
+  // warp every gate straight into the output image, without storing the warped gates
   //! todo This is not implemented as sum (or should it be the average?)
   for (unsigned int gate_num = 1; gate_num <= gated_image.get_time_gate_definitions().get_num_gates(); ++gate_num)
-    new_reference_image += new_gated_image[gate_num];
+    {
+      const BSpline::BSplinesRegularGrid<3, float> density_interpolation(gated_image[gate_num], BSpline::linear);
+      stir::warp_image(new_reference_image,
+                       density_interpolation,
+                       *(this->_spatial_transformation_x.get_densities())[gate_num - 1],
+                       *(this->_spatial_transformation_y.get_densities())[gate_num - 1],
+                       *(this->_spatial_transformation_z.get_densities())[gate_num - 1],
+                       /*accumulate=*/true);
+    }
   //	new_reference_image /= gated_image.get_time_gate_definitions().get_num_gates();
 }
 
@@ -195,22 +205,23 @@ GatedSpatialTransformation::warp_image(GatedDiscretisedDensity& gated_image,
            % (this->_spatial_transformation_y.get_densities())[0]->size_all());
       error("GatedSpatialTransformation::warp_image needs the same sizes for motion vectors and input/output images.\n");
     }
-  const shared_ptr<DiscretisedDensity<3, float>> reference_image_sptr(reference_image.clone());
   gated_image.resize_densities(this->_gate_defs);
 
   if (this->_spatial_transformations_are_stored)
-    for (unsigned int gate_num = 1; gate_num <= gated_image.get_time_gate_definitions().get_num_gates(); ++gate_num)
-      {
-        const VoxelsOnCartesianGrid<float> density
-            = stir::warp_image(reference_image_sptr,
-                               (this->_spatial_transformation_x.get_densities())[gate_num - 1],
-                               (this->_spatial_transformation_y.get_densities())[gate_num - 1],
-                               (this->_spatial_transformation_z.get_densities())[gate_num - 1],
-                               BSpline::linear,
-                               false);
-        const shared_ptr<DiscretisedDensity<3, float>> density_sptr(density.clone());
-        gated_image.set_density_sptr(density_sptr, gate_num);
-      }
+    {
+      // the B-spline coefficients of the reference image are the same for all gates
+      const BSpline::BSplinesRegularGrid<3, float> density_interpolation(reference_image, BSpline::linear);
+      for (unsigned int gate_num = 1; gate_num <= gated_image.get_time_gate_definitions().get_num_gates(); ++gate_num)
+        {
+          const shared_ptr<DiscretisedDensity<3, float>> density_sptr(reference_image.get_empty_copy());
+          stir::warp_image(*density_sptr,
+                           density_interpolation,
+                           *(this->_spatial_transformation_x.get_densities())[gate_num - 1],
+                           *(this->_spatial_transformation_y.get_densities())[gate_num - 1],
+                           *(this->_spatial_transformation_z.get_densities())[gate_num - 1]);
+          gated_image.set_density_sptr(density_sptr, gate_num);
+        }
+    }
   else
     error("The transformation fields haven't been set properly yet.");
 }
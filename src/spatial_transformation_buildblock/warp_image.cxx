@@ -20,6 +20,23 @@
 START_NAMESPACE_STIR
 // using namespace BSpline;
 
+//! checks if all indices in the regular range [min,max] are in \a range
+static bool
+index_range_contains(const IndexRange<3>& range, const BasicCoordinate<3, int>& min, const BasicCoordinate<3, int>& max)
+{
+  if (range.get_min_index() > min[1] || range.get_max_index() < max[1])
+    return false;
+  for (int z = min[1]; z <= max[1]; ++z)
+    {
+      if (range[z].get_min_index() > min[2] || range[z].get_max_index() < max[2])
+        return false;
+      for (int y = min[2]; y <= max[2]; ++y)
+        if (range[z][y].get_min_index() > min[3] || range[z][y].get_max_index() < max[3])
+          return false;
+    }
+  return true;
+}
+
 VoxelsOnCartesianGrid<float>
 warp_image(const shared_ptr<DiscretisedDensity<3, float>>& density_sptr,
            const shared_ptr<DiscretisedDensity<3, float>>& motion_x_sptr,
@@ -53,32 +70,67 @@ warp_image(const shared_ptr<DiscretisedDensity<3, float>>& density_sptr,
 #endif
   const IndexRange<3> out_range(out_min, out_max);
   VoxelsOnCartesianGrid<float> out_density(out_range, origin, grid_spacing);
+  warp_image(out_density, density_interpolation, *motion_x_sptr, *motion_y_sptr, *motion_z_sptr);
+  return out_density;
+}
+
+void
+warp_image(DiscretisedDensity<3, float>& out_density,
+           const BSpline::BSplinesRegularGrid<3, float>& density_interpolation,
+           const DiscretisedDensity<3, float>& motion_x,
+           const DiscretisedDensity<3, float>& motion_y,
+           const DiscretisedDensity<3, float>& motion_z,
+           const bool accumulate)
+{
+  const DiscretisedDensityOnCartesianGrid<3, float>* out_density_cartesian_ptr
+      = dynamic_cast<const DiscretisedDensityOnCartesianGrid<3, float>*>(&out_density);
+  if (!out_density_cartesian_ptr)
+    error("warp_image: image has to be on a Cartesian grid.\n");
+  const BasicCoordinate<3, float> grid_spacing = out_density_cartesian_ptr->get_grid_spacing();
 
-  BasicCoordinate<3, int> c;
-  BasicCoordinate<3, double> d, l;
-  for (c[1] = min[1]; c[1] <= max[1]; ++c[1])
-    for (c[2] = min[2]; c[2] <= max[2]; ++c[2])
-      for (c[3] = min[3]; c[3] <= max[3]; ++c[3])
+  BasicCoordinate<3, int> min;
+  BasicCoordinate<3, int> max;
+  const IndexRange<3> range = out_density.get_index_range();
+  if (!range.get_regular_range(min, max))
+    error("image is not in regular grid.\n");
+  if (!index_range_contains(motion_x.get_index_range(), min, max) || !index_range_contains(motion_y.get_index_range(), min, max)
+      || !index_range_contains(motion_z.get_index_range(), min, max))
+    error("warp_image: the index range of the motion images needs to contain the index range of the image.\n");
+
+  // planes are independent, and we use row references to avoid indexing with coordinates in the inner loop
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int z = min[1]; z <= max[1]; ++z)
+    {
+      BasicCoordinate<3, double> d;
+      for (int y = min[2]; y <= max[2]; ++y)
         {
-          l[1] = static_cast<double>((*motion_z_sptr)[c] / grid_spacing[1]);
-          l[2] = static_cast<double>((*motion_y_sptr)[c] / grid_spacing[2]);
-          l[3] = static_cast<double>((*motion_x_sptr)[c] / grid_spacing[3]);
-          d[1] = static_cast<double>(c[1]) + l[1]; // for the IRTK version I had c-l, but for Christian's it seems to work as c+l
-          d[2] = static_cast<double>(c[2]) + l[2];
-          d[3] = static_cast<double>(c[3]) + l[3];
-          // Temporary fix such that when radioactivity comes from outside is set to 0.
-          // To fix this properly we need to modify the B-Splines interpolation method by changing the periodicity extrapolation.
-          if ((d[1] <= static_cast<double>(min[1])) || (d[1] >= static_cast<double>(max[1]))
-              || // I'm not considering the last plane if linear
-              (d[2] <= static_cast<double>(min[2])) || (d[2] >= static_cast<double>(max[2]))
-              || // because it's going to use extrapolated data
-              (d[3] <= static_cast<double>(min[3]))
-              || (d[3] >= static_cast<double>(max[3]))) // I haven't implemented anything for higher order
-            out_density[c] = 0.F;
-          else
-            out_density[c] = density_interpolation(d);
+          const Array<1, float>& motion_z_row = motion_z[z][y];
+          const Array<1, float>& motion_y_row = motion_y[z][y];
+          const Array<1, float>& motion_x_row = motion_x[z][y];
+          Array<1, float>& out_row = out_density[z][y];
+          for (int x = min[3]; x <= max[3]; ++x)
+            {
+              // for the IRTK version I had c-l, but for Christian's it seems to work as c+l
+              d[1] = static_cast<double>(z) + static_cast<double>(motion_z_row[x] / grid_spacing[1]);
+              d[2] = static_cast<double>(y) + static_cast<double>(motion_y_row[x] / grid_spacing[2]);
+              d[3] = static_cast<double>(x) + static_cast<double>(motion_x_row[x] / grid_spacing[3]);
+              // Temporary fix such that when radioactivity comes from outside is set to 0.
+              // To fix this properly we need to modify the B-Splines interpolation method by changing the periodicity
+              // extrapolation. I'm not considering the last plane if linear because it's going to use extrapolated data.
+              // I haven't implemented anything for higher order.
+              const bool outside = (d[1] <= static_cast<double>(min[1])) || (d[1] >= static_cast<double>(max[1]))
+                                   || (d[2] <= static_cast<double>(min[2])) || (d[2] >= static_cast<double>(max[2]))
+                                   || (d[3] <= static_cast<double>(min[3])) || (d[3] >= static_cast<double>(max[3]));
+              const float value = outside ? 0.F : density_interpolation(d);
+              if (accumulate)
+                out_row[x] += value;
+              else
+                out_row[x] = value;
+            }
         }
-  return out_density;
+    }
 }
 
 END_NAMESPACE_STIR
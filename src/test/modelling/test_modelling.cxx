@@ -25,6 +25,7 @@
 #include "stir/TimeFrameDefinitions.h"
 #include "stir/utilities.h"
 #include <boost/shared_array.hpp>
+#include <cstdio>
 
 START_NAMESPACE_STIR
 
@@ -101,7 +102,17 @@ modellingTests::run_tests()
 
     ModelMatrix<2> file_model_matrix, correct_model_matrix;
     file_model_matrix.read_from_file(this->add_directory("model_array.in"));
-    file_model_matrix.write_to_file(this->add_directory("model_array.out"));
+    {
+      // write to a temporary file and check that we can read it back
+      const std::string output_filename = "test_modelling_model_array.out";
+      file_model_matrix.write_to_file(output_filename);
+      ModelMatrix<2> read_back_model_matrix;
+      read_back_model_matrix.read_from_file(output_filename);
+      std::remove(output_filename.c_str());
+      check_if_equal(read_back_model_matrix.get_model_array(),
+                     file_model_matrix.get_model_array(),
+                     "Check ModelMatrix read back after writing");
+    }
 
     BasicCoordinate<2, int> min_range;
     BasicCoordinate<2, int> max_range;
@@ -27,6 +27,7 @@
 #include "stir/numerics/fourier.h"
 #include <iostream>
 #include <algorithm>
+#include <string>
 
 using std::cin;
 using std::cout;
@@ -67,8 +68,31 @@ public:
 private:
   template <int num_dimensions>
   void test_single_dimension(const IndexRange<num_dimensions>& index_range);
+  //! compare fourier() with a direct computation of the DFT
+  void test_with_direct_DFT(const int length);
 };
 
+void
+FourierTests::test_with_direct_DFT(const int length)
+{
+  ArrayC1 c(length);
+  for (int i = 0; i < length; ++i)
+    c[i] = std::complex<float>(rand1(), rand1());
+  ArrayC1 direct_DFT(length);
+  const int sign = 1;
+  for (int s = 0; s < length; ++s)
+    {
+      std::complex<double> sum = 0;
+      for (int r = 0; r < length; ++r)
+        sum += std::complex<double>(c[r]) * std::exp(std::complex<double>(0, sign * 2 * _PI * ((r * s) % length) / length));
+      direct_DFT[s] = std::complex<float>(sum);
+    }
+  const double norm_direct_DFT = norm(direct_DFT.begin(), direct_DFT.end());
+  fourier(c, sign);
+  c -= direct_DFT;
+  check_if_less(norm(c.begin(), c.end()) / norm_direct_DFT, 1E-5, "FT of length " + std::to_string(length) + " versus direct DFT");
+}
+
 template <int num_dimensions>
 void
 FourierTests::test_single_dimension(const IndexRange<num_dimensions>& index_range)
@@ -96,14 +120,18 @@ FourierTests::test_single_dimension(const IndexRange<num_dimensions>& index_rang
   // cout << all_frequencies << complex_array;
   // cout << '\n' << complex_array-all_frequencies;
   complex_array -= all_frequencies;
-  cout << "\nReal FT Residual norm "
-       << norm(complex_array.begin_all(), complex_array.end_all()) / norm(real_array.begin_all(), real_array.end_all());
+  const double real_FT_residual
+      = norm(complex_array.begin_all(), complex_array.end_all()) / norm(all_frequencies.begin_all(), all_frequencies.end_all());
+  cout << "\nReal FT Residual norm " << real_FT_residual;
+  check_if_less(real_FT_residual, 1E-4, "Real FT residual");
 
   real_type test_inverse_real = inverse_fourier_for_real_data(pos_frequencies, sign);
   // cout <<"\nv,test "<< v << test_inverse_real << test_inverse_real/v;
   test_inverse_real -= real_array;
-  cout << "\ninverse Real FT Residual norm "
-       << norm(test_inverse_real.begin_all(), test_inverse_real.end_all()) / norm(real_array.begin_all(), real_array.end_all());
+  const double inverse_real_FT_residual
+      = norm(test_inverse_real.begin_all(), test_inverse_real.end_all()) / norm(real_array.begin_all(), real_array.end_all());
+  cout << "\ninverse Real FT Residual norm " << inverse_real_FT_residual;
+  check_if_less(inverse_real_FT_residual, 1E-4, "inverse Real FT residual");
 
   // fill
   {
@@ -115,8 +143,10 @@ FourierTests::test_single_dimension(const IndexRange<num_dimensions>& index_rang
   fourier(complex_array, sign);
   inverse_fourier(complex_array, sign);
   complex_array -= array_copy;
-  cout << "\ninverse  FT Residual norm "
-       << norm(complex_array.begin_all(), complex_array.end_all()) / norm(array_copy.begin_all(), array_copy.end_all());
+  const double inverse_FT_residual
+      = norm(complex_array.begin_all(), complex_array.end_all()) / norm(array_copy.begin_all(), array_copy.end_all());
+  cout << "\ninverse  FT Residual norm " << inverse_FT_residual << '\n';
+  check_if_less(inverse_FT_residual, 1E-4, "inverse FT residual");
 }
 
 void
@@ -130,6 +160,14 @@ FourierTests::run_tests()
   test_single_dimension(IndexRange2D(128, 256));
   std::cerr << "... Testing 3D\n";
   test_single_dimension(IndexRange3D(128, 256, 16));
+  std::cerr << "... Testing lengths which are not a power of 2\n";
+  test_single_dimension(IndexRange<1>(90));
+  test_single_dimension(IndexRange<1>(2 * 127)); // large prime factor
+  test_single_dimension(IndexRange2D(45, 126));
+  test_single_dimension(IndexRange3D(10, 21, 34));
+  std::cerr << "... Comparing with direct DFT\n";
+  for (int length : { 1, 2, 3, 4, 5, 8, 12, 30, 64, 97, 231, 256 })
+    test_with_direct_DFT(length);
 }
 
 END_NAMESPACE_STIR
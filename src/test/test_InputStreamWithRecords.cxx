@@ -0,0 +1,181 @@
+//
+//
+/*
+    Copyright (C) 2026, University College London
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup test
+
+  \brief Test program for stir::InputStreamWithRecords
+
+  Writes a file with records of variable size, and reads it back using a stream,
+  a (small) buffer and memory-mapping, checking single and batch reads and
+  saved positions.
+*/
+
+#include "stir/IO/InputStreamWithRecords.h"
+#include "stir/RunTests.h"
+#include "stir/Succeeded.h"
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+
+START_NAMESPACE_STIR
+
+namespace
+{
+//! a simple record type: the first byte gives the size of the record, the others are its "data"
+class TestRecord
+{
+public:
+  std::size_t size_of_record_at_ptr(const char* const buffer, const std::size_t, const int) const
+  {
+    return static_cast<std::size_t>(static_cast<unsigned char>(buffer[0]));
+  }
+  Succeeded init_from_data_ptr(const char* const buffer, const std::size_t size_of_record, const int offset)
+  {
+    data.assign(buffer + 1, buffer + size_of_record);
+    for (char& c : data)
+      c = static_cast<char>(c - offset);
+    return Succeeded::yes;
+  }
+  std::string data;
+};
+} // namespace
+
+/*!
+  \ingroup test
+  \brief Test class for InputStreamWithRecords
+*/
+class InputStreamWithRecordsTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  std::string filename;
+  std::vector<std::string> records;
+  static constexpr int offset = 3;
+  static constexpr std::size_t start_of_data = 5;
+
+  void write_file();
+  void run_tests_for_stream(InputStreamWithRecords<TestRecord, int>& stream, const std::string& str);
+};
+
+void
+InputStreamWithRecordsTests::write_file()
+{
+  filename = "test_InputStreamWithRecords.dat";
+  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+  // some junk at the start
+  file.write("junk!", start_of_data);
+  for (int i = 0; i < 5000; ++i)
+    {
+      const std::size_t size = 1 + static_cast<std::size_t>((i * 7) % 9);
+      std::string rec(size - 1, 'a');
+      for (std::size_t j = 0; j < rec.size(); ++j)
+        rec[j] = static_cast<char>('a' + (i + j) % 26);
+      records.push_back(rec);
+      file.put(static_cast<char>(size));
+      for (char c : rec)
+        file.put(static_cast<char>(c + offset));
+    }
+}
+
+void
+InputStreamWithRecordsTests::run_tests_for_stream(InputStreamWithRecords<TestRecord, int>& stream, const std::string& str)
+{
+  std::cerr << "Testing " << str << '\n';
+  TestRecord record;
+  // read half of the records one by one, and save position
+  const std::size_t half = records.size() / 2;
+  for (std::size_t i = 0; i < half; ++i)
+    {
+      if (!check(stream.get_next_record(record) == Succeeded::yes, str + ": get_next_record should succeed")
+          || !check_if_equal(record.data, records[i], str + ": record content"))
+        return;
+    }
+  const auto saved_position = stream.save_get_position();
+
+  // read the rest in batches
+  {
+    std::vector<TestRecord> batch(333);
+    std::vector<TestRecord*> batch_ptrs;
+    for (auto& r : batch)
+      batch_ptrs.push_back(&r);
+    std::size_t num_read_total = half;
+    while (true)
+      {
+        const std::size_t num_read = stream.get_next_records(batch_ptrs.data(), batch_ptrs.size());
+        for (std::size_t i = 0; i < num_read; ++i)
+          if (!check_if_equal(batch[i].data, records[num_read_total + i], str + ": record content in batch"))
+            return;
+        num_read_total += num_read;
+        if (num_read < batch.size())
+          break;
+      }
+    check_if_equal(num_read_total, records.size(), str + ": total number of records");
+  }
+  check(stream.get_next_record(record) == Succeeded::no, str + ": reading after the end should fail");
+
+  // go back
+  check(stream.set_get_position(saved_position) == Succeeded::yes, str + ": set_get_position");
+  check(stream.get_next_record(record) == Succeeded::yes, str + ": reading after set_get_position");
+  check_if_equal(record.data, records[half], str + ": record content after set_get_position");
+
+  // overwrite the saved position with the current one
+  check(stream.overwrite_saved_get_position(saved_position) == Succeeded::yes, str + ": overwrite_saved_get_position");
+  stream.get_next_record(record);
+  check(stream.set_get_position(saved_position) == Succeeded::yes, str + ": set_get_position after overwriting");
+  check(stream.get_next_record(record) == Succeeded::yes, str + ": reading after overwrite_saved_get_position");
+  check_if_equal(record.data, records[half + 1], str + ": record content after overwrite_saved_get_position");
+
+  check(stream.reset() == Succeeded::yes, str + ": reset");
+  check(stream.get_next_record(record) == Succeeded::yes, str + ": reading after reset");
+  check_if_equal(record.data, records[0], str + ": record content after reset");
+}
+
+void
+InputStreamWithRecordsTests::run_tests()
+{
+  std::cerr << "Tests for InputStreamWithRecords\n";
+  write_file();
+  {
+    shared_ptr<std::istream> stream_sptr(new std::ifstream(filename.c_str(), std::ios::in | std::ios::binary));
+    stream_sptr->seekg(static_cast<std::streamoff>(start_of_data));
+    InputStreamWithRecords<TestRecord, int> stream(stream_sptr, 1, 9, offset);
+    run_tests_for_stream(stream, "stream");
+  }
+  {
+    InputStreamWithRecords<TestRecord, int> stream(filename, 1, 9, offset, start_of_data);
+    // use a small buffer to check records spanning buffer boundaries
+    stream.set_buffer_size(100);
+    run_tests_for_stream(stream, "small buffer");
+  }
+  {
+    InputStreamWithRecords<TestRecord, int> stream(filename, 1, 9, offset, start_of_data, /* use_memory_mapping = */ true);
+    run_tests_for_stream(stream, "memory mapping");
+  }
+  std::remove(filename.c_str());
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  InputStreamWithRecordsTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -181,6 +181,69 @@ ML_normTests::test_proj_data_info(shared_ptr<TProjDataInfo> proj_data_info_sptr)
         }
     }
   }
+
+  // test iterate_efficiencies: if the data are consistent with the model, the efficiencies are a fixed point
+  {
+    DetectorEfficiencies efficiencies(IndexRange2D(num_physical_rings, num_physical_detectors_per_ring));
+    for (int ra = 0; ra < num_physical_rings; ++ra)
+      for (int a = 0; a < num_physical_detectors_per_ring; ++a)
+        efficiencies[ra][a] = 1.F + ((3 * ra + 7 * a) % 5) / 10.F;
+    FanProjData measured_fan_data = fan_data;
+    apply_efficiencies(measured_fan_data, efficiencies);
+    Array<2, float> data_fan_sums(IndexRange2D(num_physical_rings, num_physical_detectors_per_ring));
+    make_fan_sum_data(data_fan_sums, measured_fan_data);
+    for (int simultaneous_update = 0; simultaneous_update <= 1; ++simultaneous_update)
+      {
+        DetectorEfficiencies new_efficiencies(efficiencies);
+        iterate_efficiencies(new_efficiencies, data_fan_sums, fan_data, simultaneous_update == 1);
+        check_if_equal(efficiencies,
+                       new_efficiencies,
+                       simultaneous_update ? "iterate_efficiencies (simultaneous update)" : "iterate_efficiencies");
+      }
+
+    // test make_block_data: compare with accumulating ring by ring
+    const int num_axial_blocks = proj_data_info_sptr->get_scanner_sptr()->get_num_axial_blocks();
+    const int num_transaxial_blocks = proj_data_info_sptr->get_scanner_sptr()->get_num_transaxial_blocks();
+    BlockData3D block_data(num_axial_blocks, num_transaxial_blocks, num_axial_blocks - 1, num_transaxial_blocks - 1);
+    make_block_data(block_data, measured_fan_data);
+    BlockData3D org_block_data(num_axial_blocks, num_transaxial_blocks, num_axial_blocks - 1, num_transaxial_blocks - 1);
+    org_block_data.fill(0);
+    const int num_axial_crystals_per_block_in_fan = measured_fan_data.get_num_rings() / num_axial_blocks;
+    const int num_transaxial_crystals_per_block_in_fan = measured_fan_data.get_num_detectors_per_ring() / num_transaxial_blocks;
+    for (int ra = measured_fan_data.get_min_ra(); ra <= measured_fan_data.get_max_ra(); ++ra)
+      for (int a = measured_fan_data.get_min_a(); a <= measured_fan_data.get_max_a(); ++a)
+        for (int rb = std::max(ra, measured_fan_data.get_min_rb(ra)); rb <= measured_fan_data.get_max_rb(ra); ++rb)
+          for (int b = measured_fan_data.get_min_b(a); b <= measured_fan_data.get_max_b(a); ++b)
+            org_block_data(ra / num_axial_crystals_per_block_in_fan,
+                           a / num_transaxial_crystals_per_block_in_fan,
+                           rb / num_axial_crystals_per_block_in_fan,
+                           b / num_transaxial_crystals_per_block_in_fan)
+                += measured_fan_data(ra, a, rb, b);
+    check_if_equal(block_data.sum(), org_block_data.sum(), "make_block_data (sum over all blocks)");
+    for (int ra = block_data.get_min_ra(); ra <= block_data.get_max_ra(); ++ra)
+      for (int a = block_data.get_min_a(); a <= block_data.get_max_a(); ++a)
+        check_if_equal(block_data.sum(ra, a), org_block_data.sum(ra, a), "make_block_data (sum for one block)");
+    if (num_axial_blocks > 1)
+      {
+        // number of rings not a multiple of the number of axial blocks
+        const FanProjData odd_fan_data(measured_fan_data.get_num_rings() + 1,
+                                       measured_fan_data.get_num_detectors_per_ring(),
+                                       measured_fan_data.get_num_rings(),
+                                       measured_fan_data.get_num_detectors_per_ring() / 2);
+        bool error_thrown = false;
+        try
+          {
+            std::cerr << "\nmake_block_data should now throw an error\n";
+            make_block_data(block_data, odd_fan_data);
+          }
+        catch (...)
+          {
+            error_thrown = true;
+          }
+        check(error_thrown,
+              "make_block_data should refuse a number of rings that is not a multiple of the number of axial blocks");
+      }
+  }
 }
 
 END_NAMESPACE_STIR
@@ -41,6 +41,11 @@
 #include "stir/IO/write_to_file.h"
 #include "stir/stream.h"
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
 #include <math.h>
 #include "stir/centre_of_gravity.h"
 
@@ -73,6 +78,10 @@ private:
 
   void test_symmetric(ScatterSimulation& sss, const std::string& name);
   void test_output_is_symmetric(const ProjData& proj_data, const std::string& name);
+  //! run set_up() and process_data() and return the output
+  shared_ptr<ProjDataInMemory> run_scatter_simulation(ScatterSimulation& ss, const std::string& name);
+  void test_attenuation_integrals_cache_file(ScatterSimulation& ss,
+                                             const shared_ptr<const DiscretisedDensity<3, float>>& density_sptr);
 };
 
 void
@@ -285,6 +294,86 @@ ScatterSimulationTests::test_symmetric(ScatterSimulation& ss, const std::string&
     sss_output->write_to_file("my_single_scatter_sim_" + name + ".hs");
 }
 
+shared_ptr<ProjDataInMemory>
+ScatterSimulationTests::run_scatter_simulation(ScatterSimulation& ss, const std::string& name)
+{
+  shared_ptr<ProjDataInMemory> output_sptr(new ProjDataInMemory(ss.get_exam_info_sptr(), ss.get_template_proj_data_info_sptr()));
+  ss.set_output_proj_data_sptr(output_sptr);
+  check(ss.set_up() == Succeeded::yes ? true : false, "Check Scatter Simulation set_up. test " + name);
+  check(ss.process_data() == Succeeded::yes ? true : false, "Check Scatter Simulation process. test " + name);
+  return output_sptr;
+}
+
+void
+ScatterSimulationTests::test_attenuation_integrals_cache_file(
+    ScatterSimulation& ss, const shared_ptr<const DiscretisedDensity<3, float>>& density_sptr)
+{
+  std::cerr << "\nTesting reading/writing attenuation integrals\n";
+  const std::string filename = "test_ScatterSimulation_attenuation_integrals.bin";
+  std::remove(filename.c_str());
+  ss.set_attenuation_integrals_cache_filename(filename);
+  // reset attenuation image, such that any cached integrals are removed
+  ss.set_density_image_sptr(density_sptr);
+  ss.downsample_density_image_for_scatter_points(.2F, .3F, -1, -1);
+
+  auto org_output_sptr = run_scatter_simulation(ss, "writing attenuation integrals");
+  check(std::ifstream(filename.c_str()).good(), "attenuation integrals should have been written");
+
+  // again, but now the integrals should be read
+  ss.set_density_image_sptr(density_sptr);
+  ss.downsample_density_image_for_scatter_points(.2F, .3F, -1, -1);
+  auto output_sptr = run_scatter_simulation(ss, "reading attenuation integrals");
+  check_if_equal(*org_output_sptr, *output_sptr, "scatter simulation with attenuation integrals read from file");
+
+  // halve the stored integrals, keeping the header (signature, hash and sizes) intact.
+  // As the scatter estimate uses the product of 2 integrals, the output should be a quarter of the original
+  // if (and only if) the integrals are read from the file.
+  {
+    std::fstream s(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    std::string signature;
+    std::getline(s, signature, '\0');
+    const std::streamoff data_offset
+        = static_cast<std::streamoff>(signature.size() + 1 + sizeof(std::uint64_t) + 2 * sizeof(std::int32_t));
+    s.seekg(0, std::ios::end);
+    const std::streamoff file_size = s.tellg();
+    std::vector<float> integrals(static_cast<std::size_t>((file_size - data_offset) / sizeof(float)));
+    s.seekg(data_offset);
+    s.read(reinterpret_cast<char*>(integrals.data()), integrals.size() * sizeof(float));
+    for (auto& integral : integrals)
+      integral *= .5F;
+    s.seekp(data_offset);
+    s.write(reinterpret_cast<const char*>(integrals.data()), integrals.size() * sizeof(float));
+    check(!integrals.empty() && s.good(), "modifying attenuation integrals in file");
+  }
+  ss.set_density_image_sptr(density_sptr);
+  ss.downsample_density_image_for_scatter_points(.2F, .3F, -1, -1);
+  output_sptr = run_scatter_simulation(ss, "reading modified attenuation integrals");
+  {
+    SegmentBySinogram<float> expected_segment = org_output_sptr->get_segment_by_sinogram(0);
+    expected_segment *= .25F;
+    check_if_equal(expected_segment,
+                   output_sptr->get_segment_by_sinogram(0),
+                   "scatter simulation should use the (modified) attenuation integrals read from file");
+  }
+
+  // a different attenuation image should not use the file
+  shared_ptr<DiscretisedDensity<3, float>> other_density_sptr(density_sptr->clone());
+  *other_density_sptr *= 2.F;
+  ss.set_density_image_sptr(other_density_sptr);
+  ss.downsample_density_image_for_scatter_points(.2F, .3F, -1, -1);
+  output_sptr = run_scatter_simulation(ss, "attenuation integrals for different attenuation image");
+  {
+    const float org_max = org_output_sptr->get_segment_by_sinogram(0).find_max();
+    const float max = output_sptr->get_segment_by_sinogram(0).find_max();
+    check(std::fabs(org_max - max) > org_max * .01F, "scatter simulation with different attenuation image should not use the file");
+  }
+
+  // restore
+  ss.set_attenuation_integrals_cache_filename("");
+  ss.set_density_image_sptr(density_sptr);
+  std::remove(filename.c_str());
+}
+
 void
 ScatterSimulationTests::test_output_is_symmetric(const ProjData& proj_data, const std::string& name)
 {
@@ -469,6 +558,17 @@ ScatterSimulationTests::test_scatter_simulation()
   }
 #endif
 
+  test_attenuation_integrals_cache_file(*sss, water_density);
+
+  // caching uses precomputed integrals and geometric factors, check that this gives the same result
+  {
+    auto cached_output_sptr = run_scatter_simulation(*sss, "with cache");
+    sss->set_use_cache(false);
+    auto output_sptr = run_scatter_simulation(*sss, "without cache");
+    check_if_equal(*cached_output_sptr, *output_sptr, "scatter simulation with and without cache");
+    sss->set_use_cache(true);
+  }
+
   //    shared_ptr<ProjDataInMemory> atten_sino(new ProjDataInMemory(exam, output_projdata_info));
   //    atten_sino->fill(1.F);
   //    shared_ptr<ProjDataInMemory> act_sino(new ProjDataInMemory(exam, output_projdata_info));
@@ -34,8 +34,12 @@
 #include "stir/numerics/norm.h"
 #include "stir/IndexRange4D.h"
 #include "stir/CPUTimer.h"
+#include "stir/Bin.h"
 #include <algorithm>
 #include <numeric>
+#include <string>
+#include <vector>
+#include <fstream>
 
 START_NAMESPACE_STIR
 
@@ -51,6 +55,10 @@ public:
 private:
   void run_tests_on_proj_data(ProjData&);
   void run_tests_in_memory_only(ProjDataInMemory&);
+  //! write \a proj_data to file in the given storage order, read it back (using memory mapping) and compare
+  void run_tests_concurrent_reading(const ProjData& proj_data, const ProjDataFromStream::StorageOrder storage_order);
+  //! compare viewgrams (read in parallel), sinograms and bin values
+  void check_concurrent_reading(const ProjData& proj_data, const ProjDataFromStream& read_proj_data, const std::string& str);
 };
 
 void
@@ -403,6 +411,84 @@ ProjDataTests::run_tests_in_memory_only(ProjDataInMemory& proj_data)
   }
 }
 
+void
+ProjDataTests::check_concurrent_reading(const ProjData& proj_data, const ProjDataFromStream& read_proj_data, const std::string& str)
+{
+  for (int timing_pos_num = proj_data.get_min_tof_pos_num(); timing_pos_num <= proj_data.get_max_tof_pos_num(); ++timing_pos_num)
+    for (int seg = proj_data.get_min_segment_num(); seg <= proj_data.get_max_segment_num(); ++seg)
+      {
+        // read viewgrams in parallel (if OpenMP is enabled)
+        std::vector<int> equal(proj_data.get_num_views(), 0);
+#ifdef STIR_OPENMP
+#  pragma omp parallel for
+#endif
+        for (int view = proj_data.get_min_view_num(); view <= proj_data.get_max_view_num(); ++view)
+          {
+            const Viewgram<float> org = proj_data.get_viewgram(view, seg, false, timing_pos_num);
+            const Viewgram<float> read = read_proj_data.get_viewgram(view, seg, false, timing_pos_num);
+            equal[view - proj_data.get_min_view_num()] = org == read;
+          }
+        check(std::find(equal.begin(), equal.end(), 0) == equal.end(),
+              "get_viewgram with " + str + " (seg " + std::to_string(seg) + ")");
+
+        const int ax_pos_num = proj_data.get_max_axial_pos_num(seg);
+        const Sinogram<float> org = proj_data.get_sinogram(ax_pos_num, seg, false, timing_pos_num);
+        const Sinogram<float> read = read_proj_data.get_sinogram(ax_pos_num, seg, false, timing_pos_num);
+        check_if_equal(org, read, "get_sinogram with " + str);
+
+        const Bin bin(seg, proj_data.get_min_view_num(), ax_pos_num, proj_data.get_max_tangential_pos_num(), timing_pos_num);
+        check_if_equal(
+            read_proj_data.get_bin_value(bin), org[bin.view_num()][bin.tangential_pos_num()], "get_bin_value with " + str);
+      }
+}
+
+void
+ProjDataTests::run_tests_concurrent_reading(const ProjData& proj_data, const ProjDataFromStream::StorageOrder storage_order)
+{
+  std::cerr << "\ntest reading with positional reads and memory mapping\n";
+  {
+    ProjDataInterfile proj_data_interfile(proj_data.get_exam_info_sptr(),
+                                          proj_data.get_proj_data_info_sptr(),
+                                          "test_proj_data_mmap.hs",
+                                          std::ios::out,
+                                          storage_order);
+    proj_data_interfile.fill(proj_data);
+  }
+  {
+    const shared_ptr<ProjData> read_proj_data_sptr = ProjData::read_from_file("test_proj_data_mmap.hs");
+    const auto pdfs_ptr = dynamic_cast<ProjDataFromStream*>(read_proj_data_sptr.get());
+    if (!check(pdfs_ptr != 0, "read_from_file should return ProjDataFromStream"))
+      return;
+    check_if_equal(static_cast<int>(pdfs_ptr->get_storage_order()), static_cast<int>(storage_order), "storage order");
+    check(pdfs_ptr->uses_positional_reads_for_reading(), "read_from_file should use positional reads");
+    check(!pdfs_ptr->uses_memory_mapping_for_reading(), "read_from_file should not use memory mapping by default");
+    check_concurrent_reading(proj_data, *pdfs_ptr, "positional reads");
+
+    pdfs_ptr->use_memory_mapping_for_reading("test_proj_data_mmap.s");
+    check(pdfs_ptr->uses_memory_mapping_for_reading(), "memory mapping for reading should be enabled");
+    check_concurrent_reading(proj_data, *pdfs_ptr, "memory mapping");
+  }
+  {
+    // reading from a truncated file should fail with an error (and not crash)
+    const shared_ptr<ProjData> read_proj_data_sptr = ProjData::read_from_file("test_proj_data_mmap.hs");
+    {
+      std::ofstream truncated_file("test_proj_data_mmap.s", std::ios::out | std::ios::binary | std::ios::trunc);
+      truncated_file << "truncated";
+    }
+    bool failed = false;
+    try
+      {
+        std::cerr << "\nThe next test should give an error about reading data\n";
+        read_proj_data_sptr->get_viewgram(proj_data.get_max_view_num(), proj_data.get_max_segment_num());
+      }
+    catch (...)
+      {
+        failed = true;
+      }
+    check(failed, "reading from a truncated file with positional reads should throw");
+  }
+}
+
 void
 ProjDataTests::run_tests()
 {
@@ -439,6 +525,9 @@ ProjDataTests::run_tests()
 
     ProjDataInterfile(exam_info_sptr, proj_data_info_sptr, "test_proj_data.hs", std::ios::in | std::ios::out | std::ios::trunc);
     run_tests_on_proj_data(proj_data_in_memory);
+
+    run_tests_concurrent_reading(proj_data_in_memory, ProjDataFromStream::Segment_View_AxialPos_TangPos);
+    run_tests_concurrent_reading(proj_data_in_memory, ProjDataFromStream::Segment_AxialPos_View_TangPos);
   }
 
   std::cerr << "\n--------------------------------TOF tests\n";
@@ -471,6 +560,8 @@ ProjDataTests::run_tests()
     ProjDataInterfile proj_data_interfile(
         exam_info_sptr, proj_data_info_sptr, "test_proj_data.hs", std::ios::in | std::ios::out | std::ios::trunc);
     run_tests_on_proj_data(proj_data_interfile);
+
+    run_tests_concurrent_reading(proj_data_in_memory, ProjDataFromStream::Timing_Segment_View_AxialPos_TangPos);
   }
 }
 END_NAMESPACE_STIR
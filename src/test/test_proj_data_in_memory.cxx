@@ -5,7 +5,7 @@
   \file
   \ingroup test
 
-  \brief Test program for stir::ProjDataInMemory
+  \brief Test program for stir::ProjDataInMemory and stir::ProjDataMemoryMapped
 
   \author Kris Thielemans
 
@@ -28,6 +28,7 @@
 */
 
 #include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataMemoryMapped.h"
 #include "stir/ExamInfo.h"
 #include "stir/ProjDataInfo.h"
 #include "stir/Sinogram.h"
@@ -35,6 +36,8 @@
 #include "stir/Succeeded.h"
 #include "stir/RunTests.h"
 #include "stir/Scanner.h"
+#include <algorithm>
+#include <cstdio>
 
 START_NAMESPACE_STIR
 
@@ -48,6 +51,7 @@ public:
   void run_tests();
   void run_tests_no_tof();
   void run_tests_tof();
+  void run_tests_memory_mapped(shared_ptr<const ProjDataInfo> proj_data_info_sptr);
 };
 
 void
@@ -55,6 +59,16 @@ ProjDataInMemoryTests::run_tests()
 {
   this->run_tests_no_tof();
   this->run_tests_tof();
+  {
+    shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+    this->run_tests_memory_mapped(shared_ptr<const ProjDataInfo>(
+        ProjDataInfo::ProjDataInfoCTI(scanner_sptr, /*span*/ 1, 4, /*views*/ 48, /*tang_pos*/ 64, /*arc_corrected*/ true)));
+  }
+  {
+    shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::PETMR_Signa));
+    this->run_tests_memory_mapped(shared_ptr<const ProjDataInfo>(
+        ProjDataInfo::ProjDataInfoCTI(scanner_sptr, /*span*/ 1, 2, /*views*/ 48, /*tang_pos*/ 32, /*arc_corrected*/ true, 70)));
+  }
 }
 
 void
@@ -268,6 +282,61 @@ ProjDataInMemoryTests::run_tests_tof()
   }
 }
 
+void
+ProjDataInMemoryTests::run_tests_memory_mapped(shared_ptr<const ProjDataInfo> proj_data_info_sptr)
+{
+  std::cerr << "-------- Testing ProjDataMemoryMapped with " << proj_data_info_sptr->get_num_tof_poss()
+            << " TOF bins --------\n";
+  shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo);
+  const std::string filename = "test_proj_data_memory_mapped.hs";
+
+  ProjDataInMemory proj_data(exam_info_sptr, proj_data_info_sptr);
+  {
+    float value = 0.F;
+    for (auto iter = proj_data.begin_all(); iter != proj_data.end_all(); ++iter)
+      *iter = (value += 1.F);
+  }
+  const int min_timing_pos_num = proj_data.get_min_tof_pos_num();
+  const int max_timing_pos_num = proj_data.get_max_tof_pos_num();
+
+  {
+    ProjDataMemoryMapped mapped_proj_data(exam_info_sptr, proj_data_info_sptr, filename);
+    check_if_equal(mapped_proj_data.find_max(), 0.F, "test ProjDataMemoryMapped constructor initialises to 0");
+    mapped_proj_data.fill(proj_data);
+    check(std::equal(proj_data.begin_all(), proj_data.end_all(), mapped_proj_data.begin_all()), "test fill and begin_all()");
+    check_if_equal(mapped_proj_data.get_viewgram(2, -1, false, max_timing_pos_num),
+                   proj_data.get_viewgram(2, -1, false, max_timing_pos_num),
+                   "test fill and get_viewgram");
+    mapped_proj_data += proj_data;
+    check_if_equal(mapped_proj_data.sum(), 2 * proj_data.sum(), "test operator+= and sum()");
+    mapped_proj_data.flush();
+  }
+  proj_data *= 2.F;
+
+  // read back in different ways
+  {
+    shared_ptr<const ProjDataMemoryMapped> mapped_proj_data_sptr = ProjDataMemoryMapped::read_from_file(filename);
+    check(*mapped_proj_data_sptr->get_proj_data_info_sptr() == *proj_data_info_sptr,
+          "test read_from_file() and get_proj_data_info_sptr()");
+    check_if_equal(*mapped_proj_data_sptr, proj_data, "test read_from_file()");
+
+    shared_ptr<ProjData> proj_data_sptr = ProjData::read_from_file(filename);
+    check_if_equal(proj_data_sptr->get_sinogram(1, 1, false, min_timing_pos_num),
+                   proj_data.get_sinogram(1, 1, false, min_timing_pos_num),
+                   "test ProjData::read_from_file() of memory-mapped data and get_sinogram");
+
+    // modifications via a read-write mapping should be visible in the read-only one
+    {
+      shared_ptr<ProjDataMemoryMapped> updated_proj_data_sptr = ProjDataMemoryMapped::open_for_update(filename);
+      *updated_proj_data_sptr *= 3.F;
+    }
+    check_if_equal(mapped_proj_data_sptr->sum(), 3 * proj_data.sum(), "test open_for_update() and operator*=");
+  }
+
+  std::remove(filename.c_str());
+  std::remove("test_proj_data_memory_mapped.s");
+}
+
 END_NAMESPACE_STIR
 
 USING_NAMESPACE_STIR
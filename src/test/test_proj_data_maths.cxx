@@ -22,6 +22,7 @@
 */
 
 #include "stir/ProjDataInMemory.h"
+#include "stir/apply_to_proj_data.h"
 #include "stir/ExamInfo.h"
 #include "stir/ProjDataInfo.h"
 #include "stir/Sinogram.h"
@@ -31,7 +32,9 @@
 #include "stir/Scanner.h"
 #include "stir/copy_fill.h"
 #include "stir/error.h"
+#include "stir/num_threads.h"
 #include <string>
+#include <stdexcept>
 START_NAMESPACE_STIR
 
 /*!
@@ -114,6 +117,55 @@ ProjDataInMemoryTests::run_tests(shared_ptr<const ExamInfo> exam_info_sptr, shar
 
   check_proj_data_are_equal_and_non_zero(pd1, pd3, "fill");
 
+  // Check generic functions in apply_to_proj_data.h and reductions
+  {
+    ProjDataInMemory pd4(pd1);
+    auto a_x_plus_y = [a](float& out, float x, float y) { out = a * x + y; };
+    transform_proj_data(pd4, elementwise_function(a_x_plus_y), x1, y1);
+    ProjDataInMemory pd5(x1);
+    pd5.sapyb(a, y1, 1.F);
+    check_proj_data_are_equal_and_non_zero(pd4, pd5, "transform_proj_data");
+
+    in_place_apply_to_proj_data(pd4, elementwise_function([b](float& out, float y) { out += b * y; }), y1);
+    pd5.sapyb(1.F, y1, b);
+    check_proj_data_are_equal_and_non_zero(pd4, pd5, "in_place_apply_to_proj_data");
+
+    check_if_equal(pd1.ProjData::sum(), pd1.sum(), "ProjData::sum vs ProjDataInMemory::sum");
+    check_if_equal(pd1.ProjData::find_max(), pd1.find_max(), "ProjData::find_max vs ProjDataInMemory::find_max");
+    check_if_equal(pd1.ProjData::find_min(), pd1.find_min(), "ProjData::find_min vs ProjDataInMemory::find_min");
+    check_if_equal(pd1.ProjData::norm(), pd1.norm(), "ProjData::norm vs ProjDataInMemory::norm");
+
+    // exceptions thrown by func should be passed on to the caller
+    {
+      bool exception_thrown = false;
+      try
+        {
+          in_place_apply_to_proj_data(pd4, [](SegmentBySinogram<float>&) { throw std::runtime_error("test exception"); });
+        }
+      catch (...)
+        {
+          exception_thrown = true;
+        }
+      check(exception_thrown, "in_place_apply_to_proj_data should rethrow exceptions");
+    }
+    {
+      bool exception_thrown = false;
+      try
+        {
+          reduce_proj_data(
+              pd4,
+              0.F,
+              [](const SegmentBySinogram<float>&) -> float { throw std::runtime_error("test exception"); },
+              [](float x, float y) { return x + y; });
+        }
+      catch (...)
+        {
+          exception_thrown = true;
+        }
+      check(exception_thrown, "reduce_proj_data should rethrow exceptions");
+    }
+  }
+
   // clang-format 14.0 makes a complete mess of the stuff below, so we'll switch if off
   // clang-format off
 
@@ -348,6 +400,28 @@ ProjDataInMemoryTests::run_tests()
 
     run_tests(exam_info_sptr, proj_data_info_sptr);
   }
+
+  std::cerr << "------------------ number of threads for apply_to_proj_data\n";
+  {
+    shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+    shared_ptr<ProjDataInfo> small_proj_data_info_sptr(ProjDataInfo::construct_proj_data_info(scanner_sptr,
+                                                                                              /*span*/ 1,
+                                                                                              10,
+                                                                                              /*views*/ 96,
+                                                                                              /*tang_pos*/ 128,
+                                                                                              /*arc_corrected*/ true));
+    check_if_equal(detail::get_num_threads_for_apply(*small_proj_data_info_sptr, 3),
+                   get_max_num_threads(),
+                   "all threads should be used for small data");
+    // segment 0 is 31*4096*4096 floats, i.e. about 2 GB, so only one of them should be in memory
+    shared_ptr<ProjDataInfo> large_proj_data_info_sptr(ProjDataInfo::construct_proj_data_info(scanner_sptr,
+                                                                                              /*span*/ 1,
+                                                                                              0,
+                                                                                              /*views*/ 4096,
+                                                                                              /*tang_pos*/ 4096,
+                                                                                              /*arc_corrected*/ true));
+    check_if_equal(detail::get_num_threads_for_apply(*large_proj_data_info_sptr, 2), 1, "one thread should be used for large data");
+  }
 }
 
 END_NAMESPACE_STIR
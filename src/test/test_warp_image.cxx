@@ -91,6 +91,33 @@ warp_imageTests::run_tests()
     check_if_equal(new_image[indices], 0.F, "testing warped image at original location");
     check_if_equal(new_image[new_indices], 1.F, "testing warped image at new location");
   }
+  {
+    // warping with precomputed B-spline coefficients
+    const BSpline::BSplinesRegularGrid<3, float> image_interpolation(image, BSpline::linear);
+    VoxelsOnCartesianGrid<float> warped_image(range, origin, grid_spacing);
+    warped_image.fill(1.F); // should be overwritten
+    warp_image(warped_image, image_interpolation, motion_x, motion_y, motion_z);
+    check_if_equal(warped_image, new_image, "testing warp_image with precomputed B-spline coefficients");
+    warp_image(warped_image, image_interpolation, motion_x, motion_y, motion_z, /*accumulate=*/true);
+    check_if_equal(warped_image[new_indices], 2.F, "testing accumulating warp_image at new location");
+    check_if_equal(warped_image[indices], 0.F, "testing accumulating warp_image at original location");
+  }
+  {
+    // motion images with a larger index range than the image
+    IndexRange<3> larger_range(CartesianCoordinate3D<int>(-1, -16, -15), CartesianCoordinate3D<int>(41, 45, 46));
+    const shared_ptr<VoxelsOnCartesianGrid<float>> larger_motion_x_sptr(
+        new VoxelsOnCartesianGrid<float>(larger_range, origin, grid_spacing));
+    const shared_ptr<VoxelsOnCartesianGrid<float>> larger_motion_y_sptr(
+        new VoxelsOnCartesianGrid<float>(larger_range, origin, grid_spacing));
+    const shared_ptr<VoxelsOnCartesianGrid<float>> larger_motion_z_sptr(
+        new VoxelsOnCartesianGrid<float>(larger_range, origin, grid_spacing));
+    larger_motion_x_sptr->fill(3 * grid_spacing[3]);
+    larger_motion_y_sptr->fill(2 * grid_spacing[2]);
+    larger_motion_z_sptr->fill(grid_spacing[1]);
+    const VoxelsOnCartesianGrid<float> warped_image = warp_image(
+        image_sptr, larger_motion_x_sptr, larger_motion_y_sptr, larger_motion_z_sptr, BSpline::BSplineType(1), 0);
+    check_if_equal(warped_image, new_image, "testing warp_image with motion images with a larger index range");
+  }
   std::cerr << "Tests for class GatedSpatialTransformation::warp_image etc" << std::endl;
   const shared_ptr<VoxelsOnCartesianGrid<float>> new_image_sptr(new_image.clone());
   GatedDiscretisedDensity gated_image(image_sptr, 2);
@@ -174,6 +201,15 @@ warp_imageTests::run_tests()
     check_if_equal(
         accumulated_image[new_indices], 0.F, "testing the accumulated image at the location where the non-zero point had moved");
   }
+  {
+    // warp a single image to all gates
+    GatedDiscretisedDensity warped_gated_image(image_sptr, 2);
+    mvtest.warp_image(warped_gated_image, new_image);
+    check_if_equal(warped_gated_image.get_density(1), new_image, "testing warping the reference image to the 1st gate");
+    check_if_equal(warped_gated_image.get_density(2)[indices], 1.F, "testing warping the reference image to the 2nd gate");
+    check_if_equal(
+        warped_gated_image.get_density(2)[new_indices], 0.F, "testing warping the reference image to the 2nd gate (old location)");
+  }
 }
 END_NAMESPACE_STIR
 
@@ -29,7 +29,8 @@ static void
 print_usage_and_exit(const std::string& program_name)
 {
   std::cerr << "Usage: " << program_name
-            << " [--display | --print-KL | --include-block-timing-model | --for-symmetry-per-block] \\\n"
+            << " [--display | --print-KL | --include-block-timing-model | --for-symmetry-per-block \\\n"
+            << "  | --simultaneous-efficiencies-update] \\\n"
             << " out_filename_prefix measured_data model num_iterations num_eff_iterations\n"
             << " set num_iterations to 0 to do only efficiencies\n";
   exit(EXIT_FAILURE);
@@ -50,6 +51,7 @@ main(int argc, char** argv)
   bool do_geo = true;
   bool do_block = false;
   bool do_symmetry_per_block = false;
+  bool do_simultaneous_efficiencies_update = false;
 
   // first process command line options
   while (argc > 0 && argv[0][0] == '-' && argc >= 1)
@@ -84,6 +86,12 @@ main(int argc, char** argv)
           --argc;
           ++argv;
         }
+      else if (strcmp(argv[0], "--simultaneous-efficiencies-update") == 0)
+        {
+          do_simultaneous_efficiencies_update = true;
+          --argc;
+          ++argv;
+        }
       else
         print_usage_and_exit(program_name);
     }
@@ -114,7 +122,8 @@ main(int argc, char** argv)
                                             do_block,
                                             do_symmetry_per_block,
                                             do_KL,
-                                            do_display);
+                                            do_display,
+                                            do_simultaneous_efficiencies_update);
 
   timer.stop();
   info(boost::format("CPU time %1% secs") % timer.value());
@@ -109,11 +109,12 @@
 
 #include "stir/ArrayFunction.h"
 #include "stir/DiscretisedDensity.h"
-#include "stir/SegmentByView.h"
+#include "stir/SegmentBySinogram.h"
 #include "stir/IO/OutputFileFormat.h"
 #include "stir/IO/read_from_file.h"
 #include "stir/Succeeded.h"
 #include "stir/ProjDataInterfile.h"
+#include "stir/apply_to_proj_data.h"
 #include "stir/ExamInfo.h"
 #include "stir/utilities.h"
 #include "stir/Succeeded.h"
@@ -131,6 +132,9 @@
 #include <functional>
 #include <algorithm>
 #include <memory>
+#ifdef STIR_OPENMP
+#  include <mutex>
+#endif
 using std::cerr;
 using std::cout;
 using std::endl;
@@ -143,6 +147,21 @@ using std::vector;
 
 USING_NAMESPACE_STIR
 
+//! read a segment, serialising the reads if \a proj_data does not support reading from multiple threads
+static SegmentBySinogram<float>
+get_segment_by_sinogram_from_any_thread(const ProjData& proj_data, const SegmentIndices& segment_indices)
+{
+#ifdef STIR_OPENMP
+  if (!proj_data_io_is_thread_safe(proj_data))
+    {
+      static std::mutex mutex;
+      const std::lock_guard<std::mutex> lock(mutex);
+      return proj_data.get_segment_by_sinogram(segment_indices);
+    }
+#endif
+  return proj_data.get_segment_by_sinogram(segment_indices);
+}
+
 template <class DataT, class FunctionObjectT>
 void
 process_data(const string& output_file_name,
@@ -609,32 +628,50 @@ main(int argc, char** argv)
       for (int i = 1; i < num_files; ++i)
         all_proj_data[i] = ProjData::read_from_file(argv[i]);
 
-      // do reading/writing in a loop over segments
-      for (int segment_num = out_proj_data_ptr->get_min_segment_num(); segment_num <= out_proj_data_ptr->get_max_segment_num();
-           ++segment_num)
+      // do reading/writing in a loop over segments (and TOF bins), in parallel if possible.
+      // The first input is handled by in_place_apply_to_proj_data/transform_proj_data, the others are read here.
+      const auto combine_with_other_files = [&](SegmentBySinogram<float>& segment) {
+        const SegmentIndices segment_indices(segment.get_segment_num(), segment.get_timing_pos_num());
+        if (verbose)
+          {
+#ifdef STIR_OPENMP
+#  pragma omp critical(STIRMATHLOG)
+#endif
+            cout << "Processing segment num " << segment_indices.segment_num() << " (TOF bin "
+                 << segment_indices.timing_pos_num() << ") for all files" << endl;
+          }
+
+        if (!no_math_on_data && !except_first)
+          in_place_apply_function(segment, pow_times_add_object);
+        for (int f = 1; f < num_files; ++f)
+          {
+            SegmentBySinogram<float> current_segment
+                = get_segment_by_sinogram_from_any_thread(*all_proj_data[f], segment_indices);
+            if (!no_math_on_data)
+              in_place_apply_function(current_segment, pow_times_add_object);
+            if (do_add)
+              segment += current_segment;
+            else
+              segment *= current_segment;
+          }
+      };
+      try
         {
-          if (verbose)
-            cout << "Processing segment num " << segment_num << " for all files" << endl;
-
-          for (int k = out_proj_data_ptr->get_min_tof_pos_num(); k <= out_proj_data_ptr->get_max_tof_pos_num(); ++k)
-            {
-              SegmentByView<float> segment_by_view = (*all_proj_data[0]).get_segment_by_view(segment_num, k);
-              if (!no_math_on_data && !except_first)
-                in_place_apply_function(segment_by_view, pow_times_add_object);
-              for (int i = 1; i < num_files; ++i)
-                {
-                  SegmentByView<float> current_segment_by_view = (*all_proj_data[i]).get_segment_by_view(segment_num, k);
-                  if (!no_math_on_data)
-                    in_place_apply_function(current_segment_by_view, pow_times_add_object);
-                  if (do_add)
-                    segment_by_view += current_segment_by_view;
-                  else
-                    segment_by_view *= current_segment_by_view;
-                }
-
-              if (!(out_proj_data_ptr->set_segment(segment_by_view) == Succeeded::yes))
-                warning("Error set_segment %d\n", segment_num);
-            }
+          if (accumulate)
+            in_place_apply_to_proj_data(*out_proj_data_ptr, combine_with_other_files);
+          else
+            transform_proj_data(
+                *out_proj_data_ptr,
+                [&](SegmentBySinogram<float>& segment, const SegmentBySinogram<float>& first_segment) {
+                  segment += first_segment;
+                  combine_with_other_files(segment);
+                },
+                *all_proj_data[0]);
+        }
+      catch (std::exception& e)
+        {
+          warning(e.what());
+          return EXIT_FAILURE;
         }
     }
   return EXIT_SUCCESS;
@@ -35,6 +35,8 @@
 #include "stir/recon_buildblock/ProjMatrixByBinUsingRayTracing.h"
 #include "stir/recon_buildblock/PoissonLogLikelihoodWithLinearModelForMeanAndProjData.h"
 #include "stir/recon_buildblock/RelativeDifferencePrior.h"
+#include "stir/recon_buildblock/QuadraticPrior.h"
+#include "stir/recon_buildblock/LogcoshPrior.h"
 #ifdef STIR_WITH_CUDA
 #  include "stir/recon_buildblock/CUDA/CudaRelativeDifferencePrior.h"
 #endif
@@ -358,6 +360,20 @@ Timings::run_all(const unsigned runs)
         this->run_it(&Timings::prior_grad, "RDP_grad", runs * 10);
         this->prior_sptr = nullptr;
       }
+      {
+        this->prior_sptr = std::make_shared<QuadraticPrior<float>>(false, 1.F);
+        this->prior_sptr->set_up(this->image_sptr);
+        this->run_it(&Timings::prior_value, "QP_value", runs * 10);
+        this->run_it(&Timings::prior_grad, "QP_grad", runs * 10);
+        this->prior_sptr = nullptr;
+      }
+      {
+        this->prior_sptr = std::make_shared<LogcoshPrior<float>>(false, 1.F, 1.F);
+        this->prior_sptr->set_up(this->image_sptr);
+        this->run_it(&Timings::prior_value, "Logcosh_value", runs * 10);
+        this->run_it(&Timings::prior_grad, "Logcosh_grad", runs * 10);
+        this->prior_sptr = nullptr;
+      }
 #ifdef STIR_WITH_CUDA
       {
         this->prior_sptr = std::make_shared<CudaRelativeDifferencePrior<float>>(false, 1.F, 2.F, 0.1F);